@@ -50,6 +50,9 @@ void CSound::OpenJack()
     // register a "buffer size changed" callback function
     jack_set_buffer_size_callback ( pJackClient, bufferSizeCallback, this );
 
+    // register a callback function which counts the buffer over- and underruns
+    jack_set_xrun_callback ( pJackClient, xrunCallback, this );
+
     // register shutdown callback function
     jack_on_shutdown ( pJackClient, shutdownCallback, this );
 
@@ -208,6 +211,7 @@ int CSound::Init ( const int /* iNewPrefMonoBufferSize */ )
 
     // create memory for intermediate audio buffer
     vecsTmpAudioSndCrdStereo.Init ( iJACKBufferSizeStero );
+    vecfTmpAudioSndCrdStereo.Init ( iJACKBufferSizeStero );
 
     return iJACKBufferSizeMono;
 }
@@ -230,19 +234,6 @@ int CSound::process ( jack_nframes_t nframes, void* arg )
             (jack_default_audio_sample_t*) jack_port_get_buffer (
             pSound->input_port_right, nframes );
 
-        // copy input data
-        for ( i = 0; i < pSound->iJACKBufferSizeMono; i++ )
-        {
-            pSound->vecsTmpAudioSndCrdStereo[2 * i] =
-                (short) ( in_left[i] * _MAXSHORT );
-
-            pSound->vecsTmpAudioSndCrdStereo[2 * i + 1] =
-                (short) ( in_right[i] * _MAXSHORT );
-        }
-
-        // call processing callback function
-        pSound->ProcessCallback ( pSound->vecsTmpAudioSndCrdStereo );
-
         // get output data pointer
         jack_default_audio_sample_t* out_left =
             (jack_default_audio_sample_t*) jack_port_get_buffer (
@@ -252,14 +243,50 @@ int CSound::process ( jack_nframes_t nframes, void* arg )
             (jack_default_audio_sample_t*) jack_port_get_buffer (
             pSound->output_port_right, nframes );
 
-        // copy output data
-        for ( i = 0; i < pSound->iJACKBufferSizeMono; i++ )
+        if ( pSound->IsProcessCallbackFloatSet() )
         {
-            out_left[i] = (jack_default_audio_sample_t)
-                pSound->vecsTmpAudioSndCrdStereo[2 * i] / _MAXSHORT;
-
-            out_right[i] = (jack_default_audio_sample_t)
-                pSound->vecsTmpAudioSndCrdStereo[2 * i + 1] / _MAXSHORT;
+            // the floating point callback gets the JACK samples without a
+            // conversion to 16 bit
+            for ( i = 0; i < pSound->iJACKBufferSizeMono; i++ )
+            {
+                pSound->vecfTmpAudioSndCrdStereo[2 * i]     = in_left[i];
+                pSound->vecfTmpAudioSndCrdStereo[2 * i + 1] = in_right[i];
+            }
+
+            // call processing callback function
+            pSound->ProcessCallbackFloat ( pSound->vecfTmpAudioSndCrdStereo );
+
+            // copy output data
+            for ( i = 0; i < pSound->iJACKBufferSizeMono; i++ )
+            {
+                out_left[i]  = pSound->vecfTmpAudioSndCrdStereo[2 * i];
+                out_right[i] = pSound->vecfTmpAudioSndCrdStereo[2 * i + 1];
+            }
+        }
+        else
+        {
+            // copy input data
+            for ( i = 0; i < pSound->iJACKBufferSizeMono; i++ )
+            {
+                pSound->vecsTmpAudioSndCrdStereo[2 * i] =
+                    (short) ( in_left[i] * _MAXSHORT );
+
+                pSound->vecsTmpAudioSndCrdStereo[2 * i + 1] =
+                    (short) ( in_right[i] * _MAXSHORT );
+            }
+
+            // call processing callback function
+            pSound->ProcessCallback ( pSound->vecsTmpAudioSndCrdStereo );
+
+            // copy output data
+            for ( i = 0; i < pSound->iJACKBufferSizeMono; i++ )
+            {
+                out_left[i] = (jack_default_audio_sample_t)
+                    pSound->vecsTmpAudioSndCrdStereo[2 * i] / _MAXSHORT;
+
+                out_right[i] = (jack_default_audio_sample_t)
+                    pSound->vecsTmpAudioSndCrdStereo[2 * i + 1] / _MAXSHORT;
+            }
         }
     }
     else
@@ -293,6 +320,15 @@ int CSound::bufferSizeCallback ( jack_nframes_t, void *arg )
     return 0; // zero on success, non-zero on error
 }
 
+int CSound::xrunCallback ( void *arg )
+{
+    CSound* pSound = reinterpret_cast<CSound*> ( arg );
+
+    pSound->CountXrun();
+
+    return 0; // zero on success, non-zero on error
+}
+
 void CSound::shutdownCallback ( void* )
 {
     // without a Jack server, our software makes no sense to run, throw
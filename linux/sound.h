@@ -67,9 +67,12 @@ public:
     virtual void Start();
     virtual void Stop();
 
+    virtual bool IsXrunCountAvailable() { return true; }
+
     // these variables should be protected but cannot since we want
     // to access them from the callback function
     CVector<short> vecsTmpAudioSndCrdStereo;
+    CVector<float> vecfTmpAudioSndCrdStereo;
     int            iJACKBufferSizeMono;
     int            iJACKBufferSizeStero;
 
@@ -85,6 +88,7 @@ protected:
     // callbacks
     static int      process ( jack_nframes_t nframes, void* arg );
     static int      bufferSizeCallback ( jack_nframes_t, void *arg );
+    static int      xrunCallback ( void *arg );
     static void     shutdownCallback ( void* );
     jack_client_t*  pJackClient;
 };
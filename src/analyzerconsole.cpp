@@ -67,6 +67,28 @@ CAnalyzerConsole::CAnalyzerConsole ( CClient* pNCliP,
     pMainTabWidget->addTab ( pTabWidgetBufErrRate,
                              tr ( "Error Rate of Each Buffer Size" ) );
 
+    // audio processing time tab
+    pTabWidgetAudioProcTime = new QWidget();
+    QVBoxLayout* pTabAudioProcTimeLayout = new QVBoxLayout ( pTabWidgetAudioProcTime );
+
+    pLabelAudioProcTime = new QLabel ( this );
+    pLabelAudioProcTime->setAlignment ( Qt::AlignLeft | Qt::AlignTop );
+    pTabAudioProcTimeLayout->addWidget ( pLabelAudioProcTime );
+
+    pMainTabWidget->addTab ( pTabWidgetAudioProcTime,
+                             tr ( "Audio Processing Time" ) );
+
+    // network timing tab
+    pTabWidgetNetworkTiming = new QWidget();
+    QVBoxLayout* pTabNetworkTimingLayout = new QVBoxLayout ( pTabWidgetNetworkTiming );
+
+    pLabelNetworkTiming = new QLabel ( this );
+    pLabelNetworkTiming->setAlignment ( Qt::AlignLeft | Qt::AlignTop );
+    pTabNetworkTimingLayout->addWidget ( pLabelNetworkTiming );
+
+    pMainTabWidget->addTab ( pTabWidgetNetworkTiming,
+                             tr ( "Network Timing" ) );
+
 
     // Connections -------------------------------------------------------------
     // timers
@@ -76,6 +98,9 @@ CAnalyzerConsole::CAnalyzerConsole ( CClient* pNCliP,
 
 void CAnalyzerConsole::showEvent ( QShowEvent* )
 {
+    // the simulation buffer statistic is only calculated for the display
+    pClient->SetBufSimulationEnabled ( true );
+
     // start timer for error rate graph
     TimerErrRateUpdate.start ( ERR_RATE_GRAPH_UPDATE_TIME_MS );
 }
@@ -84,6 +109,8 @@ void CAnalyzerConsole::hideEvent ( QHideEvent* )
 {
     // if window is closed, stop timer
     TimerErrRateUpdate.stop();
+
+    pClient->SetBufSimulationEnabled ( false );
 }
 
 void CAnalyzerConsole::OnTimerErrRateUpdate()
@@ -94,6 +121,9 @@ void CAnalyzerConsole::OnTimerErrRateUpdate()
 
     // set new image to the label
     pGraphErrRate->setPixmap ( QPixmap().fromImage ( GraphImage ) );
+
+    UpdateAudioProcTimeStats();
+    UpdateNetworkTimingStats();
 }
 
 void CAnalyzerConsole::DrawFrame()
@@ -191,6 +221,133 @@ void CAnalyzerConsole::DrawErrorRateTrace()
                                          GraphGridFrame.height() ),
                                 curPoint );
     }
+
+    // compare the decision of the simulation buffer statistic with the
+    // current jitter buffer size (which is set by the inter-arrival statistic
+    // if the auto setting is enabled)
+    GraphPainter.setPen ( GraphFrameColor );
+
+    GraphPainter.drawText ( QPoint ( GraphGridFrame.x() + iGridFrameOffset,
+                                     GraphGridFrame.y() + iXAxisTextHeight ),
+        tr ( "Jitter buffer size: " ) +
+        QString().setNum ( pClient->GetSockBufNumFrames() ) +
+        tr ( ", simulation decision: " ) +
+        QString().setNum ( pClient->GetBufSimulationAutoSetting() ) );
+
+    // counters of the frames which were received out of order (only available
+    // if the server supports sequence numbers)
+    int iNumReordered;
+    int iNumLate;
+
+    pClient->GetBufSeqNumStats ( iNumReordered, iNumLate );
+
+    GraphPainter.drawText ( QPoint ( GraphGridFrame.x() + iGridFrameOffset,
+                                     GraphGridFrame.y() + 2 * iXAxisTextHeight ),
+        tr ( "Reordered frames: " ) + QString().setNum ( iNumReordered ) +
+        tr ( ", late frames: " ) + QString().setNum ( iNumLate ) );
+
+    // frames which were recovered from the redundancy frames and frames which
+    // had to be concealed
+    int iNumRecovered;
+    int iNumConcealed;
+
+    pClient->GetBufRedundancyStats ( iNumRecovered, iNumConcealed );
+
+    GraphPainter.drawText ( QPoint ( GraphGridFrame.x() + iGridFrameOffset,
+                                     GraphGridFrame.y() + 3 * iXAxisTextHeight ),
+        tr ( "Recovered frames: " ) + QString().setNum ( iNumRecovered ) +
+        tr ( ", concealed frames: " ) + QString().setNum ( iNumConcealed ) );
+
+    // clock drift of the server relative to the sound card (zero until the
+    // estimation is reliable)
+    GraphPainter.drawText ( QPoint ( GraphGridFrame.x() + iGridFrameOffset,
+                                     GraphGridFrame.y() + 4 * iXAxisTextHeight ),
+        tr ( "Clock drift: " ) +
+        QString().setNum ( pClient->GetClockDriftPpm(), 'f', 1 ) + " ppm" );
+}
+
+void CAnalyzerConsole::UpdateAudioProcTimeStats()
+{
+    const CAudioProcTimeStats& AudioProcTimeStats =
+        pClient->GetAudioProcTimeStats();
+
+    // the processing times are given in percent of the budget which is the
+    // duration of one sound card block
+    QString strStats = tr ( "Budget per audio callback: " ) +
+        QString().setNum ( AudioProcTimeStats.GetBudgetUs() ) + " us\n" +
+        tr ( "Audio callbacks: " ) +
+        QString().setNum ( AudioProcTimeStats.GetNumCallbacks() ) +
+        tr ( ", near budget: " ) +
+        QString().setNum ( AudioProcTimeStats.GetNumNearBudget() ) +
+        tr ( ", over budget: " ) +
+        QString().setNum ( AudioProcTimeStats.GetNumOverBudget() ) + "\n";
+
+    if ( pClient->IsSndCrdXrunCountAvailable() )
+    {
+        strStats += tr ( "Sound card xruns: " ) +
+            QString().setNum ( pClient->GetSndCrdNumXruns() );
+    }
+    else
+    {
+        strStats += tr ( "Sound card xruns: not available" );
+    }
+
+    strStats += tr ( ", dropped send packets: " ) +
+        QString().setNum ( pClient->GetNumDroppedSendPackets() ) + "\n";
+
+    // the audio callback must neither wait for a lock nor allocate memory
+    strStats += tr ( "Callback lock contentions: " ) +
+        QString().setNum ( pClient->GetNumLockContentions() ) +
+        tr ( ", allocations: " ) +
+        QString().setNum ( pClient->GetNumCallbackAllocs() ) + "\n";
+
+    const QString strStageNames[APS_NUM_STAGES] =
+        { tr ( "Reverb" ), tr ( "Encode" ), tr ( "Send" ),
+          tr ( "Decode" ), tr ( "Total" ) };
+
+    for ( int i = 0; i < APS_NUM_STAGES; i++ )
+    {
+        const EAudioProcStage eStage = static_cast<EAudioProcStage> ( i );
+
+        strStats += "\n" + strStageNames[i] + tr ( " (max " ) +
+            QString().setNum ( AudioProcTimeStats.GetMaxTimeUs ( eStage ) ) +
+            " us):\n  " + AudioProcTimeStats.GetHistogramText ( eStage ) + "\n";
+    }
+
+    // the statistic of the last connections is logged on disconnect
+    const QStringList& strlstLog = pClient->GetAudioProcTimeStatsLog();
+
+    if ( !strlstLog.isEmpty() )
+    {
+        strStats += "\n" + tr ( "Last connections:" ) + "\n" +
+            strlstLog.join ( "\n" ) + "\n";
+    }
+
+    pLabelAudioProcTime->setText ( strStats );
+}
+
+void CAnalyzerConsole::UpdateNetworkTimingStats()
+{
+    const CRttStatistics& RttStats = pClient->GetRttStatistics();
+
+    QString strStats = tr ( "Ping time to the server (last " ) +
+        QString().setNum ( RttStats.GetNumValues() ) + tr ( " pings):\n  " ) +
+        RttStats.GetText() + "\n\n" +
+        tr ( "Inter-arrival jitter of the received audio packets: " ) +
+        QString().setNum ( pClient->GetInterArrivalJitterUs() / 1000.0, 'f', 2 ) +
+        " ms\n\n";
+
+    if ( pClient->IsKernelRecTimeStampEnabled() )
+    {
+        strStats += tr ( "Receive time stamps: kernel (pings), socket "
+            "thread (audio packets)" );
+    }
+    else
+    {
+        strStats += tr ( "Receive time stamps: socket thread" );
+    }
+
+    pLabelNetworkTiming->setText ( strStats );
 }
 
 int CAnalyzerConsole::CalcYPosInGraph ( const double dAxisMin,
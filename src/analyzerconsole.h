@@ -57,6 +57,8 @@ protected:
 
     void DrawFrame();
     void DrawErrorRateTrace();
+    void UpdateAudioProcTimeStats();
+    void UpdateNetworkTimingStats();
     int  CalcYPosInGraph ( const double dAxisMin,
                            const double dAxisMax,
                            const double dValue ) const;
@@ -65,10 +67,15 @@ protected:
 
     QTabWidget* pMainTabWidget;
     QWidget*    pTabWidgetBufErrRate;
+    QWidget*    pTabWidgetAudioProcTime;
+    QWidget*    pTabWidgetNetworkTiming;
 
     QLabel*     pGraphErrRate;
     QImage      GraphImage;
 
+    QLabel*     pLabelAudioProcTime;
+    QLabel*     pLabelNetworkTiming;
+
     QRect       GraphErrRateCanvasRect;
     QRect       GraphGridFrame;
 
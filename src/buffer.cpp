@@ -33,6 +33,28 @@ void CNetBuf::Init ( const int  iNewBlockSize,
                      const int  iNewNumBlocks,
                      const bool bPreserve )
 {
+    CVector<int>     veciOldSeqNum;
+    CVector<uint8_t> vecbyOldReceived;
+
+    // the base class preserves the data starting at the get position, we have
+    // to do the same with the states of the blocks
+    if ( bPreserve && bIsInitialized && !bIsSimulation )
+    {
+        const int iNumOldBlocks = GetAvailData() / iBlockSize;
+        const int iOldGetBlock  = iGetPos / iBlockSize;
+
+        veciOldSeqNum.Init    ( iNumOldBlocks );
+        vecbyOldReceived.Init ( iNumOldBlocks );
+
+        for ( int i = 0; i < iNumOldBlocks; i++ )
+        {
+            const int iBlock = ( iOldGetBlock + i ) % veciBlockSeqNum.Size();
+
+            veciOldSeqNum[i]    = veciBlockSeqNum[iBlock];
+            vecbyOldReceived[i] = vecbyBlockReceived[iBlock];
+        }
+    }
+
     // store block size value
     iBlockSize = iNewBlockSize;
 
@@ -40,6 +62,16 @@ void CNetBuf::Init ( const int  iNewBlockSize,
     CBufferBase<uint8_t>::Init ( iNewBlockSize * iNewNumBlocks,
                                  bPreserve );
 
+    // blocks which were never written must not match any sequence number
+    veciBlockSeqNum.Init    ( iNewNumBlocks, -1 );
+    vecbyBlockReceived.Init ( iNewNumBlocks, 1 );
+
+    for ( int i = 0; ( i < veciOldSeqNum.Size() ) && ( i < iNewNumBlocks ); i++ )
+    {
+        veciBlockSeqNum[i]    = veciOldSeqNum[i];
+        vecbyBlockReceived[i] = vecbyOldReceived[i];
+    }
+
     // clear buffer if not preserved
     if ( !bPreserve )
     {
@@ -47,30 +79,146 @@ void CNetBuf::Init ( const int  iNewBlockSize,
     }
 }
 
+void CNetBuf::Clear()
+{
+    CBufferBase<uint8_t>::Clear();
+
+    // synchronize to the sequence number of the next frame
+    bSeqNumSync    = false;
+    iNumReordered  = 0;
+    iNumLate       = 0;
+    iNumRecovered  = 0;
+    iNumConcealed  = 0;
+    iNumPutFrames  = 0;
+    iLastGetSeqNum = -1;
+}
+
 bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData,
                     const int               iInSize )
 {
     bool bPutOK = true;
 
+    // a packet may contain several blocks (block size factor)
+    const int iNumPacketBlocks = iInSize / iBlockSize;
+
+    iNumPutFrames += iNumPacketBlocks;
+
     // check if there is not enough space available
     if ( GetAvailSpace() < iInSize )
     {
         return false;
     }
 
+    // without sequence number the packet is stored in the order of arrival,
+    // all blocks of the packet get the sequence number of the packet
+    MarkPacketBlocks ( iPutPos / iBlockSize, iNumPacketBlocks, iPutSeqNum, 1 );
+    iPutSeqNum = ( iPutSeqNum + 1 ) % NET_BUF_SEQ_NUM_RANGE;
+
     // copy new data in internal buffer (implemented in base class)
     CBufferBase<uint8_t>::Put ( vecbyData, iInSize );
 
     return bPutOK;
 }
 
-bool CNetBuf::Get ( CVector<uint8_t>& vecbyData )
+bool CNetBuf::Put ( const CVector<uint8_t>& vecbyData,
+                    const int               iInSize,
+                    const int               iSeqNum )
 {
-    bool bGetOK = true; // init return value
+    const int iNumBlocks       = veciBlockSeqNum.Size();
+    const int iNumPacketBlocks = iInSize / iBlockSize;
+
+    if ( ( iNumPacketBlocks < 1 ) || ( iNumPacketBlocks > iNumBlocks ) )
+    {
+        return false;
+    }
 
+    const int iNumPackets = iNumBlocks / iNumPacketBlocks;
+
+    // distance of the sequence number to the one of the next packet which is
+    // stored at the put position (considering the wrap around)
+    int iSeqNumDist = GetSeqNumDist ( iSeqNum );
+
+    // synchronize on the first packet and if the sequence number does not fit
+    // into the buffer at all (e.g. if the sender was restarted)
+    if ( !bSeqNumSync || ( iSeqNumDist >= iNumPackets ) ||
+         ( -iSeqNumDist > iNumPackets ) )
+    {
+        bSeqNumSync = true;
+        iPutSeqNum  = iSeqNum;
+        iSeqNumDist = 0;
+    }
+
+    if ( iSeqNumDist < 0 )
+    {
+        // the packet is older than the last stored packet, it can only be used
+        // if it fills a gap which was not yet read
+        const int iBlock = GetPacketFirstBlock ( iSeqNumDist, iNumPacketBlocks );
+
+        if ( ( -iSeqNumDist * iNumPacketBlocks <= GetAvailData() / iBlockSize ) &&
+             ( veciBlockSeqNum[iBlock] == iSeqNum ) &&
+             !vecbyBlockReceived[iBlock] )
+        {
+            if ( !bIsSimulation )
+            {
+                for ( int i = 0; i < iInSize; i++ )
+                {
+                    vecMemory[GetPacketMemPos ( iBlock, i )] = vecbyData[i];
+                }
+            }
+
+            MarkPacketBlocks ( iBlock, iNumPacketBlocks, iSeqNum, 1 );
+            iNumReordered++;
+
+            return true;
+        }
+        else
+        {
+            // the packet was already read (or is a duplicate) -> drop it
+            iNumLate++;
+
+            return false;
+        }
+    }
+    else
+    {
+        // check if there is enough space for the missing packets and the
+        // received packet
+        if ( GetAvailSpace() < ( iSeqNumDist + 1 ) * iInSize )
+        {
+            return false;
+        }
+
+        // the missing packets were sent, too
+        iNumPutFrames += iSeqNumDist * iNumPacketBlocks;
+
+        // mark the blocks of the missing packets, they are filled if the
+        // packets arrive later, otherwise they are concealed on reading (the
+        // put position is advanced by the base class, the copied payload of
+        // the current packet is then replaced by silence)
+        for ( int i = 0; i < iSeqNumDist; i++ )
+        {
+            const int iGapBlock = iPutPos / iBlockSize;
+
+            MarkPacketBlocks ( iGapBlock, iNumPacketBlocks, iPutSeqNum, 0 );
+
+            iPutSeqNum = ( iPutSeqNum + 1 ) % NET_BUF_SEQ_NUM_RANGE;
+
+            CBufferBase<uint8_t>::Put ( vecbyData, iInSize );
+
+            ClearPacketBlocks ( iGapBlock, iNumPacketBlocks );
+        }
+
+        return CNetBuf::Put ( vecbyData, iInSize );
+    }
+}
+
+bool CNetBuf::Get ( CVector<uint8_t>& vecbyData )
+{
     // get size of data to be get from the buffer
     const int iInSize = vecbyData.Size();
 
+    iLastGetSeqNum = -1;
+
     // check size
     if ( ( iInSize == 0 ) || ( iInSize != iBlockSize ) )
     {
@@ -83,6 +231,19 @@ bool CNetBuf::Get ( CVector<uint8_t>& vecbyData )
         return false;
     }
 
+    // a block of a missing packet is read but an error is returned so that the
+    // frame is concealed
+    const bool bGetOK = ( vecbyBlockReceived[iGetPos / iBlockSize] != 0 );
+
+    if ( bGetOK )
+    {
+        iLastGetSeqNum = veciBlockSeqNum[iGetPos / iBlockSize];
+    }
+    else
+    {
+        iNumConcealed++;
+    }
+
     // copy data from internal buffer in output buffer (implemented in base
     // class)
     CBufferBase<uint8_t>::Get ( vecbyData );
@@ -90,10 +251,282 @@ bool CNetBuf::Get ( CVector<uint8_t>& vecbyData )
     return bGetOK;
 }
 
+bool CNetBuf::PutRedundancy ( const CVector<uint8_t>& vecbyData,
+                              const int               iSeqNum,
+                              const int               iNumFrames )
+{
+    // the redundancy frame is the XOR of the iNumFrames packets before the
+    // packet with the given sequence number, if exactly one of these packets
+    // is missing and not yet read, it can be recovered (the data of the
+    // packets which are already read are still in the buffer memory as long
+    // as the blocks were not overwritten)
+    const int iInSize          = vecbyData.Size();
+    const int iNumBlocks       = veciBlockSeqNum.Size();
+    const int iNumPacketBlocks = iInSize / iBlockSize;
+    int       viFirstBlocks[MAX_NUM_REDUNDANCY_FRAMES];
+    int       iMissBlock       = -1;
+    int       i, j;
+
+    if ( bIsSimulation || !bSeqNumSync || ( iNumPacketBlocks < 1 ) ||
+         ( iNumFrames < 1 ) || ( iNumFrames > MAX_NUM_REDUNDANCY_FRAMES ) ||
+         ( iNumFrames * iNumPacketBlocks > iNumBlocks ) )
+    {
+        return false;
+    }
+
+    for ( i = 0; i < iNumFrames; i++ )
+    {
+        const int iCurSeqNum = ( iSeqNum - i - 1 + NET_BUF_SEQ_NUM_RANGE ) %
+            NET_BUF_SEQ_NUM_RANGE;
+
+        // the protected packets must be stored before the put position
+        const int iSeqNumDist = GetSeqNumDist ( iCurSeqNum );
+
+        if ( ( iSeqNumDist >= 0 ) ||
+             ( -iSeqNumDist * iNumPacketBlocks > iNumBlocks ) )
+        {
+            return false;
+        }
+
+        const int iBlock = GetPacketFirstBlock ( iSeqNumDist, iNumPacketBlocks );
+
+        // the blocks must not be overwritten by another packet
+        if ( veciBlockSeqNum[iBlock] != iCurSeqNum )
+        {
+            return false;
+        }
+
+        viFirstBlocks[i] = iBlock;
+
+        if ( !vecbyBlockReceived[iBlock] )
+        {
+            // only one missing packet can be recovered and it must not be read
+            if ( ( iMissBlock >= 0 ) ||
+                 ( -iSeqNumDist * iNumPacketBlocks > GetAvailData() / iBlockSize ) )
+            {
+                return false;
+            }
+
+            iMissBlock = iBlock;
+        }
+    }
+
+    if ( iMissBlock < 0 )
+    {
+        return false; // nothing to recover
+    }
+
+    // XOR of the redundancy frame with all received packets
+    for ( j = 0; j < iInSize; j++ )
+    {
+        uint8_t byData = vecbyData[j];
+
+        for ( i = 0; i < iNumFrames; i++ )
+        {
+            if ( viFirstBlocks[i] != iMissBlock )
+            {
+                byData ^= vecMemory[GetPacketMemPos ( viFirstBlocks[i], j )];
+            }
+        }
+
+        vecMemory[GetPacketMemPos ( iMissBlock, j )] = byData;
+    }
+
+    MarkPacketBlocks ( iMissBlock, iNumPacketBlocks,
+                       veciBlockSeqNum[iMissBlock], 1 );
+
+    iNumRecovered++;
+
+    return true;
+}
+
+int CNetBuf::GetSeqNumDist ( const int iSeqNum ) const
+{
+    // distance of the sequence number to the one of the next packet (modulo
+    // the sequence number range, mapped to positive and negative values)
+    int iSeqNumDist = ( iSeqNum - iPutSeqNum + NET_BUF_SEQ_NUM_RANGE ) %
+        NET_BUF_SEQ_NUM_RANGE;
+
+    if ( iSeqNumDist >= NET_BUF_SEQ_NUM_RANGE / 2 )
+    {
+        iSeqNumDist -= NET_BUF_SEQ_NUM_RANGE;
+    }
+
+    return iSeqNumDist;
+}
+
+int CNetBuf::GetPacketFirstBlock ( const int iSeqNumDist,
+                                   const int iNumPacketBlocks ) const
+{
+    // first block of the packet with the given distance to the put position
+    // (the distance is not smaller than the negative number of blocks)
+    const int iNumBlocks = veciBlockSeqNum.Size();
+
+    return ( iPutPos / iBlockSize + iSeqNumDist * iNumPacketBlocks +
+             iNumBlocks ) % iNumBlocks;
+}
+
+void CNetBuf::MarkPacketBlocks ( const int iFirstBlock,
+                                 const int iNumPacketBlocks,
+                                 const int iSeqNum,
+                                 const int iReceived )
+{
+    const int iNumBlocks = veciBlockSeqNum.Size();
+
+    for ( int i = 0; i < iNumPacketBlocks; i++ )
+    {
+        const int iBlock = ( iFirstBlock + i ) % iNumBlocks;
+
+        veciBlockSeqNum[iBlock]    = iSeqNum;
+        vecbyBlockReceived[iBlock] = static_cast<uint8_t> ( iReceived );
+    }
+}
+
+void CNetBuf::ClearPacketBlocks ( const int iFirstBlock,
+                                  const int iNumPacketBlocks )
+{
+    // the blocks of a packet may wrap around at the end of the buffer memory
+    const int iNumBlocks = veciBlockSeqNum.Size();
+
+    if ( !bIsSimulation )
+    {
+        for ( int i = 0; i < iNumPacketBlocks; i++ )
+        {
+            const int iBlock = ( iFirstBlock + i ) % iNumBlocks;
+
+            memset ( &vecMemory[iBlock * iBlockSize], 0, iBlockSize );
+        }
+    }
+}
+
+int CNetBuf::GetPacketMemPos ( const int iFirstBlock,
+                               const int iPos ) const
+{
+    // the blocks of a packet may wrap around at the end of the buffer memory
+    const int iNumBlocks = veciBlockSeqNum.Size();
+
+    return ( ( iFirstBlock + iPos / iBlockSize ) % iNumBlocks ) * iBlockSize +
+        iPos % iBlockSize;
+}
+
+
+/* Packet inter-arrival statistic implementation *****************************/
+void CArrivalStatistic::Init()
+{
+    vecdHistogram.Init ( NUM_ARRIVAL_HIST_BINS, 0.0 );
+    dTotalWeight = 0.0;
+
+    // instead of scaling down all histogram values on each update (forgetting)
+    // we scale up the weight of each new value
+    dCurWeight  = 1.0;
+    dWeightFact = static_cast<double> ( ARRIVAL_HIST_TIME_CONST_PACKETS ) /
+        ( ARRIVAL_HIST_TIME_CONST_PACKETS - 1 );
+}
+
+void CArrivalStatistic::Update ( const int iInterArrivalTime )
+{
+    int iBin = iInterArrivalTime;
+
+    // larger values are accumulated in the last bin
+    if ( iBin >= NUM_ARRIVAL_HIST_BINS )
+    {
+        iBin = NUM_ARRIVAL_HIST_BINS - 1;
+    }
+
+    vecdHistogram[iBin] += dCurWeight;
+    dTotalWeight        += dCurWeight;
+    dCurWeight          *= dWeightFact;
+
+    // normalize the histogram from time to time to avoid an overflow of the
+    // weights (this happens only every some ten thousand packets)
+    if ( dCurWeight > 1.0e6 )
+    {
+        for ( int i = 0; i < NUM_ARRIVAL_HIST_BINS; i++ )
+        {
+            vecdHistogram[i] /= dCurWeight;
+        }
+
+        dTotalWeight /= dCurWeight;
+        dCurWeight    = 1.0;
+    }
+}
+
+int CArrivalStatistic::GetQuantile ( const double dErrorRate ) const
+{
+    // search the smallest inter-arrival time for which the probability of
+    // larger inter-arrival times is below the given error rate (start at the
+    // largest value and accumulate the histogram tail)
+    const double dMaxTailWeight = dErrorRate * dTotalWeight;
+    double       dTailWeight    = 0.0;
+    int          iQuantile      = NUM_ARRIVAL_HIST_BINS - 1;
+
+    while ( ( iQuantile > 0 ) &&
+            ( dTailWeight + vecdHistogram[iQuantile] <= dMaxTailWeight ) )
+    {
+        dTailWeight += vecdHistogram[iQuantile];
+        iQuantile--;
+    }
+
+    return iQuantile;
+}
+
+
+/* Clock drift estimation implementation *************************************/
+void CClockDriftEstimator::Init()
+{
+    dLambda    = 1.0 - 1.0 / CLOCK_DRIFT_TIME_CONST_BLOCKS;
+    dSumW      = 0.0;
+    dSumA      = 0.0;
+    dSumAA     = 0.0;
+    dSumY      = 0.0;
+    dSumAY     = 0.0;
+    iNumBlocks = 0;
+}
+
+void CClockDriftEstimator::Update ( const int iFillLevel )
+{
+    // the age of all stored values is increased by one and the weights are
+    // multiplied with the forgetting factor, the new value has the age zero
+    // (the order of the updates is important since the old sums are used)
+    dSumAA = dLambda * ( dSumAA + 2.0 * dSumA + dSumW );
+    dSumAY = dLambda * ( dSumAY + dSumY );
+    dSumA  = dLambda * ( dSumA + dSumW );
+    dSumY  = dLambda * dSumY + iFillLevel;
+    dSumW  = dLambda * dSumW + 1.0;
+
+    if ( iNumBlocks < CLOCK_DRIFT_MIN_NUM_BLOCKS )
+    {
+        iNumBlocks++;
+    }
+}
+
+double CClockDriftEstimator::GetDriftPpm() const
+{
+    double dDriftPpm = 0.0;
+
+    // the estimate is not reliable in the initialization phase
+    if ( iNumBlocks >= CLOCK_DRIFT_MIN_NUM_BLOCKS )
+    {
+        const double dDenom = dSumW * dSumAA - dSumA * dSumA;
+
+        if ( dDenom > 0.0 )
+        {
+            // the regression slope is defined over the age, i.e., we have to
+            // invert the sign to get the slope over time (in frames per played
+            // frame)
+            dDriftPpm = -( dSumW * dSumAY - dSumA * dSumY ) / dDenom * 1.0e6;
+        }
+    }
+
+    return dDriftPpm;
+}
+
 
 /* Network buffer with statistic calculations implementation ******************/
 CNetBufWithStats::CNetBufWithStats() :
-    CNetBuf ( false ) // base class init: no simulation mode
+    CNetBuf                    ( false ), // base class init: no simulation mode
+    iInitAutoBufferSizeSetting ( DEF_AUTO_NET_BUF_SIZE_NUM_BL ),
+    bSimulationEnabled         ( false )
 {
     // define the sizes of the simulation buffers,
     // must be NUM_STAT_SIMULATION_BUFFERS elements!
@@ -131,6 +564,18 @@ void CNetBufWithStats::GetErrorRates ( CVector<double>& vecErrRates,
     dLimit = ERROR_RATE_BOUND;
 }
 
+void CNetBufWithStats::SetSimulationEnabled ( const bool bNewEnabled )
+{
+    // the simulation buffers are not updated while the simulation is
+    // disabled, therefore we have to start a new statistic on enabling
+    if ( bNewEnabled && !bSimulationEnabled )
+    {
+        InitSimulation();
+    }
+
+    bSimulationEnabled = bNewEnabled;
+}
+
 void CNetBufWithStats::Init ( const int  iNewBlockSize,
                               const int  iNewNumBlocks,
                               const bool bPreserve )
@@ -141,27 +586,74 @@ void CNetBufWithStats::Init ( const int  iNewBlockSize,
     // inits for statistics calculation
     if ( !bPreserve )
     {
-        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
-        {
-            // init simulation buffers with the correct size
-            SimulationBuffer[i].Init ( iNewBlockSize, viBufSizesForSim[i] );
-
-            // init statistics
-            ErrorRateStatistic[i].Init ( MAX_STATISTIC_COUNT, true );
-        }
+        ArrivalStatistic.Init();
+        iNumGetsSinceLastPut = 0;
 
-        // start initialization phase of IIR filtering, use a quarter the size
-        // of the error rate statistic buffers which should be ok for a good
-        // initialization value (initialization phase should be as short as
-        // possible
-        iInitCounter = MAX_STATISTIC_COUNT / 4;
+        // the inter-arrival statistic is only used after an initialization
+        // phase, until then we do not go below the initial value
+        iArrivalInitCounter = ARRIVAL_STAT_MIN_NUM_PACKETS;
 
         // init auto buffer setting with a meaningful value, also init the
-        // IIR parameter with this value
-        iCurAutoBufferSizeSetting = 6;
-        dCurIIRFilterResult       = iCurAutoBufferSizeSetting;
+        // filter with this value
+        iCurAutoBufferSizeSetting = iInitAutoBufferSizeSetting;
+        iCurDecision              = iCurAutoBufferSizeSetting;
+        dCurFilterResult          = iCurAutoBufferSizeSetting;
         iCurDecidedResult         = iCurAutoBufferSizeSetting;
+
+        ClockDriftEstimator.Init();
+        iNumPlayoutFrames = 0;
+
+        InitSimulation();
+    }
+}
+
+void CNetBufWithStats::SetInitAutoSetting ( const int iNewInitAutoSetting )
+{
+    // check range
+    if ( iNewInitAutoSetting < MIN_NET_BUF_SIZE_NUM_BL )
+    {
+        iInitAutoBufferSizeSetting = MIN_NET_BUF_SIZE_NUM_BL;
+    }
+    else if ( iNewInitAutoSetting > MAX_NET_BUF_SIZE_NUM_BL )
+    {
+        iInitAutoBufferSizeSetting = MAX_NET_BUF_SIZE_NUM_BL;
+    }
+    else
+    {
+        iInitAutoBufferSizeSetting = iNewInitAutoSetting;
+    }
+
+    // restart the initialization phase of the inter-arrival statistic with the
+    // new value, the collected histogram is kept
+    iArrivalInitCounter       = ARRIVAL_STAT_MIN_NUM_PACKETS;
+    iCurAutoBufferSizeSetting = iInitAutoBufferSizeSetting;
+    iCurDecision              = iCurAutoBufferSizeSetting;
+    dCurFilterResult          = iCurAutoBufferSizeSetting;
+    iCurDecidedResult         = iCurAutoBufferSizeSetting;
+}
+
+void CNetBufWithStats::InitSimulation()
+{
+    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    {
+        // init simulation buffers with the correct size
+        SimulationBuffer[i].Init ( iBlockSize, viBufSizesForSim[i] );
+
+        // init statistics
+        ErrorRateStatistic[i].Init ( MAX_STATISTIC_COUNT, true );
     }
+
+    // start initialization phase of IIR filtering, use a quarter the size
+    // of the error rate statistic buffers which should be ok for a good
+    // initialization value (initialization phase should be as short as
+    // possible
+    iSimInitCounter = MAX_STATISTIC_COUNT / 4;
+
+    // init auto buffer setting with a meaningful value, also init the
+    // IIR parameter with this value
+    iSimAutoBufferSizeSetting = 6;
+    dSimIIRFilterResult       = iSimAutoBufferSizeSetting;
+    iSimDecidedResult         = iSimAutoBufferSizeSetting;
 }
 
 bool CNetBufWithStats::Put ( const CVector<uint8_t>& vecbyData,
@@ -170,14 +662,53 @@ bool CNetBufWithStats::Put ( const CVector<uint8_t>& vecbyData,
     // call base class Put
     const bool bPutOK = CNetBuf::Put ( vecbyData, iInSize );
 
-    // update statistics calculations
-    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    UpdatePutStatistics ( vecbyData, iInSize );
+
+    return bPutOK;
+}
+
+bool CNetBufWithStats::Put ( const CVector<uint8_t>& vecbyData,
+                             const int               iInSize,
+                             const int               iSeqNum )
+{
+    // call base class Put
+    const bool bPutOK = CNetBuf::Put ( vecbyData, iInSize, iSeqNum );
+
+    UpdatePutStatistics ( vecbyData, iInSize );
+
+    return bPutOK;
+}
+
+void CNetBufWithStats::UpdatePutStatistics ( const CVector<uint8_t>& vecbyData,
+                                             const int               iInSize )
+{
+    // update inter-arrival statistic and get the buffer size required for the
+    // error bound: for a packet which arrives k blocks late we measure an
+    // inter-arrival time of k + 1 and we need k + 2 blocks in the buffer
+    ArrivalStatistic.Update ( iNumGetsSinceLastPut );
+    iNumGetsSinceLastPut = 0;
+
+    iCurDecision = ArrivalStatistic.GetQuantile ( ERROR_RATE_BOUND ) + 1;
+
+    if ( iCurDecision < 2 )
     {
-        ErrorRateStatistic[i].Update (
-            !SimulationBuffer[i].Put ( vecbyData, iInSize ) );
+        iCurDecision = 2;
     }
 
-    return bPutOK;
+    if ( iArrivalInitCounter > 0 )
+    {
+        iArrivalInitCounter--;
+    }
+
+    // update statistics calculations of the simulation
+    if ( bSimulationEnabled )
+    {
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            ErrorRateStatistic[i].Update (
+                !SimulationBuffer[i].Put ( vecbyData, iInSize ) );
+        }
+    }
 }
 
 bool CNetBufWithStats::Get ( CVector<uint8_t>& vecbyData )
@@ -185,11 +716,27 @@ bool CNetBufWithStats::Get ( CVector<uint8_t>& vecbyData )
     // call base class Get
     const bool bGetOK = CNetBuf::Get ( vecbyData );
 
-    // update statistics calculations
-    for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+    // the buffer reads are the time base of the inter-arrival statistic
+    iNumGetsSinceLastPut++;
+
+    // the clock drift estimation starts with the first received frame
+    if ( iNumPutFrames > 0 )
+    {
+        iNumPlayoutFrames++;
+
+        ClockDriftEstimator.Update ( iNumPutFrames - iNumPlayoutFrames );
+    }
+
+    // update statistics calculations of the simulation
+    if ( bSimulationEnabled )
     {
-        ErrorRateStatistic[i].Update (
-            !SimulationBuffer[i].Get ( vecbyData ) );
+        for ( int i = 0; i < NUM_STAT_SIMULATION_BUFFERS; i++ )
+        {
+            ErrorRateStatistic[i].Update (
+                !SimulationBuffer[i].Get ( vecbyData ) );
+        }
+
+        UpdateSimulationAutoSetting();
     }
 
     // update auto setting
@@ -200,7 +747,36 @@ bool CNetBufWithStats::Get ( CVector<uint8_t>& vecbyData )
 
 void CNetBufWithStats::UpdateAutoSetting()
 {
-    int  iCurDecision   = 0; // dummy initialization
+    // in the initialization phase the statistic is not yet reliable, we only
+    // allow to increase the buffer size
+    int iDecision = iCurDecision;
+
+    if ( ( iArrivalInitCounter > 0 ) && ( iDecision < iCurDecidedResult ) )
+    {
+        iDecision = iCurDecidedResult;
+    }
+
+    // The buffer size is increased immediately if the statistic requires it
+    // since otherwise we would get audio dropouts. A decrease is filtered so
+    // that a short period of good network conditions does not reduce the
+    // buffer size right before the next jitter burst.
+    MathUtils().UpDownIIR1 ( dCurFilterResult,
+                             static_cast<double> ( iDecision ),
+                             0.0,
+                             0.9995 );
+
+    // apply a hysteresis
+    iCurAutoBufferSizeSetting =
+        MathUtils().DecideWithHysteresis ( dCurFilterResult,
+                                           iCurDecidedResult,
+                                           0.1 );
+
+    iCurDecidedResult = iCurAutoBufferSizeSetting;
+}
+
+void CNetBufWithStats::UpdateSimulationAutoSetting()
+{
+    int  iSimDecision   = 0; // dummy initialization
     bool bDecisionFound = false;
 
 
@@ -213,7 +789,7 @@ void CNetBufWithStats::UpdateAutoSetting()
         if ( ( !bDecisionFound ) &&
              ( ErrorRateStatistic[i].GetAverage() <= ERROR_RATE_BOUND ) )
         {
-            iCurDecision   = viBufSizesForSim[i];
+            iSimDecision   = viBufSizesForSim[i];
             bDecisionFound = true;
         }
     }
@@ -221,7 +797,7 @@ void CNetBufWithStats::UpdateAutoSetting()
     if ( !bDecisionFound )
     {
         // in case no buffer is below bound, use largest buffer size
-        iCurDecision = viBufSizesForSim[NUM_STAT_SIMULATION_BUFFERS - 1];
+        iSimDecision = viBufSizesForSim[NUM_STAT_SIMULATION_BUFFERS - 1];
     }
 
 
@@ -239,10 +815,10 @@ void CNetBufWithStats::UpdateAutoSetting()
     const double dHysteresisValue = 0.1;
 
     // check for initialization phase
-    if ( iInitCounter > 0 )
+    if ( iSimInitCounter > 0 )
     {
         // decrease init counter
-        iInitCounter--;
+        iSimInitCounter--;
 
         // overwrite weigth values with lower values
         dWeightUp   = 0.9995;
@@ -250,22 +826,22 @@ void CNetBufWithStats::UpdateAutoSetting()
     }
 
     // apply non-linear IIR filter
-    MathUtils().UpDownIIR1 ( dCurIIRFilterResult,
-                             static_cast<double> ( iCurDecision ),
+    MathUtils().UpDownIIR1 ( dSimIIRFilterResult,
+                             static_cast<double> ( iSimDecision ),
                              dWeightUp,
                              dWeightDown );
 
     // apply a hysteresis
-    iCurAutoBufferSizeSetting =
-        MathUtils().DecideWithHysteresis ( dCurIIRFilterResult,
-                                           iCurDecidedResult,
+    iSimAutoBufferSizeSetting =
+        MathUtils().DecideWithHysteresis ( dSimIIRFilterResult,
+                                           iSimDecidedResult,
                                            dHysteresisValue );
 
 
     // Initialization phase check and correction -------------------------------
     // sometimes in the very first period after a connection we get a bad error
     // rate result -> delete this from the initialization phase
-    if ( iInitCounter == MAX_STATISTIC_COUNT / 8 )
+    if ( iSimInitCounter == MAX_STATISTIC_COUNT / 8 )
     {
         // check error rate of the largest buffer as the indicator
         if ( ErrorRateStatistic[NUM_STAT_SIMULATION_BUFFERS - 1].
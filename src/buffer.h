@@ -25,6 +25,8 @@
 #if !defined ( BUFFER_H__3B123453_4344_BB23945IUHF1912__INCLUDED_ )
 #define BUFFER_H__3B123453_4344_BB23945IUHF1912__INCLUDED_
 
+#include <cstring>
+#include <QAtomicInt>
 #include "util.h"
 #include "global.h"
 
@@ -40,6 +42,31 @@
 // number of simulation network jitter buffers for evaluating the statistic
 #define NUM_STAT_SIMULATION_BUFFERS         11
 
+// number of histogram bins of the packet inter-arrival statistic, larger
+// inter-arrival times are accumulated in the last bin
+#define NUM_ARRIVAL_HIST_BINS               MAX_NET_BUF_SIZE_NUM_BL
+
+// time constant of the forgetting of the inter-arrival statistic (one packet is
+// half of the buffer accesses -> same observation period as the simulation)
+#define ARRIVAL_HIST_TIME_CONST_PACKETS     ( MAX_STATISTIC_COUNT / 2 )
+
+// range of the sequence numbers of the audio frames (the sequence number is
+// transmitted with one byte)
+#define NET_BUF_SEQ_NUM_RANGE               256
+
+// minimum number of packets until the inter-arrival statistic is used for the
+// auto setting (we need some packets to be able to evaluate the error bound)
+#define ARRIVAL_STAT_MIN_NUM_PACKETS        1000
+
+// initial value of the auto buffer setting if no better value is known (e.g.
+// from a network probe or from a previous connection to the same server)
+#define DEF_AUTO_NET_BUF_SIZE_NUM_BL        6
+
+// time constant of the clock drift estimation in blocks (with 2.66 ms blocks
+// this is approx. 87 s) and number of blocks until the estimate is used
+#define CLOCK_DRIFT_TIME_CONST_BLOCKS       32768
+#define CLOCK_DRIFT_MIN_NUM_BLOCKS          ( CLOCK_DRIFT_TIME_CONST_BLOCKS / 4 )
+
 
 /* Classes ********************************************************************/
 // Buffer base class -----------------------------------------------------------
@@ -62,14 +89,6 @@ public:
             // copy old data in new vector using get pointer as zero per
             // definition
 
-            int iCurPos;
-
-            // copy current data in temporary vector
-            CVector<TData> vecTempMemory ( vecMemory );
-
-            // resize actual buffer memory
-            vecMemory.Init ( iNewMemSize );
-
             // get maximum number of data to be copied
             int iCopyLen = GetAvailData();
             if ( iCopyLen > iNewMemSize )
@@ -77,6 +96,24 @@ public:
                 iCopyLen = iNewMemSize;
             }
 
+            // read the data which shall be kept (only the available data and
+            // not the complete old memory is copied)
+            CVector<TData> vecTempMemory ( iCopyLen );
+
+            if ( iCopyLen > 0 )
+            {
+                Get ( &vecTempMemory[0], iCopyLen );
+            }
+
+            // resize actual buffer memory and copy the data to the beginning
+            vecMemory.Init ( iNewMemSize );
+
+            if ( iCopyLen > 0 )
+            {
+                memcpy ( &vecMemory[0], &vecTempMemory[0],
+                         iCopyLen * sizeof ( TData ) );
+            }
+
             // set correct buffer state
             if ( iCopyLen == iNewMemSize )
             {
@@ -94,46 +131,6 @@ public:
                 }
             }
 
-            if ( iGetPos < iPutPos )
-            {
-                // "get" position is before "put" position -> no wrap around
-                for ( iCurPos = 0; iCurPos < iCopyLen; iCurPos++ )
-                {
-                    vecMemory[iCurPos] = vecTempMemory[iGetPos + iCurPos];
-                }
-            }
-            else
-            {
-                // "put" position is before "get" position -> wrap around
-                bool bEnoughSpaceForSecondPart = true;
-                int  iFirstPartLen             = iMemSize - iGetPos;
-
-                // check that first copy length is not larger then new memory
-                if ( iFirstPartLen >= iCopyLen )
-                {
-                    iFirstPartLen             = iCopyLen;
-                    bEnoughSpaceForSecondPart = false;
-                }
-
-                for ( iCurPos = 0; iCurPos < iFirstPartLen; iCurPos++ )
-                {
-                    vecMemory[iCurPos] = vecTempMemory[iGetPos + iCurPos];
-                }
-
-                if ( bEnoughSpaceForSecondPart )
-                {
-                    // calculate remaining copy length
-                    const int iRemainingCopyLen = iCopyLen - iFirstPartLen;
-
-                    // perform copying of second part
-                    for ( iCurPos = 0; iCurPos < iRemainingCopyLen; iCurPos++ )
-                    {
-                        vecMemory[iCurPos + iFirstPartLen] =
-                            vecTempMemory[iCurPos];
-                    }
-                }
-            }
-
             // update put pointer
             if ( eBufState == CBufferBase<TData>::BS_FULL )
             {
@@ -170,6 +167,17 @@ public:
 
     virtual bool Put ( const CVector<TData>& vecData,
                        const int             iInSize )
+    {
+        // the const index operator of CVector returns a copy, therefore the
+        // address of the data is taken from the first element reference
+        return Put ( &vecData.front(), iInSize );
+    }
+
+    // the data is copied with at most two block copies (the buffer is only
+    // used with plain data types which is checked at compile time, therefore
+    // we can use memcpy)
+    bool Put ( const TData* pData,
+               const int    iInSize )
     {
         if ( bIsSimulation )
         {
@@ -184,31 +192,27 @@ public:
         else
         {
             // copy new data in internal buffer
-            int iCurPos = 0;
             if ( iPutPos + iInSize > iMemSize )
             {
-                // remaining space size for second block
-                const int iRemSpace = iPutPos + iInSize - iMemSize;
-
                 // data must be written in two steps because of wrap around
-                while ( iPutPos < iMemSize )
-                {
-                    vecMemory[iPutPos++] = vecData[iCurPos++];
-                }
+                const int iFirstPartLen = iMemSize - iPutPos;
+                const int iRemSpace     = iInSize - iFirstPartLen;
 
-                for ( iPutPos = 0; iPutPos < iRemSpace; iPutPos++ )
-                {
-                    vecMemory[iPutPos] = vecData[iCurPos++];
-                }
+                memcpy ( &vecMemory[iPutPos], pData,
+                         iFirstPartLen * sizeof ( TData ) );
+
+                memcpy ( &vecMemory[0], pData + iFirstPartLen,
+                         iRemSpace * sizeof ( TData ) );
+
+                iPutPos = iRemSpace;
             }
-            else
+            else if ( iInSize > 0 )
             {
                 // data can be written in one step
-                const int iEnd = iPutPos + iInSize;
-                while ( iPutPos < iEnd )
-                {
-                    vecMemory[iPutPos++] = vecData[iCurPos++];
-                }
+                memcpy ( &vecMemory[iPutPos], pData,
+                         iInSize * sizeof ( TData ) );
+
+                iPutPos += iInSize;
             }
         }
 
@@ -234,13 +238,17 @@ public:
     virtual bool Get ( CVector<TData>& vecData )
     {
         // get size of data to be get from the buffer
-        const int iInSize = vecData.Size();
+        return Get ( &vecData[0], vecData.Size() );
+    }
 
+    bool Get ( TData*    pData,
+               const int iOutSize )
+    {
         if ( bIsSimulation )
         {
             // in this simulation only the buffer pointers and the buffer state
             // is updated, no actual data is transferred
-            iGetPos += iInSize;
+            iGetPos += iOutSize;
             if ( iGetPos >= iMemSize )
             {
                 iGetPos -= iMemSize;
@@ -249,31 +257,27 @@ public:
         else
         {
             // copy data from internal buffer in output buffer
-            int iCurPos = 0;
-            if ( iGetPos + iInSize > iMemSize )
+            if ( iGetPos + iOutSize > iMemSize )
             {
-                // remaining data size for second block
-                const int iRemData = iGetPos + iInSize - iMemSize;
-
                 // data must be read in two steps because of wrap around
-                while ( iGetPos < iMemSize )
-                {
-                    vecData[iCurPos++] = vecMemory[iGetPos++];
-                }
+                const int iFirstPartLen = iMemSize - iGetPos;
+                const int iRemData      = iOutSize - iFirstPartLen;
 
-                for ( iGetPos = 0; iGetPos < iRemData; iGetPos++ )
-                {
-                    vecData[iCurPos++] = vecMemory[iGetPos];
-                }
+                memcpy ( pData, &vecMemory[iGetPos],
+                         iFirstPartLen * sizeof ( TData ) );
+
+                memcpy ( pData + iFirstPartLen, &vecMemory[0],
+                         iRemData * sizeof ( TData ) );
+
+                iGetPos = iRemData;
             }
-            else
+            else if ( iOutSize > 0 )
             {
                 // data can be read in one step
-                const int iEnd = iGetPos + iInSize;
-                while ( iGetPos < iEnd )
-                {
-                    vecData[iCurPos++] = vecMemory[iGetPos++];
-                }
+                memcpy ( pData, &vecMemory[iGetPos],
+                         iOutSize * sizeof ( TData ) );
+
+                iGetPos += iOutSize;
             }
         }
 
@@ -362,27 +366,144 @@ protected:
     EBufState      eBufState;
     bool           bIsSimulation;
     bool           bIsInitialized;
+
+private:
+    // the data is copied with memcpy, therefore the buffer must only be used
+    // with plain data types (a complex type gives a negative array size and
+    // stops the compilation, works with Qt 4 and Qt 5)
+    typedef char TDataMustBePlainDataType[QTypeInfo<TData>::isComplex ? -1 : 1];
 };
 
 
 // Network buffer (jitter buffer) ----------------------------------------------
+// If the packets have a sequence number, they are stored at the block position
+// given by the sequence number, i.e., reordered packets are played in the
+// correct order, duplicated and stale packets are dropped and for a missing
+// packet the get function returns an error (and silence) so that the decoder
+// can conceal it (a packet may contain several blocks). A missing packet can also be
+// recovered from a redundancy frame which is the XOR of a number of
+// consecutive packets.
 class CNetBuf : public CBufferBase<uint8_t>
 {
 public:
     CNetBuf ( const bool bNewIsSim = false ) :
-       CBufferBase<uint8_t> ( bNewIsSim ) {}
+       CBufferBase<uint8_t> ( bNewIsSim ),
+       iPutSeqNum ( 0 ),
+       bSeqNumSync ( false ),
+       iNumReordered ( 0 ),
+       iNumLate ( 0 ),
+       iNumRecovered ( 0 ),
+       iNumConcealed ( 0 ),
+       iNumPutFrames ( 0 ),
+       iLastGetSeqNum ( -1 ) {}
 
     virtual void Init ( const int  iNewBlockSize,
                         const int  iNewNumBlocks,
                         const bool bPreserve = false );
 
     int GetSize() { return iMemSize / iBlockSize; }
+    int GetNumAvailBlocks() const { return GetAvailData() / iBlockSize; }
 
     virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
+    virtual bool Put ( const CVector<uint8_t>& vecbyData,
+                       const int               iInSize,
+                       const int               iSeqNum );
     virtual bool Get ( CVector<uint8_t>& vecbyData );
 
+    bool PutRedundancy ( const CVector<uint8_t>& vecbyData,
+                         const int               iSeqNum,
+                         const int               iNumFrames );
+
+    int GetNumReordered() const { return iNumReordered; }
+    int GetNumLate() const { return iNumLate; }
+    int GetNumRecovered() const { return iNumRecovered; }
+    int GetNumConcealed() const { return iNumConcealed; }
+
+    // sequence number of the block which was read last (-1 if the block was
+    // not received)
+    int GetLastGetSeqNum() const { return iLastGetSeqNum; }
+
 protected:
-    int iBlockSize;
+    virtual void Clear();
+
+    int  GetSeqNumDist ( const int iSeqNum ) const;
+    int  GetPacketFirstBlock ( const int iSeqNumDist,
+                               const int iNumPacketBlocks ) const;
+    int  GetPacketMemPos ( const int iFirstBlock, const int iPos ) const;
+    void MarkPacketBlocks ( const int iFirstBlock,
+                            const int iNumPacketBlocks,
+                            const int iSeqNum,
+                            const int iReceived );
+    void ClearPacketBlocks ( const int iFirstBlock,
+                             const int iNumPacketBlocks );
+
+    int              iBlockSize;
+
+    // sequence number and reception state of each block
+    CVector<int>     veciBlockSeqNum;
+    CVector<uint8_t> vecbyBlockReceived;
+    int              iPutSeqNum;
+    bool             bSeqNumSync;
+    int              iNumReordered;
+    int              iNumLate;
+    int              iNumRecovered;
+    int              iNumConcealed;
+
+    // number of frames sent by the other side (including lost frames and
+    // frames which did not fit into the buffer)
+    int              iNumPutFrames;
+
+    int              iLastGetSeqNum;
+};
+
+
+// Packet inter-arrival statistic ----------------------------------------------
+// The inter-arrival times are measured in units of the playout clock (number of
+// buffer reads between two received packets), i.e., the statistic does not
+// depend on the clock drift between the sender and the receiver. The values
+// are stored in a histogram with exponential forgetting so that the update
+// and the error rate evaluation have a constant effort per packet.
+class CArrivalStatistic
+{
+public:
+    CArrivalStatistic() { Init(); }
+
+    void Init();
+    void Update ( const int iInterArrivalTime );
+    int  GetQuantile ( const double dErrorRate ) const;
+
+protected:
+    CVector<double> vecdHistogram;
+    double          dTotalWeight;
+    double          dCurWeight;
+    double          dWeightFact;
+};
+
+
+// Clock drift estimation ------------------------------------------------------
+// The fill level of a virtual jitter buffer of infinite size (number of frames
+// sent by the other side minus the number of played frames) increases or
+// decreases linearly if the sender clock is faster or slower than the playout
+// clock. The slope is estimated by a linear regression with exponential
+// forgetting, the age weighted sums are updated recursively so that the effort
+// per block is constant.
+class CClockDriftEstimator
+{
+public:
+    CClockDriftEstimator() { Init(); }
+
+    void Init();
+    void Update ( const int iFillLevel );
+    double GetDriftPpm() const;
+
+protected:
+    double dLambda;
+    double dSumW;   // sum of the weights
+    double dSumA;   // sum of the weights times the age
+    double dSumAA;  // sum of the weights times the squared age
+    double dSumY;   // sum of the weights times the fill level
+    double dSumAY;  // sum of the weights times the age times the fill level
+    int    iNumBlocks;
 };
 
 
@@ -397,24 +518,63 @@ public:
                         const bool bPreserve = false );
 
     virtual bool Put ( const CVector<uint8_t>& vecbyData, const int iInSize );
+    virtual bool Put ( const CVector<uint8_t>& vecbyData,
+                       const int               iInSize,
+                       const int               iSeqNum );
     virtual bool Get ( CVector<uint8_t>& vecbyData );
 
     int GetAutoSetting() { return iCurAutoBufferSizeSetting; }
+
+    // the initial value of the auto setting, if the statistic is already
+    // running it is restarted with the new value
+    void SetInitAutoSetting ( const int iNewInitAutoSetting );
+
+    // the simulation buffer statistic is only used for comparison (e.g. in
+    // the analyzer console) since it is much more expensive
+    void SetSimulationEnabled ( const bool bNewEnabled );
+    int GetSimulationAutoSetting() { return iSimAutoBufferSizeSetting; }
     void GetErrorRates ( CVector<double>& vecErrRates, double& dLimit );
 
+    // the clock drift of the sender relative to the playout clock, frames
+    // which are skipped or inserted by the playout on purpose (e.g. for the
+    // drift compensation) must be reported so that they are not detected as
+    // clock drift
+    double GetClockDriftPpm() const { return ClockDriftEstimator.GetDriftPpm(); }
+    void AddPlayoutCorrection ( const int iNumFrames )
+        { iNumPlayoutFrames -= iNumFrames; }
+
 protected:
+    void InitSimulation();
+    void UpdatePutStatistics ( const CVector<uint8_t>& vecbyData,
+                               const int               iInSize );
     void UpdateAutoSetting();
-
-    // statistic (do not use the vector class since the classes do not have
-    // appropriate copy constructor/operator)
+    void UpdateSimulationAutoSetting();
+
+    // inter-arrival statistic
+    CArrivalStatistic ArrivalStatistic;
+    int               iNumGetsSinceLastPut;
+    int               iArrivalInitCounter;
+    int               iCurDecision;
+    double            dCurFilterResult;
+    int               iCurDecidedResult;
+    int               iCurAutoBufferSizeSetting;
+    int               iInitAutoBufferSizeSetting;
+
+    // clock drift statistic
+    CClockDriftEstimator ClockDriftEstimator;
+    int                  iNumPlayoutFrames;
+
+    // simulation statistic (do not use the vector class since the classes do
+    // not have appropriate copy constructor/operator)
+    bool       bSimulationEnabled;
     CErrorRate ErrorRateStatistic[NUM_STAT_SIMULATION_BUFFERS];
     CNetBuf    SimulationBuffer[NUM_STAT_SIMULATION_BUFFERS];
     int        viBufSizesForSim[NUM_STAT_SIMULATION_BUFFERS];
 
-    double     dCurIIRFilterResult;
-    int        iCurDecidedResult;
-    int        iInitCounter;
-    int        iCurAutoBufferSizeSetting;
+    double     dSimIIRFilterResult;
+    int        iSimDecidedResult;
+    int        iSimInitCounter;
+    int        iSimAutoBufferSizeSetting;
 };
 
 
@@ -479,4 +639,108 @@ protected:
     int            iPutPos;
 };
 
+
+// Packet queue (lock-free, single producer and single consumer) ---------------
+// The memory of all packets is allocated on initialization so that putting and
+// getting a packet only copies the data and updates one index. The put index is
+// only written by the producer and the get index only by the consumer, the
+// acquire/release semantic of the index accesses makes sure that the packet
+// data are completely written before the other thread can see the new index.
+class CPacketQueue
+{
+public:
+    CPacketQueue() : iNumDropped ( 0 ) { Init ( 0, 0 ); }
+
+    // must not be called while one of the threads accesses the queue
+    void Init ( const int iNewNumPackets, const int iNewMaxPacketSize )
+    {
+        // one packet slot is always unused to distinguish between a full and
+        // an empty queue
+        iNumSlots      = iNewNumPackets + 1;
+        iMaxPacketSize = iNewMaxPacketSize;
+
+        vecvecbyPackets.Init ( iNumSlots );
+        veciPacketSizes.Init ( iNumSlots, 0 );
+
+        for ( int i = 0; i < iNumSlots; i++ )
+        {
+            vecvecbyPackets[i].Init ( iMaxPacketSize );
+        }
+
+        Reset();
+    }
+
+    // must not be called while one of the threads accesses the queue
+    void Reset()
+    {
+        AtomicStoreRelease ( iPutIdx, 0 );
+        AtomicStoreRelease ( iGetIdx, 0 );
+    }
+
+    bool Put ( const uint8_t* pData, const int iSize )
+    {
+        const int iCurPutIdx  = AtomicLoadAcquire ( iPutIdx );
+        const int iNextPutIdx = ( iCurPutIdx + 1 ) % iNumSlots;
+
+        if ( ( iNextPutIdx == AtomicLoadAcquire ( iGetIdx ) ) || ( iSize > iMaxPacketSize ) )
+        {
+            // queue is full (the consumer does not keep up) or the packet is
+            // too large, the packet is dropped
+            iNumDropped++;
+            return false;
+        }
+
+        if ( iSize > 0 )
+        {
+            memcpy ( &vecvecbyPackets[iCurPutIdx][0], pData, iSize * sizeof ( uint8_t ) );
+        }
+
+        veciPacketSizes[iCurPutIdx] = iSize;
+        AtomicStoreRelease ( iPutIdx, iNextPutIdx );
+
+        return true;
+    }
+
+    // the data vector is resized to the size of the packet (this is only done
+    // if the size has changed)
+    bool Get ( CVector<uint8_t>& vecbyData )
+    {
+        const int iCurGetIdx = AtomicLoadAcquire ( iGetIdx );
+
+        if ( iCurGetIdx == AtomicLoadAcquire ( iPutIdx ) )
+        {
+            // queue is empty
+            return false;
+        }
+
+        const int iSize = veciPacketSizes[iCurGetIdx];
+
+        if ( vecbyData.Size() != iSize )
+        {
+            vecbyData.Init ( iSize );
+        }
+
+        if ( iSize > 0 )
+        {
+            memcpy ( &vecbyData[0], &vecvecbyPackets[iCurGetIdx][0], iSize * sizeof ( uint8_t ) );
+        }
+
+        AtomicStoreRelease ( iGetIdx, ( iCurGetIdx + 1 ) % iNumSlots );
+
+        return true;
+    }
+
+    // number of packets which could not be put since the queue was full
+    int GetNumDropped() const { return iNumDropped; }
+
+protected:
+    CVector<CVector<uint8_t> > vecvecbyPackets;
+    CVector<int>               veciPacketSizes;
+    int                        iNumSlots;
+    int                        iMaxPacketSize;
+    QAtomicInt                 iPutIdx;
+    QAtomicInt                 iGetIdx;
+    int                        iNumDropped;
+};
+
 #endif /* !defined ( BUFFER_H__3B123453_4344_BB23945IUHF1912__INCLUDED_ ) */
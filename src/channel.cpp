@@ -28,9 +28,39 @@
 // CChannel implementation *****************************************************
 CChannel::CChannel ( const bool bNIsServer ) :
     vecdGains          ( MAX_NUM_CHANNELS, (double) 1.0 ),
+    vecbyGainOverride  ( MAX_NUM_CHANNELS, 0 ),
+    vecdGainOverrides  ( MAX_NUM_CHANNELS, (double) 1.0 ),
     bDoAutoSockBufSize ( true ),
     bIsEnabled         ( false ),
-    bIsServer          ( bNIsServer )
+    bIsServer          ( bNIsServer ),
+    bIsFederationLink  ( false ),
+    bForwardingAllowed ( false ),
+    bOpus64Supported   ( false ),
+    bIsForwarding      ( false ),
+    iChanID            ( -1 ),
+    bP2PRequested      ( false ),
+    bIsP2P             ( false ),
+    bIsLocal           ( false ),
+    iReqRedundancy     ( 0 ),
+    bMixMinus          ( false ),
+    veciLatencySendTimeUs ( NET_BUF_SEQ_NUM_RANGE, 0 ),
+    veciLatencyGetTimeUs  ( NET_BUF_SEQ_NUM_RANGE, 0 ),
+    veciLatencyOutSeqNum  ( NET_BUF_SEQ_NUM_RANGE, 0 ),
+    iLatencyProbeSeqNum   ( -1 ),
+    iLatencyProbeTimeStampUs ( 0 ),
+    dLatencyRoundTripMs   ( -1 ),
+    vecbyForwardBundle    ( FORWARD_BUNDLE_BLOCK_SIZE, 0 ),
+    vecbyForwardPacketReceived ( MAX_NUM_CHANNELS, 0 ),
+    iForwardSeqNum        ( -1 ),
+    iForwardBundleSize    ( 0 ),
+    iForwardNumPackets    ( 0 ),
+    iForwardNumRecPackets ( 0 ),
+    iNumLockContentions   ( 0 ),
+    iNewConnectionPending ( 0 ),
+    iDisconnectedPending  ( 0 ),
+    iPendingPlayoutCorrection ( 0 ),
+    iLastNumAvailFrames   ( 0 ),
+    dLastClockDriftPpm    ( 0 )
 {
     // reset network transport properties
     ResetNetworkTransportProperties();
@@ -46,9 +76,28 @@ CChannel::CChannel ( const bool bNIsServer ) :
     // init the socket buffer
     SetSockBufNumFrames ( DEF_NET_BUF_SIZE_NUM_BL );
 
+    // the frame buffers which are resized by the audio thread of the client
+    // are reserved for the largest packet so that no memory is allocated
+    if ( !bIsServer )
+    {
+        vecbyRedRecFrame.reserve ( MAX_SIZE_BYTES_NETW_BUF );
+    }
+
+#ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
+    // only the client uses a separate socket thread
+    if ( !bIsServer )
+    {
+        RecAudioQueue.Init ( REC_AUDIO_QUEUE_NUM_PACKETS, MAX_SIZE_BYTES_NETW_BUF );
+        vecbyRecAudioData.reserve ( MAX_SIZE_BYTES_NETW_BUF );
+    }
+#endif
+
     // initialize channel info
     ResetInfo();
 
+    // time base of the latency measurement
+    LatencyTimer.start();
+
 
     // Connections -------------------------------------------------------------
     QObject::connect ( &Protocol,
@@ -82,6 +131,19 @@ CChannel::CChannel ( const bool bNIsServer ) :
     QObject::connect( &Protocol, SIGNAL ( ChangeChanGain ( int, double ) ),
         this, SLOT ( OnChangeChanGain ( int, double ) ) );
 
+    QObject::connect ( &Protocol,
+        SIGNAL ( P2PChanIDsReceived ( int, int ) ),
+        SIGNAL ( P2PChanIDsReceived ( int, int ) ) );
+
+    QObject::connect( &Protocol, SIGNAL ( ChangeChanGainOverride ( int, bool, double ) ),
+        this, SLOT ( OnChangeChanGainOverride ( int, bool, double ) ) );
+
+    QObject::connect( &Protocol, SIGNAL ( ChangeChanBus ( QString ) ),
+        this, SLOT ( OnChangeChanBus ( QString ) ) );
+
+    QObject::connect( &Protocol, SIGNAL ( ChangeBusGain ( QString, double ) ),
+        this, SLOT ( OnChangeBusGain ( QString, double ) ) );
+
     QObject::connect( &Protocol, SIGNAL ( ChangeChanName ( QString ) ),
         this, SLOT ( OnChangeChanName ( QString ) ) );
 
@@ -97,6 +159,14 @@ QObject::connect ( &Protocol,
     SIGNAL ( OpusSupported() ),
     SIGNAL ( OpusSupported() ) );
 
+    QObject::connect ( &Protocol,
+        SIGNAL ( Opus64Supported() ),
+        SIGNAL ( Opus64Supported() ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( RawAudioSupported() ),
+        SIGNAL ( RawAudioSupported() ) );
+
     QObject::connect ( &Protocol,
         SIGNAL ( NetTranspPropsReceived ( CNetworkTransportProps ) ),
         this, SLOT ( OnNetTranspPropsReceived ( CNetworkTransportProps ) ) );
@@ -105,6 +175,42 @@ QObject::connect ( &Protocol,
         SIGNAL ( ReqNetTranspProps() ),
         this, SLOT ( OnReqNetTranspProps() ) );
 
+    QObject::connect ( &Protocol,
+        SIGNAL ( FederationLinkReceived() ),
+        this, SLOT ( OnFederationLinkReceived() ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( ReqForwarding() ),
+        this, SLOT ( OnReqForwarding() ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( ForwardingReceived ( int ) ),
+        this, SLOT ( OnForwardingReceived ( int ) ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( ReqP2P() ),
+        this, SLOT ( OnReqP2P() ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( SeqNumSupported() ),
+        this, SLOT ( OnSeqNumSupported() ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( ReqRedundancy ( int ) ),
+        this, SLOT ( OnReqRedundancy ( int ) ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( MixMinus ( bool ) ),
+        this, SLOT ( OnMixMinus ( bool ) ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( LatencyProbe ( int, int ) ),
+        this, SLOT ( OnLatencyProbe ( int, int ) ) );
+
+    QObject::connect ( &Protocol,
+        SIGNAL ( LatencyProbeEcho ( int, int ) ),
+        this, SLOT ( OnLatencyProbeEcho ( int, int ) ) );
+
 #ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
     // this connection is intended for a thread transition if we have a
     // separate socket thread running
@@ -142,6 +248,167 @@ void CChannel::SetEnable ( const bool bNEnStat )
     {
         iConTimeOut = 0;
         Protocol.Reset();
+
+#ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
+        // discard the audio packets which were not yet put in the jitter
+        // buffer (the queue is only read with locked mutex)
+        while ( RecAudioQueue.Get ( vecbyRecAudioData ) ) {}
+#endif
+
+        // a new connection starts without forwarding and without sequence
+        // numbers until the peer tells that it supports them
+        bIsForwarding         = false;
+        iForwardSeqNum        = -1;
+        bSendSeqNum           = false;
+        iSendRedundancy       = 0;
+
+        // the client only knows its channel ID at the server in the
+        // forwarding mode
+        if ( !bIsServer )
+        {
+            iChanID = -1;
+        }
+
+        // the connection events of the audio thread are not valid anymore
+        AtomicStoreRelease ( iNewConnectionPending, 0 );
+        AtomicStoreRelease ( iDisconnectedPending, 0 );
+
+        // the latency is measured again for the new connection
+        iLatencyProbeSeqNum = -1;
+        dLatencyRoundTripMs = -1;
+
+        // the server requests the redundancy only if the client does
+        if ( bIsServer )
+        {
+            iReqRedundancy = 0;
+        }
+    }
+}
+
+void CChannel::SetBufSimulationEnabled ( const bool bNewEnabled )
+{
+    // the simulation buffers are accessed by the jitter buffer put and get
+    QMutexLocker locker ( &Mutex );
+
+    SockBuf.SetSimulationEnabled ( bNewEnabled );
+}
+
+void CChannel::GetBufSeqNumStats ( int& iNumReordered, int& iNumLate )
+{
+    QMutexLocker locker ( &Mutex );
+
+    iNumReordered = SockBuf.GetNumReordered();
+    iNumLate      = SockBuf.GetNumLate();
+}
+
+void CChannel::GetBufRedundancyStats ( int& iNumRecovered, int& iNumConcealed )
+{
+    QMutexLocker locker ( &Mutex );
+
+    iNumRecovered = SockBuf.GetNumRecovered();
+    iNumConcealed = SockBuf.GetNumConcealed();
+}
+
+double CChannel::GetClockDriftPpm()
+{
+    QMutexLocker locker ( &Mutex );
+
+    return SockBuf.GetClockDriftPpm();
+}
+
+void CChannel::EmitPendingEvents()
+{
+    if ( iNewConnectionPending.fetchAndStoreOrdered ( 0 ) != 0 )
+    {
+        emit NewConnection();
+    }
+
+    if ( iDisconnectedPending.fetchAndStoreOrdered ( 0 ) != 0 )
+    {
+        emit Disconnected();
+    }
+}
+
+void CChannel::CreateLatencyProbeMes()
+{
+    bool bSendProbe = false;
+    int  iSeqNum    = 0;
+    int  iTimeStamp = 0;
+
+    Mutex.lock();
+    {
+        // the probe needs the sequence numbers in both directions, the
+        // forwarded bundles do not carry sequence numbers
+        if ( !bIsServer && bSendSeqNum && !bIsForwarding && IsConnected() )
+        {
+            // use the time stamp of the frame which was sent last
+            iSeqNum    = ( iSendSeqNum + NET_BUF_SEQ_NUM_RANGE - 1 ) %
+                NET_BUF_SEQ_NUM_RANGE;
+            iTimeStamp = veciLatencySendTimeUs[iSeqNum];
+            bSendProbe = true;
+        }
+    }
+    Mutex.unlock();
+
+    if ( bSendProbe )
+    {
+        Protocol.CreateLatencyProbeMes ( iSeqNum, iTimeStamp );
+    }
+}
+
+double CChannel::GetLatencyRoundTripMs()
+{
+    QMutexLocker locker ( &Mutex );
+
+    return dLatencyRoundTripMs;
+}
+
+void CChannel::UpdateLatencyRoundTrip ( const int iRoundTripUs )
+{
+    // values which are too large are caused by a wrap around of the sequence
+    // numbers or by lost packets
+    if ( ( iRoundTripUs >= 0 ) && ( iRoundTripUs < LATENCY_MAX_ROUND_TRIP_US ) )
+    {
+        const double dRoundTripMs = static_cast<double> ( iRoundTripUs ) / 1000;
+
+        if ( dLatencyRoundTripMs < 0 )
+        {
+            dLatencyRoundTripMs = dRoundTripMs;
+        }
+        else
+        {
+            dLatencyRoundTripMs = LATENCY_IIR_WEIGHT * dLatencyRoundTripMs +
+                ( 1.0 - LATENCY_IIR_WEIGHT ) * dRoundTripMs;
+        }
+    }
+}
+
+void CChannel::SetIsForwarding ( const bool bNIsForwarding )
+{
+    QMutexLocker locker ( &Mutex );
+
+    bIsForwarding = bNIsForwarding;
+
+    // The block size of the client jitter buffer does not depend on the
+    // number and the codecs of the forwarded streams, it is only initialized
+    // if the mode changes. The reassembly of the packets starts again.
+    if ( !bIsServer )
+    {
+        SockBuf.Init ( GetSockBufBlockSize(), iCurSockBufNumFrames );
+
+        iForwardSeqNum = -1;
+    }
+}
+
+void CChannel::SetIsLocal ( const bool bNIsLocal )
+{
+    bIsLocal = bNIsLocal;
+
+    // the packets of a co-located peer have almost no jitter, therefore we
+    // use a fixed minimal jitter buffer (the auto setting is not used)
+    if ( bIsLocal )
+    {
+        SetSockBufNumFrames ( LOCAL_NET_BUF_SIZE_NUM_BL, true );
     }
 }
 
@@ -165,7 +432,7 @@ void CChannel::SetAudioStreamProperties ( const EAudComprType eNewAudComprType,
         iNetwFrameSizeFact    = iNewNetwFrameSizeFact;
 
         // init socket buffer
-        SockBuf.Init ( iNetwFrameSize, iCurSockBufNumFrames );
+        SockBuf.Init ( GetSockBufBlockSize(), iCurSockBufNumFrames );
 
         // init conversion buffer
         ConvBuf.Init ( iNetwFrameSize * iNetwFrameSizeFact );
@@ -178,6 +445,33 @@ void CChannel::SetAudioStreamProperties ( const EAudComprType eNewAudComprType,
 
     // tell the server about the new network settings
     Protocol.CreateNetwTranspPropsMes ( NetworkTransportProps );
+
+    // we accept audio frames with sequence numbers
+    Protocol.CreateSeqNumSupportedMes();
+
+    // request redundancy frames if the link is lossy
+    if ( iReqRedundancy > 0 )
+    {
+        Protocol.CreateReqRedundancyMes ( iReqRedundancy );
+    }
+
+    // we monitor our own signal locally
+    if ( bMixMinus )
+    {
+        Protocol.CreateMixMinusMes ( true );
+    }
+}
+
+void CChannel::SetMixMinus ( const bool bNewMixMinus )
+{
+    // on a change the server must be informed if we are already connected,
+    // otherwise this is done with the audio stream properties
+    if ( ( bMixMinus != bNewMixMinus ) && !bIsServer && IsConnected() )
+    {
+        Protocol.CreateMixMinusMes ( bNewMixMinus );
+    }
+
+    bMixMinus = bNewMixMinus;
 }
 
 bool CChannel::SetSockBufNumFrames ( const int  iNewNumFrames,
@@ -200,7 +494,7 @@ bool CChannel::SetSockBufNumFrames ( const int  iNewNumFrames,
 
                 // the network block size is a multiple of the minimum network
                 // block size
-                SockBuf.Init ( iNetwFrameSize, iNewNumFrames, bPreserve );
+                SockBuf.Init ( GetSockBufBlockSize(), iNewNumFrames, bPreserve );
 
                 // store current auto socket buffer size setting in the mutex
                 // region since if we use the current parameter below in the
@@ -256,6 +550,83 @@ double CChannel::GetGain ( const int iChanID )
     }
 }
 
+void CChannel::SetGainOverride ( const int    iChanID,
+                                 const bool   bOverride,
+                                 const double dNewGain )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // set value (make sure channel ID is in range)
+    if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) )
+    {
+        vecbyGainOverride[iChanID] = bOverride ? 1 : 0;
+        vecdGainOverrides[iChanID] = dNewGain;
+    }
+}
+
+bool CChannel::GetGainOverride ( const int iChanID,
+                                 double&   dOverrideGain )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // get value (make sure channel ID is in range)
+    if ( ( iChanID >= 0 ) && ( iChanID < MAX_NUM_CHANNELS ) &&
+         ( vecbyGainOverride[iChanID] != 0 ) )
+    {
+        dOverrideGain = vecdGainOverrides[iChanID];
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+void CChannel::ResetBusInfo()
+{
+    QMutexLocker locker ( &Mutex );
+
+    strBusName.clear();
+    mapBusGains.clear();
+    vecbyGainOverride.Reset ( 0 );
+}
+
+void CChannel::SetBusName ( const QString strNewBusName )
+{
+    QMutexLocker locker ( &Mutex );
+
+    strBusName = strNewBusName;
+}
+
+QString CChannel::GetBusName()
+{
+    QMutexLocker locker ( &Mutex );
+
+    return strBusName;
+}
+
+void CChannel::SetBusGain ( const QString& strBus,
+                            const double   dNewGain )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // there cannot be more buses than channels, limit the number of stored
+    // gains so that a client cannot let this map grow without bounds
+    if ( mapBusGains.contains ( strBus ) ||
+         ( mapBusGains.size() < MAX_NUM_CHANNELS ) )
+    {
+        mapBusGains[strBus] = dNewGain;
+    }
+}
+
+double CChannel::GetBusGain ( const QString& strBus )
+{
+    QMutexLocker locker ( &Mutex );
+
+    // if no gain was set for this bus, the bus is mixed with unity gain
+    return mapBusGains.value ( strBus, (double) 1.0 );
+}
+
 void CChannel::SetChanInfo ( const CChannelCoreInfo& NChanInf )
 {
     // apply value (if different from previous one)
@@ -315,21 +686,41 @@ void CChannel::OnSendProtMessage ( CVector<uint8_t> vecMessage )
     }
 }
 
+void CChannel::SetSockBufInitAutoSetting ( const int iNewInitAutoSetting )
+{
+    QMutexLocker locker ( &Mutex );
+
+    SockBuf.SetInitAutoSetting ( iNewInitAutoSetting );
+}
+
 void CChannel::OnJittBufSizeChange ( int iNewJitBufSize )
 {
     // for server apply setting, for client emit message
     if ( bIsServer )
     {
-        // first check for special case: auto setting
-        if ( iNewJitBufSize == AUTO_NET_BUF_SIZE_FOR_PROTOCOL )
+        // the jitter buffer of a local transport channel is fixed
+        if ( !bIsLocal )
         {
-            SetDoAutoSockBufSize ( true );
-        }
-        else
-        {
-            // manual setting is received, turn OFF auto setting and apply new value
-            SetDoAutoSockBufSize ( false );
-            SetSockBufNumFrames ( iNewJitBufSize, true );
+            // first check for special case: auto setting
+            if ( iNewJitBufSize == AUTO_NET_BUF_SIZE_FOR_PROTOCOL )
+            {
+                // if the client switches from a manual setting to auto, the
+                // manual value is used as the start value of the auto setting
+                // (this is used by the client to seed the auto setting with
+                // the result of its network probe)
+                if ( !GetDoAutoSockBufSize() )
+                {
+                    SetSockBufInitAutoSetting ( GetSockBufNumFrames() );
+                }
+
+                SetDoAutoSockBufSize ( true );
+            }
+            else
+            {
+                // manual setting is received, turn OFF auto setting and apply new value
+                SetDoAutoSockBufSize ( false );
+                SetSockBufNumFrames ( iNewJitBufSize, true );
+            }
         }
     }
     else
@@ -344,6 +735,38 @@ void CChannel::OnChangeChanGain ( int    iChanID,
     SetGain ( iChanID, dNewGain );
 }
 
+void CChannel::OnChangeChanGainOverride ( int    iChanID,
+                                          bool   bOverride,
+                                          double dNewGain )
+{
+    // only the server mixes buses
+    if ( bIsServer )
+    {
+        SetGainOverride ( iChanID, bOverride, dNewGain );
+    }
+}
+
+void CChannel::OnChangeChanBus ( QString strNewBusName )
+{
+    // only the server mixes buses, the server resolves the bus assignment
+    // of all channels again on the next timer tick
+    if ( bIsServer )
+    {
+        SetBusName ( strNewBusName );
+        emit BusInfoHasChanged();
+    }
+}
+
+void CChannel::OnChangeBusGain ( QString strBus,
+                                 double  dNewGain )
+{
+    if ( bIsServer )
+    {
+        SetBusGain ( strBus, dNewGain );
+        emit BusInfoHasChanged();
+    }
+}
+
 void CChannel::OnChangeChanName ( QString strName )
 {
     SetName ( strName );
@@ -372,8 +795,19 @@ bool CChannel::GetAddress ( CHostAddress& RetAddr )
 
 void CChannel::OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTransportProps )
 {
-    // only the server shall act on network transport properties message
-    if ( bIsServer )
+    // the small frame size can only be processed by a server which runs with
+    // the small frame size, ignore these properties otherwise (the same
+    // applies to uncompressed audio with a wrong frame size)
+    const bool bCodecSupported = !( bIsServer && !bOpus64Supported &&
+        ( NetworkTransportProps.eAudioCodingType == CT_OPUS64 ) ) &&
+        !( ( NetworkTransportProps.eAudioCodingType == CT_NONE ) &&
+           ( static_cast<int> ( NetworkTransportProps.iBaseNetworkPacketSize ) !=
+             2 * SYSTEM_FRAME_SIZE_SAMPLES *
+             static_cast<int> ( NetworkTransportProps.iNumAudioChannels ) ) );
+
+    // only the server shall act on network transport properties message (and
+    // the P2P channel of the client which receives the audio of the peer)
+    if ( ( bIsServer || bIsP2P ) && bCodecSupported )
     {
         Mutex.lock();
         {
@@ -386,7 +820,7 @@ void CChannel::OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTranspor
 
             // update socket buffer (the network block size is a multiple of the
             // minimum network frame size
-            SockBuf.Init ( iNetwFrameSize, iCurSockBufNumFrames );
+            SockBuf.Init ( GetSockBufBlockSize(), iCurSockBufNumFrames );
 
             // init conversion buffer
             ConvBuf.Init ( iNetwFrameSize * iNetwFrameSizeFact );
@@ -395,10 +829,33 @@ void CChannel::OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTranspor
 
         // if old CELT codec is used, inform the client that the new OPUS codec
         // is supported
-        if ( NetworkTransportProps.eAudioCodingType != CT_OPUS )
+        if ( bIsServer &&
+             ( NetworkTransportProps.eAudioCodingType != CT_OPUS ) &&
+             ( NetworkTransportProps.eAudioCodingType != CT_OPUS64 ) &&
+             ( NetworkTransportProps.eAudioCodingType != CT_NONE ) )
         {
             Protocol.CreateOpusSupportedMes();
         }
+
+        // if the server runs with the small frame size, inform the client that
+        // it may use OPUS with the small frame size, too
+        if ( bIsServer && bOpus64Supported &&
+             ( NetworkTransportProps.eAudioCodingType != CT_OPUS64 ) &&
+             ( NetworkTransportProps.eAudioCodingType != CT_NONE ) )
+        {
+            Protocol.CreateOpus64SupportedMes();
+        }
+
+        // the server can always mix uncompressed audio, the client decides
+        // whether it uses it (e.g. in a LAN session)
+        if ( bIsServer &&
+             ( NetworkTransportProps.eAudioCodingType != CT_NONE ) )
+        {
+            Protocol.CreateRawAudioSupportedMes();
+        }
+
+        // inform the peer that we accept audio frames with sequence numbers
+        Protocol.CreateSeqNumSupportedMes();
     }
 }
 
@@ -408,43 +865,175 @@ void CChannel::OnReqNetTranspProps()
     Protocol.CreateNetwTranspPropsMes ( GetNetworkTransportPropsFromCurrentSettings() );
 }
 
-CNetworkTransportProps CChannel::GetNetworkTransportPropsFromCurrentSettings()
+void CChannel::OnReqForwarding()
 {
-    // use current stored settings of the channel to fill the network transport
-    // properties structure
-    return CNetworkTransportProps (
-        iNetwFrameSize,
-        iNetwFrameSizeFact,
-        iNumAudioChannels,
-        SYSTEM_SAMPLE_RATE_HZ,
-        eAudioCompressionType,
-        0, // version of the codec
-        0 );
+    // only the server shall act on the forwarding request and only if the
+    // forwarding mode is enabled, otherwise the client gets the server mix
+    if ( bIsServer && bForwardingAllowed )
+    {
+        SetIsForwarding ( true );
+
+        // confirm that the server now forwards the streams, the client needs
+        // the ID of its channel for applying the gain of its own fader to its
+        // own signal (which is not forwarded)
+        Protocol.CreateForwardingMes ( iChanID );
+    }
 }
 
-void CChannel::Disconnect()
+void CChannel::OnForwardingReceived ( int iOwnChanID )
 {
-    // we only have to disconnect the channel if it is actually connected
-    if ( IsConnected() )
+    if ( !bIsServer )
     {
-        // set time out counter to a small value > 0 so that the next time a
-        // received audio block is queried, the disconnection is performed
-        // (assuming that no audio packet is received in the meantime)
-        iConTimeOut = 1; // a small number > 0
+        iChanID = iOwnChanID;
+
+        SetIsForwarding ( true );
     }
 }
 
-EPutDataStat CChannel::PutData ( const CVector<uint8_t>& vecbyData,
-                                 int                     iNumBytes )
+void CChannel::OnSeqNumSupported()
 {
-/*
-    Note that this function might be called from a different thread (separate
-    Socket thread) and therefore we should not call functions which emit signals
-    themself directly but emit a signal here so that the thread transition is
-    done as early as possible.
-    This is the reason why "ParseMessageBody" is not called directly but through a
-    signal-slot mechanism.
-*/
+    QMutexLocker locker ( &Mutex );
+
+    // from now on we append a sequence number to the audio frames
+    bSendSeqNum = true;
+}
+
+void CChannel::OnReqRedundancy ( int iNumFrames )
+{
+    Mutex.lock();
+    {
+        // the redundancy frames start with the next packet
+        iSendRedundancy = iNumFrames;
+        iRedNumFrames   = 0;
+    }
+    Mutex.unlock();
+
+    // the server uses the same redundancy for both directions since the loss
+    // is usually on the link of the client
+    if ( bIsServer && ( iReqRedundancy != iNumFrames ) )
+    {
+        iReqRedundancy = iNumFrames;
+        Protocol.CreateReqRedundancyMes ( iNumFrames );
+    }
+}
+
+void CChannel::OnLatencyProbe ( int iSeqNum, int iTimeStampUs )
+{
+    bool bSendEcho  = false;
+    int  iOutSeqNum = 0;
+
+    // only the server answers latency probes
+    if ( bIsServer && ( iSeqNum >= 0 ) && ( iSeqNum < NET_BUF_SEQ_NUM_RANGE ) )
+    {
+        Mutex.lock();
+        {
+            // the probed frame is usually already mixed since the probe
+            // message is sent after the frame, otherwise the echo is sent as
+            // soon as the frame is read from the jitter buffer
+            if ( LatencyTimeDiffUs ( GetLatencyTimeUs(),
+                    veciLatencyGetTimeUs[iSeqNum] ) < LATENCY_PROBE_MAX_AGE_US )
+            {
+                iOutSeqNum = veciLatencyOutSeqNum[iSeqNum];
+                bSendEcho  = true;
+            }
+            else
+            {
+                iLatencyProbeSeqNum      = iSeqNum;
+                iLatencyProbeTimeStampUs = iTimeStampUs;
+            }
+        }
+        Mutex.unlock();
+    }
+
+    if ( bSendEcho )
+    {
+        Protocol.CreateLatencyProbeEchoMes ( iOutSeqNum, iTimeStampUs );
+    }
+}
+
+void CChannel::OnLatencyProbeEcho ( int iSeqNum, int iTimeStampUs )
+{
+    if ( !bIsServer && ( iSeqNum >= 0 ) && ( iSeqNum < NET_BUF_SEQ_NUM_RANGE ) )
+    {
+        QMutexLocker locker ( &Mutex );
+
+        const int iRoundTripUs = LatencyTimeDiffUs (
+            veciLatencyGetTimeUs[iSeqNum], iTimeStampUs );
+
+        // if the packet with the mix was not yet read from the jitter buffer,
+        // the round trip is evaluated when it is read
+        if ( ( iRoundTripUs >= 0 ) && ( iRoundTripUs < LATENCY_MAX_ROUND_TRIP_US ) )
+        {
+            UpdateLatencyRoundTrip ( iRoundTripUs );
+        }
+        else
+        {
+            iLatencyProbeSeqNum      = iSeqNum;
+            iLatencyProbeTimeStampUs = iTimeStampUs;
+        }
+    }
+}
+
+void CChannel::OnReqP2P()
+{
+    // only the server brokers peer-to-peer connections
+    if ( bIsServer )
+    {
+        bP2PRequested = true;
+
+        emit P2PRequested();
+    }
+}
+
+void CChannel::OnFederationLinkReceived()
+{
+    // only the server shall act on the federation link message, the flag is
+    // used by the server mixer to exclude the submix of the linked server
+    // from the mix which is sent back to it
+    if ( bIsServer )
+    {
+        bIsFederationLink = true;
+    }
+}
+
+CNetworkTransportProps CChannel::GetNetworkTransportPropsFromCurrentSettings()
+{
+    // use current stored settings of the channel to fill the network transport
+    // properties structure
+    return CNetworkTransportProps (
+        iNetwFrameSize,
+        iNetwFrameSizeFact,
+        iNumAudioChannels,
+        SYSTEM_SAMPLE_RATE_HZ,
+        eAudioCompressionType,
+        0, // version of the codec
+        0 );
+}
+
+void CChannel::Disconnect()
+{
+    // we only have to disconnect the channel if it is actually connected
+    if ( IsConnected() )
+    {
+        // set time out counter to a small value > 0 so that the next time a
+        // received audio block is queried, the disconnection is performed
+        // (assuming that no audio packet is received in the meantime)
+        iConTimeOut = 1; // a small number > 0
+    }
+}
+
+EPutDataStat CChannel::PutData ( const CVector<uint8_t>& vecbyData,
+                                 int                     iNumBytes,
+                                 const int               iRecTimeUs )
+{
+/*
+    Note that this function might be called from a different thread (separate
+    Socket thread) and therefore we should not call functions which emit signals
+    themself directly but emit a signal here so that the thread transition is
+    done as early as possible.
+    This is the reason why "ParseMessageBody" is not called directly but through a
+    signal-slot mechanism.
+*/
 
     // init return state
     EPutDataStat eRet = PS_GEN_ERROR;
@@ -519,44 +1108,36 @@ EPutDataStat CChannel::PutData ( const CVector<uint8_t>& vecbyData,
             // This seems to be an audio packet (only try to parse audio if it
             // was not a protocol packet):
 
-            Mutex.lock();
+            // the nominal interval of the packets is the duration of the
+            // network frames of this connection
+            InterArrivalJitter.Update ( iRecTimeUs,
+                iNetwFrameSizeFact * GetFrameSizeSamples() * 1000 /
+                ( SYSTEM_SAMPLE_RATE_HZ / 1000 ) );
+
+#ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
+            if ( !bIsServer )
             {
-                // only process audio if packet has correct size
-                if ( iNumBytes == ( iNetwFrameSize * iNetwFrameSizeFact ) )
+                // the socket thread of the client does not lock the mutex, the
+                // packet is put in the jitter buffer by the audio thread (the
+                // packet is only dropped if the audio thread does not run)
+                if ( RecAudioQueue.Put ( &vecbyData.front(), iNumBytes ) )
                 {
-                    // store new packet in jitter buffer
-                    if ( SockBuf.Put ( vecbyData, iNumBytes ) )
-                    {
-                        eRet = PS_AUDIO_OK;
-                    }
-                    else
-                    {
-                        eRet = PS_AUDIO_ERR;
-                    }
+                    eRet = PS_AUDIO_OK;
                 }
                 else
                 {
-                    // the protocol parsing failed and this was no audio block,
-                    // we treat this as protocol error (unkown packet)
-                    eRet = PS_PROT_ERR;
+                    eRet = PS_AUDIO_ERR;
                 }
-
-                // All network packets except of valid protocol messages
-                // regardless if they are valid or invalid audio packets lead to
-                // a state change to a connected channel.
-                // This is because protocol messages can only be sent on a
-                // connected channel and the client has to inform the server
-                // about the audio packet properties via the protocol.
-
-                // check if channel was not connected, this is a new connection
-                // (do not fire an event directly since we are inside a mutex
-                // region -> to avoid a dead-lock)
-                bNewConnection = !IsConnected();
-
-                // reset time-out counter
-                ResetTimeOutCounter();
             }
-            Mutex.unlock();
+            else
+#endif
+            {
+                Mutex.lock();
+                {
+                    eRet = PutAudioData ( vecbyData, iNumBytes, bNewConnection );
+                }
+                Mutex.unlock();
+            }
         }
 
         if ( bNewConnection )
@@ -569,27 +1150,217 @@ EPutDataStat CChannel::PutData ( const CVector<uint8_t>& vecbyData,
     return eRet;
 }
 
+EPutDataStat CChannel::PutAudioData ( const CVector<uint8_t>& vecbyData,
+                                      const int               iNumBytes,
+                                      bool&                   bNewConnection )
+{
+    EPutDataStat eRet;
+
+    // in forwarding mode the client receives the bundles of all streams
+    // split in packets, a bundle is put in the jitter buffer as soon as all
+    // packets of the frame were received
+    if ( !bIsServer && bIsForwarding &&
+         ( iNumBytes >= FORWARD_PACKET_HEADER_SIZE ) &&
+         ( iNumBytes <= FORWARD_MAX_PACKET_SIZE ) )
+    {
+        if ( PutForwardPacket ( vecbyData, iNumBytes ) )
+        {
+            eRet = PS_AUDIO_OK;
+        }
+        else
+        {
+            eRet = PS_AUDIO_ERR;
+        }
+    }
+    // only process audio if packet has correct size
+    else if ( iNumBytes == ( iNetwFrameSize * iNetwFrameSizeFact ) )
+    {
+        // store new packet in jitter buffer
+        if ( SockBuf.Put ( vecbyData, iNumBytes ) )
+        {
+            eRet = PS_AUDIO_OK;
+        }
+        else
+        {
+            eRet = PS_AUDIO_ERR;
+        }
+    }
+    else if ( iNumBytes == ( 2 * iNetwFrameSize * iNetwFrameSizeFact +
+                             AUDIO_REDUNDANCY_HEADER_SIZE +
+                             AUDIO_SEQ_NUM_SIZE ) )
+    {
+        const int iFrameSize = iNetwFrameSize * iNetwFrameSizeFact;
+        const int iSeqNum    = vecbyData[iNumBytes - AUDIO_SEQ_NUM_SIZE];
+
+        if ( SockBuf.Put ( vecbyData, iFrameSize, iSeqNum ) )
+        {
+            eRet = PS_AUDIO_OK;
+        }
+        else
+        {
+            eRet = PS_AUDIO_ERR;
+        }
+
+        // recover a lost frame from the redundancy frame
+        vecbyRedRecFrame.Init ( iFrameSize );
+
+        for ( int i = 0; i < iFrameSize; i++ )
+        {
+            vecbyRedRecFrame[i] = vecbyData[iFrameSize + i];
+        }
+
+        SockBuf.PutRedundancy ( vecbyRedRecFrame,
+                                iSeqNum,
+                                vecbyData[2 * iFrameSize] );
+    }
+    else if ( iNumBytes == ( iNetwFrameSize * iNetwFrameSizeFact +
+                             AUDIO_SEQ_NUM_SIZE ) )
+    {
+        // the jitter buffer stores the packet at the position
+        // given by the sequence number (last byte of the packet)
+        if ( SockBuf.Put ( vecbyData,
+                           iNumBytes - AUDIO_SEQ_NUM_SIZE,
+                           vecbyData[iNumBytes - AUDIO_SEQ_NUM_SIZE] ) )
+        {
+            eRet = PS_AUDIO_OK;
+        }
+        else
+        {
+            eRet = PS_AUDIO_ERR;
+        }
+    }
+    else
+    {
+        // the protocol parsing failed and this was no audio block,
+        // we treat this as protocol error (unkown packet)
+        eRet = PS_PROT_ERR;
+    }
+
+    // All network packets except of valid protocol messages
+    // regardless if they are valid or invalid audio packets lead to
+    // a state change to a connected channel.
+    // This is because protocol messages can only be sent on a
+    // connected channel and the client has to inform the server
+    // about the audio packet properties via the protocol.
+
+    // check if channel was not connected, this is a new connection
+    // (do not fire an event directly since we are inside a mutex
+    // region -> to avoid a dead-lock)
+    bNewConnection = !IsConnected();
+
+    // reset time-out counter
+    ResetTimeOutCounter();
+
+    return eRet;
+}
+
 EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData )
 {
     EGetDataStat eGetStatus;
 
-    Mutex.lock();
+    bool bNewConnection          = false;
+    bool bSendLatencyEcho        = false;
+    int  iLatencyEchoSeqNum      = 0;
+    int  iLatencyEchoTimeStampUs = 0;
+    bool bLocked                 = true;
+
+    // the audio thread of the client must never wait for the mutex (which is
+    // e.g. locked by the main thread if the jitter buffer size is changed),
+    // if the mutex is locked, the frame is treated as lost
+    if ( bIsServer )
     {
+        Mutex.lock();
+    }
+    else
+    {
+        bLocked = Mutex.tryLock();
+    }
+
+    if ( !bLocked )
+    {
+        AtomicStoreRelease ( iNumLockContentions,
+            AtomicLoadAcquire ( iNumLockContentions ) + 1 );
+
+        // the frame which was not read must not be detected as clock drift
+        iPendingPlayoutCorrection--;
+
+        if ( IsConnected() )
+        {
+            eGetStatus = GS_BUFFER_UNDERRUN;
+        }
+        else
+        {
+            eGetStatus = GS_CHAN_NOT_CONNECTED;
+        }
+    }
+    else
+    {
+        // the frames which the playout skipped or inserted since the last
+        // call must not be detected as clock drift
+        SockBuf.AddPlayoutCorrection ( iPendingPlayoutCorrection );
+        iPendingPlayoutCorrection = 0;
+
+#ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
+        // put the audio packets which were received by the socket thread since
+        // the last call in the jitter buffer
+        while ( RecAudioQueue.Get ( vecbyRecAudioData ) )
+        {
+            bool bPacketNewConnection;
+
+            PutAudioData ( vecbyRecAudioData,
+                           vecbyRecAudioData.Size(),
+                           bPacketNewConnection );
+
+            if ( bPacketNewConnection )
+            {
+                bNewConnection = true;
+            }
+        }
+#endif
+
         // the socket access must be inside a mutex
         const bool bSockBufState = SockBuf.Get ( vecbyData );
 
+        // store the read time of the frame for the latency measurement
+        const int iGetSeqNum = SockBuf.GetLastGetSeqNum();
+
+        if ( ( iGetSeqNum >= 0 ) && !bIsForwarding )
+        {
+            veciLatencyGetTimeUs[iGetSeqNum] = GetLatencyTimeUs();
+
+            // the mix with this frame is sent in the next packet
+            veciLatencyOutSeqNum[iGetSeqNum] = iSendSeqNum;
+
+            if ( iGetSeqNum == iLatencyProbeSeqNum )
+            {
+                if ( bIsServer )
+                {
+                    bSendLatencyEcho        = true;
+                    iLatencyEchoSeqNum      = iSendSeqNum;
+                    iLatencyEchoTimeStampUs = iLatencyProbeTimeStampUs;
+                }
+                else
+                {
+                    UpdateLatencyRoundTrip ( LatencyTimeDiffUs (
+                        veciLatencyGetTimeUs[iGetSeqNum], iLatencyProbeTimeStampUs ) );
+                }
+
+                iLatencyProbeSeqNum = -1;
+            }
+        }
+
         // decrease time-out counter
         if ( iConTimeOut > 0 )
         {
             // subtract the number of samples of the current block since the
             // time out counter is based on samples not on blocks (definition:
             // always one atomic block is get by using the GetData() function
-            // where the atomic block size is "SYSTEM_FRAME_SIZE_SAMPLES")
+            // where the atomic block size is the frame size of the codec)
 
 // TODO this code only works with the above assumption -> better
 // implementation so that we are not depending on assumptions
 
-            iConTimeOut -= SYSTEM_FRAME_SIZE_SAMPLES;
+            iConTimeOut -= GetFrameSizeSamples();
 
             if ( iConTimeOut <= 0 )
             {
@@ -599,6 +1370,10 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData )
 
                 // reset network transport properties
                 ResetNetworkTransportProperties();
+
+                // a jitter buffer size seeded by the peer is only valid for
+                // this connection
+                SockBuf.SetInitAutoSetting ( DEF_AUTO_NET_BUF_SIZE_NUM_BL );
             }
             else
             {
@@ -619,14 +1394,49 @@ EGetDataStat CChannel::GetData ( CVector<uint8_t>& vecbyData )
             // channel is disconnected
             eGetStatus = GS_CHAN_NOT_CONNECTED;
         }
+
+        // store the jitter buffer state for the audio thread of the client
+        iLastNumAvailFrames = SockBuf.GetNumAvailBlocks();
+        dLastClockDriftPpm  = SockBuf.GetClockDriftPpm();
+
+        Mutex.unlock();
+    }
+
+    if ( bNewConnection )
+    {
+        // inform other objects that new connection was established (the
+        // audio thread of the client does not post events, the signal is
+        // emitted by EmitPendingEvents())
+        if ( bIsServer )
+        {
+            emit NewConnection();
+        }
+        else
+        {
+            AtomicStoreRelease ( iNewConnectionPending, 1 );
+        }
+    }
+
+    // the server answers a pending latency probe (the client never does since
+    // this function is called by the audio thread)
+    if ( bSendLatencyEcho )
+    {
+        Protocol.CreateLatencyProbeEchoMes ( iLatencyEchoSeqNum,
+                                             iLatencyEchoTimeStampUs );
     }
-    Mutex.unlock();
 
     // in case we are just disconnected, we have to fire a message
     if ( eGetStatus == GS_CHAN_NOW_DISCONNECTED )
     {
         // emit message
-        emit Disconnected();
+        if ( bIsServer )
+        {
+            emit Disconnected();
+        }
+        else
+        {
+            AtomicStoreRelease ( iDisconnectedPending, 1 );
+        }
     }
 
     return eGetStatus;
@@ -647,14 +1457,213 @@ CVector<uint8_t> CChannel::PrepSendPacket ( const CVector<uint8_t>& vecbyNPacket
         // a packet is ready
         vecbySendBuf.Init ( iNetwFrameSize * iNetwFrameSizeFact );
         vecbySendBuf = ConvBuf.Get();
+
+        // append the sequence number if the receiver supports it
+        if ( bSendSeqNum )
+        {
+            // the redundancy frame is the XOR of the previous frames, it is
+            // only sent with sequence numbers since the receiver needs them to
+            // identify the protected frames
+            if ( iSendRedundancy > 0 )
+            {
+                AddRedundancy ( vecbySendBuf );
+            }
+
+            vecbySendBuf.Add ( static_cast<uint8_t> ( iSendSeqNum ) );
+
+            // send time of the frame for the latency measurement
+            veciLatencySendTimeUs[iSendSeqNum] = GetLatencyTimeUs();
+
+            iSendSeqNum = ( iSendSeqNum + 1 ) % NET_BUF_SEQ_NUM_RANGE;
+        }
     }
 
     return vecbySendBuf;
 }
 
+void CChannel::AddRedundancy ( CVector<uint8_t>& vecbySendBuf )
+{
+    const int iFrameSize = iNetwFrameSize * iNetwFrameSizeFact;
+    int       i;
+
+    // a change of the frame size starts a new redundancy frame
+    if ( vecbyRedSendFrame.Size() != iFrameSize )
+    {
+        vecbyRedSendFrame.Init ( iFrameSize );
+        iRedNumFrames = 0;
+    }
+
+    // append the redundancy frame if it contains the requested number of
+    // frames
+    if ( iRedNumFrames == iSendRedundancy )
+    {
+        vecbySendBuf.Enlarge ( iFrameSize + AUDIO_REDUNDANCY_HEADER_SIZE );
+
+        for ( i = 0; i < iFrameSize; i++ )
+        {
+            vecbySendBuf[iFrameSize + i] = vecbyRedSendFrame[i];
+        }
+
+        vecbySendBuf[2 * iFrameSize] = static_cast<uint8_t> ( iSendRedundancy );
+
+        iRedNumFrames = 0;
+    }
+
+    // add the current frame to the redundancy frame
+    if ( iRedNumFrames == 0 )
+    {
+        for ( i = 0; i < iFrameSize; i++ )
+        {
+            vecbyRedSendFrame[i] = vecbySendBuf[i];
+        }
+    }
+    else
+    {
+        for ( i = 0; i < iFrameSize; i++ )
+        {
+            vecbyRedSendFrame[i] ^= vecbySendBuf[i];
+        }
+    }
+
+    iRedNumFrames++;
+}
+
+void CChannel::PrepForwardPackets ( const CVector<uint8_t>&     vecbyStreams,
+                                    const CVector<int>&         veciStreamPos,
+                                    CVector<CVector<uint8_t> >& vecvecbyPackets )
+{
+    QMutexLocker locker ( &Mutex );
+
+    int i, j;
+
+    // the last entry of the stream positions is the end of the last stream
+    const int iNumStreams = veciStreamPos.Size() - 1;
+
+    // there is always at least one packet so that the client gets a bundle
+    // for each frame (even if it is the only connected client)
+    vecvecbyPackets.Init ( 1 );
+    vecvecbyPackets[0].Init ( FORWARD_PACKET_HEADER_SIZE );
+
+    for ( i = 0; i < iNumStreams; i++ )
+    {
+        const int iStreamPos  = veciStreamPos[i];
+        const int iStreamSize = veciStreamPos[i + 1] - iStreamPos;
+
+        // the own stream is not sent back, the client mixes its own signal
+        // locally
+        if ( vecbyStreams[iStreamPos] != iChanID )
+        {
+            // start a new packet if the stream does not fit into the current
+            // packet (a stream is never split)
+            if ( vecvecbyPackets[vecvecbyPackets.Size() - 1].Size() + iStreamSize >
+                 FORWARD_MAX_PACKET_SIZE )
+            {
+                vecvecbyPackets.Enlarge ( 1 );
+                vecvecbyPackets[vecvecbyPackets.Size() - 1].Init ( FORWARD_PACKET_HEADER_SIZE );
+            }
+
+            CVector<uint8_t>& vecbyPacket = vecvecbyPackets[vecvecbyPackets.Size() - 1];
+            const int         iPacketPos  = vecbyPacket.Size();
+
+            vecbyPacket.Enlarge ( iStreamSize );
+
+            for ( j = 0; j < iStreamSize; j++ )
+            {
+                vecbyPacket[iPacketPos + j] = vecbyStreams[iStreamPos + j];
+            }
+        }
+    }
+
+    // all packets of the frame have the same sequence number
+    const int iNumPackets = vecvecbyPackets.Size();
+
+    for ( i = 0; i < iNumPackets; i++ )
+    {
+        vecvecbyPackets[i][0] = static_cast<uint8_t> ( iSendSeqNum );
+        vecvecbyPackets[i][1] = static_cast<uint8_t> ( i );
+        vecvecbyPackets[i][2] = static_cast<uint8_t> ( iNumPackets );
+    }
+
+    iSendSeqNum = ( iSendSeqNum + 1 ) % NET_BUF_SEQ_NUM_RANGE;
+}
+
+bool CChannel::PutForwardPacket ( const CVector<uint8_t>& vecbyData,
+                                  const int               iNumBytes )
+{
+    bool bPutOK = false;
+
+    const int iSeqNum         = vecbyData[0];
+    const int iPacketIdx      = vecbyData[1];
+    const int iNumPackets     = vecbyData[2];
+    const int iNumStreamBytes = iNumBytes - FORWARD_PACKET_HEADER_SIZE;
+
+    // each packet holds at least one stream (except of the single packet of
+    // an empty bundle), corrupt packets are ignored
+    if ( ( iNumPackets >= 1 ) && ( iNumPackets <= MAX_NUM_CHANNELS ) &&
+         ( iPacketIdx < iNumPackets ) )
+    {
+        // a packet of the next frame completes the current frame even if some
+        // of its packets are missing (the streams of the missing packets are
+        // concealed by the client)
+        if ( iSeqNum != iForwardSeqNum )
+        {
+            if ( iForwardSeqNum >= 0 )
+            {
+                PutForwardBundle();
+            }
+
+            iForwardSeqNum        = iSeqNum;
+            iForwardBundleSize    = 0;
+            iForwardNumPackets    = iNumPackets;
+            iForwardNumRecPackets = 0;
+            vecbyForwardPacketReceived.Reset ( 0 );
+        }
+
+        // duplicates and packets which do not fit into the bundle are dropped
+        if ( ( iNumPackets == iForwardNumPackets ) &&
+             !vecbyForwardPacketReceived[iPacketIdx] &&
+             ( FORWARD_BUNDLE_LEN_SIZE + iForwardBundleSize + iNumStreamBytes <=
+               FORWARD_BUNDLE_BLOCK_SIZE ) )
+        {
+            for ( int i = 0; i < iNumStreamBytes; i++ )
+            {
+                vecbyForwardBundle[FORWARD_BUNDLE_LEN_SIZE + iForwardBundleSize + i] =
+                    vecbyData[FORWARD_PACKET_HEADER_SIZE + i];
+            }
+
+            iForwardBundleSize += iNumStreamBytes;
+            vecbyForwardPacketReceived[iPacketIdx] = 1;
+            iForwardNumRecPackets++;
+
+            bPutOK = true;
+
+            // the bundle is complete, we do not have to wait for the next frame
+            if ( iForwardNumRecPackets == iForwardNumPackets )
+            {
+                bPutOK         = PutForwardBundle();
+                iForwardSeqNum = -1;
+            }
+        }
+    }
+
+    return bPutOK;
+}
+
+bool CChannel::PutForwardBundle()
+{
+    // the size of the bundle is stored in front of the streams, the jitter
+    // buffer puts the bundle at the position given by the sequence number
+    vecbyForwardBundle[0] = static_cast<uint8_t> ( iForwardBundleSize & 255 );
+    vecbyForwardBundle[1] = static_cast<uint8_t> ( iForwardBundleSize >> 8 );
+
+    return SockBuf.Put ( vecbyForwardBundle,
+                         FORWARD_BUNDLE_BLOCK_SIZE,
+                         iForwardSeqNum );
+}
+
 int CChannel::GetUploadRateKbps()
 {
-    const int iAudioSizeOut = iNetwFrameSizeFact * SYSTEM_FRAME_SIZE_SAMPLES;
+    const int iAudioSizeOut = iNetwFrameSizeFact * GetFrameSizeSamples();
 
     // we assume that the UDP packet which is transported via IP has an
     // additional header size of ("Network Music Performance (NMP) in narrow
@@ -662,19 +1671,34 @@ int CChannel::GetUploadRateKbps()
     // 8 (UDP) + 20 (IP without optional fields) = 28 bytes
     // 2 (PPP) + 6 (PPPoE) + 18 (MAC)            = 26 bytes
     // 5 (RFC1483B) + 8 (AAL) + 10 (ATM)         = 23 bytes
-    return ( iNetwFrameSize * iNetwFrameSizeFact + 28 + 26 + 23 /* header */ ) *
-        8 /* bits per byte */ *
+    int iPacketSize = iNetwFrameSize * iNetwFrameSizeFact +
+        ( bSendSeqNum ? AUDIO_SEQ_NUM_SIZE : 0 ) + 28 + 26 + 23 /* header */;
+
+    // the redundancy frame is sent with each k-th packet
+    if ( bSendSeqNum && ( iSendRedundancy > 0 ) )
+    {
+        iPacketSize += ( iNetwFrameSize * iNetwFrameSizeFact +
+            AUDIO_REDUNDANCY_HEADER_SIZE ) / iSendRedundancy;
+    }
+
+    return iPacketSize * 8 /* bits per byte */ *
         SYSTEM_SAMPLE_RATE_HZ / iAudioSizeOut / 1000;
 }
 
 void CChannel::UpdateSocketBufferSize()
 {
     // just update the socket buffer size if auto setting is enabled, otherwise
-    // do nothing
-    if ( bDoAutoSockBufSize )
+    // do nothing (a local transport channel uses a fixed minimal size)
+    if ( bDoAutoSockBufSize && !bIsLocal )
     {
+        const int iAutoSetting = SockBuf.GetAutoSetting();
+
         // use auto setting result from channel, make sure we preserve the
-        // buffer memory since we just adjust the size here
-        SetSockBufNumFrames ( SockBuf.GetAutoSetting(), true );
+        // buffer memory since we just adjust the size here (the mutex is only
+        // locked if the size changes to not block the audio thread)
+        if ( iAutoSetting != iCurSockBufNumFrames )
+        {
+            SetSockBufNumFrames ( iAutoSetting, true );
+        }
     }
 }
@@ -29,6 +29,7 @@
 #include <QDateTime>
 #include <QFile>
 #include <QTextStream>
+#include <QMap>
 #include "global.h"
 #include "buffer.h"
 #include "util.h"
@@ -41,6 +42,63 @@
 // correction is implemented)
 #define CON_TIME_OUT_SEC_MAX                30 // seconds
 
+// In forwarding mode the server sends for each frame a bundle with the coded
+// audio streams of all connected channels except of the own channel of the
+// client (the client mixes its own signal locally). The bundle is split in
+// packets which do not exceed FORWARD_MAX_PACKET_SIZE. Each packet has the
+// following header followed by complete streams:
+// +------------------+---------------------+-------------------------------+
+// | 1 byte seq. num. | 1 byte packet index | 1 byte num packets of frame   |
+// +------------------+---------------------+-------------------------------+
+// Each stream has the following header followed by n bytes of coded audio:
+// +-------------+--------------+----------------+---------------+-----------+
+// | 1 byte chan | 1 byte codec | 1 byte num aud | 1 byte frame  | 2 bytes n |
+// | ID          |              | channels       | ok            |           |
+// +-------------+--------------+----------------+---------------+-----------+
+// The codec is the audio compression type (EAudComprType) of the stream.
+// If "frame ok" is zero, the frame was lost and the data bytes must be ignored.
+// Only frames with the normal frame size which are not larger than
+// FORWARD_MAX_STREAM_SIZE (uncompressed stereo audio) are forwarded.
+#define FORWARD_PACKET_HEADER_SIZE          3 // bytes
+#define FORWARD_STREAM_HEADER_SIZE          6 // bytes
+#define FORWARD_MAX_PACKET_SIZE             1200 // bytes
+#define FORWARD_MAX_STREAM_SIZE             ( 2 * 2 * SYSTEM_FRAME_SIZE_SAMPLES )
+
+// The client reassembles the packets of a frame and stores the bundle in a
+// jitter buffer block of fixed size which can hold the streams of all
+// channels, the first two bytes of the block hold the size of the bundle.
+#define FORWARD_BUNDLE_LEN_SIZE             2 // bytes
+#define FORWARD_BUNDLE_BLOCK_SIZE           ( FORWARD_BUNDLE_LEN_SIZE + MAX_NUM_CHANNELS * \
+                                              ( FORWARD_STREAM_HEADER_SIZE + FORWARD_MAX_STREAM_SIZE ) )
+
+// If the receiver supports it, one byte with a sequence number (modulo 256) is
+// appended to each coded audio frame so that the jitter buffer can correct
+// the order of the frames. The receiver detects the sequence number by the
+// packet size, therefore frames with and without it are always accepted.
+#define AUDIO_SEQ_NUM_SIZE                  1 // bytes
+
+// If the receiver requests it, each k-th packet carries a redundancy frame
+// (the XOR of the coded audio data of the previous k packets) in front of the
+// sequence number:
+// +------------------+--------------------------+----------+----------------+
+// | n bytes audio    | n bytes redundancy frame | 1 byte k | 1 byte seq num |
+// +------------------+--------------------------+----------+----------------+
+#define AUDIO_REDUNDANCY_HEADER_SIZE        1 // bytes
+
+// number of audio packets the client socket thread can hand over to the audio
+// thread between two jitter buffer accesses
+#define REC_AUDIO_QUEUE_NUM_PACKETS         32
+
+// The latency of the audio path through the server is measured with the
+// latency probe messages: the client sends the time stamp of an audio frame,
+// the server echoes it together with the sequence number of the packet which
+// carries the mix with this frame and the client takes the time when that
+// packet is read from its jitter buffer. Older measurements are not valid
+// anymore since the sequence numbers wrap around.
+#define LATENCY_MAX_ROUND_TRIP_US           300000 // us
+#define LATENCY_PROBE_MAX_AGE_US            150000 // us
+#define LATENCY_IIR_WEIGHT                  0.8
+
 enum EPutDataStat
 {
     PS_GEN_ERROR,
@@ -63,10 +121,14 @@ public:
     CChannel ( const bool bNIsServer = true );
 
     EPutDataStat PutData ( const CVector<uint8_t>& vecbyData,
-                           int iNumBytes );
+                           int                     iNumBytes,
+                           const int               iRecTimeUs );
     EGetDataStat GetData ( CVector<uint8_t>& vecbyData );
 
     CVector<uint8_t> PrepSendPacket ( const CVector<uint8_t>& vecbyNPacket );
+    void PrepForwardPackets ( const CVector<uint8_t>&     vecbyStreams,
+                              const CVector<int>&         veciStreamPos,
+                              CVector<CVector<uint8_t> >& vecvecbyPackets );
 
     void ResetTimeOutCounter() { iConTimeOut = iConTimeOutStartVal; }
     bool IsConnected() const { return iConTimeOut > 0; }
@@ -95,16 +157,76 @@ Protocol.CreateChanNameMes ( ChInfo.strName );
     }
     void CreateReqChanInfoMes() { Protocol.CreateReqChanInfoMes(); }
 
+    // server federation: the peer of this channel is a linked server
+    void SetIsFederationLink ( const bool bNIsFedLink ) { bIsFederationLink = bNIsFedLink; }
+    bool IsFederationLink() const { return bIsFederationLink; }
+    void CreateFederationLinkMes() { Protocol.CreateFederationLinkMes(); }
+
+    // forwarding mode: the server forwards the coded streams of all channels
+    // to the client which mixes them locally
+    void SetForwardingAllowed ( const bool bNAllowed ) { bForwardingAllowed = bNAllowed; }
+    void SetOpus64Supported ( const bool bNSupported ) { bOpus64Supported = bNSupported; }
+    void SetIsForwarding ( const bool bNIsForwarding );
+    bool IsForwarding() const { return bIsForwarding; }
+    void CreateReqForwardingMes() { Protocol.CreateReqForwardingMes(); }
+
+    // ID of the channel at the server (on the client it is only known in the
+    // forwarding mode, otherwise it is invalid)
+    void SetChanID ( const int iNChanID ) { iChanID = iNChanID; }
+    int GetChanID() const { return iChanID; }
+
+    // peer-to-peer mode: on the server the flag tells that the client
+    // requested a direct connection, on the client a P2P channel receives the
+    // audio directly from the other client (peer)
+    void SetP2PRequested ( const bool bNRequested ) { bP2PRequested = bNRequested; }
+    bool IsP2PRequested() const { return bP2PRequested; }
+    void SetIsP2P ( const bool bNIsP2P ) { bIsP2P = bNIsP2P; }
+    void CreateReqP2PMes() { Protocol.CreateReqP2PMes(); }
+    void CreateP2PChanIDsMes ( const int iOwnChanID, const int iPeerChanID )
+        { Protocol.CreateP2PChanIDsMes ( iOwnChanID, iPeerChanID ); }
+
+    // local transport: the peer is on the same host and uses the local
+    // transport, the server uses a minimal jitter buffer for these channels
+    void SetIsLocal ( const bool bNIsLocal );
+    bool IsLocal() const { return bIsLocal; }
+
     void SetGain ( const int iChanID, const double dNewGain );
     double GetGain ( const int iChanID );
 
+    // the gain of a channel which is assigned to a bus is the bus gain, only
+    // an explicit override (which is independent of the channel gain set by
+    // the fader of the listener) replaces the bus gain for this channel
+    void SetGainOverride ( const int iChanID, const bool bOverride, const double dNewGain );
+    bool GetGainOverride ( const int iChanID, double& dOverrideGain );
+
     void SetRemoteChanGain ( const int iId, const double dGain )
         { Protocol.CreateChanGainMes ( iId, dGain ); }
 
+    void SetRemoteChanGainOverride ( const int iId, const bool bOverride, const double dGain )
+        { Protocol.CreateChanGainOverrideMes ( iId, bOverride, dGain ); }
+
+    // submix buses: the bus this channel belongs to and the bus gains of the
+    // mix of this channel
+    void ResetBusInfo();
+    void SetBusName ( const QString strNewBusName );
+    QString GetBusName();
+    void SetBusGain ( const QString& strBus, const double dNewGain );
+    double GetBusGain ( const QString& strBus );
+
+    void SetRemoteBusName ( const QString& strBus )
+        { Protocol.CreateChanBusMes ( strBus ); }
+
+    void SetRemoteBusGain ( const QString& strBus, const double dGain )
+        { Protocol.CreateBusGainMes ( strBus, dGain ); }
+
     bool SetSockBufNumFrames ( const int  iNewNumFrames,
                                const bool bPreserve = false );
     int GetSockBufNumFrames() const { return iCurSockBufNumFrames; }
 
+    // number of frames in the jitter buffer after the last GetData() call
+    // (for the audio thread, no mutex is needed)
+    int GetSockBufNumAvailFrames() const { return iLastNumAvailFrames; }
+
     void UpdateSocketBufferSize();
 
     int GetUploadRateKbps();
@@ -120,13 +242,74 @@ Protocol.CreateChanNameMes ( ChInfo.strName );
 
     bool GetDoAutoSockBufSize() const { return bDoAutoSockBufSize; }
 
+    // start value of the auto jitter buffer size, e.g. from a network probe
+    void SetSockBufInitAutoSetting ( const int iNewInitAutoSetting );
+
     int GetNetwFrameSizeFact() const { return iNetwFrameSizeFact; }
     int GetNetwFrameSize() const { return iNetwFrameSize; }
 
+    void SetBufSimulationEnabled ( const bool bNewEnabled );
+    int GetBufSimulationAutoSetting() { return SockBuf.GetSimulationAutoSetting(); }
     void GetBufErrorRates ( CVector<double>& vecErrRates, double& dLimit )
         { SockBuf.GetErrorRates ( vecErrRates, dLimit ); }
+    void GetBufSeqNumStats ( int& iNumReordered, int& iNumLate );
+    void GetBufRedundancyStats ( int& iNumRecovered, int& iNumConcealed );
+
+    // number of frames protected by one redundancy frame which we request from
+    // the peer (zero: no redundancy)
+    void SetReqRedundancy ( const int iNewNumFrames )
+        { iReqRedundancy = iNewNumFrames; }
+    int GetReqRedundancy() const { return iReqRedundancy; }
+
+    // mix-minus: the own signal is excluded from the mix which the server
+    // sends back (the client monitors its own signal locally)
+    void SetMixMinus ( const bool bNewMixMinus );
+    bool GetMixMinus() const { return bMixMinus; }
+    double GetClockDriftPpm();
+    void AddPlayoutCorrection ( const int iNumFrames )
+        { iPendingPlayoutCorrection += iNumFrames; }
+
+    // the audio thread of the client reads the clock drift which was stored
+    // by the last GetData() call, the playout corrections are applied by the
+    // next GetData() call (both must only be used by the audio thread)
+    double GetLastClockDriftPpm() const { return dLastClockDriftPpm; }
+
+    // number of GetData() calls of the client audio thread which found the
+    // mutex locked by another thread (the frame is treated as lost instead
+    // of waiting for the mutex)
+    int GetNumLockContentions() const
+        { return AtomicLoadAcquire ( iNumLockContentions ); }
+    void ResetNumLockContentions()
+        { AtomicStoreRelease ( iNumLockContentions, 0 ); }
+
+    // the client audio thread does not emit the connection signals since
+    // this posts events, they are emitted by this function which must be
+    // called regularly by the main thread
+    void EmitPendingEvents();
+
+    // measured round trip of the audio frames from sending until the mix is
+    // read from the jitter buffer (negative if no measurement is available)
+    void CreateLatencyProbeMes();
+    double GetLatencyRoundTripMs();
+
+    // inter-arrival jitter of the received audio packets
+    int GetInterArrivalJitterUs() const
+        { return InterArrivalJitter.GetJitterUs(); }
 
     EAudComprType GetAudioCompressionType() { return eAudioCompressionType; }
+
+    // the frame size of the audio coded with the current codec
+    int GetFrameSizeSamples() const
+    {
+        if ( eAudioCompressionType == CT_OPUS64 )
+        {
+            return SYSTEM_FRAME_SIZE_SAMPLES_SMALL;
+        }
+        else
+        {
+            return SYSTEM_FRAME_SIZE_SAMPLES;
+        }
+    }
     int GetNumAudioChannels() const { return iNumAudioChannels; }
 
     // network protocol interface
@@ -138,6 +321,8 @@ Protocol.CreateChanNameMes ( ChInfo.strName );
         }
     }
     void CreateReqNetwTranspPropsMes()                    { Protocol.CreateReqNetwTranspPropsMes(); }
+    void CreateNetwTranspPropsMes ( const CNetworkTransportProps& NetTrProps )
+        { Protocol.CreateNetwTranspPropsMes ( NetTrProps ); }
     void CreateReqJitBufMes()                             { Protocol.CreateReqJitBufMes(); }
     void CreateReqConnClientsList()                       { Protocol.CreateReqConnClientsList(); }
     void CreateChatTextMes ( const QString& strChatText ) { Protocol.CreateChatTextMes ( strChatText ); }
@@ -154,6 +339,35 @@ void CreateConClientListNameMes ( const CVector<CChannelInfo>& vecChanInfo )
 protected:
     bool ProtocolIsEnabled();
 
+    int GetSockBufBlockSize()
+    {
+        // in forwarding mode the client jitter buffer stores complete bundles
+        return ( !bIsServer && bIsForwarding ) ? FORWARD_BUNDLE_BLOCK_SIZE : iNetwFrameSize;
+    }
+
+    void AddRedundancy ( CVector<uint8_t>& vecbySendBuf );
+    bool PutForwardPacket ( const CVector<uint8_t>& vecbyData,
+                            const int               iNumBytes );
+    bool PutForwardBundle();
+
+    int GetLatencyTimeUs() const
+        { return static_cast<int> ( LatencyTimer.nsecsElapsed() / 1000 ); }
+
+    static int LatencyTimeDiffUs ( const int iTimeUs, const int iRefTimeUs )
+    {
+        // the time stamps wrap around
+        return static_cast<int> ( static_cast<uint32_t> ( iTimeUs ) -
+                                  static_cast<uint32_t> ( iRefTimeUs ) );
+    }
+
+    // the mutex must be locked
+    void UpdateLatencyRoundTrip ( const int iRoundTripUs );
+
+    // puts an audio packet in the jitter buffer (the mutex must be locked)
+    EPutDataStat PutAudioData ( const CVector<uint8_t>& vecbyData,
+                                const int               iNumBytes,
+                                bool&                   bNewConnection );
+
     void ResetNetworkTransportProperties()
     {
         // set it to a state were no decoding is ever possible (since we want
@@ -163,6 +377,13 @@ protected:
         iNetwFrameSizeFact    = FRAME_SIZE_FACTOR_PREFERRED;
         iNetwFrameSize        = CELT_MINIMUM_NUM_BYTES;
         iNumAudioChannels     = 1; // mono
+
+        // the sequence numbers and the redundancy are enabled by the peer on
+        // the next connection
+        bSendSeqNum     = false;
+        iSendSeqNum     = 0;
+        iSendRedundancy = 0;
+        iRedNumFrames   = 0;
     }
 
     // connection parameters
@@ -174,6 +395,13 @@ protected:
     // mixer and effect settings
     CVector<double>   vecdGains;
 
+    // submix buses (an override gain which was explicitly set for a bused
+    // channel replaces the bus gain of this mix)
+    CVector<uint8_t>      vecbyGainOverride;
+    CVector<double>       vecdGainOverrides;
+    QString               strBusName;
+    QMap<QString, double> mapBusGains;
+
     // network jitter-buffer
     CNetBufWithStats  SockBuf;
     int               iCurSockBufNumFrames;
@@ -190,6 +418,44 @@ protected:
 
     bool              bIsEnabled;
     bool              bIsServer;
+    bool              bIsFederationLink;
+    bool              bForwardingAllowed;
+    bool              bOpus64Supported;
+    bool              bIsForwarding;
+    int               iChanID;
+    bool              bP2PRequested;
+    bool              bIsP2P;
+    bool              bIsLocal;
+    bool              bSendSeqNum;
+    int               iSendSeqNum;
+
+    // redundancy frames
+    int               iReqRedundancy;
+    bool              bMixMinus;
+    int               iSendRedundancy;
+    int               iRedNumFrames;
+    CVector<uint8_t>  vecbyRedSendFrame;
+    CVector<uint8_t>  vecbyRedRecFrame;
+
+    // reassembly of the forwarded bundle of the current frame (client)
+    CVector<uint8_t>  vecbyForwardBundle;
+    CVector<uint8_t>  vecbyForwardPacketReceived;
+    int               iForwardSeqNum;
+    int               iForwardBundleSize;
+    int               iForwardNumPackets;
+    int               iForwardNumRecPackets;
+
+    // latency measurement, the times are stored for each sequence number
+    QElapsedTimer     LatencyTimer;
+    CVector<int>      veciLatencySendTimeUs;
+    CVector<int>      veciLatencyGetTimeUs;
+    CVector<int>      veciLatencyOutSeqNum;
+    int               iLatencyProbeSeqNum;
+    int               iLatencyProbeTimeStampUs;
+    double            dLatencyRoundTripMs;
+
+    // only updated by the thread which puts the received packets
+    CInterArrivalJitter InterArrivalJitter;
 
     int               iNetwFrameSizeFact;
     int               iNetwFrameSize;
@@ -199,6 +465,21 @@ protected:
 
     QMutex            Mutex;
 
+    // state of the client audio thread, see GetData()
+    QAtomicInt        iNumLockContentions;
+    QAtomicInt        iNewConnectionPending;
+    QAtomicInt        iDisconnectedPending;
+    int               iPendingPlayoutCorrection;
+    int               iLastNumAvailFrames;
+    double            dLastClockDriftPpm;
+
+#ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
+    // the client audio packets are handed over from the socket thread to the
+    // audio thread which puts them in the jitter buffer
+    CPacketQueue      RecAudioQueue;
+    CVector<uint8_t>  vecbyRecAudioData;
+#endif
+
 public slots:
     void OnSendProtMessage ( CVector<uint8_t> vecMessage );
     void OnJittBufSizeChange ( int iNewJitBufSize );
@@ -207,6 +488,18 @@ public slots:
     void OnChangeChanInfo ( CChannelCoreInfo ChanInfo );
     void OnNetTranspPropsReceived ( CNetworkTransportProps NetworkTransportProps );
     void OnReqNetTranspProps();
+    void OnFederationLinkReceived();
+    void OnChangeChanGainOverride ( int iChanID, bool bOverride, double dNewGain );
+    void OnChangeChanBus ( QString strNewBusName );
+    void OnChangeBusGain ( QString strBus, double dNewGain );
+    void OnReqForwarding();
+    void OnForwardingReceived ( int iOwnChanID );
+    void OnReqP2P();
+    void OnSeqNumSupported();
+    void OnReqRedundancy ( int iNumFrames );
+    void OnMixMinus ( bool bNewMixMinus ) { bMixMinus = bNewMixMinus; }
+    void OnLatencyProbe ( int iSeqNum, int iTimeStampUs );
+    void OnLatencyProbeEcho ( int iSeqNum, int iTimeStampUs );
 
 #ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
     void OnParseMessageBody ( CVector<uint8_t> vecbyMesBodyData,
@@ -224,10 +517,15 @@ signals:
     void ConClientListNameMesReceived ( CVector<CChannelInfo> vecChanInfo );
     void ConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
     void ChanInfoHasChanged();
+    void BusInfoHasChanged();
     void ReqChanInfo();
     void OpusSupported();
+    void Opus64Supported();
+    void RawAudioSupported();
     void ChatTextReceived ( QString strChatText );
     void ReqNetTranspProps();
+    void P2PRequested();
+    void P2PChanIDsReceived ( int iOwnChanID, int iPeerChanID );
     void Disconnected();
 
     void DetectedCLMessage ( CVector<uint8_t> vecbyMesBodyData,
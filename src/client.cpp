@@ -26,11 +26,68 @@
 
 
 /* Implementation *************************************************************/
+void CClientSendThread::Start()
+{
+    // only start if not already running
+    if ( !bRun )
+    {
+        bRun = true;
+
+        // the packets must be sent with the same reliability as the audio
+        // is processed
+        QThread::start ( QThread::TimeCriticalPriority );
+    }
+}
+
+void CClientSendThread::Stop()
+{
+    // set flag so that thread can leave the main loop
+    bRun = false;
+
+    // give thread some time to terminate
+    wait ( 5000 );
+}
+
+void CClientSendThread::run()
+{
+    int iNumEmptyPolls = 0;
+
+    // loop until the thread shall be terminated
+    while ( bRun )
+    {
+        // the outgoing queue is polled so that the audio callback does not
+        // have to wake up this thread, if no audio is processed, the thread
+        // sleeps longer
+        if ( pClient->SendQueuedPackets() )
+        {
+            iNumEmptyPolls = 0;
+        }
+        else if ( iNumEmptyPolls < SEND_THREAD_NUM_POLLS_BEFORE_IDLE )
+        {
+            iNumEmptyPolls++;
+        }
+
+        if ( iNumEmptyPolls < SEND_THREAD_NUM_POLLS_BEFORE_IDLE )
+        {
+            usleep ( SEND_THREAD_POLL_INTERVAL_US );
+        }
+        else
+        {
+            msleep ( SEND_THREAD_IDLE_INTERVAL_MS );
+        }
+    }
+}
+
 CClient::CClient ( const quint16 iPortNumber ) :
     vstrIPAddress                    ( MAX_NUM_SERVER_ADDR_ITEMS, "" ),
     ChannelInfo                      (),
     vecStoredFaderTags               ( MAX_NUM_STORED_FADER_LEVELS, "" ),
     vecStoredFaderLevels             ( MAX_NUM_STORED_FADER_LEVELS, AUD_MIX_FADER_MAX ),
+    vecStoredBusNames                ( MAX_NUM_STORED_BUS_GAINS, "" ),
+    vecStoredBusGains                ( MAX_NUM_STORED_BUS_GAINS, AUD_MIX_FADER_MAX ),
+    vecStoredJitBufAddr              ( MAX_NUM_STORED_JIT_BUF_SIZES, "" ),
+    vecStoredJitBufSizes             ( MAX_NUM_STORED_JIT_BUF_SIZES, DEF_AUTO_NET_BUF_SIZE_NUM_BL ),
+    vecStoredServerJitBufSizes       ( MAX_NUM_STORED_JIT_BUF_SIZES, DEF_AUTO_NET_BUF_SIZE_NUM_BL ),
     vecWindowPosMain                 (), // empty array
     vecWindowPosSettings             (), // empty array
     vecWindowPosChat                 (), // empty array
@@ -39,20 +96,59 @@ CClient::CClient ( const quint16 iPortNumber ) :
     bWindowWasShownChat              ( false ),
     bWindowWasShownConnect           ( false ),
     Channel                          ( false ), /* we need a client channel -> "false" */
+    P2PChannel                       ( false ),
     eAudioCompressionType            ( CT_OPUS ),
+    iFrameSizeSamples                ( SYSTEM_FRAME_SIZE_SAMPLES ),
     iCeltNumCodedBytes               ( CELT_NUM_BYTES_MONO_LOW_QUALITY ),
     eAudioQuality                    ( AQ_LOW ),
     bUseStereo                       ( false ),
     bIsInitializationPhase           ( true ),
-    Socket                           ( &Channel, iPortNumber ),
+    bUseForwarding                   ( false ),
+    vecdForwardGains                 ( MAX_NUM_CHANNELS, (double) 1.0 ),
+    vecForwardNumAudChan             ( MAX_NUM_CHANNELS, 0 ),
+    vecForwardAudComprType           ( MAX_NUM_CHANNELS, CT_OPUS ),
+    vecsForwardDecoded               ( 2 * SYSTEM_FRAME_SIZE_SAMPLES, 0 ),
+    vecdForwardMix                   ( 2 * SYSTEM_FRAME_SIZE_SAMPLES, 0 ),
+    bUseP2P                          ( false ),
+    bP2PPathActive                   ( false ),
+    iP2PNumLostFrames                ( 0 ),
+    iP2PPingTimeMs                   ( -1 ),
+    iP2POwnChanID                    ( -1 ),
+    iP2PPeerChanID                   ( -1 ),
+    vecbyP2PNetwData                 (), // empty array
+    bUseLocalTransport               ( false ),
+    bUseRawAudio                     ( false ),
+    bPreProbeServer                  ( true ),
+    SwitchServerAddr                 (),
+    iSwitchServerPingCnt             ( 0 ),
+    bUseAdaptivePlayout              ( false ),
+    bPlayoutInsertFrame              ( false ),
+    vecsPlayoutFrame                 (), // empty array
+    bUseDriftCompensation            ( false ),
+    DriftResampler                   (),
+    vecsDriftFrame                   (), // empty array
+    Socket                           ( &Channel, iPortNumber, &P2PChannel ),
     Sound                            ( AudioCallback, this ),
+    SendQueue                        (),
+    vecbySendQueueData               (), // empty array
+    SendThread                       ( this ),
+    iAudioProcState                  ( AUDIO_PROC_RUNNING ),
+    iNumCallbackAllocs               ( 0 ),
+    iJitBufGetOk                     ( 0 ),
+    iJitBufGetErr                    ( 0 ),
     iAudioInFader                    ( AUD_FADER_IN_MIDDLE ),
     bReverbOnLeftChan                ( false ),
     iReverbLevel                     ( 0 ),
+    iMonitorLevel                    ( 0 ),
+    bLatencyMarker                   ( false ),
+    iLatencyMarkerIntervalCnt        ( 0 ),
+    iLatencyMarkerCnt                ( -1 ),
+    iLatencyMarkerDelaySam           ( -1 ),
     iSndCrdPrefFrameSizeFactor       ( FRAME_SIZE_FACTOR_PREFERRED ),
     iSndCrdFrameSizeFactor           ( FRAME_SIZE_FACTOR_PREFERRED ),
     bSndCrdConversionBufferRequired  ( false ),
     iSndCardMonoBlockSizeSamConvBuff ( 0 ),
+    iSndCrdConvBufDelayMonoSam       ( 0 ),
     bFraSiFactPrefSupported          ( false ),
     bFraSiFactDefSupported           ( false ),
     bFraSiFactSafeSupported          ( false ),
@@ -60,7 +156,12 @@ CClient::CClient ( const quint16 iPortNumber ) :
     eGUIDesign                       ( GD_ORIGINAL ),
     strCentralServerAddress          ( "" ),
     bUseDefaultCentralServerAddress  ( true ),
-    iServerSockBufNumFrames          ( DEF_NET_BUF_SIZE_NUM_BL )
+    iServerSockBufNumFrames          ( DEF_NET_BUF_SIZE_NUM_BL ),
+    iInitSockBufNumFrames            ( 0 ),
+    iInitServerSockBufNumFrames      ( 0 ),
+    iProbeCnt                        ( 0 ),
+    iProbeNumReplies                 ( 0 ),
+    veciProbeRttMs                   ( PROBE_NUM_PACKETS, -1 )
 {
     int iOpusError;
 
@@ -138,6 +239,95 @@ CClient::CClient ( const quint16 iPortNumber ) :
                               OPUS_SET_COMPLEXITY ( 1 ) );
 #endif
 
+    // init OPUS encoder/decoder with the small frame size (mono and stereo)
+    Opus64Mode = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
+                                           SYSTEM_FRAME_SIZE_SAMPLES_SMALL,
+                                           &iOpusError );
+
+    Opus64EncoderMono = opus_custom_encoder_create ( Opus64Mode,
+                                                     1,
+                                                     &iOpusError );
+
+    Opus64DecoderMono = opus_custom_decoder_create ( Opus64Mode,
+                                                     1,
+                                                     &iOpusError );
+
+    Opus64EncoderStereo = opus_custom_encoder_create ( Opus64Mode,
+                                                       2,
+                                                       &iOpusError );
+
+    Opus64DecoderStereo = opus_custom_decoder_create ( Opus64Mode,
+                                                       2,
+                                                       &iOpusError );
+
+    // we require a constant bit rate with as low delay as possible
+    opus_custom_encoder_ctl ( Opus64EncoderMono,
+                              OPUS_SET_VBR ( 0 ) );
+
+    opus_custom_encoder_ctl ( Opus64EncoderMono,
+                              OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+    opus_custom_encoder_ctl ( Opus64EncoderStereo,
+                              OPUS_SET_VBR ( 0 ) );
+
+    opus_custom_encoder_ctl ( Opus64EncoderStereo,
+                              OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+#ifdef USE_LOW_COMPLEXITY_CELT_ENC
+    // set encoder low complexity
+    opus_custom_encoder_ctl ( Opus64EncoderMono,
+                              OPUS_SET_COMPLEXITY ( 1 ) );
+
+    opus_custom_encoder_ctl ( Opus64EncoderStereo,
+                              OPUS_SET_COMPLEXITY ( 1 ) );
+#endif
+
+    // the current encoder/decoder are selected in Init()
+    CurOpusEncoder = OpusEncoderMono;
+    CurOpusDecoder = OpusDecoderMono;
+
+    // decoders for the streams of all channels in forwarding mode
+    for ( int i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        OpusDecoderForwardMono[i] = opus_custom_decoder_create ( OpusMode,
+                                                                 1,
+                                                                 &iOpusError );
+
+        OpusDecoderForwardStereo[i] = opus_custom_decoder_create ( OpusMode,
+                                                                   2,
+                                                                   &iOpusError );
+
+        CeltDecoderForwardMono[i]   = cc6_celt_decoder_create ( CeltModeMono );
+        CeltDecoderForwardStereo[i] = cc6_celt_decoder_create ( CeltModeStereo );
+    }
+
+    // decoders for the stream of the peer in peer-to-peer mode
+    CeltDecoderP2PMono   = cc6_celt_decoder_create ( CeltModeMono );
+    CeltDecoderP2PStereo = cc6_celt_decoder_create ( CeltModeStereo );
+
+    OpusDecoderP2PMono = opus_custom_decoder_create ( OpusMode,
+                                                      1,
+                                                      &iOpusError );
+
+    OpusDecoderP2PStereo = opus_custom_decoder_create ( OpusMode,
+                                                        2,
+                                                        &iOpusError );
+
+    // the P2P channel accepts the network transport properties of the peer
+    P2PChannel.SetIsP2P ( true );
+
+    // the memory of the outgoing queue is allocated once so that the audio
+    // callback never allocates memory
+    SendQueue.Init ( SEND_QUEUE_NUM_PACKETS, MAX_SIZE_BYTES_NETW_BUF );
+
+    // the processing times of the audio callback are measured relative to
+    // this monotonic timer
+    AudioProcTimer.start();
+
+    // sound interfaces which work with floating point samples call the
+    // floating point callback (the 16 bit callback is used by all others)
+    Sound.SetProcessCallbackFloat ( AudioCallbackFloat );
+
 
     // Connections -------------------------------------------------------------
     // connections for the protocol mechanism
@@ -181,6 +371,29 @@ CClient::CClient ( const quint16 iPortNumber ) :
 QObject::connect ( &Channel, SIGNAL ( OpusSupported() ),
     this, SLOT ( OnOpusSupported() ) );
 
+    QObject::connect ( &Channel, SIGNAL ( Opus64Supported() ),
+        this, SLOT ( OnOpus64Supported() ) );
+
+    QObject::connect ( &Channel, SIGNAL ( RawAudioSupported() ),
+        this, SLOT ( OnRawAudioSupported() ) );
+
+    QObject::connect ( &Channel,
+        SIGNAL ( ConClientListMesReceived ( CVector<CChannelInfo> ) ),
+        this, SLOT ( OnConClientListMesReceived ( CVector<CChannelInfo> ) ) );
+
+    QObject::connect ( &Channel,
+        SIGNAL ( P2PChanIDsReceived ( int, int ) ),
+        this, SLOT ( OnP2PChanIDsReceived ( int, int ) ) );
+
+    // connections for the direct connection to the peer
+    QObject::connect ( &P2PChannel,
+        SIGNAL ( MessReadyForSending ( CVector<uint8_t> ) ),
+        this, SLOT ( OnSendP2PProtMessage ( CVector<uint8_t> ) ) );
+
+    QObject::connect ( &P2PChannel,
+        SIGNAL ( DetectedCLMessage ( CVector<uint8_t>, int ) ),
+        this, SLOT ( OnDetectedP2PCLMessage ( CVector<uint8_t>, int ) ) );
+
     QObject::connect ( &ConnLessProtocol,
         SIGNAL ( CLMessReadyForSending ( CHostAddress, CVector<uint8_t> ) ),
         this, SLOT ( OnSendCLProtMessage ( CHostAddress, CVector<uint8_t> ) ) );
@@ -197,6 +410,24 @@ QObject::connect ( &Channel, SIGNAL ( OpusSupported() ),
         SIGNAL ( CLPingWithNumClientsReceived ( CHostAddress, int, int ) ),
         this, SLOT ( OnCLPingWithNumClientsReceived ( CHostAddress, int, int ) ) );
 
+    QObject::connect ( &ConnLessProtocol,
+        SIGNAL ( CLSendEmptyMes ( CHostAddress, CHostAddress ) ),
+        this, SLOT ( OnCLSendEmptyMes ( CHostAddress, CHostAddress ) ) );
+
+    QObject::connect ( &ConnLessProtocol,
+        SIGNAL ( CLProbeReceived ( CHostAddress, int, int ) ),
+        this, SLOT ( OnCLProbeReceived ( CHostAddress, int, int ) ) );
+
+    // timers
+    QObject::connect ( &TimerProbe, SIGNAL ( timeout() ),
+        this, SLOT ( OnTimerProbe() ) );
+
+    QObject::connect ( &TimerSwitchServer, SIGNAL ( timeout() ),
+        this, SLOT ( OnTimerSwitchServer() ) );
+
+    QObject::connect ( &TimerChannelUpdate, SIGNAL ( timeout() ),
+        this, SLOT ( OnTimerChannelUpdate() ) );
+
 
     // other
     QObject::connect ( &Sound, SIGNAL ( ReinitRequest ( int ) ),
@@ -206,6 +437,34 @@ QObject::connect ( &Channel, SIGNAL ( OpusSupported() ),
         this, SLOT ( OnInvalidPacketReceived ( CVector<uint8_t>, int, CHostAddress ) ) );
 }
 
+bool CClient::SendQueuedPackets()
+{
+    bool bPacketSent = false;
+
+    while ( SendQueue.Get ( vecbySendQueueData ) )
+    {
+        bPacketSent = true;
+
+        // send coded audio through the network
+        const CVector<uint8_t> vecbySendPacket =
+            Channel.PrepSendPacket ( vecbySendQueueData );
+
+        Socket.SendPacket ( vecbySendPacket, Channel.GetAddress() );
+
+        // In peer-to-peer mode the same packet is sent directly to the peer.
+        // The server still gets it since the server disconnects a channel
+        // which does not send audio and since the peer falls back to the
+        // server mix within P2P_FALLBACK_TIME_MS if the direct path fails,
+        // which is only possible if the server has our stream.
+        if ( P2PChannel.IsEnabled() )
+        {
+            Socket.SendPacket ( vecbySendPacket, P2PChannel.GetAddress() );
+        }
+    }
+
+    return bPacketSent;
+}
+
 void CClient::OnSendProtMessage ( CVector<uint8_t> vecMessage )
 {
     // the protocol queries me to call the function to send the message
@@ -213,6 +472,12 @@ void CClient::OnSendProtMessage ( CVector<uint8_t> vecMessage )
     Socket.SendPacket ( vecMessage, Channel.GetAddress() );
 }
 
+void CClient::OnSendP2PProtMessage ( CVector<uint8_t> vecMessage )
+{
+    // protocol messages of the P2P channel are sent directly to the peer
+    Socket.SendPacket ( vecMessage, P2PChannel.GetAddress() );
+}
+
 void CClient::OnSendCLProtMessage ( CHostAddress     InetAddr,
                                     CVector<uint8_t> vecMessage )
 {
@@ -255,6 +520,92 @@ void CClient::OnDetectedCLMessage ( CVector<uint8_t> vecbyMesBodyData,
                                                       Channel.GetAddress() );
 }
 
+void CClient::OnDetectedP2PCLMessage ( CVector<uint8_t> vecbyMesBodyData,
+                                       int              iRecID )
+{
+    // connection less message of the peer (e.g. the ping for measuring the
+    // latency of the direct path)
+    ConnLessProtocol.ParseConnectionLessMessageBody ( vecbyMesBodyData,
+                                                      iRecID,
+                                                      P2PChannel.GetAddress() );
+}
+
+void CClient::OnCLSendEmptyMes ( CHostAddress InetAddr,
+                                 CHostAddress PeerInetAddr )
+{
+    // the server brokers a direct connection to the other client of a duet,
+    // we only accept it if we requested it and if the message comes from the
+    // server we are connected to (otherwise any host could redirect a copy of
+    // our audio stream to an address of its choice)
+    if ( bUseP2P && Channel.IsConnected() &&
+         ( InetAddr == Channel.GetAddress() ) )
+    {
+        // send an empty message to the peer to open our NAT for its packets
+        ConnLessProtocol.CreateCLEmptyMes ( PeerInetAddr );
+
+        // the server repeats the message on each change of the client list,
+        // only (re-)start the direct connection if the peer has changed
+        if ( !P2PChannel.IsEnabled() ||
+             !( P2PChannel.GetAddress() == PeerInetAddr ) )
+        {
+            StartP2P ( PeerInetAddr );
+        }
+    }
+}
+
+void CClient::OnConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo )
+{
+    // the direct connection is only used for a duet, if a third client joins
+    // the session we go back to the server mix
+    if ( P2PChannel.IsEnabled() && ( vecChanInfo.Size() != 2 ) )
+    {
+        StopP2P();
+    }
+}
+
+void CClient::OnP2PChanIDsReceived ( int iOwnChanID,
+                                     int iPeerChanID )
+{
+    // the channel gains of these IDs (faders, mute and solo of the mixer
+    // board) are applied to the local mix of the direct connection
+    iP2POwnChanID  = iOwnChanID;
+    iP2PPeerChanID = iPeerChanID;
+}
+
+void CClient::StartP2P ( const CHostAddress& PeerAddr )
+{
+    // reset a previous direct connection
+    P2PChannel.SetEnable ( false );
+
+    // the P2P channel uses the same jitter buffer settings as the channel to
+    // the server
+    P2PChannel.SetAddress ( PeerAddr );
+    P2PChannel.SetDoAutoSockBufSize ( Channel.GetDoAutoSockBufSize() );
+    P2PChannel.SetSockBufNumFrames ( Channel.GetSockBufNumFrames() );
+
+    // the server mix is used until audio is received from the peer
+    iP2PNumLostFrames = P2P_FALLBACK_NUM_FRAMES;
+    bP2PPathActive    = false;
+    iP2PPingTimeMs    = -1;
+
+    P2PChannel.SetEnable ( true );
+
+    // tell the peer the properties of our audio stream (the protocol
+    // repeats the message until the peer has opened its P2P channel, too)
+    P2PChannel.CreateNetwTranspPropsMes (
+        Channel.GetNetworkTransportPropsFromCurrentSettings() );
+}
+
+void CClient::StopP2P()
+{
+    P2PChannel.SetEnable ( false );
+
+    bP2PPathActive = false;
+    iP2PPingTimeMs = -1;
+    iP2POwnChanID  = -1;
+    iP2PPeerChanID = -1;
+}
+
 void CClient::OnJittBufSizeChanged ( int iNewJitBufSize )
 {
     // we received a jitter buffer size changed message from the server,
@@ -272,7 +623,21 @@ void CClient::OnNewConnection()
 {
     // a new connection was successfully initiated, send infos and request
     // connected clients list
-    Channel.SetRemoteInfo ( ChannelInfo );
+    SetRemoteInfo();
+
+    // request the streams of all channels for mixing them locally, the local
+    // gains are set by the mixer faders when the client list is received
+    if ( bUseForwarding )
+    {
+        vecdForwardGains.Reset ( 1.0 );
+        Channel.CreateReqForwardingMes();
+    }
+
+    // ask the server for a direct connection to the other client of a duet
+    if ( bUseP2P )
+    {
+        Channel.CreateReqP2PMes();
+    }
 
     // We have to send a connected clients list request since it can happen
     // that we just had connected to the server and then disconnected but
@@ -284,12 +649,50 @@ void CClient::OnNewConnection()
     CreateServerJitterBufferMessage();
 }
 
+void CClient::SetRemoteInfo()
+{
+    Channel.SetRemoteInfo ( ChannelInfo );
+    Channel.SetRemoteBusName ( strBusName );
+
+    // send the stored submix bus gains for our mix, buses which are not in
+    // use on the server are ignored there
+    for ( int iIdx = 0; iIdx < MAX_NUM_STORED_BUS_GAINS; iIdx++ )
+    {
+        if ( !vecStoredBusNames[iIdx].isEmpty() )
+        {
+            Channel.SetRemoteBusGain ( vecStoredBusNames[iIdx],
+                static_cast<double> ( vecStoredBusGains[iIdx] ) / AUD_MIX_FADER_MAX );
+        }
+    }
+}
+
+void CClient::SetRemoteChanGain ( const int    iId,
+                                  const double dGain )
+{
+    // store the gain for the local mix in forwarding mode
+    if ( ( iId >= 0 ) && ( iId < MAX_NUM_CHANNELS ) )
+    {
+        vecdForwardGains[iId] = dGain;
+    }
+
+    Channel.SetRemoteChanGain ( iId, dGain );
+}
+
 void CClient::CreateServerJitterBufferMessage()
 {
     // per definition in the client: if auto jitter buffer is enabled, both,
     // the client and server shall use an auto jitter buffer
     if ( GetDoAutoSockBufSize() )
     {
+        // if we know a good start value for the auto setting of the server, we
+        // transmit it as a manual setting right before the auto setting (the
+        // server uses the last manual setting as the start value of the auto
+        // setting, older servers simply switch to auto)
+        if ( iInitServerSockBufNumFrames > 0 )
+        {
+            Channel.CreateJitBufMes ( iInitServerSockBufNumFrames );
+        }
+
         // in case auto jitter buffer size is enabled, we have to transmit a
         // special value
         Channel.CreateJitBufMes ( AUTO_NET_BUF_SIZE_FOR_PROTOCOL );
@@ -300,45 +703,132 @@ void CClient::CreateServerJitterBufferMessage()
     }
 }
 
+void CClient::CreateCLPingMes()
+{
+    ConnLessProtocol.CreateCLPingMes ( Channel.GetAddress(), PreparePingMessage() );
+
+    // the round trip of the audio frames through the server is measured
+    // together with the ping time
+    Channel.CreateLatencyProbeMes();
+
+    // in peer-to-peer mode we also measure the ping time of the direct path
+    if ( P2PChannel.IsEnabled() )
+    {
+        ConnLessProtocol.CreateCLPingMes ( P2PChannel.GetAddress(),
+                                           PreparePingMessage() );
+    }
+}
+
 void CClient::OnCLPingReceived ( CHostAddress InetAddr,
                                  int          iMs )
 {
+    // the ping of the peer is answered like the server does it but with the
+    // ping with number of clients message so that the peer can distinguish
+    // the answer from a ping request
+    if ( P2PChannel.IsEnabled() && ( InetAddr == P2PChannel.GetAddress() ) )
+    {
+        ConnLessProtocol.CreateCLPingWithNumClientsMes ( InetAddr, iMs, 0 );
+    }
+    // the target server of a server switch answered, now we can cut over
+    else if ( TimerSwitchServer.isActive() && ( InetAddr == SwitchServerAddr ) )
+    {
+        TimerSwitchServer.stop();
+        CutOverToServer ( SwitchServerAddr );
+    }
     // make sure we are running and the server address is correct
-    if ( IsRunning() && ( InetAddr == Channel.GetAddress() ) )
+    else if ( IsRunning() && ( InetAddr == Channel.GetAddress() ) )
+    {
+        // take care of wrap arounds (if wrapping, do not use result)
+        const int iCurDiffUs = EvaluatePingMessage ( iMs );
+        if ( iCurDiffUs >= 0 )
+        {
+            RttStats.Update ( iCurDiffUs );
+
+            emit PingTimeReceived ( MathUtils::round ( iCurDiffUs / 1000.0 ) );
+        }
+    }
+}
+
+void CClient::OnCLProbeReceived ( CHostAddress InetAddr,
+                                  int          iProbeIdx,
+                                  int          iMs )
+{
+    // only use replies to the current probe burst
+    if ( TimerProbe.isActive() &&
+         ( InetAddr == Channel.GetAddress() ) &&
+         ( iProbeIdx >= 0 ) && ( iProbeIdx < PROBE_NUM_PACKETS ) &&
+         ( veciProbeRttMs[iProbeIdx] < 0 ) )
     {
         // take care of wrap arounds (if wrapping, do not use result)
-        const int iCurDiff = EvaluatePingMessage ( iMs );
-        if ( iCurDiff >= 0 )
+        const int iCurDiffUs = EvaluatePingMessage ( iMs );
+        if ( iCurDiffUs >= 0 )
         {
-            emit PingTimeReceived ( iCurDiff );
+            veciProbeRttMs[iProbeIdx] = MathUtils::round ( iCurDiffUs / 1000.0 );
+            iProbeNumReplies++;
         }
     }
 }
 
+void CClient::OnTimerProbe()
+{
+    if ( iProbeCnt < PROBE_NUM_PACKETS )
+    {
+        // send the next probe of the burst
+        ConnLessProtocol.CreateCLProbeMes ( Channel.GetAddress(),
+                                            iProbeCnt,
+                                            PreparePingMessage() );
+    }
+    else if ( ( iProbeNumReplies == PROBE_NUM_PACKETS ) ||
+              ( ( iProbeCnt - PROBE_NUM_PACKETS ) * PROBE_INTERVAL_MS >= PROBE_TIME_OUT_MS ) )
+    {
+        // all replies are received or the remaining probes are lost
+        EvaluateProbe();
+    }
+
+    iProbeCnt++;
+}
+
 void CClient::OnCLPingWithNumClientsReceived ( CHostAddress InetAddr,
                                                int          iMs,
                                                int          iNumClients )
 {
     // take care of wrap arounds (if wrapping, do not use result)
-    const int iCurDiff = EvaluatePingMessage ( iMs );
-    if ( iCurDiff >= 0 )
+    const int iCurDiffUs = EvaluatePingMessage ( iMs );
+    if ( iCurDiffUs >= 0 )
     {
-        emit CLPingTimeWithNumClientsReceived ( InetAddr,
-                                                iCurDiff,
-                                                iNumClients );
+        if ( P2PChannel.IsEnabled() && ( InetAddr == P2PChannel.GetAddress() ) )
+        {
+            // answer of the peer: ping time of the direct path
+            iP2PPingTimeMs = MathUtils::round ( iCurDiffUs / 1000.0 );
+        }
+        else
+        {
+            emit CLPingTimeWithNumClientsReceived ( InetAddr,
+                                                    iCurDiffUs,
+                                                    iNumClients );
+        }
     }
 }
 
 int CClient::PreparePingMessage()
 {
-    // transmit the current precise time (in ms)
-    return PreciseTime.elapsed();
+    // transmit the current precise time (in us)
+    return PreciseTime.elapsedUs();
 }
 
-int CClient::EvaluatePingMessage ( const int iMs )
+int CClient::EvaluatePingMessage ( const int iTimeStampUs )
 {
-    // calculate difference between received time in ms and current time in ms
-    return PreciseTime.elapsed() - iMs;
+    int iRecTimeUs;
+
+    // use the receive time of the socket if available, the message is
+    // evaluated in the GUI thread which may be delayed
+    if ( !Socket.GetPingRecTimeUs ( iTimeStampUs, iRecTimeUs ) )
+    {
+        iRecTimeUs = PreciseTime.elapsedUs();
+    }
+
+    // calculate difference between received time and transmit time in us
+    return CPreciseTime::DiffUs ( iRecTimeUs, iTimeStampUs );
 }
 
 void CClient::SetDoAutoSockBufSize ( const bool bValue )
@@ -353,8 +843,7 @@ void CClient::SetDoAutoSockBufSize ( const bool bValue )
 bool CClient::SetServerAddr ( QString strNAddr )
 {
     CHostAddress HostAddress;
-    if ( NetworkUtil().ParseNetworkAddress ( strNAddr,
-                                             HostAddress ) )
+    if ( ParseServerAddr ( strNAddr, HostAddress ) )
     {
         // apply address to the channel
         Channel.SetAddress ( HostAddress );
@@ -367,73 +856,296 @@ bool CClient::SetServerAddr ( QString strNAddr )
     }
 }
 
-void CClient::SetSndCrdPrefFrameSizeFactor ( const int iNewFactor )
+bool CClient::ParseServerAddr ( const QString& strNAddr,
+                                CHostAddress&  HostAddress )
 {
-    // first check new input parameter
-    if ( ( iNewFactor == FRAME_SIZE_FACTOR_PREFERRED ) ||
-         ( iNewFactor == FRAME_SIZE_FACTOR_DEFAULT ) ||
-         ( iNewFactor == FRAME_SIZE_FACTOR_SAFE ) )
+    if ( NetworkUtil().ParseNetworkAddress ( strNAddr,
+                                             HostAddress ) )
     {
-        // init with new parameter, if client was running then first
-        // stop it and restart again after new initialization
-        const bool bWasRunning = Sound.IsRunning();
-        if ( bWasRunning )
+        // if the server runs on the same host and offers the local transport,
+        // we use it instead of UDP (the same packets are sent, only the
+        // address of the server is replaced by the local transport address)
+        if ( bUseLocalTransport &&
+             ( HostAddress.InetAddr == QHostAddress ( QHostAddress::LocalHost ) ) &&
+             CSocket::LocalTransportAvailable ( HostAddress.iPort ) )
         {
-            Sound.Stop();
+            HostAddress = CHostAddress::LocalTransport ( HostAddress.iPort );
         }
 
-        // set new parameter
-        iSndCrdPrefFrameSizeFactor = iNewFactor;
+        return true;
+    }
+    else
+    {
+        return false; // invalid address
+    }
+}
 
-        // init with new block size index parameter
-        Init();
+bool CClient::SwitchServer ( QString strNAddr )
+{
+    CHostAddress HostAddress;
+    if ( ParseServerAddr ( strNAddr, HostAddress ) )
+    {
+        if ( bPreProbeServer )
+        {
+            // ping the target server first, the current connection is kept
+            // until the answer is received
+            SwitchServerAddr     = HostAddress;
+            iSwitchServerPingCnt = 1;
 
-        if ( bWasRunning )
+            ConnLessProtocol.CreateCLPingMes ( SwitchServerAddr,
+                                               PreparePingMessage() );
+
+            TimerSwitchServer.start ( SWITCH_SERVER_PING_INTERVAL_MS );
+        }
+        else
         {
-            // restart client
-            Sound.Start();
+            CutOverToServer ( HostAddress );
         }
+
+        return true;
+    }
+    else
+    {
+        return false; // invalid address
     }
 }
 
-// #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
-void CClient::OnOpusSupported()
+void CClient::OnTimerSwitchServer()
 {
-    if ( eAudioCompressionType != CT_OPUS )
+    if ( iSwitchServerPingCnt < SWITCH_SERVER_NUM_PINGS )
     {
-        SetAudoCompressiontype ( CT_OPUS );
+        // the ping or its answer may be lost, try again
+        ConnLessProtocol.CreateCLPingMes ( SwitchServerAddr,
+                                           PreparePingMessage() );
+
+        iSwitchServerPingCnt++;
     }
+    else
+    {
+        // the target server does not answer, stay with the current server
+        TimerSwitchServer.stop();
 
-    // inform the GUI about the change of the network rate
-    emit UpstreamRateChanged();
+        emit ServerSwitchFailed();
+    }
 }
 
-// #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
-void CClient::SetAudoCompressiontype ( const EAudComprType eNAudCompressionType )
+void CClient::OnTimerChannelUpdate()
 {
-    // init with new parameter, if client was running then first
-    // stop it and restart again after new initialization
-    const bool bWasRunning = Sound.IsRunning();
-    if ( bWasRunning )
+    // the LED shows red if any frame which the audio callback read since the
+    // last update was lost
+    const bool bGetErr = ( iJitBufGetErr.fetchAndStoreOrdered ( 0 ) != 0 );
+    const bool bGetOk  = ( iJitBufGetOk.fetchAndStoreOrdered ( 0 ) != 0 );
+
+    if ( bGetErr )
     {
-        Sound.Stop();
+        PostWinMessage ( MS_JIT_BUF_GET, MUL_COL_LED_RED );
+    }
+    else if ( bGetOk )
+    {
+        PostWinMessage ( MS_JIT_BUF_GET, MUL_COL_LED_GREEN );
     }
 
-    // set new parameter
-    eAudioCompressionType = eNAudCompressionType;
-    Init();
+    // the connection events which were detected by the audio callback
+    Channel.EmitPendingEvents();
+    P2PChannel.EmitPendingEvents();
 
-    if ( bWasRunning )
+    // update socket buffer size
+    Channel.UpdateSocketBufferSize();
+
+    if ( P2PChannel.IsEnabled() )
     {
-        Sound.Start();
+        P2PChannel.UpdateSocketBufferSize();
     }
 }
 
-void CClient::SetAudioQuality ( const EAudioQuality eNAudioQuality )
+void CClient::CutOverToServer ( const CHostAddress& NewAddr )
 {
-    // init with new parameter, if client was running then first
-    // stop it and restart again after new initialization
-    const bool bWasRunning = Sound.IsRunning();
+    // the small frame size requires a different sound card block size,
+    // otherwise the sound card keeps running and outputs silence while the
+    // connection to the new server is initialized
+    bool bSndCrdReinit = ( eAudioCompressionType == CT_OPUS64 );
+
+    if ( !bSndCrdReinit && !PauseAudioProcessing() )
+    {
+        // the audio callback did not acknowledge the pause in time and may
+        // still access the audio coding and the channel, therefore we have
+        // to stop the sound card instead
+        bSndCrdReinit = true;
+    }
+
+    if ( bSndCrdReinit )
+    {
+        Sound.Stop();
+
+        // a pause request must not survive the restart of the sound card
+        ResumeAudioProcessing();
+    }
+
+    // remember the converged jitter buffer sizes and the audio callback
+    // statistic of the current server
+    TimerProbe.stop();
+    StoreJitBufSizes();
+    LogAudioProcTimeStats();
+
+    // leave the current server (if the disconnect message gets lost, the
+    // time-out disconnects us anyway)
+    Channel.SetEnable ( false );
+    StopP2P();
+    ConnLessProtocol.CreateCLDisconnection ( Channel.GetAddress() );
+
+    Channel.SetAddress ( NewAddr );
+
+// #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
+// like on a new start, our first attempt is to use the old code
+eAudioCompressionType = CT_CELT;
+
+    // the channel, the jitter buffer and the audio coding are initialized for
+    // the new connection
+    InitJitBufSizes();
+
+    if ( bSndCrdReinit )
+    {
+        Init();
+    }
+    else
+    {
+        InitAudioCoding();
+    }
+
+    Channel.SetEnable ( true );
+    StartProbe();
+    ResetConnectionStats();
+
+    if ( bSndCrdReinit )
+    {
+        Sound.Start();
+    }
+    else
+    {
+        ResumeAudioProcessing();
+    }
+
+    // reset current signal level and LEDs of the old connection
+    SignalLevelMeter.Reset();
+    PostWinMessage ( MS_RESET_ALL, 0 );
+
+    emit ServerSwitched();
+}
+
+void CClient::SetSndCrdPrefFrameSizeFactor ( const int iNewFactor )
+{
+    // first check new input parameter
+    if ( ( iNewFactor == FRAME_SIZE_FACTOR_PREFERRED ) ||
+         ( iNewFactor == FRAME_SIZE_FACTOR_DEFAULT ) ||
+         ( iNewFactor == FRAME_SIZE_FACTOR_SAFE ) )
+    {
+        // init with new parameter, if client was running then first
+        // stop it and restart again after new initialization
+        const bool bWasRunning = Sound.IsRunning();
+        if ( bWasRunning )
+        {
+            Sound.Stop();
+        }
+
+        // set new parameter
+        iSndCrdPrefFrameSizeFactor = iNewFactor;
+
+        // init with new block size index parameter
+        Init();
+
+        if ( bWasRunning )
+        {
+            // restart client
+            Sound.Start();
+        }
+    }
+}
+
+// #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
+void CClient::OnOpusSupported()
+{
+    // do not fall back if the small frame size is already in use
+    if ( eAudioCompressionType == CT_CELT )
+    {
+        SetAudoCompressiontype ( CT_OPUS );
+    }
+
+    // inform the GUI about the change of the network rate
+    emit UpstreamRateChanged();
+}
+
+void CClient::OnOpus64Supported()
+{
+    // the server runs with the small frame size, use it, too (except if we
+    // already transmit uncompressed audio)
+    if ( ( eAudioCompressionType != CT_OPUS64 ) &&
+         ( eAudioCompressionType != CT_NONE ) )
+    {
+        SetAudoCompressiontype ( CT_OPUS64 );
+    }
+
+    // inform the GUI about the change of the network rate and frame size
+    emit UpstreamRateChanged();
+}
+
+void CClient::OnRawAudioSupported()
+{
+    // only use uncompressed audio if it is enabled in the settings
+    if ( bUseRawAudio && ( eAudioCompressionType != CT_NONE ) )
+    {
+        SetAudoCompressiontype ( CT_NONE );
+    }
+
+    // inform the GUI about the change of the network rate
+    emit UpstreamRateChanged();
+}
+
+// #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
+void CClient::SetAudoCompressiontype ( const EAudComprType eNAudCompressionType )
+{
+    // if the frame size does not change, the sound card keeps running and
+    // only the audio coding is initialized again (if the audio callback does
+    // not acknowledge the pause in time, the sound card is restarted)
+    const bool bWasRunning = Sound.IsRunning();
+
+    if ( bWasRunning &&
+         ( ( eNAudCompressionType == CT_OPUS64 ) ==
+           ( eAudioCompressionType == CT_OPUS64 ) ) &&
+         PauseAudioProcessing() )
+    {
+        eAudioCompressionType = eNAudCompressionType;
+        InitAudioCoding();
+
+        ResumeAudioProcessing();
+    }
+    else
+    {
+        // init with new parameter, if client was running then first
+        // stop it and restart again after new initialization
+        if ( bWasRunning )
+        {
+            Sound.Stop();
+        }
+
+        // a pause request of a timed out pause must not survive the restart
+        ResumeAudioProcessing();
+
+        // set new parameter
+        eAudioCompressionType = eNAudCompressionType;
+        Init();
+
+        if ( bWasRunning )
+        {
+            Sound.Start();
+        }
+    }
+}
+
+void CClient::SetAudioQuality ( const EAudioQuality eNAudioQuality )
+{
+    // init with new parameter, if client was running then first
+    // stop it and restart again after new initialization
+    const bool bWasRunning = Sound.IsRunning();
     if ( bWasRunning )
     {
         Sound.Stop();
@@ -618,23 +1330,98 @@ void CClient::Start()
 // our first attempt is always to use the old code
 eAudioCompressionType = CT_CELT;
 
+    // the start values of the auto jitter buffer sizes must be known before
+    // the jitter buffer is initialized
+    InitJitBufSizes();
+
     // init object
     Init();
 
     // enable channel
     Channel.SetEnable ( true );
 
+    // the network probe runs while the connection is established, its result
+    // is applied as soon as it is available
+    StartProbe();
+
+    // the send thread must run before the audio callback puts packets in the
+    // outgoing queue
+    SendThread.Start();
+
+    // hands over the state of the audio callback to the main thread
+    AtomicStoreRelease ( iJitBufGetOk, 0 );
+    AtomicStoreRelease ( iJitBufGetErr, 0 );
+    TimerChannelUpdate.start ( CHANNEL_UPDATE_INTERVAL_MS );
+
+    Sound.ResetNumXruns();
+    ResetConnectionStats();
+
     // start audio interface
+    AtomicStoreRelease ( iAudioProcState, AUDIO_PROC_RUNNING );
     Sound.Start();
 }
 
+void CClient::ResetConnectionStats()
+{
+    RttStats.Reset();
+
+    // the audio callback statistic covers one connection (the histograms are
+    // cleared by the audio thread)
+    AudioProcTimeStats.RequestReset();
+
+    // the real-time violations are counted for the new connection
+    AtomicStoreRelease ( iNumCallbackAllocs, 0 );
+    Channel.ResetNumLockContentions();
+    P2PChannel.ResetNumLockContentions();
+
+    // the latency marker is measured again for the new connection
+    iLatencyMarkerIntervalCnt = 0;
+    iLatencyMarkerCnt         = -1;
+    AtomicStoreRelease ( iLatencyMarkerDelaySam, -1 );
+}
+
+bool CClient::PauseAudioProcessing()
+{
+    AtomicStoreRelease ( iAudioProcState, AUDIO_PROC_PAUSE_REQUESTED );
+
+    // wait until the audio callback has finished its current block, after
+    // that it does not access the audio coding and the channel anymore (if
+    // the sound card does not call the callback, we do not wait forever)
+    QElapsedTimer WaitTimer;
+    WaitTimer.start();
+
+    while ( Sound.IsRunning() &&
+            ( AtomicLoadAcquire ( iAudioProcState ) != AUDIO_PROC_PAUSED ) &&
+            ( WaitTimer.elapsed() < AUDIO_PROC_PAUSE_TIME_OUT_MS ) )
+    {
+        CThreadSleep::MSleep ( 1 );
+    }
+
+    // on a time out the callback may still be processing audio
+    return !Sound.IsRunning() ||
+        ( AtomicLoadAcquire ( iAudioProcState ) == AUDIO_PROC_PAUSED );
+}
+
 void CClient::Stop()
 {
+    // a pending server switch is given up
+    TimerSwitchServer.stop();
+
+    // remember the converged jitter buffer sizes for the next connection to
+    // this server
+    TimerProbe.stop();
+    StoreJitBufSizes();
+
     // stop audio interface
     Sound.Stop();
+    SendThread.Stop();
+    TimerChannelUpdate.stop();
+
+    LogAudioProcTimeStats();
 
     // disable channel
     Channel.SetEnable ( false );
+    StopP2P();
 
     // wait for approx. 100 ms to make sure no audio packet is still in the
     // network queue causing the channel to be reconnected right after having
@@ -663,30 +1450,227 @@ void CClient::Stop()
     PostWinMessage ( MS_RESET_ALL, 0 );
 }
 
+void CClient::LogAudioProcTimeStats()
+{
+    // the statistic of the audio callback shows if audio dropouts were caused
+    // by the processing in the client or by the sound card, it is kept for the
+    // last connections so that it can be inspected in the analyzer console
+    // after the disconnect
+    QString strXruns;
+
+    if ( Sound.IsXrunCountAvailable() )
+    {
+        strXruns = QString().setNum ( Sound.GetNumXruns() );
+    }
+    else
+    {
+        strXruns = "not available";
+    }
+
+    QString strLogEntry =
+        QDateTime::currentDateTime().toString ( "yyyy-MM-dd hh:mm:ss" ) +
+        ", " + Channel.GetAddress().toString() + ": " +
+        QString().setNum ( AudioProcTimeStats.GetNumCallbacks() ) +
+        " callbacks, budget " +
+        QString().setNum ( AudioProcTimeStats.GetBudgetUs() ) +
+        " us, near budget: " +
+        QString().setNum ( AudioProcTimeStats.GetNumNearBudget() ) +
+        ", over budget: " +
+        QString().setNum ( AudioProcTimeStats.GetNumOverBudget() ) +
+        ", xruns: " + strXruns + ", dropped send packets: " +
+        QString().setNum ( GetNumDroppedSendPackets() ) +
+        ", lock contentions: " + QString().setNum ( GetNumLockContentions() ) +
+        ", allocations: " + QString().setNum ( GetNumCallbackAllocs() );
+
+    const char* strStageNames[APS_NUM_STAGES] =
+        { "reverb", "encode", "send", "decode", "total" };
+
+    for ( int i = 0; i < APS_NUM_STAGES; i++ )
+    {
+        const EAudioProcStage eStage = static_cast<EAudioProcStage> ( i );
+
+        strLogEntry += QString ( "\n  " ) + strStageNames[i] + ": max " +
+            QString().setNum ( AudioProcTimeStats.GetMaxTimeUs ( eStage ) ) +
+            " us, " + AudioProcTimeStats.GetHistogramText ( eStage );
+    }
+
+    strlstAudioProcTimeStatsLog.prepend ( strLogEntry );
+
+    while ( strlstAudioProcTimeStatsLog.size() > AUDIO_PROC_STATS_LOG_NUM_CONN )
+    {
+        strlstAudioProcTimeStatsLog.removeLast();
+    }
+}
+
+void CClient::InitJitBufSizes()
+{
+    // warm start: use the sizes of the last connection to this server
+    const QString strAddr = Channel.GetAddress().toString();
+
+    iInitSockBufNumFrames       = 0;
+    iInitServerSockBufNumFrames = 0;
+
+    for ( int iIdx = 0; iIdx < MAX_NUM_STORED_JIT_BUF_SIZES; iIdx++ )
+    {
+        if ( !vecStoredJitBufAddr[iIdx].compare ( strAddr ) )
+        {
+            iInitSockBufNumFrames       = vecStoredJitBufSizes[iIdx];
+            iInitServerSockBufNumFrames = vecStoredServerJitBufSizes[iIdx];
+        }
+    }
+
+    if ( iInitSockBufNumFrames > 0 )
+    {
+        Channel.SetSockBufInitAutoSetting ( iInitSockBufNumFrames );
+    }
+    else
+    {
+        Channel.SetSockBufInitAutoSetting ( DEF_AUTO_NET_BUF_SIZE_NUM_BL );
+    }
+}
+
+void CClient::StoreJitBufSizes()
+{
+    // only the sizes of the auto setting are of interest and only if the
+    // statistic had the chance to converge
+    if ( GetDoAutoSockBufSize() && Channel.IsConnected() &&
+         !Channel.GetAddress().IsLocalTransport() )
+    {
+        CVector<int> viOldStoredJitBufSizes       ( vecStoredJitBufSizes );
+        CVector<int> viOldStoredServerJitBufSizes ( vecStoredServerJitBufSizes );
+
+        // put the current server on the top of the list
+        const int iOldIdx =
+            vecStoredJitBufAddr.StringFiFoWithCompare ( Channel.GetAddress().toString() );
+
+        vecStoredJitBufSizes[0]       = GetSockBufNumFrames();
+        vecStoredServerJitBufSizes[0] = iServerSockBufNumFrames;
+
+        int iTempListCnt = 1;
+
+        for ( int iIdx = 0; iIdx < MAX_NUM_STORED_JIT_BUF_SIZES; iIdx++ )
+        {
+            // first check if we still have space in our data storage and skip
+            // the old index of the current entry
+            if ( ( iTempListCnt < MAX_NUM_STORED_JIT_BUF_SIZES ) &&
+                 ( iIdx != iOldIdx ) )
+            {
+                vecStoredJitBufSizes[iTempListCnt]       = viOldStoredJitBufSizes[iIdx];
+                vecStoredServerJitBufSizes[iTempListCnt] = viOldStoredServerJitBufSizes[iIdx];
+
+                iTempListCnt++;
+            }
+        }
+    }
+}
+
+void CClient::StartProbe()
+{
+    veciProbeRttMs.Reset ( -1 );
+    iProbeCnt        = 0;
+    iProbeNumReplies = 0;
+
+    // the probe is only needed for the auto setting and the jitter buffer of
+    // the local transport is fixed
+    if ( GetDoAutoSockBufSize() && !Channel.GetAddress().IsLocalTransport() )
+    {
+        TimerProbe.start ( PROBE_INTERVAL_MS );
+    }
+}
+
+void CClient::EvaluateProbe()
+{
+    TimerProbe.stop();
+
+    // collect the round trip times of the received probes (lost probes have
+    // no round trip time, they are not part of the quantile and only reduce
+    // the number of replies which must reach the minimum)
+    CVector<int> veciRttMs ( 0 );
+
+    for ( int i = 0; i < PROBE_NUM_PACKETS; i++ )
+    {
+        if ( veciProbeRttMs[i] >= 0 )
+        {
+            veciRttMs.Add ( veciProbeRttMs[i] );
+        }
+    }
+
+    if ( GetDoAutoSockBufSize() && ( veciRttMs.Size() >= PROBE_MIN_NUM_REPLIES ) )
+    {
+        std::sort ( veciRttMs.begin(), veciRttMs.end() );
+
+        // the spread of the round trip times is caused by the jitter of both
+        // directions, we assume that both directions have the same jitter
+        const int iQuantIdx = static_cast<int> (
+            ceil ( PROBE_RTT_QUANTILE * veciRttMs.Size() ) ) - 1;
+
+        const double dJitterMs = ( veciRttMs[iQuantIdx] - veciRttMs[0] ) / 2.0;
+
+        // the jitter buffer must cover the jitter, the blocks of one packet and
+        // one additional block for the timing of the sound card
+        const int iProbeNumFrames = static_cast<int> (
+            ceil ( dJitterMs / SYSTEM_BLOCK_DURATION_MS_FLOAT ) ) +
+            iSndCrdFrameSizeFactor + 1;
+
+        // a value of a previous connection to this server is only replaced
+        // by a larger one (the auto setting only increases the size in its
+        // initialization phase, too)
+        if ( iProbeNumFrames > iInitSockBufNumFrames )
+        {
+            iInitSockBufNumFrames = iProbeNumFrames;
+        }
+
+        if ( iProbeNumFrames > iInitServerSockBufNumFrames )
+        {
+            iInitServerSockBufNumFrames = iProbeNumFrames;
+        }
+
+        Channel.SetSockBufInitAutoSetting ( iInitSockBufNumFrames );
+
+        // if the connection is already established, the server must be
+        // informed now, otherwise this is done on the new connection
+        if ( Channel.IsConnected() )
+        {
+            CreateServerJitterBufferMessage();
+        }
+    }
+}
+
 void CClient::Init()
 {
+    // the frame size depends on the audio codec, all frame size factors are
+    // relative to this frame size
+    if ( eAudioCompressionType == CT_OPUS64 )
+    {
+        iFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES_SMALL;
+    }
+    else
+    {
+        iFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES;
+    }
+
     // check if possible frame size factors are supported
     const int iFraSizePreffered =
-        FRAME_SIZE_FACTOR_PREFERRED * SYSTEM_FRAME_SIZE_SAMPLES;
+        FRAME_SIZE_FACTOR_PREFERRED * iFrameSizeSamples;
 
     bFraSiFactPrefSupported =
         ( Sound.Init ( iFraSizePreffered ) == iFraSizePreffered );
 
     const int iFraSizeDefault =
-        FRAME_SIZE_FACTOR_DEFAULT * SYSTEM_FRAME_SIZE_SAMPLES;
+        FRAME_SIZE_FACTOR_DEFAULT * iFrameSizeSamples;
 
     bFraSiFactDefSupported =
         ( Sound.Init ( iFraSizeDefault ) == iFraSizeDefault );
 
     const int iFraSizeSafe =
-        FRAME_SIZE_FACTOR_SAFE * SYSTEM_FRAME_SIZE_SAMPLES;
+        FRAME_SIZE_FACTOR_SAFE * iFrameSizeSamples;
 
     bFraSiFactSafeSupported =
         ( Sound.Init ( iFraSizeSafe ) == iFraSizeSafe );
 
     // translate block size index in actual block size
     const int iPrefMonoFrameSize =
-        iSndCrdPrefFrameSizeFactor * SYSTEM_FRAME_SIZE_SAMPLES;
+        iSndCrdPrefFrameSizeFactor * iFrameSizeSamples;
 
     // get actual sound card buffer size using preferred size
     iMonoBlockSizeSam = Sound.Init ( iPrefMonoFrameSize );
@@ -694,12 +1678,12 @@ void CClient::Init()
     // Calculate the current sound card frame size factor. In case
     // the current mono block size is not a multiple of the system
     // frame size, we have to use a sound card conversion buffer.
-    if ( ( iMonoBlockSizeSam == ( SYSTEM_FRAME_SIZE_SAMPLES * FRAME_SIZE_FACTOR_PREFERRED ) ) ||
-         ( iMonoBlockSizeSam == ( SYSTEM_FRAME_SIZE_SAMPLES * FRAME_SIZE_FACTOR_DEFAULT ) ) ||
-         ( iMonoBlockSizeSam == ( SYSTEM_FRAME_SIZE_SAMPLES * FRAME_SIZE_FACTOR_SAFE ) ) )
+    if ( ( iMonoBlockSizeSam == ( iFrameSizeSamples * FRAME_SIZE_FACTOR_PREFERRED ) ) ||
+         ( iMonoBlockSizeSam == ( iFrameSizeSamples * FRAME_SIZE_FACTOR_DEFAULT ) ) ||
+         ( iMonoBlockSizeSam == ( iFrameSizeSamples * FRAME_SIZE_FACTOR_SAFE ) ) )
     {
         // regular case: one of our predefined buffer sizes is available
-        iSndCrdFrameSizeFactor = iMonoBlockSizeSam / SYSTEM_FRAME_SIZE_SAMPLES;
+        iSndCrdFrameSizeFactor = iMonoBlockSizeSam / iFrameSizeSamples;
 
         // no sound card conversion buffer required
         bSndCrdConversionBufferRequired  = false;
@@ -717,7 +1701,7 @@ void CClient::Init()
         // overwrite block size by smallest supported buffer size
         iSndCrdFrameSizeFactor = FRAME_SIZE_FACTOR_PREFERRED;
         iMonoBlockSizeSam =
-            SYSTEM_FRAME_SIZE_SAMPLES * FRAME_SIZE_FACTOR_PREFERRED;
+            iFrameSizeSamples * FRAME_SIZE_FACTOR_PREFERRED;
 
         iStereoBlockSizeSam = 2 * iMonoBlockSizeSam;
 
@@ -730,11 +1714,23 @@ void CClient::Init()
         SndCrdConversionBufferOut.Init ( iConBufSize );
         vecDataConvBuf.Init            ( iStereoBlockSizeSam );
 
-        // the output conversion buffer must be filled with the inner
-        // block size for initialization (this is the latency which is
-        // introduced by the conversion buffer) to avoid buffer underruns
-        const CVector<int16_t> vZeros ( iStereoBlockSizeSam, 0 );
-        SndCrdConversionBufferOut.Put ( vZeros, vZeros.Size() );
+        // The inner blocks are processed as soon as the input conversion
+        // buffer has enough data. The samples which are left in the input
+        // buffer after a sound card block are missing in the output buffer,
+        // therefore the output conversion buffer must be pre-filled with the
+        // maximum number of left samples to avoid buffer underruns. This
+        // number is a multiple of the greatest common divisor of both block
+        // sizes and at most the inner block size minus the divisor. The
+        // pre-fill is the exact latency introduced by the conversion buffer.
+        iSndCrdConvBufDelayMonoSam = iMonoBlockSizeSam -
+            MathUtils::GreatestCommonDivisor ( iSndCardMonoBlockSizeSamConvBuff,
+                                               iMonoBlockSizeSam );
+
+        if ( iSndCrdConvBufDelayMonoSam > 0 )
+        {
+            const CVector<int16_t> vZeros ( 2 * iSndCrdConvBufDelayMonoSam, 0 );
+            SndCrdConversionBufferOut.Put ( vZeros, vZeros.Size() );
+        }
 
         bSndCrdConversionBufferRequired = true;
     }
@@ -743,14 +1739,53 @@ void CClient::Init()
     iStereoBlockSizeSam = 2 * iMonoBlockSizeSam;
 
     vecsAudioSndCrdMono.Init ( iMonoBlockSizeSam );
-    vecdAudioStereo.Init     ( iStereoBlockSizeSam );
+    vecfAudioSndCrdMono.Init ( iMonoBlockSizeSam );
+    vecsFloatConvBuf.Init    ( 2 * GetSndCrdActualMonoBlSize() );
+
+    // the received signal of the last block is kept so that a latency marker
+    // which is split between two blocks can be detected
+    vecfLatencyMarkerHist.Init ( LATENCY_MARKER_LEN_SAMPLES - 1 + iMonoBlockSizeSam, 0 );
+
+    // the processing of one sound card block must be finished within the
+    // duration of the block
+    AudioProcTimeStats.SetBudget ( GetSndCrdActualMonoBlSize(),
+                                   SYSTEM_SAMPLE_RATE_HZ );
+
+    InitAudioCoding();
+}
+
+void CClient::InitAudioCoding()
+{
+    // init clock drift compensation
+    if ( bUseStereo )
+    {
+        DriftResampler.Init ( 2, iFrameSizeSamples );
+        vecsDriftFrame.Init ( 2 * iFrameSizeSamples );
+    }
+    else
+    {
+        DriftResampler.Init ( 1, iFrameSizeSamples );
+        vecsDriftFrame.Init ( iFrameSizeSamples );
+    }
 
     // init reverberation
     AudioReverbL.Init ( SYSTEM_SAMPLE_RATE_HZ );
     AudioReverbR.Init ( SYSTEM_SAMPLE_RATE_HZ );
 
     // inits for audio coding
-    if ( eAudioCompressionType == CT_CELT )
+    if ( eAudioCompressionType == CT_NONE )
+    {
+        // uncompressed audio with 16 bit per sample
+        if ( bUseStereo )
+        {
+            iCeltNumCodedBytes = 4 * iFrameSizeSamples;
+        }
+        else
+        {
+            iCeltNumCodedBytes = 2 * iFrameSizeSamples;
+        }
+    }
+    else if ( eAudioCompressionType == CT_CELT )
     {
         if ( bUseStereo )
         {
@@ -775,6 +1810,43 @@ void CClient::Init()
             }
         }
     }
+    else if ( eAudioCompressionType == CT_OPUS64 )
+    {
+        if ( bUseStereo )
+        {
+            switch ( eAudioQuality )
+            {
+            case AQ_LOW:
+                iCeltNumCodedBytes = OPUS64_NUM_BYTES_STEREO_LOW_QUALITY;
+                break;
+
+            case AQ_NORMAL:
+                iCeltNumCodedBytes = OPUS64_NUM_BYTES_STEREO_NORMAL_QUALITY;
+                break;
+
+            case AQ_HIGH:
+                iCeltNumCodedBytes = OPUS64_NUM_BYTES_STEREO_HIGH_QUALITY;
+                break;
+            }
+        }
+        else
+        {
+            switch ( eAudioQuality )
+            {
+            case AQ_LOW:
+                iCeltNumCodedBytes = OPUS64_NUM_BYTES_MONO_LOW_QUALITY;
+                break;
+
+            case AQ_NORMAL:
+                iCeltNumCodedBytes = OPUS64_NUM_BYTES_MONO_NORMAL_QUALITY;
+                break;
+
+            case AQ_HIGH:
+                iCeltNumCodedBytes = OPUS64_NUM_BYTES_MONO_HIGH_QUALITY;
+                break;
+            }
+        }
+    }
     else
     {
         if ( bUseStereo )
@@ -814,26 +1886,51 @@ void CClient::Init()
     }
     vecCeltData.Init ( iCeltNumCodedBytes );
 
+    // select the OPUS encoder/decoder which matches the frame size
     if ( bUseStereo )
     {
-        opus_custom_encoder_ctl ( OpusEncoderStereo,
-                                  OPUS_SET_BITRATE (
-                                      CalcBitRateBitsPerSecFromCodedBytes (
-                                          iCeltNumCodedBytes ) ) );
+        if ( eAudioCompressionType == CT_OPUS64 )
+        {
+            CurOpusEncoder = Opus64EncoderStereo;
+            CurOpusDecoder = Opus64DecoderStereo;
+        }
+        else
+        {
+            CurOpusEncoder = OpusEncoderStereo;
+            CurOpusDecoder = OpusDecoderStereo;
+        }
     }
     else
     {
-        opus_custom_encoder_ctl ( OpusEncoderMono,
-                                  OPUS_SET_BITRATE (
-                                      CalcBitRateBitsPerSecFromCodedBytes (
-                                          iCeltNumCodedBytes ) ) );
+        if ( eAudioCompressionType == CT_OPUS64 )
+        {
+            CurOpusEncoder = Opus64EncoderMono;
+            CurOpusDecoder = Opus64DecoderMono;
+        }
+        else
+        {
+            CurOpusEncoder = OpusEncoderMono;
+            CurOpusDecoder = OpusDecoderMono;
+        }
     }
 
-    // inits for network and channel
+    opus_custom_encoder_ctl ( CurOpusEncoder,
+                              OPUS_SET_BITRATE (
+                                  CalcBitRateBitsPerSecFromCodedBytes (
+                                      iCeltNumCodedBytes, iFrameSizeSamples ) ) );
+
+    // inits for network and channel (the buffers of the forwarded bundles and
+    // of the peer frames are resized in the audio callback, with the reserved
+    // memory this does not allocate)
+    vecbyNetwData.reserve ( MAX_SIZE_BYTES_NETW_BUF );
     vecbyNetwData.Init ( iCeltNumCodedBytes );
+    vecbyP2PNetwData.reserve ( MAX_SIZE_BYTES_NETW_BUF );
+    vecbyP2PNetwData.Init ( 0 );
     if ( bUseStereo )
     {
         vecsNetwork.Init ( iStereoBlockSizeSam );
+        vecfNetwork.Init ( iStereoBlockSizeSam );
+        vecsPlayoutFrame.Init ( 2 * iFrameSizeSamples );
 
         // set the channel network properties
         Channel.SetAudioStreamProperties ( eAudioCompressionType,
@@ -844,6 +1941,8 @@ void CClient::Init()
     else
     {
         vecsNetwork.Init ( iMonoBlockSizeSam );
+        vecfNetwork.Init ( iMonoBlockSizeSam );
+        vecsPlayoutFrame.Init ( iFrameSizeSamples );
 
         // set the channel network properties
         Channel.SetAudioStreamProperties ( eAudioCompressionType,
@@ -852,6 +1951,25 @@ void CClient::Init()
                                            1 );
     }
 
+    // in peer-to-peer mode the peer must know the new properties, too
+    if ( P2PChannel.IsEnabled() )
+    {
+        P2PChannel.CreateNetwTranspPropsMes (
+            Channel.GetNetworkTransportPropsFromCurrentSettings() );
+    }
+
+    // the outgoing queue must not contain packets with the previous settings
+    // (the queue can only be cleared while the send thread is stopped)
+    const bool bSendThreadWasRunning = SendThread.isRunning();
+
+    SendThread.Stop();
+    SendQueue.Reset();
+
+    if ( bSendThreadWasRunning )
+    {
+        SendThread.Start();
+    }
+
     // reset initialization phase flag
     bIsInitializationPhase = true;
 }
@@ -867,8 +1985,24 @@ void CClient::AudioCallback ( CVector<int16_t>& psData, void* arg )
 
 void CClient::ProcessSndCrdAudioData ( CVector<int16_t>& vecsStereoSndCrd )
 {
+    const qint64 iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
+    const int iCurAudioProcState = AtomicLoadAcquire ( iAudioProcState );
+
+    if ( iCurAudioProcState != AUDIO_PROC_RUNNING )
+    {
+        // the audio processing is paused, output silence and acknowledge the
+        // pause request (only if the processing was not resumed meanwhile)
+        if ( iCurAudioProcState == AUDIO_PROC_PAUSE_REQUESTED )
+        {
+            iAudioProcState.testAndSetOrdered ( AUDIO_PROC_PAUSE_REQUESTED,
+                                                AUDIO_PROC_PAUSED );
+        }
+
+        vecsStereoSndCrd.Reset ( 0 );
+    }
     // check if a conversion buffer is required or not
-    if ( bSndCrdConversionBufferRequired )
+    else if ( bSndCrdConversionBufferRequired )
     {
         // add new sound card block in conversion buffer
         SndCrdConversionBufferIn.Put ( vecsStereoSndCrd, vecsStereoSndCrd.Size() );
@@ -894,25 +2028,89 @@ void CClient::ProcessSndCrdAudioData ( CVector<int16_t>& vecsStereoSndCrd )
         // process audio data
         ProcessAudioDataIntern ( vecsStereoSndCrd );
     }
+
+    AudioProcTimeStats.Update ( APS_TOTAL,
+        AudioProcTimer.nsecsElapsed() - iStartTimeNs );
 }
 
-void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
+void CClient::AudioCallbackFloat ( CVector<float>& pfData, void* arg )
 {
-    int i, j;
+    // get the pointer to the object
+    CClient* pMyClientObj = reinterpret_cast<CClient*> ( arg );
 
-    // Transmit signal ---------------------------------------------------------
-    // update stereo signal level meter
-    SignalLevelMeter.Update ( vecsStereoSndCrd );
+    // process audio data
+    pMyClientObj->ProcessSndCrdAudioDataFloat ( pfData );
+}
+
+void CClient::ProcessSndCrdAudioDataFloat ( CVector<float>& vecfStereoSndCrd )
+{
+    int i;
+
+    // The floating point samples are only processed directly if the OPUS
+    // codec (which has a floating point interface) is used and none of the
+    // processing is active which works on 16 bit samples (reverberation and
+    // pan are available in floating point). Otherwise the samples are
+    // converted and the regular 16 bit processing is used.
+    const bool bUseFloatPath =
+        ( AtomicLoadAcquire ( iAudioProcState ) == AUDIO_PROC_RUNNING ) &&
+        ( ( eAudioCompressionType == CT_OPUS ) ||
+          ( eAudioCompressionType == CT_OPUS64 ) ) &&
+        ( vecfStereoSndCrd.Size() == iStereoBlockSizeSam ) &&
+        !bSndCrdConversionBufferRequired &&
+        !bLatencyMarker &&
+        !bUseAdaptivePlayout &&
+        !bUseDriftCompensation &&
+        !Channel.IsForwarding() &&
+        !P2PChannel.IsEnabled();
+
+    if ( bUseFloatPath )
+    {
+        const qint64 iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
+        ProcessAudioDataInternFloat ( vecfStereoSndCrd );
 
-    // convert data from short to double
-    for ( i = 0; i < iStereoBlockSizeSam; i++ )
+        AudioProcTimeStats.Update ( APS_TOTAL,
+            AudioProcTimer.nsecsElapsed() - iStartTimeNs );
+    }
+    else
     {
-        vecdAudioStereo[i] = static_cast<double> ( vecsStereoSndCrd[i] );
+        // the sound card block size only changes on a re-initialization
+        if ( vecsFloatConvBuf.Size() != vecfStereoSndCrd.Size() )
+        {
+            InitCallbackBuffer ( vecsFloatConvBuf, vecfStereoSndCrd.Size() );
+        }
+
+        for ( i = 0; i < vecfStereoSndCrd.Size(); i++ )
+        {
+            vecsFloatConvBuf[i] =
+                Double2Short ( static_cast<double> ( vecfStereoSndCrd[i] ) * _MAXSHORT );
+        }
+
+        ProcessSndCrdAudioData ( vecsFloatConvBuf );
+
+        for ( i = 0; i < vecfStereoSndCrd.Size(); i++ )
+        {
+            vecfStereoSndCrd[i] =
+                static_cast<float> ( vecsFloatConvBuf[i] ) / _MAXSHORT;
+        }
     }
+}
+
+void CClient::ProcessAudioDataInternFloat ( CVector<float>& vecfStereoSndCrd )
+{
+    int    i, j;
+    qint64 iStartTimeNs;
 
-    // add reverberation effect if activated
+    // Transmit signal ---------------------------------------------------------
+    // update stereo signal level meter
+    SignalLevelMeter.Update ( vecfStereoSndCrd );
+
+    // add reverberation effect if activated (same processing as for the 16
+    // bit samples)
     if ( iReverbLevel != 0 )
     {
+        iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
         // calculate attenuation amplification factor
         const double dRevLev =
             static_cast<double> ( iReverbLevel ) / AUD_REVERB_MAX / 2;
@@ -920,60 +2118,275 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
         if ( bUseStereo )
         {
             // for stereo always apply reverberation effect on both channels
-            for ( i = 0; i < iStereoBlockSizeSam; i += 2 )
+            AudioReverbL.Process ( vecfStereoSndCrd, iStereoBlockSizeSam, 0, dRevLev );
+            AudioReverbR.Process ( vecfStereoSndCrd, iStereoBlockSizeSam, 1, dRevLev );
+        }
+        else
+        {
+            if ( bReverbOnLeftChan )
+            {
+                AudioReverbL.Process ( vecfStereoSndCrd, iStereoBlockSizeSam, 0, dRevLev );
+            }
+            else
+            {
+                AudioReverbR.Process ( vecfStereoSndCrd, iStereoBlockSizeSam, 1, dRevLev );
+            }
+        }
+
+        AudioProcTimeStats.Update ( APS_REVERB,
+            AudioProcTimer.nsecsElapsed() - iStartTimeNs );
+    }
+
+    // mix both signals depending on the fading setting
+    if ( iAudioInFader == AUD_FADER_IN_MIDDLE )
+    {
+        if ( bUseStereo )
+        {
+            // no processing required, simply copy the samples
+            memcpy ( &vecfNetwork[0], &vecfStereoSndCrd[0],
+                     iStereoBlockSizeSam * sizeof ( float ) );
+        }
+        else
+        {
+            for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
+            {
+                vecfNetwork[i] =
+                    ( vecfStereoSndCrd[j] + vecfStereoSndCrd[j + 1] ) / 2;
+            }
+        }
+    }
+    else
+    {
+        if ( bUseStereo )
+        {
+            // stereo
+            const float fAttFactStereo = static_cast<float> (
+                AUD_FADER_IN_MIDDLE - abs ( AUD_FADER_IN_MIDDLE - iAudioInFader ) ) /
+                AUD_FADER_IN_MIDDLE;
+
+            if ( iAudioInFader > AUD_FADER_IN_MIDDLE )
+            {
+                for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
+                {
+                    // attenuation on right channel
+                    vecfNetwork[j]     = vecfStereoSndCrd[j];
+                    vecfNetwork[j + 1] = fAttFactStereo * vecfStereoSndCrd[j + 1];
+                }
+            }
+            else
             {
-                // left channel
-                vecdAudioStereo[i] +=
-                    dRevLev * AudioReverbL.ProcessSample ( vecdAudioStereo[i] );
+                for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
+                {
+                    // attenuation on left channel
+                    vecfNetwork[j]     = fAttFactStereo * vecfStereoSndCrd[j];
+                    vecfNetwork[j + 1] = vecfStereoSndCrd[j + 1];
+                }
+            }
+        }
+        else
+        {
+            // mono (same amplification factors as for the 16 bit samples)
+            const float fAttFactMono = static_cast<float> (
+                AUD_FADER_IN_MIDDLE - abs ( AUD_FADER_IN_MIDDLE - iAudioInFader ) ) /
+                AUD_FADER_IN_MIDDLE / 2;
+
+            const float fAmplFactMono = 0.5f + static_cast<float> (
+                abs ( AUD_FADER_IN_MIDDLE - iAudioInFader ) ) /
+                AUD_FADER_IN_MIDDLE / 2;
 
-                // right channel
-                vecdAudioStereo[i + 1] +=
-                    dRevLev * AudioReverbR.ProcessSample ( vecdAudioStereo[i + 1] );
+            if ( iAudioInFader > AUD_FADER_IN_MIDDLE )
+            {
+                for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
+                {
+                    // attenuation on right channel
+                    vecfNetwork[i] = fAmplFactMono * vecfStereoSndCrd[j] +
+                                     fAttFactMono * vecfStereoSndCrd[j + 1];
+                }
+            }
+            else
+            {
+                for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
+                {
+                    // attenuation on left channel
+                    vecfNetwork[i] = fAmplFactMono * vecfStereoSndCrd[j + 1] +
+                                     fAttFactMono * vecfStereoSndCrd[j];
+                }
             }
         }
+    }
+
+    const int iNumAudChan   = bUseStereo ? 2 : 1;
+    qint64    iEncodeTimeNs = 0;
+    qint64    iSendTimeNs   = 0;
+
+    for ( i = 0; i < iSndCrdFrameSizeFactor; i++ )
+    {
+        iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
+        // encode current audio frame
+        opus_custom_encode_float ( CurOpusEncoder,
+                                   &vecfNetwork[i * iNumAudChan * iFrameSizeSamples],
+                                   iFrameSizeSamples,
+                                   &vecCeltData[0],
+                                   iCeltNumCodedBytes );
+
+        const qint64 iEncodedTimeNs = AudioProcTimer.nsecsElapsed();
+
+        // put the coded audio in the outgoing queue, it is sent through the
+        // network by the network send thread (if the queue is full, the
+        // packet is dropped and counted)
+        SendQueue.Put ( &vecCeltData[0], vecCeltData.Size() );
+
+        iEncodeTimeNs += iEncodedTimeNs - iStartTimeNs;
+        iSendTimeNs   += AudioProcTimer.nsecsElapsed() - iEncodedTimeNs;
+    }
+
+    AudioProcTimeStats.Update ( APS_ENCODE, iEncodeTimeNs );
+    AudioProcTimeStats.Update ( APS_SEND,   iSendTimeNs );
+
+
+    // Receive signal ----------------------------------------------------------
+    iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
+    for ( i = 0; i < iSndCrdFrameSizeFactor; i++ )
+    {
+        float* pfFrame;
+
+        if ( bUseStereo )
+        {
+            pfFrame = &vecfStereoSndCrd[i * 2 * iFrameSizeSamples];
+        }
         else
         {
-            if ( bReverbOnLeftChan )
+            pfFrame = &vecfAudioSndCrdMono[i * iFrameSizeSamples];
+        }
+
+        // decode the frame (a NULL pointer as coded data tells the decoder to
+        // conceal the frame in case of a lost packet)
+        const unsigned char* pCodedData = NULL;
+
+        if ( GetNetwFrame() )
+        {
+            pCodedData = &vecbyNetwData[0];
+        }
+
+        opus_custom_decode_float ( CurOpusDecoder,
+                                   pCodedData,
+                                   iCeltNumCodedBytes,
+                                   pfFrame,
+                                   iFrameSizeSamples );
+    }
+
+    AudioProcTimeStats.Update ( APS_DECODE,
+        AudioProcTimer.nsecsElapsed() - iStartTimeNs );
+
+    // check if channel is connected and if we do not have the initialization
+    // phase
+    if ( Channel.IsConnected() && ( !bIsInitializationPhase ) )
+    {
+        if ( !bUseStereo )
+        {
+            // copy mono data in stereo sound card buffer
+            for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
+            {
+                vecfStereoSndCrd[j] = vecfStereoSndCrd[j + 1] =
+                    vecfAudioSndCrdMono[i];
+            }
+        }
+
+        // local monitoring: add our own signal as it is sent to the server
+        // (the server does not send it back in that case)
+        if ( iMonitorLevel != 0 )
+        {
+            const float fMonLev =
+                static_cast<float> ( iMonitorLevel ) / AUD_MONITOR_MAX;
+
+            if ( bUseStereo )
             {
-                for ( i = 0; i < iStereoBlockSizeSam; i += 2 )
+                for ( i = 0; i < iStereoBlockSizeSam; i++ )
                 {
-                    // left channel
-                    vecdAudioStereo[i] +=
-                        dRevLev * AudioReverbL.ProcessSample ( vecdAudioStereo[i] );
+                    vecfStereoSndCrd[i] += fMonLev * vecfNetwork[i];
                 }
             }
             else
             {
-                for ( i = 1; i < iStereoBlockSizeSam; i += 2 )
+                for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
                 {
-                    // right channel
-                    vecdAudioStereo[i] +=
-                        dRevLev * AudioReverbR.ProcessSample ( vecdAudioStereo[i] );
+                    const float fMonSample = fMonLev * vecfNetwork[i];
+
+                    vecfStereoSndCrd[j]     += fMonSample;
+                    vecfStereoSndCrd[j + 1] += fMonSample;
                 }
             }
         }
     }
+    else
+    {
+        // if not connected, clear data
+        vecfStereoSndCrd.Reset ( 0 );
+    }
+}
 
-    // mix both signals depending on the fading setting, convert
-    // from double to short
-    if ( iAudioInFader == AUD_FADER_IN_MIDDLE )
+void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
+{
+    int    i, j;
+    qint64 iStartTimeNs;
+
+    // Transmit signal ---------------------------------------------------------
+    // update stereo signal level meter
+    SignalLevelMeter.Update ( vecsStereoSndCrd );
+
+    // add reverberation effect if activated (the effect is applied directly
+    // on the sound card samples, therefore no conversion of the complete
+    // block to floating point and back is required)
+    if ( iReverbLevel != 0 )
     {
+        iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
+        // calculate attenuation amplification factor
+        const double dRevLev =
+            static_cast<double> ( iReverbLevel ) / AUD_REVERB_MAX / 2;
+
         if ( bUseStereo )
         {
-            // perform type conversion
-            for ( i = 0; i < iStereoBlockSizeSam; i++ )
+            // for stereo always apply reverberation effect on both channels
+            AudioReverbL.Process ( vecsStereoSndCrd, iStereoBlockSizeSam, 0, dRevLev );
+            AudioReverbR.Process ( vecsStereoSndCrd, iStereoBlockSizeSam, 1, dRevLev );
+        }
+        else
+        {
+            if ( bReverbOnLeftChan )
+            {
+                AudioReverbL.Process ( vecsStereoSndCrd, iStereoBlockSizeSam, 0, dRevLev );
+            }
+            else
             {
-                vecsNetwork[i] = Double2Short ( vecdAudioStereo[i] );
+                AudioReverbR.Process ( vecsStereoSndCrd, iStereoBlockSizeSam, 1, dRevLev );
             }
         }
+
+        AudioProcTimeStats.Update ( APS_REVERB,
+            AudioProcTimer.nsecsElapsed() - iStartTimeNs );
+    }
+
+    // mix both signals depending on the fading setting
+    if ( iAudioInFader == AUD_FADER_IN_MIDDLE )
+    {
+        if ( bUseStereo )
+        {
+            // no processing required, simply copy the samples
+            memcpy ( &vecsNetwork[0], &vecsStereoSndCrd[0],
+                     iStereoBlockSizeSam * sizeof ( int16_t ) );
+        }
         else
         {
-            // mix channels together
+            // mix channels together (the sum of two samples cannot overflow
+            // the integer range)
             for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
             {
-                vecsNetwork[i] =
-                    Double2Short ( ( vecdAudioStereo[j] +
-                    vecdAudioStereo[j + 1] ) / 2 );
+                vecsNetwork[i] = static_cast<int16_t> (
+                    ( static_cast<int> ( vecsStereoSndCrd[j] ) +
+                      vecsStereoSndCrd[j + 1] ) / 2 );
             }
         }
     }
@@ -991,11 +2404,10 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
                 for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
                 {
                     // attenuation on right channel
-                    vecsNetwork[j] = Double2Short (
-                        vecdAudioStereo[j] );
+                    vecsNetwork[j] = vecsStereoSndCrd[j];
 
                     vecsNetwork[j + 1] = Double2Short (
-                        dAttFactStereo * vecdAudioStereo[j + 1] );
+                        dAttFactStereo * vecsStereoSndCrd[j + 1] );
                 }
             }
             else
@@ -1004,10 +2416,9 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
                 {
                     // attenuation on left channel
                     vecsNetwork[j] = Double2Short (
-                        dAttFactStereo * vecdAudioStereo[j] );
+                        dAttFactStereo * vecsStereoSndCrd[j] );
 
-                    vecsNetwork[j + 1] = Double2Short (
-                        vecdAudioStereo[j + 1] );
+                    vecsNetwork[j + 1] = vecsStereoSndCrd[j + 1];
                 }
             }
         }
@@ -1031,8 +2442,8 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
                 {
                     // attenuation on right channel
                     vecsNetwork[i] = Double2Short (
-                        dAmplFactMono * vecdAudioStereo[j] +
-                        dAttFactMono * vecdAudioStereo[j + 1] );
+                        dAmplFactMono * vecsStereoSndCrd[j] +
+                        dAttFactMono * vecsStereoSndCrd[j + 1] );
                 }
             }
             else
@@ -1041,31 +2452,49 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
                 {
                     // attenuation on left channel
                     vecsNetwork[i] = Double2Short (
-                        dAmplFactMono * vecdAudioStereo[j + 1] +
-                        dAttFactMono * vecdAudioStereo[j] );
+                        dAmplFactMono * vecsStereoSndCrd[j + 1] +
+                        dAttFactMono * vecsStereoSndCrd[j] );
                 }
             }
         }
     }
 
+    // the latency marker is injected after all processing of the transmitted
+    // signal so that it is not changed locally
+    if ( bLatencyMarker )
+    {
+        InjectLatencyMarker();
+    }
+
+    qint64 iEncodeTimeNs = 0;
+    qint64 iSendTimeNs   = 0;
+
     for ( i = 0; i < iSndCrdFrameSizeFactor; i++ )
     {
+        iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
         if ( bUseStereo )
         {
             // encode current audio frame
-            if ( eAudioCompressionType == CT_CELT )
+            if ( eAudioCompressionType == CT_NONE )
+            {
+                PackRawAudio ( &vecsNetwork[i * 2 * iFrameSizeSamples],
+                               2 * iFrameSizeSamples,
+                               &vecCeltData[0] );
+            }
+            else if ( eAudioCompressionType == CT_CELT )
             {
                 cc6_celt_encode ( CeltEncoderStereo,
-                                  &vecsNetwork[i * 2 * SYSTEM_FRAME_SIZE_SAMPLES],
+                                  &vecsNetwork[i * 2 * iFrameSizeSamples],
                                   NULL,
                                   &vecCeltData[0],
                                   iCeltNumCodedBytes );
             }
             else
             {
-                opus_custom_encode ( OpusEncoderStereo,
-                                     &vecsNetwork[i * 2 * SYSTEM_FRAME_SIZE_SAMPLES],
-                                     SYSTEM_FRAME_SIZE_SAMPLES,
+                opus_custom_encode ( CurOpusEncoder,
+                                     &vecsNetwork[i * 2 * iFrameSizeSamples],
+                                     iFrameSizeSamples,
                                      &vecCeltData[0],
                                      iCeltNumCodedBytes );
             }
@@ -1073,132 +2502,98 @@ void CClient::ProcessAudioDataIntern ( CVector<int16_t>& vecsStereoSndCrd )
         else
         {
             // encode current audio frame
-            if ( eAudioCompressionType == CT_CELT )
+            if ( eAudioCompressionType == CT_NONE )
+            {
+                PackRawAudio ( &vecsNetwork[i * iFrameSizeSamples],
+                               iFrameSizeSamples,
+                               &vecCeltData[0] );
+            }
+            else if ( eAudioCompressionType == CT_CELT )
             {
                 cc6_celt_encode ( CeltEncoderMono,
-                                  &vecsNetwork[i * SYSTEM_FRAME_SIZE_SAMPLES],
+                                  &vecsNetwork[i * iFrameSizeSamples],
                                   NULL,
                                   &vecCeltData[0],
                                   iCeltNumCodedBytes );
             }
             else
             {
-                opus_custom_encode ( OpusEncoderMono,
-                                     &vecsNetwork[i * SYSTEM_FRAME_SIZE_SAMPLES],
-                                     SYSTEM_FRAME_SIZE_SAMPLES,
+                opus_custom_encode ( CurOpusEncoder,
+                                     &vecsNetwork[i * iFrameSizeSamples],
+                                     iFrameSizeSamples,
                                      &vecCeltData[0],
                                      iCeltNumCodedBytes );
             }
         }
 
-        // send coded audio through the network
-        Socket.SendPacket ( Channel.PrepSendPacket ( vecCeltData ),
-            Channel.GetAddress() );
+        const qint64 iEncodedTimeNs = AudioProcTimer.nsecsElapsed();
+
+        // put the coded audio in the outgoing queue, it is sent through the
+        // network by the network send thread (if the queue is full, the
+        // packet is dropped and counted)
+        SendQueue.Put ( &vecCeltData[0], vecCeltData.Size() );
+
+        iEncodeTimeNs += iEncodedTimeNs - iStartTimeNs;
+        iSendTimeNs   += AudioProcTimer.nsecsElapsed() - iEncodedTimeNs;
     }
 
+    AudioProcTimeStats.Update ( APS_ENCODE, iEncodeTimeNs );
+    AudioProcTimeStats.Update ( APS_SEND,   iSendTimeNs );
+
 
     // Receive signal ----------------------------------------------------------
+    iStartTimeNs = AudioProcTimer.nsecsElapsed();
+
     for ( i = 0; i < iSndCrdFrameSizeFactor; i++ )
     {
-        // receive a new block
-        const bool bReceiveDataOk =
-            ( Channel.GetData ( vecbyNetwData ) == GS_BUFFER_OK );
-
-        if ( bReceiveDataOk )
+        // in forwarding mode the jitter buffer stores bundles of all streams
+        if ( Channel.IsForwarding() )
         {
-            PostWinMessage ( MS_JIT_BUF_GET, MUL_COL_LED_GREEN );
-        }
-        else
-        {
-            PostWinMessage ( MS_JIT_BUF_GET, MUL_COL_LED_RED );
-        }
+            if ( vecbyNetwData.Size() != FORWARD_BUNDLE_BLOCK_SIZE )
+            {
+                InitCallbackBuffer ( vecbyNetwData, FORWARD_BUNDLE_BLOCK_SIZE );
+            }
+
+            // the adaptive playout is not used for bundles
+            bPlayoutInsertFrame = false;
 
-        // CELT decoding
-        if ( bReceiveDataOk )
+            // decode and mix the streams of all channels locally
+            MixForwardedStreams ( vecsStereoSndCrd, GetNetwFrame(), i );
+        }
+        else
         {
-            // on any valid received packet, we clear the initialization phase
-            // flag
-            bIsInitializationPhase = false;
+            int16_t* psFrame;
 
             if ( bUseStereo )
             {
-                if ( eAudioCompressionType == CT_CELT )
-                {
-                    cc6_celt_decode ( CeltDecoderStereo,
-                                      &vecbyNetwData[0],
-                                      iCeltNumCodedBytes,
-                                      &vecsStereoSndCrd[i * 2 * SYSTEM_FRAME_SIZE_SAMPLES] );
-                }
-                else
-                {
-                    opus_custom_decode ( OpusDecoderStereo,
-                                         &vecbyNetwData[0],
-                                         iCeltNumCodedBytes,
-                                         &vecsStereoSndCrd[i * 2 * SYSTEM_FRAME_SIZE_SAMPLES],
-                                         SYSTEM_FRAME_SIZE_SAMPLES );
-                }
+                psFrame = &vecsStereoSndCrd[i * 2 * iFrameSizeSamples];
             }
             else
             {
-                if ( eAudioCompressionType == CT_CELT )
-                {
-                    cc6_celt_decode ( CeltDecoderMono,
-                                      &vecbyNetwData[0],
-                                      iCeltNumCodedBytes,
-                                      &vecsAudioSndCrdMono[i * SYSTEM_FRAME_SIZE_SAMPLES] );
-                }
-                else
-                {
-                    opus_custom_decode ( OpusDecoderMono,
-                                         &vecbyNetwData[0],
-                                         iCeltNumCodedBytes,
-                                         &vecsAudioSndCrdMono[i * SYSTEM_FRAME_SIZE_SAMPLES],
-                                         SYSTEM_FRAME_SIZE_SAMPLES );
-                }
+                psFrame = &vecsAudioSndCrdMono[i * iFrameSizeSamples];
             }
-        }
-        else
-        {
-            // lost packet
-            if ( bUseStereo )
+
+            if ( bUseDriftCompensation && !bIsInitializationPhase )
             {
-                if ( eAudioCompressionType == CT_CELT )
-                {
-                    cc6_celt_decode ( CeltDecoderStereo,
-                                      NULL,
-                                      0,
-                                      &vecsStereoSndCrd[i * 2 * SYSTEM_FRAME_SIZE_SAMPLES] );
-                }
-                else
-                {
-                    opus_custom_decode ( OpusDecoderStereo,
-                                         NULL,
-                                         iCeltNumCodedBytes,
-                                         &vecsStereoSndCrd[i * 2 * SYSTEM_FRAME_SIZE_SAMPLES],
-                                         SYSTEM_FRAME_SIZE_SAMPLES );
-                }
+                GetCompensatedFrame ( psFrame );
             }
             else
             {
-                if ( eAudioCompressionType == CT_CELT )
-                {
-                    cc6_celt_decode ( CeltDecoderMono,
-                                      NULL,
-                                      0,
-                                      &vecsAudioSndCrdMono[i * SYSTEM_FRAME_SIZE_SAMPLES] );
-                }
-                else
-                {
-                    opus_custom_decode ( OpusDecoderMono,
-                                         NULL,
-                                         iCeltNumCodedBytes,
-                                         &vecsAudioSndCrdMono[i * SYSTEM_FRAME_SIZE_SAMPLES],
-                                         SYSTEM_FRAME_SIZE_SAMPLES );
-                }
+                GetDecodedFrame ( psFrame );
             }
         }
+
+        // in peer-to-peer mode the frame is replaced by the local mix of our
+        // signal and the signal received directly from the peer
+        if ( P2PChannel.IsEnabled() )
+        {
+            ProcessP2PFrame ( vecsStereoSndCrd, i );
+        }
     }
 
+    AudioProcTimeStats.Update ( APS_DECODE,
+        AudioProcTimer.nsecsElapsed() - iStartTimeNs );
+
 
 /*
 // TEST
@@ -1227,15 +2622,564 @@ fflush(pFileDelay);
                     vecsAudioSndCrdMono[i];
             }
         }
+
+        // the latency marker must be detected before our own signal is added
+        // by the local monitoring
+        if ( bLatencyMarker )
+        {
+            DetectLatencyMarker ( vecsStereoSndCrd );
+        }
+
+        // local monitoring: add our own signal as it is sent to the server
+        // (the server does not send it back in that case)
+        if ( iMonitorLevel != 0 )
+        {
+            const double dMonLev =
+                static_cast<double> ( iMonitorLevel ) / AUD_MONITOR_MAX;
+
+            if ( bUseStereo )
+            {
+                for ( i = 0; i < iStereoBlockSizeSam; i++ )
+                {
+                    vecsStereoSndCrd[i] = Double2Short (
+                        vecsStereoSndCrd[i] + dMonLev * vecsNetwork[i] );
+                }
+            }
+            else
+            {
+                for ( i = 0, j = 0; i < iMonoBlockSizeSam; i++, j += 2 )
+                {
+                    const double dMonSample = dMonLev * vecsNetwork[i];
+
+                    vecsStereoSndCrd[j] =
+                        Double2Short ( vecsStereoSndCrd[j] + dMonSample );
+
+                    vecsStereoSndCrd[j + 1] =
+                        Double2Short ( vecsStereoSndCrd[j + 1] + dMonSample );
+                }
+            }
+        }
     }
     else
     {
         // if not connected, clear data
         vecsStereoSndCrd.Reset ( 0 );
     }
+}
 
-    // update socket buffer size
-    Channel.UpdateSocketBufferSize();
+void CClient::MixForwardedStreams ( CVector<short>& vecsStereoSndCrd,
+                                    const bool      bReceiveDataOk,
+                                    const int       iFrameIdx )
+{
+    int i;
+
+    // the server does not forward our own stream, we mix our own signal
+    // locally with the gain of our own channel
+    MixOwnSignal ( Channel.GetChanID(), iFrameIdx );
+
+    if ( bReceiveDataOk )
+    {
+        // the bundle contains all streams which are currently available
+        vecForwardNumAudChan.Reset ( 0 );
+
+        // parse the streams of the bundle (see FORWARD_STREAM_HEADER_SIZE), the
+        // size of the bundle is stored in front of the streams
+        const int iBundleSize = FORWARD_BUNDLE_LEN_SIZE +
+            ( vecbyNetwData[0] | ( vecbyNetwData[1] << 8 ) );
+
+        int iPos = FORWARD_BUNDLE_LEN_SIZE;
+
+        while ( ( iPos + FORWARD_STREAM_HEADER_SIZE <= iBundleSize ) &&
+                ( iBundleSize <= vecbyNetwData.Size() ) )
+        {
+            const int           iChanID       = vecbyNetwData[iPos];
+            const EAudComprType eAudComprType =
+                static_cast<EAudComprType> ( vecbyNetwData[iPos + 1] );
+            const int           iNumAudChan   = vecbyNetwData[iPos + 2];
+            const bool          bFrameOk      = ( vecbyNetwData[iPos + 3] != 0 );
+            const int           iNumBytes     =
+                vecbyNetwData[iPos + 4] | ( vecbyNetwData[iPos + 5] << 8 );
+
+            iPos += FORWARD_STREAM_HEADER_SIZE;
+
+            // check for a corrupt bundle
+            if ( ( iChanID >= MAX_NUM_CHANNELS ) ||
+                 ( iNumAudChan < 1 ) || ( iNumAudChan > 2 ) ||
+                 ( iPos + iNumBytes > iBundleSize ) )
+            {
+                break;
+            }
+
+            DecodeForwardedStream ( iChanID,
+                                    eAudComprType,
+                                    iNumAudChan,
+                                    bFrameOk ? &vecbyNetwData[iPos] : NULL,
+                                    iNumBytes );
+
+            iPos += iNumBytes;
+        }
+    }
+    else
+    {
+        // lost bundle: conceal the streams of the last received bundle
+        for ( i = 0; i < MAX_NUM_CHANNELS; i++ )
+        {
+            if ( vecForwardNumAudChan[i] > 0 )
+            {
+                DecodeForwardedStream ( i,
+                                        vecForwardAudComprType[i],
+                                        vecForwardNumAudChan[i],
+                                        NULL,
+                                        0 );
+            }
+        }
+    }
+
+    WriteLocalMix ( vecsStereoSndCrd, iFrameIdx );
+}
+
+void CClient::WriteLocalMix ( CVector<short>& vecsStereoSndCrd,
+                              const int       iFrameIdx )
+{
+    int i;
+
+    // write the local mix in the sound card buffer
+    if ( bUseStereo )
+    {
+        for ( i = 0; i < 2 * iFrameSizeSamples; i++ )
+        {
+            vecsStereoSndCrd[iFrameIdx * 2 * iFrameSizeSamples + i] =
+                Double2Short ( vecdForwardMix[i] );
+        }
+    }
+    else
+    {
+        for ( i = 0; i < iFrameSizeSamples; i++ )
+        {
+            vecsAudioSndCrdMono[iFrameIdx * iFrameSizeSamples + i] =
+                Double2Short ( vecdForwardMix[i] );
+        }
+    }
+}
+
+void CClient::DecodeForwardedStream ( const int           iChanID,
+                                      const EAudComprType eAudComprType,
+                                      const int           iNumAudChan,
+                                      const uint8_t*      pData,
+                                      const int           iNumBytes )
+{
+    // only streams with our frame size can be mixed (the server only forwards
+    // streams with the normal frame size), uncompressed audio must have the
+    // size of a frame
+    if ( ( iFrameSizeSamples == SYSTEM_FRAME_SIZE_SAMPLES ) &&
+         ( ( eAudComprType == CT_OPUS ) ||
+           ( eAudComprType == CT_CELT ) ||
+           ( ( eAudComprType == CT_NONE ) &&
+             ( ( pData == NULL ) || ( iNumBytes == 2 * iNumAudChan * iFrameSizeSamples ) ) ) ) )
+    {
+        // decode the stream (a NULL pointer invokes the packet loss
+        // concealment, an uncompressed frame is muted)
+        if ( eAudComprType == CT_NONE )
+        {
+            UnpackRawAudio ( pData,
+                             iNumAudChan * iFrameSizeSamples,
+                             &vecsForwardDecoded[0] );
+        }
+        else if ( eAudComprType == CT_CELT )
+        {
+            cc6_celt_decode ( ( iNumAudChan == 1 ) ?
+                                  CeltDecoderForwardMono[iChanID] :
+                                  CeltDecoderForwardStereo[iChanID],
+                              pData,
+                              ( pData != NULL ) ? iNumBytes : 0,
+                              &vecsForwardDecoded[0] );
+        }
+        else
+        {
+            opus_custom_decode ( ( iNumAudChan == 1 ) ?
+                                     OpusDecoderForwardMono[iChanID] :
+                                     OpusDecoderForwardStereo[iChanID],
+                                 pData,
+                                 iNumBytes,
+                                 &vecsForwardDecoded[0],
+                                 iFrameSizeSamples );
+        }
+
+        vecForwardNumAudChan[iChanID]   = iNumAudChan;
+        vecForwardAudComprType[iChanID] = eAudComprType;
+
+        // add the stream to the local mix with the gain of the mixer fader
+        MixDecodedStream ( iNumAudChan, vecdForwardGains[iChanID] );
+    }
+}
+
+void CClient::MixOwnSignal ( const int iOwnChanID,
+                             const int iFrameIdx )
+{
+    int i;
+
+    vecdForwardMix.Reset ( 0 );
+
+    // our own signal is taken before the encoder, it has the format of the
+    // local mix already (with local monitoring, our own signal is added to the
+    // output separately), it is mixed with the gain of our own channel of the
+    // mixer board like in the server mix
+    if ( ( iMonitorLevel == 0 ) && ( iOwnChanID >= 0 ) &&
+         ( iOwnChanID < MAX_NUM_CHANNELS ) )
+    {
+        const double dOwnGain = vecdForwardGains[iOwnChanID];
+
+        if ( bUseStereo )
+        {
+            for ( i = 0; i < 2 * iFrameSizeSamples; i++ )
+            {
+                vecdForwardMix[i] = dOwnGain *
+                    vecsNetwork[iFrameIdx * 2 * iFrameSizeSamples + i];
+            }
+        }
+        else
+        {
+            for ( i = 0; i < iFrameSizeSamples; i++ )
+            {
+                vecdForwardMix[i] = dOwnGain *
+                    vecsNetwork[iFrameIdx * iFrameSizeSamples + i];
+            }
+        }
+    }
+}
+
+void CClient::MixDecodedStream ( const int    iNumAudChan,
+                                 const double dGain )
+{
+    int i, k;
+
+    // add the decoded stream to the local mix (same channel conversion as in
+    // the server mixer)
+    if ( bUseStereo )
+    {
+        if ( iNumAudChan == 1 )
+        {
+            // mono: copy same mono data in both out stereo audio channels
+            for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
+            {
+                vecdForwardMix[k]     += dGain * vecsForwardDecoded[i];
+                vecdForwardMix[k + 1] += dGain * vecsForwardDecoded[i];
+            }
+        }
+        else
+        {
+            for ( i = 0; i < 2 * iFrameSizeSamples; i++ )
+            {
+                vecdForwardMix[i] += dGain * vecsForwardDecoded[i];
+            }
+        }
+    }
+    else
+    {
+        if ( iNumAudChan == 1 )
+        {
+            for ( i = 0; i < iFrameSizeSamples; i++ )
+            {
+                vecdForwardMix[i] += dGain * vecsForwardDecoded[i];
+            }
+        }
+        else
+        {
+            // stereo: apply stereo-to-mono attenuation
+            for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
+            {
+                vecdForwardMix[i] += dGain *
+                    ( vecsForwardDecoded[k] + vecsForwardDecoded[k + 1] ) / 2;
+            }
+        }
+    }
+}
+
+bool CClient::GetNetwFrame()
+{
+    // receive a new block
+    const bool bReceiveDataOk =
+        ( Channel.GetData ( vecbyNetwData ) == GS_BUFFER_OK );
+
+    // the LED is set by the channel update timer (posting a message to the
+    // GUI allocates an event)
+    if ( bReceiveDataOk )
+    {
+        AtomicStoreRelease ( iJitBufGetOk, 1 );
+
+        // on any valid received packet, we clear the initialization phase
+        // flag
+        bIsInitializationPhase = false;
+    }
+    else
+    {
+        AtomicStoreRelease ( iJitBufGetErr, 1 );
+    }
+
+    return bReceiveDataOk;
+}
+
+void CClient::GetDecodedFrame ( int16_t* psFrame )
+{
+    bool bReceiveDataOk = false;
+
+    if ( bPlayoutInsertFrame )
+    {
+        // the adaptive playout inserts a frame by concealment without reading
+        // the jitter buffer, this must not be detected as clock drift
+        bPlayoutInsertFrame = false;
+        Channel.AddPlayoutCorrection ( -1 );
+    }
+    else
+    {
+        bReceiveDataOk = GetNetwFrame();
+    }
+
+    // decode the frame (or conceal it in case of a lost packet)
+    DecodeFrame ( bReceiveDataOk, psFrame );
+
+    if ( bUseAdaptivePlayout && !bIsInitializationPhase )
+    {
+        AdaptPlayout ( psFrame );
+    }
+}
+
+void CClient::GetCompensatedFrame ( int16_t* psFrame )
+{
+/*
+    The received frames are resampled with the estimated clock drift of the
+    server relative to our sound card, i.e., if the server clock is faster, we
+    read more than one frame per output frame from time to time and the jitter
+    buffer fill level stays constant.
+*/
+    double dDriftPpm = Channel.GetLastClockDriftPpm();
+
+    if ( dDriftPpm > DRIFT_COMP_MAX_PPM )
+    {
+        dDriftPpm = DRIFT_COMP_MAX_PPM;
+    }
+    else if ( dDriftPpm < -DRIFT_COMP_MAX_PPM )
+    {
+        dDriftPpm = -DRIFT_COMP_MAX_PPM;
+    }
+
+    // number of input samples per output sample
+    const double dRatio = 1.0 + dDriftPpm * 1.0e-6;
+
+    // at most three frames are needed (on the first call the resampler buffer
+    // has to be filled with one additional frame)
+    int iNumFrames = 0;
+
+    while ( DriftResampler.NeedsFrame ( dRatio ) && ( iNumFrames < 3 ) )
+    {
+        GetDecodedFrame ( &vecsDriftFrame[0] );
+        DriftResampler.PutFrame ( &vecsDriftFrame[0] );
+        iNumFrames++;
+    }
+
+    DriftResampler.GetFrame ( psFrame, dRatio );
+
+    // the additional or missing frame reads of the resampling must not be
+    // detected as clock drift
+    if ( iNumFrames != 1 )
+    {
+        Channel.AddPlayoutCorrection ( iNumFrames - 1 );
+    }
+}
+
+void CClient::DecodeFrame ( const bool bReceiveDataOk,
+                            int16_t*   psFrame )
+{
+    // a NULL pointer as coded data tells the decoder to conceal the frame
+    const unsigned char* pCodedData = NULL;
+
+    if ( bReceiveDataOk )
+    {
+        pCodedData = &vecbyNetwData[0];
+    }
+
+    if ( eAudioCompressionType == CT_NONE )
+    {
+        // uncompressed audio (a lost packet is muted)
+        UnpackRawAudio ( pCodedData,
+                         bUseStereo ? 2 * iFrameSizeSamples : iFrameSizeSamples,
+                         psFrame );
+    }
+    else if ( bUseStereo )
+    {
+        if ( eAudioCompressionType == CT_CELT )
+        {
+            cc6_celt_decode ( CeltDecoderStereo,
+                              pCodedData,
+                              bReceiveDataOk ? iCeltNumCodedBytes : 0,
+                              psFrame );
+        }
+        else
+        {
+            opus_custom_decode ( CurOpusDecoder,
+                                 pCodedData,
+                                 iCeltNumCodedBytes,
+                                 psFrame,
+                                 iFrameSizeSamples );
+        }
+    }
+    else
+    {
+        if ( eAudioCompressionType == CT_CELT )
+        {
+            cc6_celt_decode ( CeltDecoderMono,
+                              pCodedData,
+                              bReceiveDataOk ? iCeltNumCodedBytes : 0,
+                              psFrame );
+        }
+        else
+        {
+            opus_custom_decode ( CurOpusDecoder,
+                                 pCodedData,
+                                 iCeltNumCodedBytes,
+                                 psFrame,
+                                 iFrameSizeSamples );
+        }
+    }
+}
+
+void CClient::AdaptPlayout ( int16_t* psFrame )
+{
+/*
+    The jitter buffer fill level (i.e. the effective latency) is moved towards
+    the middle of the jitter buffer in steps of one frame. To avoid audible
+    clicks, this is only done in quiet passages: a frame is skipped by reading
+    the next frame and crossfading the current frame into it, a frame is
+    inserted by concealing the next frame without reading the jitter buffer.
+*/
+    int       i;
+    const int iNumChannels = bUseStereo ? 2 : 1;
+    const int iNumSamples  = iFrameSizeSamples * iNumChannels;
+    int       iMaxLevel    = 0;
+
+    for ( i = 0; i < iNumSamples; i++ )
+    {
+        if ( abs ( psFrame[i] ) > iMaxLevel )
+        {
+            iMaxLevel = abs ( psFrame[i] );
+        }
+    }
+
+    if ( iMaxLevel <= PLAYOUT_ADJUST_MAX_LEVEL )
+    {
+        const int iNumAvailFrames = Channel.GetSockBufNumAvailFrames();
+        const int iTargetFrames   = Channel.GetSockBufNumFrames() / 2;
+
+        if ( iNumAvailFrames > iTargetFrames + PLAYOUT_ADJUST_HYSTERESIS )
+        {
+            // skip a frame: the decoder must get all frames to keep its state
+            // consistent, therefore the next frame is decoded and the current
+            // frame is crossfaded into it
+            const bool bNextFrameOk =
+                ( Channel.GetData ( vecbyNetwData ) == GS_BUFFER_OK );
+
+            // the skipped frame must not be detected as clock drift
+            Channel.AddPlayoutCorrection ( 1 );
+
+            DecodeFrame ( bNextFrameOk, &vecsPlayoutFrame[0] );
+
+            for ( i = 0; i < iNumSamples; i++ )
+            {
+                // for stereo, both channels of a sample use the same weight
+                const double dWeight =
+                    static_cast<double> ( i / iNumChannels ) /
+                    iFrameSizeSamples;
+
+                psFrame[i] = Double2Short ( ( 1.0 - dWeight ) * psFrame[i] +
+                                            dWeight * vecsPlayoutFrame[i] );
+            }
+        }
+        else if ( iNumAvailFrames < iTargetFrames - PLAYOUT_ADJUST_HYSTERESIS )
+        {
+            // insert a frame on the next call
+            bPlayoutInsertFrame = true;
+        }
+    }
+}
+
+void CClient::ProcessP2PFrame ( CVector<short>& vecsStereoSndCrd,
+                                const int       iFrameIdx )
+{
+    // the audio of the peer can only be decoded if we know its properties
+    // (the peers always use the normal frame size since the direct path is
+    // not available in the fast update mode, i.e. OPUS64 is not used)
+    const EAudComprType eAudComprType = P2PChannel.GetAudioCompressionType();
+    const int           iNumBytes     = P2PChannel.GetNetwFrameSize();
+    const int           iNumAudChan   = P2PChannel.GetNumAudioChannels();
+    bool                bFrameOk      = false;
+
+    if ( ( eAudComprType == CT_OPUS ) ||
+         ( eAudComprType == CT_CELT ) ||
+         ( ( eAudComprType == CT_NONE ) &&
+           ( iNumBytes == 2 * iNumAudChan * SYSTEM_FRAME_SIZE_SAMPLES ) ) )
+    {
+        if ( vecbyP2PNetwData.Size() != iNumBytes )
+        {
+            InitCallbackBuffer ( vecbyP2PNetwData, iNumBytes );
+        }
+
+        bFrameOk = ( P2PChannel.GetData ( vecbyP2PNetwData ) == GS_BUFFER_OK );
+    }
+
+    // if the direct path fails, we fall back to the server mix
+    if ( bFrameOk )
+    {
+        iP2PNumLostFrames = 0;
+    }
+    else if ( iP2PNumLostFrames < P2P_FALLBACK_NUM_FRAMES )
+    {
+        iP2PNumLostFrames++;
+    }
+
+    // the channel gains can only be applied if the server told us the
+    // channel IDs, until then the server mix is used
+    const int iOwnChanID  = iP2POwnChanID;
+    const int iPeerChanID = iP2PPeerChanID;
+
+    bP2PPathActive = ( iP2PNumLostFrames < P2P_FALLBACK_NUM_FRAMES ) &&
+                     ( iOwnChanID >= 0 ) && ( iPeerChanID >= 0 );
+
+    if ( bP2PPathActive )
+    {
+        // decode the frame of the peer (a NULL pointer invokes the packet
+        // loss concealment, an uncompressed frame is muted)
+        const unsigned char* pCodedData = bFrameOk ? &vecbyP2PNetwData[0] : NULL;
+
+        if ( eAudComprType == CT_NONE )
+        {
+            UnpackRawAudio ( pCodedData,
+                             iNumAudChan * SYSTEM_FRAME_SIZE_SAMPLES,
+                             &vecsForwardDecoded[0] );
+        }
+        else if ( eAudComprType == CT_CELT )
+        {
+            cc6_celt_decode ( ( iNumAudChan == 1 ) ? CeltDecoderP2PMono : CeltDecoderP2PStereo,
+                              pCodedData,
+                              bFrameOk ? iNumBytes : 0,
+                              &vecsForwardDecoded[0] );
+        }
+        else
+        {
+            opus_custom_decode ( ( iNumAudChan == 1 ) ? OpusDecoderP2PMono : OpusDecoderP2PStereo,
+                                 pCodedData,
+                                 iNumBytes,
+                                 &vecsForwardDecoded[0],
+                                 SYSTEM_FRAME_SIZE_SAMPLES );
+        }
+
+        // both signals are mixed with the channel gains of the mixer board
+        // like in the server mix
+        MixOwnSignal ( iOwnChanID, iFrameIdx );
+
+        MixDecodedStream ( iNumAudChan, vecdForwardGains[iPeerChanID] );
+
+        WriteLocalMix ( vecsStereoSndCrd, iFrameIdx );
+    }
 }
 
 int CClient::EstimatedOverallDelay ( const int iPingTimeMs )
@@ -1246,36 +3190,217 @@ int CClient::EstimatedOverallDelay ( const int iPingTimeMs )
       for the average it is assumed that the buffer is half filled)
     - consider the jitter buffer on the server side, too
 */
+    // duration of one frame of the current audio codec
+    const double dFrameDurationMs =
+        static_cast<double> ( iFrameSizeSamples ) * 1000 / SYSTEM_SAMPLE_RATE_HZ;
+
     // the buffer sizes at client and server divided by 2 (half the buffer
     // for the delay) is the total socket buffer size
-    const double dTotalJitterBufferDelayMs = SYSTEM_BLOCK_DURATION_MS_FLOAT *
+    const double dTotalJitterBufferDelayMs = dFrameDurationMs *
         static_cast<double> ( GetSockBufNumFrames() +
                               GetServerSockBufNumFrames() ) / 2;
 
+    const double dTotalBufferDelayMs =
+        GetPacketAndCodecDelayMs() +
+        dTotalJitterBufferDelayMs +
+        GetSndCrdDelayMs();
+
+    return MathUtils::round ( dTotalBufferDelayMs + iPingTimeMs );
+}
+
+double CClient::GetSndCrdDelayMs()
+{
     // we assume that we have two period sizes for the input and one for the
     // output, therefore we have "3 *" instead of "2 *" (for input and output)
     // the actual sound card buffer size, also consider delay introduced by
     // sound card conversion buffer by using
     // "GetSndCrdConvBufAdditionalDelayMonoBlSize"
-    const double dTotalSoundCardDelayMs =
-        ( 3 * GetSndCrdActualMonoBlSize() +
+    return static_cast<double> ( 3 * GetSndCrdActualMonoBlSize() +
         GetSndCrdConvBufAdditionalDelayMonoBlSize() ) *
         1000 / SYSTEM_SAMPLE_RATE_HZ;
+}
 
+double CClient::GetPacketAndCodecDelayMs()
+{
     // network packets are of the same size as the audio packets per definition
     // if no sound card conversion buffer is used
     const double dDelayToFillNetworkPacketsMs =
-        GetSystemMonoBlSize() * 1000 / SYSTEM_SAMPLE_RATE_HZ;
+        static_cast<double> ( GetSystemMonoBlSize() ) * 1000 / SYSTEM_SAMPLE_RATE_HZ;
 
-    // CELT additional delay at small frame sizes is half a frame size
-    const double dAdditionalAudioCodecDelayMs =
-        SYSTEM_BLOCK_DURATION_MS_FLOAT / 2;
+    // CELT additional delay at small frame sizes is half a frame size (there
+    // is no delay for uncompressed audio)
+    double dAdditionalAudioCodecDelayMs = 0;
 
-    const double dTotalBufferDelayMs =
-        dDelayToFillNetworkPacketsMs +
-        dTotalJitterBufferDelayMs +
-        dTotalSoundCardDelayMs +
-        dAdditionalAudioCodecDelayMs;
+    if ( eAudioCompressionType != CT_NONE )
+    {
+        dAdditionalAudioCodecDelayMs = static_cast<double> ( iFrameSizeSamples ) *
+            1000 / SYSTEM_SAMPLE_RATE_HZ / 2;
+    }
 
-    return MathUtils::round ( dTotalBufferDelayMs + iPingTimeMs );
+    return dDelayToFillNetworkPacketsMs + dAdditionalAudioCodecDelayMs;
+}
+
+double CClient::GetLatencyMarkerDelayMs()
+{
+    const int iDelaySam = AtomicLoadAcquire ( iLatencyMarkerDelaySam );
+
+    if ( iDelaySam < 0 )
+    {
+        return -1;
+    }
+    else
+    {
+        return static_cast<double> ( iDelaySam ) * 1000 / SYSTEM_SAMPLE_RATE_HZ;
+    }
+}
+
+int CClient::MeasuredOverallDelay()
+{
+    // the latency marker covers the complete path between the sound card
+    // blocks, the round trip of the frames does not cover the packet filling
+    // and the audio coding
+    const double dMarkerDelayMs = GetLatencyMarkerDelayMs();
+    const double dRoundTripMs   = GetMeasuredRoundTripMs();
+
+    if ( dMarkerDelayMs >= 0 )
+    {
+        return MathUtils::round ( GetSndCrdDelayMs() + dMarkerDelayMs );
+    }
+    else if ( dRoundTripMs >= 0 )
+    {
+        return MathUtils::round ( GetSndCrdDelayMs() +
+                                  GetPacketAndCodecDelayMs() + dRoundTripMs );
+    }
+    else
+    {
+        return -1;
+    }
+}
+
+void CClient::InjectLatencyMarker()
+{
+    if ( iLatencyMarkerCnt >= 0 )
+    {
+        // count the samples since the marker was injected
+        iLatencyMarkerCnt += iMonoBlockSizeSam;
+
+        if ( iLatencyMarkerCnt > LATENCY_MARKER_TIMEOUT_MS * SYSTEM_SAMPLE_RATE_HZ / 1000 )
+        {
+            // the marker was lost (e.g. the server excludes our signal)
+            iLatencyMarkerCnt = -1;
+        }
+    }
+    else
+    {
+        iLatencyMarkerIntervalCnt += iMonoBlockSizeSam;
+
+        if ( iLatencyMarkerIntervalCnt >=
+             LATENCY_MARKER_INTERVAL_MS * SYSTEM_SAMPLE_RATE_HZ / 1000 )
+        {
+            const int iNumChan = bUseStereo ? 2 : 1;
+            int       iNumMarkerSam = LATENCY_MARKER_LEN_SAMPLES;
+
+            if ( iNumMarkerSam > iMonoBlockSizeSam )
+            {
+                iNumMarkerSam = iMonoBlockSizeSam;
+            }
+
+            // square wave burst at the beginning of the block
+            for ( int i = 0; i < iNumMarkerSam; i++ )
+            {
+                int16_t sMarker = LATENCY_MARKER_AMPLITUDE;
+
+                if ( ( i / LATENCY_MARKER_HALF_PERIOD_SAMPLES ) % 2 != 0 )
+                {
+                    sMarker = -LATENCY_MARKER_AMPLITUDE;
+                }
+
+                for ( int j = 0; j < iNumChan; j++ )
+                {
+                    vecsNetwork[i * iNumChan + j] = sMarker;
+                }
+            }
+
+            iLatencyMarkerIntervalCnt = 0;
+            iLatencyMarkerCnt         = 0;
+        }
+    }
+}
+
+void CClient::DetectLatencyMarker ( const CVector<int16_t>& vecsStereoSndCrd )
+{
+    const int iHistLen = LATENCY_MARKER_LEN_SAMPLES - 1;
+    int       i, j;
+
+    // keep the end of the previous block in front of the current block (left
+    // channel)
+    for ( i = 0; i < iHistLen; i++ )
+    {
+        vecfLatencyMarkerHist[i] = vecfLatencyMarkerHist[iMonoBlockSizeSam + i];
+    }
+
+    for ( i = 0; i < iMonoBlockSizeSam; i++ )
+    {
+        vecfLatencyMarkerHist[iHistLen + i] = vecsStereoSndCrd[2 * i];
+    }
+
+    if ( iLatencyMarkerCnt >= 0 )
+    {
+        // Correlate the received signal with the known square wave burst at
+        // each start position of this block. The correlation is normalized
+        // by the signal energy so that other signals of the mix with a high
+        // level (e.g. a drum hit) are not taken as the marker. The start of
+        // the marker is the position with the maximum correlation.
+        const float fMinEnergy = static_cast<float> ( LATENCY_MARKER_LEN_SAMPLES ) *
+            LATENCY_MARKER_MIN_LEVEL * LATENCY_MARKER_MIN_LEVEL;
+
+        float fMaxCorr   = static_cast<float> ( LATENCY_MARKER_MIN_CORRELATION );
+        int   iMarkerPos = -1;
+
+        for ( i = 0; i < iMonoBlockSizeSam; i++ )
+        {
+            // positions in front of the injection of the marker are not
+            // considered
+            if ( iLatencyMarkerCnt + i - iHistLen >= 0 )
+            {
+                float fCrossCorr = 0;
+                float fEnergy    = 0;
+
+                for ( j = 0; j < LATENCY_MARKER_LEN_SAMPLES; j++ )
+                {
+                    const float fSample = vecfLatencyMarkerHist[i + j];
+
+                    if ( ( j / LATENCY_MARKER_HALF_PERIOD_SAMPLES ) % 2 != 0 )
+                    {
+                        fCrossCorr -= fSample;
+                    }
+                    else
+                    {
+                        fCrossCorr += fSample;
+                    }
+
+                    fEnergy += fSample * fSample;
+                }
+
+                if ( ( fEnergy >= fMinEnergy ) && ( fCrossCorr > 0 ) )
+                {
+                    const float fCorr = fCrossCorr /
+                        sqrtf ( fEnergy * LATENCY_MARKER_LEN_SAMPLES );
+
+                    if ( fCorr > fMaxCorr )
+                    {
+                        fMaxCorr   = fCorr;
+                        iMarkerPos = i;
+                    }
+                }
+            }
+        }
+
+        if ( iMarkerPos >= 0 )
+        {
+            AtomicStoreRelease ( iLatencyMarkerDelaySam,
+                                 iLatencyMarkerCnt + iMarkerPos - iHistLen );
+            iLatencyMarkerCnt = -1;
+        }
+    }
 }
@@ -28,8 +28,11 @@
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QString>
+#include <QStringList>
 #include <QDateTime>
+#include <QTimer>
 #include <QMessageBox>
+#include <algorithm>
 #include "cc6_celt.h"
 #include "opus_custom.h"
 #include "global.h"
@@ -64,6 +67,22 @@
 // audio reverberation range
 #define AUD_REVERB_MAX                          100
 
+// local monitoring level range (zero: no local monitoring)
+#define AUD_MONITOR_MAX                         100
+
+// latency marker: a short square wave burst is injected in the transmitted
+// signal in regular intervals and detected in the received mix by correlating
+// with the known burst, the marker is given up if it is not detected within
+// the time out (the minimum level is the RMS of the received burst which may
+// be attenuated by the mixer faders of the server)
+#define LATENCY_MARKER_INTERVAL_MS              2000
+#define LATENCY_MARKER_TIMEOUT_MS               500
+#define LATENCY_MARKER_LEN_SAMPLES              64
+#define LATENCY_MARKER_HALF_PERIOD_SAMPLES      16
+#define LATENCY_MARKER_AMPLITUDE                30000
+#define LATENCY_MARKER_MIN_CORRELATION          0.8
+#define LATENCY_MARKER_MIN_LEVEL                300
+
 // CELT number of coded bytes per audio packet
 // 24: mono low quality            156 kbps (128) / 114 kbps (256)
 // 44: mono normal quality         216 kbps (128) / 174 kbps (256)
@@ -95,8 +114,114 @@
 #define OPUS_NUM_BYTES_STEREO_NORMAL_QUALITY    71
 #define OPUS_NUM_BYTES_STEREO_HIGH_QUALITY      142
 
+// OPUS with the small frame size (SYSTEM_FRAME_SIZE_SAMPLES_SMALL), the
+// values give approximately the same bit rates as the values above
+#define OPUS64_NUM_BYTES_MONO_LOW_QUALITY       13
+#define OPUS64_NUM_BYTES_MONO_NORMAL_QUALITY    23
+#define OPUS64_NUM_BYTES_MONO_HIGH_QUALITY      36
+
+#define OPUS64_NUM_BYTES_STEREO_LOW_QUALITY     24
+#define OPUS64_NUM_BYTES_STEREO_NORMAL_QUALITY  36
+#define OPUS64_NUM_BYTES_STEREO_HIGH_QUALITY    71
+
+// in peer-to-peer mode the server mix is used if no audio packet was received
+// from the peer within this time
+#define P2P_FALLBACK_TIME_MS                    250
+#define P2P_FALLBACK_NUM_FRAMES                 ( P2P_FALLBACK_TIME_MS * \
+    SYSTEM_SAMPLE_RATE_HZ / 1000 / SYSTEM_FRAME_SIZE_SAMPLES )
+
+// the adaptive playout only skips or inserts frames in quiet passages, i.e., if
+// the maximum level of the frame is below this value (approx. -40 dBFS)
+#define PLAYOUT_ADJUST_MAX_LEVEL                328
+
+// hysteresis of the jitter buffer fill level for the adaptive playout
+#define PLAYOUT_ADJUST_HYSTERESIS               1 // frames
+
+// maximum clock drift which is compensated (larger values are most probably
+// caused by a wrong estimation, e.g. after a long network outage)
+#define DRIFT_COMP_MAX_PPM                      1000
+
+// network probe: before the jitter buffers have a statistic, a burst of probe
+// messages is sent to the server and the spread of the round trip times is
+// used for the initial auto jitter buffer sizes
+#define PROBE_NUM_PACKETS                       20
+#define PROBE_INTERVAL_MS                       5
+#define PROBE_TIME_OUT_MS                       500
+#define PROBE_MIN_NUM_REPLIES                   ( PROBE_NUM_PACKETS / 2 )
+
+// quantile of the round trip times which shall be covered by the jitter buffer
+#define PROBE_RTT_QUANTILE                      0.9
+
+// number of coded audio packets the outgoing queue between the audio callback
+// and the network send thread can hold
+#define SEND_QUEUE_NUM_PACKETS                  16
+
+// the network send thread polls the outgoing queue, the poll interval is a
+// fraction of the shortest frame duration (1.33 ms), after a number of polls
+// without a packet (i.e. the audio does not run) a longer interval is used
+#define SEND_THREAD_POLL_INTERVAL_US            250
+#define SEND_THREAD_NUM_POLLS_BEFORE_IDLE       40
+#define SEND_THREAD_IDLE_INTERVAL_MS            10
+
+// the state which the audio callback cannot hand over directly to the main
+// thread (LED of the jitter buffer, connection events, jitter buffer size) is
+// handled by a timer with this interval
+#define CHANNEL_UPDATE_INTERVAL_MS              20
+
+// maximum time to wait for the audio callback to finish its current block when
+// the audio processing is paused
+#define AUDIO_PROC_PAUSE_TIME_OUT_MS            100
+
+// number of connections for which the audio callback statistic is kept in the
+// log which is shown in the analyzer console
+#define AUDIO_PROC_STATS_LOG_NUM_CONN           5
+
+// server switch: before cutting over, the target server is pinged and the
+// switch is given up if no answer is received after the number of pings
+#define SWITCH_SERVER_PING_INTERVAL_MS          100
+#define SWITCH_SERVER_NUM_PINGS                 5
+
 
 /* Classes ********************************************************************/
+class CClient; // forward declaration of CClient
+
+// state of the audio processing in the audio callback, the processing is
+// paused (the sound card keeps running and outputs silence) while the audio
+// coding or the connection is initialized again
+enum EAudioProcState
+{
+    AUDIO_PROC_RUNNING = 0,
+    AUDIO_PROC_PAUSE_REQUESTED,
+    AUDIO_PROC_PAUSED
+};
+
+// The network send thread sends the audio packets which the audio callback has
+// put in the outgoing queue. This way the audio callback does not lock the
+// socket mutex, does not allocate memory and does not call the socket
+// functions. The send thread polls the queue, therefore the audio callback
+// does not wake it up (a wake up is a system call). The remaining accesses of
+// the audio callback to the channel do not wait: the jitter buffer is only
+// read if the channel mutex is free (CChannel::GetData()) and the LED state,
+// the connection events and the jitter buffer size are handled by a timer of
+// the main thread. Not covered are the sound interface and the codecs, and
+// the unlock of the channel mutex wakes a thread which waits for it.
+class CClientSendThread : public QThread
+{
+public:
+    CClientSendThread ( CClient* pNClient ) : pClient ( pNClient ), bRun ( false ) {}
+    virtual ~CClientSendThread() { Stop(); }
+
+    void Start();
+    void Stop();
+
+protected:
+    virtual void run();
+
+    CClient*      pClient;
+    volatile bool bRun;
+};
+
+
 class CClient : public QObject
 {
     Q_OBJECT
@@ -108,10 +233,48 @@ public:
     void   Stop();
     bool   IsRunning() { return Sound.IsRunning(); }
     bool   SetServerAddr ( QString strNAddr );
+
+    // switches to an other server while the sound card keeps running, returns
+    // false if the address is invalid (if the target server is pinged first,
+    // the switch is done when the answer is received)
+    bool   SwitchServer ( QString strNAddr );
     double MicLevelL() { return SignalLevelMeter.MicLevelLeft(); }
     double MicLevelR() { return SignalLevelMeter.MicLevelRight(); }
     bool   IsConnected() { return Channel.IsConnected(); }
 
+    // called by the network send thread, returns true if a packet was sent
+    bool SendQueuedPackets();
+
+    // number of audio packets which were dropped since the network send thread
+    // did not keep up with the audio callback
+    int GetNumDroppedSendPackets() const { return SendQueue.GetNumDropped(); }
+
+    // real-time violations of the audio callback: jitter buffer reads which
+    // were skipped since the channel mutex was locked by another thread and
+    // buffers which had to be enlarged (i.e. memory was allocated)
+    int GetNumLockContentions() const
+        { return Channel.GetNumLockContentions() + P2PChannel.GetNumLockContentions(); }
+
+    int GetNumCallbackAllocs() const
+        { return AtomicLoadAcquire ( iNumCallbackAllocs ); }
+
+    // processing time statistic of the audio callback and the buffer over-
+    // and underruns of the sound card
+    const CAudioProcTimeStats& GetAudioProcTimeStats() const
+        { return AudioProcTimeStats; }
+
+    // statistic of the audio callback of the last connections (newest first)
+    const QStringList& GetAudioProcTimeStatsLog() const
+        { return strlstAudioProcTimeStatsLog; }
+    bool IsSndCrdXrunCountAvailable() { return Sound.IsXrunCountAvailable(); }
+    int  GetSndCrdNumXruns() { return Sound.GetNumXruns(); }
+
+    // round trip time statistic of the pings to the server and the
+    // inter-arrival jitter of the audio packets received from the server
+    const CRttStatistics& GetRttStatistics() const { return RttStats; }
+    int  GetInterArrivalJitterUs() const { return Channel.GetInterArrivalJitterUs(); }
+    bool IsKernelRecTimeStampEnabled() const { return Socket.IsKernelRecTimeStampEnabled(); }
+
     bool GetOpenChatOnNewMessage() const { return bOpenChatOnNewMessage; }
     void SetOpenChatOnNewMessage ( const bool bNV ) { bOpenChatOnNewMessage = bNV; }
 
@@ -124,6 +287,49 @@ public:
     bool GetUseStereo() const { return bUseStereo; }
     void SetUseStereo ( const bool bNUseStereo );
 
+    // if enabled, the client requests the coded streams of all channels from
+    // the server and mixes them locally (only if the server supports it)
+    bool GetUseForwarding() const { return bUseForwarding; }
+    void SetUseForwarding ( const bool bNUseForwarding ) { bUseForwarding = bNUseForwarding; }
+
+    // if enabled and exactly one other client is connected to the server, the
+    // audio is exchanged directly with that client (the server mix is used as
+    // the fallback)
+    bool GetUseP2P() const { return bUseP2P; }
+    void SetUseP2P ( const bool bNUseP2P ) { bUseP2P = bNUseP2P; }
+    bool IsP2PActive() const { return bP2PPathActive; }
+    int  GetP2PPingTime() const { return iP2PPingTimeMs; }
+
+    // if enabled and the server supports it, the audio is transmitted
+    // uncompressed (for LAN sessions with plenty of bandwidth)
+    bool GetUseRawAudio() const { return bUseRawAudio; }
+    void SetUseRawAudio ( const bool bNUseRawAudio ) { bUseRawAudio = bNUseRawAudio; }
+
+    // if enabled, the target server of a server switch must answer a ping
+    // before the current connection is given up
+    bool GetPreProbeServer() const { return bPreProbeServer; }
+    void SetPreProbeServer ( const bool bNPrePrSe ) { bPreProbeServer = bNPrePrSe; }
+
+    // if enabled, the jitter buffer fill level is moved towards the middle of
+    // the buffer by skipping or inserting frames in quiet passages
+    bool GetUseAdaptivePlayout() const { return bUseAdaptivePlayout; }
+    void SetUseAdaptivePlayout ( const bool bNUseAdPl ) { bUseAdaptivePlayout = bNUseAdPl; }
+
+    // if enabled and the server runs on the same host, the packets are
+    // exchanged via the local transport instead of UDP
+    bool GetUseLocalTransport() const { return bUseLocalTransport; }
+    void SetUseLocalTransport ( const bool bNUseLocTr ) { bUseLocalTransport = bNUseLocTr; }
+
+    // if enabled, the clock drift between the sound card and the server is
+    // compensated by resampling the received audio
+    bool GetUseDriftCompensation() const { return bUseDriftCompensation; }
+    void SetUseDriftCompensation ( const bool bNUseDrComp ) { bUseDriftCompensation = bNUseDrComp; }
+
+    // number of frames protected by one redundancy frame (zero: no
+    // redundancy), the server uses the same setting for both directions
+    int  GetRedundancy() const { return Channel.GetReqRedundancy(); }
+    void SetRedundancy ( const int iNRed ) { Channel.SetReqRedundancy ( iNRed ); }
+
     void SetServerListCentralServerAddress ( const QString& sNCentServAddr )
         { strCentralServerAddress = sNCentServAddr; }
 
@@ -142,6 +348,25 @@ public:
     int GetReverbLevel() const { return iReverbLevel; }
     void SetReverbLevel ( const int iNL ) { iReverbLevel = iNL; }
 
+    // if the local monitoring is used, our own signal is added to the output
+    // without the delay of the server round trip and the server is requested
+    // to exclude it from our mix (mix-minus)
+    int GetMonitorLevel() const { return iMonitorLevel; }
+    void SetMonitorLevel ( const int iNL )
+    {
+        iMonitorLevel = iNL;
+        Channel.SetMixMinus ( iMonitorLevel > 0 );
+    }
+
+    // the latency marker is audible for all clients, it only comes back if
+    // the local monitoring is not used
+    bool GetLatencyMarker() const { return bLatencyMarker; }
+    void SetLatencyMarker ( const bool bNV )
+    {
+        bLatencyMarker = bNV;
+        AtomicStoreRelease ( iLatencyMarkerDelaySam, -1 );
+    }
+
     bool IsReverbOnLeftChan() const { return bReverbOnLeftChan; }
     void SetReverbOnLeftChan ( const bool bIL )
     {
@@ -216,13 +441,14 @@ public:
         }
     }
     int GetSystemMonoBlSize() { return iMonoBlockSizeSam; }
+    int GetSystemFrameSize() { return iFrameSizeSamples; }
     int GetSndCrdConvBufAdditionalDelayMonoBlSize()
     {
         if ( bSndCrdConversionBufferRequired )
         {
-            // by introducing the conversion buffer we also introduce additional
-            // delay which equals the "internal" mono buffer size
-            return iMonoBlockSizeSam;
+            // the additional delay of the conversion buffer depends on the
+            // ratio of the sound card and the "internal" mono buffer sizes
+            return iSndCrdConvBufDelayMonoSam;
         }
         else
         {
@@ -234,16 +460,25 @@ public:
     bool GetFraSiFactDefSupported()  { return bFraSiFactDefSupported; }
     bool GetFraSiFactSafeSupported() { return bFraSiFactSafeSupported; }
 
-    void SetRemoteChanGain ( const int iId, const double dGain )
-        { Channel.SetRemoteChanGain ( iId, dGain ); }
+    void SetRemoteChanGain ( const int iId, const double dGain );
+
+    void SetRemoteBusGain ( const QString& strBus, const double dGain )
+        { Channel.SetRemoteBusGain ( strBus, dGain ); }
+
+    // the channel gain of a channel which belongs to a bus is ignored by the
+    // server, the bus gain can only be replaced by an explicit override
+    void SetRemoteChanGainOverride ( const int iId, const double dGain )
+        { Channel.SetRemoteChanGainOverride ( iId, true, dGain ); }
 
-    void SetRemoteInfo() { Channel.SetRemoteInfo ( ChannelInfo ); }
+    void ClearRemoteChanGainOverride ( const int iId )
+        { Channel.SetRemoteChanGainOverride ( iId, false, (double) 1.0 ); }
+
+    void SetRemoteInfo();
 
     void CreateChatTextMes ( const QString& strChatText )
         { Channel.CreateChatTextMes ( strChatText ); }
 
-    void CreateCLPingMes()
-        { ConnLessProtocol.CreateCLPingMes ( Channel.GetAddress(), PreparePingMessage() ); }
+    void CreateCLPingMes();
 
     void CreateCLServerListPingMes ( const CHostAddress& InetAddr )
     {
@@ -257,14 +492,39 @@ public:
 
     int EstimatedOverallDelay ( const int iPingTimeMs );
 
+    // The overall delay is measured with the round trip of the audio frames
+    // through the server or with the latency marker which also covers the
+    // audio coding. The sound card delay cannot be measured and is always
+    // estimated. Negative values: no measurement available.
+    int    MeasuredOverallDelay();
+    double GetMeasuredRoundTripMs() { return Channel.GetLatencyRoundTripMs(); }
+    double GetLatencyMarkerDelayMs();
+    double GetSndCrdDelayMs();
+    double GetPacketAndCodecDelayMs();
+
+    void SetBufSimulationEnabled ( const bool bNewEnabled )
+        { Channel.SetBufSimulationEnabled ( bNewEnabled ); }
+    int GetBufSimulationAutoSetting()
+        { return Channel.GetBufSimulationAutoSetting(); }
     void GetBufErrorRates ( CVector<double>& vecErrRates, double& dLimit )
         { Channel.GetBufErrorRates ( vecErrRates, dLimit ); }
+    void GetBufSeqNumStats ( int& iNumReordered, int& iNumLate )
+        { Channel.GetBufSeqNumStats ( iNumReordered, iNumLate ); }
+    void GetBufRedundancyStats ( int& iNumRecovered, int& iNumConcealed )
+        { Channel.GetBufRedundancyStats ( iNumRecovered, iNumConcealed ); }
+    double GetClockDriftPpm() { return Channel.GetClockDriftPpm(); }
 
     // settings
     CVector<QString> vstrIPAddress;
     CChannelCoreInfo ChannelInfo;
+    QString          strBusName;
+    CVector<QString> vecStoredBusNames;
+    CVector<int>     vecStoredBusGains;
     CVector<QString> vecStoredFaderTags;
     CVector<int>     vecStoredFaderLevels;
+    CVector<QString> vecStoredJitBufAddr;
+    CVector<int>     vecStoredJitBufSizes;
+    CVector<int>     vecStoredServerJitBufSizes;
 
     // window position/state settings
     QByteArray       vecWindowPosMain;
@@ -283,20 +543,84 @@ public:
 protected:
     // callback function must be static, otherwise it does not work
     static void AudioCallback ( CVector<short>& psData, void* arg );
+    static void AudioCallbackFloat ( CVector<float>& pfData, void* arg );
 
     void        Init();
+    void        InitAudioCoding();
+    bool        PauseAudioProcessing();
+    void        ResumeAudioProcessing()
+                    { AtomicStoreRelease ( iAudioProcState, AUDIO_PROC_RUNNING ); }
+    void        ResetConnectionStats();
+    bool        ParseServerAddr ( const QString& strNAddr, CHostAddress& HostAddress );
+    void        CutOverToServer ( const CHostAddress& NewAddr );
     void        ProcessSndCrdAudioData ( CVector<short>& vecsStereoSndCrd );
     void        ProcessAudioDataIntern ( CVector<short>& vecsStereoSndCrd );
+    void        ProcessSndCrdAudioDataFloat ( CVector<float>& vecfStereoSndCrd );
+    void        ProcessAudioDataInternFloat ( CVector<float>& vecfStereoSndCrd );
+
+    void        MixForwardedStreams ( CVector<short>& vecsStereoSndCrd,
+                                      const bool      bReceiveDataOk,
+                                      const int       iFrameIdx );
+    void        DecodeForwardedStream ( const int           iChanID,
+                                        const EAudComprType eAudComprType,
+                                        const int           iNumAudChan,
+                                        const uint8_t*      pData,
+                                        const int           iNumBytes );
+    void        MixOwnSignal ( const int iOwnChanID,
+                               const int iFrameIdx );
+    void        MixDecodedStream ( const int    iNumAudChan,
+                                   const double dGain );
+    void        WriteLocalMix ( CVector<short>& vecsStereoSndCrd,
+                                const int       iFrameIdx );
+
+    bool        GetNetwFrame();
+
+    // resizes a buffer in the audio callback, the buffers are reserved so
+    // that no memory is allocated (an allocation is counted)
+    template<typename T>
+    void        InitCallbackBuffer ( CVector<T>& vecBuf, const int iNewSize )
+    {
+        if ( static_cast<size_t> ( iNewSize ) > vecBuf.capacity() )
+        {
+            AtomicStoreRelease ( iNumCallbackAllocs,
+                AtomicLoadAcquire ( iNumCallbackAllocs ) + 1 );
+        }
+
+        vecBuf.Init ( iNewSize );
+    }
+
+    void        GetDecodedFrame ( int16_t* psFrame );
+    void        GetCompensatedFrame ( int16_t* psFrame );
+    void        DecodeFrame ( const bool bReceiveDataOk,
+                              int16_t*   psFrame );
+    void        AdaptPlayout ( int16_t* psFrame );
+
+    void        StartP2P ( const CHostAddress& PeerAddr );
+    void        StopP2P();
+    void        ProcessP2PFrame ( CVector<short>& vecsStereoSndCrd,
+                                  const int       iFrameIdx );
 
     int         PreparePingMessage();
-    int         EvaluatePingMessage ( const int iMs );
+    int         EvaluatePingMessage ( const int iTimeStampUs );
     void        CreateServerJitterBufferMessage();
 
+    void        InitJitBufSizes();
+    void        StoreJitBufSizes();
+    void        StartProbe();
+    void        EvaluateProbe();
+
+    void        LogAudioProcTimeStats();
+
+    void        InjectLatencyMarker();
+    void        DetectLatencyMarker ( const CVector<int16_t>& vecsStereoSndCrd );
+
 // #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
 void SetAudoCompressiontype ( const EAudComprType eNAudCompressionType );
 
-    // only one channel is needed for client application
+    // the channel to the server and the channel for the audio which is
+    // received directly from the peer in peer-to-peer mode
     CChannel                Channel;
+    CChannel                P2PChannel;
     CProtocol               ConnLessProtocol;
 
     // audio encoder/decoder
@@ -311,13 +635,65 @@ void SetAudoCompressiontype ( const EAudComprType eNAudCompressionType );
     OpusCustomDecoder*      OpusDecoderMono;
     OpusCustomEncoder*      OpusEncoderStereo;
     OpusCustomDecoder*      OpusDecoderStereo;
+    OpusCustomMode*         Opus64Mode;
+    OpusCustomEncoder*      Opus64EncoderMono;
+    OpusCustomDecoder*      Opus64DecoderMono;
+    OpusCustomEncoder*      Opus64EncoderStereo;
+    OpusCustomDecoder*      Opus64DecoderStereo;
+    OpusCustomEncoder*      CurOpusEncoder;
+    OpusCustomDecoder*      CurOpusDecoder;
+    OpusCustomDecoder*      OpusDecoderForwardMono[MAX_NUM_CHANNELS];
+    OpusCustomDecoder*      OpusDecoderForwardStereo[MAX_NUM_CHANNELS];
+    cc6_CELTDecoder*        CeltDecoderForwardMono[MAX_NUM_CHANNELS];
+    cc6_CELTDecoder*        CeltDecoderForwardStereo[MAX_NUM_CHANNELS];
+    cc6_CELTDecoder*        CeltDecoderP2PMono;
+    cc6_CELTDecoder*        CeltDecoderP2PStereo;
+    OpusCustomDecoder*      OpusDecoderP2PMono;
+    OpusCustomDecoder*      OpusDecoderP2PStereo;
     EAudComprType           eAudioCompressionType;
+    int                     iFrameSizeSamples;
     int                     iCeltNumCodedBytes;
     EAudioQuality           eAudioQuality;
     bool                    bUseStereo;
     bool                    bIsInitializationPhase;
     CVector<unsigned char>  vecCeltData;
 
+    // forwarding mode (local mix of the streams of all channels)
+    bool                    bUseForwarding;
+    CVector<double>         vecdForwardGains;
+    CVector<int>            vecForwardNumAudChan;
+    CVector<EAudComprType>  vecForwardAudComprType;
+    CVector<int16_t>        vecsForwardDecoded;
+    CVector<double>         vecdForwardMix;
+
+    // peer-to-peer mode (direct audio connection to the other client)
+    bool                    bUseP2P;
+    bool                    bP2PPathActive;
+    int                     iP2PNumLostFrames;
+    int                     iP2PPingTimeMs;
+    int                     iP2POwnChanID;
+    int                     iP2PPeerChanID;
+    CVector<uint8_t>        vecbyP2PNetwData;
+
+    bool                    bUseLocalTransport;
+    bool                    bUseRawAudio;
+
+    // server switch
+    bool                    bPreProbeServer;
+    CHostAddress            SwitchServerAddr;
+    QTimer                  TimerSwitchServer;
+    int                     iSwitchServerPingCnt;
+
+    // adaptive playout (skip or insert frames in quiet passages)
+    bool                    bUseAdaptivePlayout;
+    bool                    bPlayoutInsertFrame;
+    CVector<int16_t>        vecsPlayoutFrame;
+
+    // clock drift compensation
+    bool                    bUseDriftCompensation;
+    CDriftResampler         DriftResampler;
+    CVector<int16_t>        vecsDriftFrame;
+
 #ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
     CHighPrioSocket         Socket;
 #else
@@ -326,11 +702,37 @@ void SetAudoCompressiontype ( const EAudComprType eNAudCompressionType );
     CSound                  Sound;
     CStereoSignalLevelMeter SignalLevelMeter;
 
+    // outgoing audio packets (audio callback -> network send thread)
+    CPacketQueue            SendQueue;
+    CVector<uint8_t>        vecbySendQueueData;
+    CClientSendThread       SendThread;
+
+    // the audio callback only processes the audio if this state is running
+    QAtomicInt              iAudioProcState;
+
+    // processing time measurement of the audio callback
+    QElapsedTimer           AudioProcTimer;
+    CAudioProcTimeStats     AudioProcTimeStats;
+    QStringList             strlstAudioProcTimeStatsLog;
+    QAtomicInt              iNumCallbackAllocs;
+
+    // state of the audio callback which is handed over to the main thread
+    // by the channel update timer
+    QAtomicInt              iJitBufGetOk;
+    QAtomicInt              iJitBufGetErr;
+    QTimer                  TimerChannelUpdate;
+
     CVector<uint8_t>        vecbyNetwData;
 
     int                     iAudioInFader;
     bool                    bReverbOnLeftChan;
     int                     iReverbLevel;
+    int                     iMonitorLevel;
+    bool                    bLatencyMarker;
+    int                     iLatencyMarkerIntervalCnt;
+    int                     iLatencyMarkerCnt;
+    QAtomicInt              iLatencyMarkerDelaySam;
+    CVector<float>          vecfLatencyMarkerHist;
     CAudioReverb            AudioReverbL;
     CAudioReverb            AudioReverbR;
 
@@ -339,6 +741,7 @@ void SetAudoCompressiontype ( const EAudComprType eNAudCompressionType );
 
     bool                    bSndCrdConversionBufferRequired;
     int                     iSndCardMonoBlockSizeSamConvBuff;
+    int                     iSndCrdConvBufDelayMonoSam;
     CBufferBase<int16_t>    SndCrdConversionBufferIn;
     CBufferBase<int16_t>    SndCrdConversionBufferOut;
     CVector<int16_t>        vecDataConvBuf;
@@ -357,27 +760,53 @@ void SetAudoCompressiontype ( const EAudComprType eNAudCompressionType );
     bool                    bUseDefaultCentralServerAddress;
 
     CVector<int16_t>        vecsAudioSndCrdMono;
-    CVector<double>         vecdAudioStereo;
     CVector<int16_t>        vecsNetwork;
 
+    // floating point audio path (sound interfaces with floating point samples)
+    CVector<int16_t>        vecsFloatConvBuf;
+    CVector<float>          vecfAudioSndCrdMono;
+    CVector<float>          vecfNetwork;
+
     // server settings
     int                     iServerSockBufNumFrames;
 
+    // start values of the auto jitter buffer sizes (zero: not known) which are
+    // taken from a previous connection to the server and from the network
+    // probe
+    int                     iInitSockBufNumFrames;
+    int                     iInitServerSockBufNumFrames;
+    QTimer                  TimerProbe;
+    int                     iProbeCnt;
+    int                     iProbeNumReplies;
+    CVector<int>            veciProbeRttMs;
+
     // for ping measurement
     CPreciseTime            PreciseTime;
+    CRttStatistics          RttStats;
 
 public slots:
     void OnSendProtMessage ( CVector<uint8_t> vecMessage );
+    void OnSendP2PProtMessage ( CVector<uint8_t> vecMessage );
     void OnInvalidPacketReceived ( CVector<uint8_t> vecbyRecBuf,
                                    int              iNumBytesRead,
                                    CHostAddress     RecHostAddr );
     void OnDetectedCLMessage ( CVector<uint8_t> vecbyMesBodyData, int iRecID );
+    void OnDetectedP2PCLMessage ( CVector<uint8_t> vecbyMesBodyData, int iRecID );
+    void OnCLSendEmptyMes ( CHostAddress InetAddr, CHostAddress PeerInetAddr );
+    void OnConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
+    void OnP2PChanIDsReceived ( int iOwnChanID, int iPeerChanID );
     void OnReqJittBufSize() { CreateServerJitterBufferMessage(); }
     void OnJittBufSizeChanged ( int iNewJitBufSize );
-    void OnReqChanInfo() { Channel.SetRemoteInfo ( ChannelInfo ); }
+    void OnReqChanInfo() { SetRemoteInfo(); }
     void OnNewConnection();
     void OnCLPingReceived ( CHostAddress InetAddr,
                             int          iMs );
+    void OnCLProbeReceived ( CHostAddress InetAddr,
+                             int          iProbeIdx,
+                             int          iMs );
+    void OnTimerProbe();
+    void OnTimerSwitchServer();
+    void OnTimerChannelUpdate();
 
     void OnSendCLProtMessage ( CHostAddress InetAddr, CVector<uint8_t> vecMessage );
     void OnCLPingWithNumClientsReceived ( CHostAddress InetAddr,
@@ -389,6 +818,9 @@ public slots:
 // #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
 void OnOpusSupported();
 
+    void OnOpus64Supported();
+    void OnRawAudioSupported();
+
 signals:
     void ConClientListNameMesReceived ( CVector<CChannelInfo> vecChanInfo );
     void ConClientListMesReceived ( CVector<CChannelInfo> vecChanInfo );
@@ -397,9 +829,11 @@ signals:
     void CLServerListReceived ( CHostAddress         InetAddr,
                                 CVector<CServerInfo> vecServerInfo );
     void CLPingTimeWithNumClientsReceived ( CHostAddress InetAddr,
-                                            int          iPingTime,
+                                            int          iPingTimeUs,
                                             int          iNumClients );
     void Disconnected();
+    void ServerSwitched();
+    void ServerSwitchFailed();
 
 // #### COMPATIBILITY OLD VERSION, TO BE REMOVED ####
 void UpstreamRateChanged();
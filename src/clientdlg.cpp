@@ -476,6 +476,14 @@ CClientDlg::CClientDlg ( CClient*        pNCliP,
         SIGNAL ( Disconnected() ),
         this, SLOT ( OnDisconnected() ) );
 
+    QObject::connect ( pClient,
+        SIGNAL ( ServerSwitched() ),
+        this, SLOT ( OnServerSwitched() ) );
+
+    QObject::connect ( pClient,
+        SIGNAL ( ServerSwitchFailed() ),
+        this, SLOT ( OnServerSwitchFailed() ) );
+
     QObject::connect ( pClient,
         SIGNAL ( ChatTextReceived ( QString ) ),
         this, SLOT ( OnChatTextReceived ( QString ) ) );
@@ -661,15 +669,43 @@ void CClientDlg::OnConnectDlgAccepted()
         strMixerBoardLabel = strSelectedAddress;
     }
 
-    // first check if we are already connected, if this is the case we have to
-    // disconnect the old server first
+    // first check if we are already connected, if this is the case we switch
+    // to the new server without stopping the audio engine
     if ( pClient->IsRunning() )
     {
-        Disconnect();
+        if ( pClient->SwitchServer ( strSelectedAddress ) )
+        {
+            // the mixer board label is set as soon as the switch is done
+            strSwitchMixerBoardLabel = strMixerBoardLabel;
+        }
+        else
+        {
+            // show the error as red light
+            ledConnection->SetLight ( MUL_COL_LED_RED );
+        }
     }
+    else
+    {
+        // initiate connection
+        Connect ( strSelectedAddress, strMixerBoardLabel );
+    }
+}
 
-    // initiate connection
-    Connect ( strSelectedAddress, strMixerBoardLabel );
+void CClientDlg::OnServerSwitched()
+{
+    // the faders of the old server are removed, the new server sends its
+    // client list
+    MainMixerBoard->HideAll();
+    MainMixerBoard->SetServerName ( strSwitchMixerBoardLabel );
+
+    UpdateDisplay();
+}
+
+void CClientDlg::OnServerSwitchFailed()
+{
+    QMessageBox::warning ( this, APP_NAME, tr ( "The selected server does "
+        "not respond. The connection to the current server is kept." ),
+        "Close", 0 );
 }
 
 void CClientDlg::OnConnectDisconBut()
@@ -947,18 +983,18 @@ void CClientDlg::OnPingTimeResult ( int iPingTime )
 }
 
 void CClientDlg::OnCLPingTimeWithNumClientsReceived ( CHostAddress InetAddr,
-                                                      int          iPingTime,
+                                                      int          iPingTimeUs,
                                                       int          iNumClients )
 {
     // color definition: <= 25 ms green, <= 50 ms yellow, otherwise red
     int iPingTimeLEDColor;
-    if ( iPingTime <= 25 )
+    if ( iPingTimeUs <= 25000 )
     {
         iPingTimeLEDColor = MUL_COL_LED_GREEN;
     }
     else
     {
-        if ( iPingTime <= 50 )
+        if ( iPingTimeUs <= 50000 )
         {
             iPingTimeLEDColor = MUL_COL_LED_YELLOW;
         }
@@ -970,7 +1006,7 @@ void CClientDlg::OnCLPingTimeWithNumClientsReceived ( CHostAddress InetAddr,
 
     // update connection dialog server list
     ConnectDlg.SetPingTimeAndNumClientsResult ( InetAddr,
-                                                iPingTime,
+                                                iPingTimeUs,
                                                 iPingTimeLEDColor,
                                                 iNumClients );
 }
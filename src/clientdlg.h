@@ -98,6 +98,7 @@ protected:
     QTimer             TimerSigMet;
     QTimer             TimerStatus;
     QTimer             TimerPing;
+    QString            strSwitchMixerBoardLabel;
 
     virtual void       customEvent ( QEvent* Event );
     virtual void       closeEvent  ( QCloseEvent* Event );
@@ -124,7 +125,7 @@ public slots:
     void OnTimerPing();
     void OnPingTimeResult ( int iPingTime );
     void OnCLPingTimeWithNumClientsReceived ( CHostAddress InetAddr,
-                                              int          iPingTime,
+                                              int          iPingTimeUs,
                                               int          iNumClients );
 
     void OnOpenConnectionSetupDialog() { ShowConnectionSetupDialog(); }
@@ -170,6 +171,8 @@ public slots:
 
     void OnConnectDlgAccepted();
     void OnDisconnected();
+    void OnServerSwitched();
+    void OnServerSwitchFailed();
 
     void OnUpstreamRateChanged()
         { ClientSettingsDlg.UpdateDisplay(); }
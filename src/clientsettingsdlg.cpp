@@ -242,7 +242,9 @@ CClientSettingsDlg::CClientSettingsDlg ( CClient* pNCliP, QWidget* parent,
         "the server is too large or your internet connection is not "
         "sufficient.<br>"
         "The overall delay is calculated from the current ping time and the "
-        "delay which is introduced by the current buffer settings.<br>"
+        "delay which is introduced by the current buffer settings. If the "
+        "server supports it, the measured overall delay is shown next to it "
+        "(the tool tip shows the parts of the measured delay).<br>"
         "The upstream rate depends on the current audio packet size and the "
         "audio compression setting. Make sure that the upstream rate is not "
         "higher than the available rate (check the upstream capabilities of "
@@ -341,17 +343,6 @@ CClientSettingsDlg::CClientSettingsDlg ( CClient* pNCliP, QWidget* parent,
     }
     UpdateCentralServerDependency();
 
-    // set text for sound card buffer delay radio buttons
-    rbtBufferDelayPreferred->setText ( GenSndCrdBufferDelayString (
-        FRAME_SIZE_FACTOR_PREFERRED * SYSTEM_FRAME_SIZE_SAMPLES,
-        ", preferred" ) );
-
-    rbtBufferDelayDefault->setText ( GenSndCrdBufferDelayString (
-        FRAME_SIZE_FACTOR_DEFAULT * SYSTEM_FRAME_SIZE_SAMPLES ) );
-
-    rbtBufferDelaySafe->setText ( GenSndCrdBufferDelayString (
-        FRAME_SIZE_FACTOR_SAFE * SYSTEM_FRAME_SIZE_SAMPLES ) );
-
     // sound card buffer delay inits
     SndCrdBufferDelayButtonGroup.addButton ( rbtBufferDelayPreferred );
     SndCrdBufferDelayButtonGroup.addButton ( rbtBufferDelayDefault );
@@ -465,6 +456,21 @@ void CClientSettingsDlg::UpdateSoundCardFrame()
     const int iCurActualBufSize =
         pClient->GetSndCrdActualMonoBlSize();
 
+    // the frame size factors are relative to the current frame size (which
+    // depends on the audio codec)
+    const int iFrameSize = pClient->GetSystemFrameSize();
+
+    // set text for sound card buffer delay radio buttons
+    rbtBufferDelayPreferred->setText ( GenSndCrdBufferDelayString (
+        FRAME_SIZE_FACTOR_PREFERRED * iFrameSize,
+        ", preferred" ) );
+
+    rbtBufferDelayDefault->setText ( GenSndCrdBufferDelayString (
+        FRAME_SIZE_FACTOR_DEFAULT * iFrameSize ) );
+
+    rbtBufferDelaySafe->setText ( GenSndCrdBufferDelayString (
+        FRAME_SIZE_FACTOR_SAFE * iFrameSize ) );
+
     // Set radio buttons according to current value (To make it possible
     // to have all radio buttons unchecked, we have to disable the
     // exclusive check for the radio button group. We require all radio
@@ -474,13 +480,13 @@ void CClientSettingsDlg::UpdateSoundCardFrame()
     SndCrdBufferDelayButtonGroup.setExclusive ( false );
 
     rbtBufferDelayPreferred->setChecked ( iCurActualBufSize ==
-        SYSTEM_FRAME_SIZE_SAMPLES * FRAME_SIZE_FACTOR_PREFERRED );
+        iFrameSize * FRAME_SIZE_FACTOR_PREFERRED );
 
     rbtBufferDelayDefault->setChecked ( iCurActualBufSize ==
-        SYSTEM_FRAME_SIZE_SAMPLES * FRAME_SIZE_FACTOR_DEFAULT );
+        iFrameSize * FRAME_SIZE_FACTOR_DEFAULT );
 
     rbtBufferDelaySafe->setChecked ( iCurActualBufSize ==
-        SYSTEM_FRAME_SIZE_SAMPLES * FRAME_SIZE_FACTOR_SAFE );
+        iFrameSize * FRAME_SIZE_FACTOR_SAFE );
 
     SndCrdBufferDelayButtonGroup.setExclusive ( true );
 
@@ -721,9 +727,82 @@ void CClientSettingsDlg::SetPingTimeResult ( const int iPingTime,
     }
     else
     {
-        lblPingTimeValue->setText ( QString().setNum ( iPingTime ) + " ms" );
-        lblOverallDelayValue->setText (
-            QString().setNum ( iOverallDelayMs ) + " ms" );
+        QString strPingTime = QString().setNum ( iPingTime ) + " ms";
+
+        // in peer-to-peer mode compare with the ping time of the direct path
+        // to the peer, the path which is currently used is shown in bold
+        const int iP2PPingTime = pClient->GetP2PPingTime();
+
+        if ( iP2PPingTime >= 0 )
+        {
+            const QString strP2PPingTime =
+                "P2P " + QString().setNum ( iP2PPingTime ) + " ms";
+
+            if ( pClient->IsP2PActive() )
+            {
+                strPingTime += " / <b>" + strP2PPingTime + "</b>";
+            }
+            else
+            {
+                strPingTime = "<b>" + strPingTime + "</b> / " + strP2PPingTime;
+            }
+        }
+
+        lblPingTimeValue->setText ( strPingTime );
+
+        // the measured delay is shown next to the estimated one, the tool tip
+        // shows how the measured delay is composed
+        QString strOverallDelay = QString().setNum ( iOverallDelayMs ) + " ms";
+        QString strDelayToolTip;
+
+        const int iMeasuredDelayMs = pClient->MeasuredOverallDelay();
+
+        if ( iMeasuredDelayMs >= 0 )
+        {
+            strOverallDelay += tr ( " / measured " ) +
+                QString().setNum ( iMeasuredDelayMs ) + " ms";
+
+            strDelayToolTip = tr ( "Sound card (estimated): " ) +
+                QString().setNum ( pClient->GetSndCrdDelayMs(), 'f', 1 ) + " ms";
+
+            const double dMarkerDelayMs = pClient->GetLatencyMarkerDelayMs();
+            const double dRoundTripMs   = pClient->GetMeasuredRoundTripMs();
+
+            if ( dMarkerDelayMs >= 0 )
+            {
+                strDelayToolTip += "<br>" + tr ( "Latency marker (measured): " ) +
+                    QString().setNum ( dMarkerDelayMs, 'f', 1 ) + " ms";
+            }
+            else
+            {
+                strDelayToolTip += "<br>" + tr ( "Packets and audio codec (estimated): " ) +
+                    QString().setNum ( pClient->GetPacketAndCodecDelayMs(), 'f', 1 ) + " ms";
+            }
+
+            if ( dRoundTripMs >= 0 )
+            {
+                strDelayToolTip += "<br>" + tr ( "Network and jitter buffers (measured): " ) +
+                    QString().setNum ( dRoundTripMs, 'f', 1 ) + " ms";
+            }
+        }
+
+        // the latency marker is part of our transmitted signal, make sure the
+        // user knows that everybody on the server hears it
+        if ( pClient->GetLatencyMarker() )
+        {
+            if ( !strDelayToolTip.isEmpty() )
+            {
+                strDelayToolTip += "<br>";
+            }
+
+            strDelayToolTip += tr ( "<b>Note:</b> The latency marker is a loud "
+                "burst which is sent every " ) +
+                QString().setNum ( LATENCY_MARKER_INTERVAL_MS / 1000 ) +
+                tr ( " seconds and is audible to all musicians on the server." );
+        }
+
+        lblOverallDelayValue->setText    ( strOverallDelay );
+        lblOverallDelayValue->setToolTip ( strDelayToolTip );
     }
 
     // set current LED status
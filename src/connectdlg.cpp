@@ -152,8 +152,9 @@ void CConnectDlg::showEvent ( QShowEvent* )
     strSelectedAddress    = "";
     strSelectedServerName = "";
 
-    // clear server list view
+    // clear server list view and the ping statistics
     lvwServers->clear();
+    mapRttStats.clear();
 
     // get the IP address of the central server (using the ParseNetworAddress
     // function) when the connect dialog is opened, this seems to be the correct
@@ -379,10 +380,16 @@ void CConnectDlg::OnTimerPing()
 }
 
 void CConnectDlg::SetPingTimeAndNumClientsResult ( CHostAddress& InetAddr,
-                                                   const int     iPingTime,
+                                                   const int     iPingTimeUs,
                                                    const int     iPingTimeLEDColor,
                                                    const int     iNumClients )
 {
+    const int iPingTime = MathUtils::round ( iPingTimeUs / 1000.0 );
+
+    // update the round trip time statistic of the server
+    CRttStatistics& RttStats = mapRttStats[InetAddr.toString()];
+    RttStats.Update ( iPingTimeUs );
+
     // apply the received ping time to the correct server list entry
     const int iServerListLen = lvwServers->topLevelItemCount();
 
@@ -425,6 +432,10 @@ void CConnectDlg::SetPingTimeAndNumClientsResult ( CHostAddress& InetAddr,
                     setText ( 1, QString().setNum ( iPingTime ) + " ms" );
             }
 
+            lvwServers->topLevelItem ( iIdx )->setToolTip ( 1,
+                tr ( "Ping time " ) + RttStats.GetText() + " (" +
+                QString().setNum ( RttStats.GetNumValues() ) + tr ( " pings)" ) );
+
             // update number of clients text
             lvwServers->topLevelItem ( iIdx )->
                 setText ( 2, QString().setNum ( iNumClients ) );
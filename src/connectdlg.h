@@ -29,6 +29,7 @@
 #include <QTimer>
 #include <QMutex>
 #include <QLocale>
+#include <QMap>
 #include "global.h"
 #include "client.h"
 #include "ui_connectdlgbase.h"
@@ -57,7 +58,7 @@ public:
                          const CVector<CServerInfo>& vecServerInfo );
 
     void SetPingTimeAndNumClientsResult ( CHostAddress& InetAddr,
-                                          const int     iPingTime,
+                                          const int     iPingTimeUs,
                                           const int     iPingTimeLEDColor,
                                           const int     iNumClients );
 
@@ -80,6 +81,9 @@ protected:
     bool             bServerListReceived;
     bool             bServerListItemWasChosen;
 
+    // round trip time statistic of each server (key is the address string)
+    QMap<QString, CRttStatistics> mapRttStats;
+
 public slots:
     void OnServerListItemSelectionChanged();
     void OnServerListItemDoubleClicked ( QTreeWidgetItem* Item, int );
@@ -69,16 +69,12 @@ LED bar:      lbr
 // does not effect the stability of the audio stream (e.g. if the GUI is on
 // high load because of a table update, the incoming network packets must still
 // be put in the jitter buffer with highest priority).
-// Since the new code is still in "experimental state", we introduced this macro
-// to enable/disable the new code.
-//
-// I disabled the new code again since it seems not to improve the situation
-// much. Maybe things must be tweaked for it to work correctly. Since the more
-// threads we have the higher is the risk of software crashes, I will only
-// enable the new code on significant performance gain.
-//
-//#define ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
-#undef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
+// The socket device runs in the socket thread (not only the socket object), the
+// audio packets are handed over to the audio thread without a mutex and the
+// protocol messages are parsed in the GUI thread (queued signal). Only the
+// client uses the separate socket thread. The macro can be undefined to get
+// the old behaviour where all packets are received in the GUI thread.
+#define ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
 
 // define this macro to get debug output
 //#define _DEBUG_
@@ -120,6 +116,11 @@ LED bar:      lbr
     ( static_cast<double> ( SYSTEM_FRAME_SIZE_SAMPLES ) / \
     SYSTEM_SAMPLE_RATE_HZ * 1000 )
 
+// small frame size for ultra low latency sessions (runtime option of the
+// server, the clients use it if the server supports it, the frame size
+// factors are then relative to this frame size)
+#define SYSTEM_FRAME_SIZE_SAMPLES_SMALL 64
+
 // define the allowed audio frame size factors (since the
 // "SYSTEM_FRAME_SIZE_SAMPLES" is quite small, it may be that on some
 // computers a larger value is required)
@@ -151,6 +152,14 @@ LED bar:      lbr
 // default network buffer size
 #define DEF_NET_BUF_SIZE_NUM_BL         10 // number of blocks
 
+// network buffer size for co-located clients which use the local transport
+// (the packets have almost no jitter)
+#define LOCAL_NET_BUF_SIZE_NUM_BL       2  // number of blocks
+
+// maximum number of frames which are protected by one redundancy frame (one
+// means that each packet carries a copy of the previous frame)
+#define MAX_NUM_REDUNDANCY_FRAMES       8
+
 // audio mixer fader maximum value
 #define AUD_MIX_FADER_MAX               100
 
@@ -171,6 +180,12 @@ LED bar:      lbr
 // maximum number of fader levels to be stored (together with the fader tags)
 #define MAX_NUM_STORED_FADER_LEVELS     10
 
+// maximum number of submix bus gains to be stored (together with the bus names)
+#define MAX_NUM_STORED_BUS_GAINS        8
+
+// maximum number of servers for which the jitter buffer sizes are stored
+#define MAX_NUM_STORED_JIT_BUF_SIZES    10
+
 // defines for LED input level meter
 #define NUM_STEPS_INP_LEV_METER         8
 #define RED_BOUND_INP_LEV_METER         7
@@ -220,6 +235,7 @@ LED bar:      lbr
 // this additionl HTML code. Right now the length of the HTML code is approx. 66
 // character. Here, we add some headroom to this number)
 #define MAX_LEN_FADER_TAG               16
+#define MAX_LEN_BUS_NAME                16
 #define MAX_LEN_CHAT_TEXT               1600
 #define MAX_LEN_CHAT_TEXT_PLUS_HTML     1800
 #define MAX_LEN_SERVER_NAME             20
@@ -61,6 +61,10 @@ int main ( int argc, char** argv )
     bool    bShowComplRegConnList     = false;
     bool    bShowAnalyzerConsole      = false;
     bool    bCentServPingServerInList = false;
+    bool    bUseForwarding            = false;
+    bool    bUseFastUpdate            = false;
+    bool    bUseLatencyMarker         = false;
+    bool    bLogProcTime              = false;
     int     iNumServerChannels        = DEFAULT_USED_NUM_CHANNELS;
     quint16 iPortNumber               = LLCON_DEFAULT_PORT_NUMBER;
     QString strIniFileName            = "";
@@ -71,6 +75,7 @@ int main ( int argc, char** argv )
     QString strCentralServer          = "";
     QString strServerInfo             = "";
     QString strWelcomeMessage         = "";
+    QString strFederationUpstream     = "";
 
     // QT docu: argv()[0] is the program name, argv()[1] is the first
     // argument and argv()[argc()-1] is the last argument.
@@ -307,6 +312,59 @@ int main ( int argc, char** argv )
         }
 
 
+        // Relay mode (forward streams) ----------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "-r",
+                               "--relay" ) )
+        {
+            bUseForwarding = true;
+            tsConsole << "- relay mode: forward streams to clients which mix locally" << endl;
+            continue;
+        }
+
+
+        // Fast update (small frame size) --------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "-F",
+                               "--fastupdate" ) )
+        {
+            bUseFastUpdate = true;
+            tsConsole << "- fast update: use the small frame size of " <<
+                SYSTEM_FRAME_SIZE_SAMPLES_SMALL << " samples (no relay, "
+                "federation or peer-to-peer)" << endl;
+            continue;
+        }
+
+
+        // Processing time statistic -------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "-T",
+                               "--proctime" ) )
+        {
+            bLogProcTime = true;
+            tsConsole << "- log the processing time of the server timer tick" << endl;
+            continue;
+        }
+
+
+        // Server federation (upstream server) ---------------------------------
+        if ( GetStringArgument ( tsConsole,
+                                 argc,
+                                 argv,
+                                 i,
+                                 "-f",
+                                 "--federate",
+                                 strArgument ) )
+        {
+            strFederationUpstream = strArgument;
+            tsConsole << "- federation upstream server: " << strFederationUpstream << endl;
+            continue;
+        }
+
+
         // Initialization file -------------------------------------------------
         if ( GetStringArgument ( tsConsole,
                                  argc,
@@ -334,6 +392,19 @@ int main ( int argc, char** argv )
         }
 
 
+        // Latency marker ------------------------------------------------------
+        if ( GetFlagArgument ( argv,
+                               i,
+                               "-L",
+                               "--latencymarker" ) )
+        {
+            bUseLatencyMarker = true;
+            tsConsole << "- latency marker enabled (audible to all musicians "
+                "on the server)" << endl;
+            continue;
+        }
+
+
         // Help (usage) flag ---------------------------------------------------
         if ( ( !strcmp ( argv[i], "--help" ) ) ||
              ( !strcmp ( argv[i], "-h" ) ) ||
@@ -366,6 +437,16 @@ int main ( int argc, char** argv )
         strCentralServer = DEFAULT_SERVER_ADDRESS;
     }
 
+    // the federation link uses the normal frame size, therefore it cannot be
+    // combined with the fast update mode
+    if ( !bIsClient && bUseFastUpdate && !strFederationUpstream.isEmpty() )
+    {
+        tsConsole << argv[0] << ": the options '--federate' and "
+            "'--fastupdate' cannot be combined" << endl;
+
+        exit ( 1 );
+    }
+
 
     // Application/GUI setup ---------------------------------------------------
     // Application object
@@ -397,6 +478,22 @@ int main ( int argc, char** argv )
 // TEST -> activate the following line to activate the test bench,
 //CTestbench Testbench ( "127.0.0.1", LLCON_DEFAULT_PORT_NUMBER );
 
+// TEST -> activate the following line to compare the reverberation with the
+// reference implementation and to measure its processing time
+//CAudioReverbTestbench AudioReverbTestbench;
+
+// TEST -> activate the following line to compare the ring buffer with the
+// element-wise reference implementation and to measure its processing time
+//CBufferBaseTestbench BufferBaseTestbench;
+
+// TEST -> activate the following line to compare the bit-packed error rate
+// history with the byte history and to measure its update time
+//CMovingAvBitTestbench MovingAvBitTestbench;
+
+// TEST -> activate the following line to check the jitter buffer with
+// reordered, duplicated, late and lost packets and redundancy frames
+//CNetBufTestbench NetBufTestbench;
+
 
     try
     {
@@ -410,6 +507,11 @@ int main ( int argc, char** argv )
             CSettings Settings ( &Client, strIniFileName );
             Settings.Load();
 
+            // the latency marker is audible to all musicians on the server,
+            // therefore it is not stored in the settings but must be enabled
+            // on each start
+            Client.SetLatencyMarker ( bUseLatencyMarker );
+
             // GUI object
             CClientDlg ClientDlg ( &Client,
                                    &Settings,
@@ -441,7 +543,11 @@ int main ( int argc, char** argv )
                              strCentralServer,
                              strServerInfo,
                              strWelcomeMessage,
-                             bCentServPingServerInList );
+                             bCentServPingServerInList,
+                             strFederationUpstream,
+                             bUseForwarding,
+                             bUseFastUpdate,
+                             bLogProcTime );
 
             if ( bUseGUI )
             {
@@ -525,11 +631,20 @@ QString UsageArguments ( char **argv )
         "                        only)\n"
         "  -d, --disableleds     disable LEDs in main window (client only)\n"
         "  -e, --centralserver   address of the central server (server only)\n"
+        "  -f, --federate        link to an upstream server and exchange the\n"
+        "                        submix of the local clients, not with\n"
+        "                        --fastupdate (server only)\n"
+        "  -F, --fastupdate      use a frame size of 64 samples for a lower\n"
+        "                        latency, requires a fast network and CPU\n"
+        "                        (server only)\n"
         "  -g, --pingservers     ping servers in list to keep NAT port open\n"
         "                        (central server only)\n"
         "  -h, -?, --help        this help text\n"
         "  -i, --inifile         initialization file name (client only)\n"
         "  -l, --log             enable logging, set file name\n"
+        "  -L, --latencymarker   send a loud burst every two seconds to measure\n"
+        "                        the overall delay, audible to all musicians\n"
+        "                        on the server (client only)\n"
         "  -m, --htmlstatus      enable HTML status file, set file name (server\n"
         "                        only)\n"
         "  -n, --nogui           disable GUI (server only)\n"
@@ -540,7 +655,12 @@ QString UsageArguments ( char **argv )
         "                        [server1 country as QLocale ID]; ...\n"
         "                        [server2 address]; ... (server only)\n"
         "  -p, --port            local port number (server only)\n"
+        "  -r, --relay           forward the streams of all clients to the\n"
+        "                        clients which support local mixing (server\n"
+        "                        only)\n"
         "  -s, --server          start server\n"
+        "  -T, --proctime        log the processing time of the server timer\n"
+        "                        tick every 10 seconds (server only)\n"
         "  -u, --numchannels     maximum number of channels (server only)\n"
         "  -w, --welcomemessage  welcome message on connect (server only)\n"
         "  -y, --history         enable connection history and set file\n"
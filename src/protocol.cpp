@@ -152,9 +152,14 @@ MESSAGES (with connection)
                          stereo
     - "sam rate":        sample rate of the audio stream
     - "audiocod type":   audio coding type, the following types are supported:
-                          - 0: none, no audio coding applied
+                          - 0: none, no audio coding applied, the samples
+                               are transmitted as 16 bit PCM in little endian
+                               byte order (interleaved for stereo)
                           - 1: CELT
                           - 2: OPUS
+                          - 3: OPUS64, OPUS with a frame size of 64 samples
+                               (the block size factor is relative to this
+                               frame size)
     - "version":         version of the audio coder, if not used this value
                          shall be set to 0
     - "audiocod arg":    argument for the audio coder, if not used this value
@@ -172,6 +177,151 @@ MESSAGES (with connection)
     note: does not have any data -> n = 0
 
 
+- PROTMESSID_FEDERATION_LINK: Informs the server that the peer of this channel
+                              is not a client but a linked (downstream) server
+                              which sends the submix of its local clients
+
+    note: does not have any data -> n = 0
+
+
+- PROTMESSID_CHANNEL_BUS: Name of the submix bus (group) the channel belongs to
+
+    +------------------+----------------------+
+    | 2 bytes number n | n bytes UTF-8 string |
+    +------------------+----------------------+
+
+    - an empty string means that the channel does not belong to any bus
+
+
+- PROTMESSID_BUS_GAIN: Gain of a submix bus
+
+    +------------------+----------------------+--------------+
+    | 2 bytes number n | n bytes UTF-8 string | 2 bytes gain |
+    +------------------+----------------------+--------------+
+
+    - the string is the name of the bus, the gain has the same format as in
+      the PROTMESSID_CHANNEL_GAIN message
+
+
+- PROTMESSID_REQ_FORWARDING: Request the server to forward the coded audio
+                             streams of all channels instead of sending a mix
+
+    note: does not have any data -> n = 0
+
+
+- PROTMESSID_FORWARDING: Informs the client that the server forwards the coded
+                         audio streams of all other channels, the client has
+                         to mix them locally with its own signal (the gain of
+                         its own channel ID is applied to the own signal)
+
+    +--------------------------+
+    | 1 byte own channel ID    |
+    +--------------------------+
+
+
+- PROTMESSID_REQ_P2P: Request a direct peer-to-peer audio connection, if
+                      exactly two clients are connected which both requested
+                      it, the server sends to each of them a
+                      PROTMESSID_CLM_SEND_EMPTY_MESSAGE with the address of
+                      the other client and a PROTMESSID_P2P_CHANNEL_IDS message
+
+    note: does not have any data -> n = 0
+
+
+- PROTMESSID_SEQ_NUM_SUPPORTED: Informs that audio packets with a sequence
+                                number are supported, i.e., the sender of
+                                this message accepts audio packets which have
+                                one additional byte with the sequence number
+                                (modulo 256) appended to the coded audio data
+
+    note: does not have any data -> n = 0
+
+
+- PROTMESSID_REQ_REDUNDANCY: Request redundancy in the audio packets, the
+                             receiver of this message appends to each k-th
+                             audio packet the XOR of the coded audio data of
+                             the previous k packets (for k = 1 this is a copy
+                             of the previous packet) so that a lost packet
+                             can be recovered, requires sequence numbers
+
+    +------------------+
+    | 1 byte number k  |
+    +------------------+
+
+    - k = 0 disables the redundancy, the maximum value is
+      MAX_NUM_REDUNDANCY_FRAMES
+
+
+- PROTMESSID_OPUS64_SUPPORTED: Informs that OPUS with a frame size of 64
+                               samples is supported (the server runs with
+                               the small frame size)
+
+    note: does not have any data -> n = 0
+
+
+- PROTMESSID_RAW_AUDIO_SUPPORTED: Informs that uncompressed audio (audio
+                                  coding type "none") is supported
+
+    note: does not have any data -> n = 0
+
+
+- PROTMESSID_MIX_MINUS: Requests that the own signal is excluded from the mix
+                        which is sent back (the sender monitors its own
+                        signal locally)
+
+    +---------------------+
+    | 1 byte mix-minus on |
+    +---------------------+
+
+    - 1: own signal is excluded from the mix, 0: own signal is in the mix
+
+
+- PROTMESSID_LATENCY_PROBE: Time stamp of an audio frame which was sent, the
+                            receiver answers with the echo message as soon as
+                            the frame was taken out of its jitter buffer
+
+    +--------------------+-------------------------+
+    | 1 byte sequence no | 4 bytes time stamp (us) |
+    +--------------------+-------------------------+
+
+    - the sequence number is the one of the audio packet
+    - the time stamp is given in the time base of the sender (wraps around)
+
+
+- PROTMESSID_LATENCY_PROBE_ECHO: Echo of the time stamp of a latency probe
+
+    +--------------------+-------------------------+
+    | 1 byte sequence no | 4 bytes time stamp (us) |
+    +--------------------+-------------------------+
+
+    - the sequence number is the one of the audio packet which contains the
+      mix with the probed frame
+    - the time stamp is the one of the latency probe message
+
+
+- PROTMESSID_CHANNEL_GAIN_OVERRIDE: Gain of a channel which replaces the bus
+                                    gain of the bus the channel belongs to
+
+    +-------------------+--------------------+--------------+
+    | 1 byte channel ID | 1 byte override on | 2 bytes gain |
+    +-------------------+--------------------+--------------+
+
+    - 1: the gain replaces the bus gain, 0: the override is cleared and the
+      channel is mixed with the bus gain again
+    - the gain has the same format as in the PROTMESSID_CHANNEL_GAIN message
+    - the gain of the PROTMESSID_CHANNEL_GAIN message is not applied to a
+      channel which belongs to a bus
+
+
+- PROTMESSID_P2P_CHANNEL_IDS: Channel IDs of the two clients of a direct
+                              peer-to-peer connection, the client applies its
+                              channel gains of these IDs to the local mix
+
+    +--------------------------+---------------------------+
+    | 1 byte own channel ID    | 1 byte peer channel ID    |
+    +--------------------------+---------------------------+
+
+
 CONNECTION LESS MESSAGES
 ------------------------
 
@@ -179,9 +329,12 @@ CONNECTION LESS MESSAGES
                           time)
 
     +-----------------------------+
-    | 4 bytes transmit time in ms |
+    | 4 bytes transmit time stamp |
     +-----------------------------+
 
+    - the time stamp is returned unchanged, its unit is only known by the
+      sender (ms in old versions, us in current versions)
+
 
 - PROTMESSID_CLM_PING_MS_WITHNUMCLIENTS: Connection less ping message (for
                                          measuring the ping time) with the
@@ -189,7 +342,7 @@ CONNECTION LESS MESSAGES
                                          connected clients
 
     +-----------------------------+---------------------------------+
-    | 4 bytes transmit time in ms | 1 byte number connected clients |
+    | 4 bytes transmit time stamp | 1 byte number connected clients |
     +-----------------------------+---------------------------------+
 
 
@@ -263,6 +416,15 @@ CONNECTION LESS MESSAGES
     note: does not have any data -> n = 0
 
 
+- PROTMESSID_CLM_PROBE: Network probe message (a burst of these messages is
+                        sent before connecting, the server returns each
+                        message unchanged)
+
+    +----------------------+-----------------------------+
+    | 2 bytes probe number | 4 bytes transmit time stamp |
+    +----------------------+-----------------------------+
+
+
  ******************************************************************************
  *
  * This program is free software; you can redistribute it and/or modify it under
@@ -546,6 +708,66 @@ case PROTMESSID_CHANNEL_NAME:
 case PROTMESSID_OPUS_SUPPORTED:
     bRet = EvaluateOpusSupportedMes();
     break;
+
+            case PROTMESSID_FEDERATION_LINK:
+                bRet = EvaluateFederationLinkMes();
+                break;
+
+            case PROTMESSID_CHANNEL_BUS:
+                bRet = EvaluateChanBusMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_BUS_GAIN:
+                bRet = EvaluateBusGainMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_REQ_FORWARDING:
+                bRet = EvaluateReqForwardingMes();
+                break;
+
+            case PROTMESSID_FORWARDING:
+                bRet = EvaluateForwardingMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_REQ_P2P:
+                bRet = EvaluateReqP2PMes();
+                break;
+
+            case PROTMESSID_SEQ_NUM_SUPPORTED:
+                bRet = EvaluateSeqNumSupportedMes();
+                break;
+
+            case PROTMESSID_REQ_REDUNDANCY:
+                bRet = EvaluateReqRedundancyMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_OPUS64_SUPPORTED:
+                bRet = EvaluateOpus64SupportedMes();
+                break;
+
+            case PROTMESSID_RAW_AUDIO_SUPPORTED:
+                bRet = EvaluateRawAudioSupportedMes();
+                break;
+
+            case PROTMESSID_MIX_MINUS:
+                bRet = EvaluateMixMinusMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_LATENCY_PROBE:
+                bRet = EvaluateLatencyProbeMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_LATENCY_PROBE_ECHO:
+                bRet = EvaluateLatencyProbeEchoMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_CHANNEL_GAIN_OVERRIDE:
+                bRet = EvaluateChanGainOverrideMes ( vecbyMesBodyData );
+                break;
+
+            case PROTMESSID_P2P_CHANNEL_IDS:
+                bRet = EvaluateP2PChanIDsMes ( vecbyMesBodyData );
+                break;
             }
 
             // immediately send acknowledge message
@@ -630,7 +852,7 @@ if ( rand() < ( RAND_MAX / 2 ) ) return false;
             break;
 
         case PROTMESSID_CLM_SEND_EMPTY_MESSAGE:
-            bRet = EvaluateCLSendEmptyMesMes ( vecbyMesBodyData );
+            bRet = EvaluateCLSendEmptyMesMes ( InetAddr, vecbyMesBodyData );
             break;
 
         case PROTMESSID_CLM_REGISTER_SERVER:
@@ -644,6 +866,10 @@ if ( rand() < ( RAND_MAX / 2 ) ) return false;
         case PROTMESSID_CLM_DISCONNECTION:
             bRet = EvaluateCLDisconnectionMes ( InetAddr );
             break;
+
+        case PROTMESSID_CLM_PROBE:
+            bRet = EvaluateCLProbeMes ( InetAddr, vecbyMesBodyData );
+            break;
         }
     }
     else
@@ -1294,7 +1520,8 @@ bool CProtocol::EvaluateNetwTranspPropsMes ( const CVector<uint8_t>& vecData )
 
     if ( ( iRecCodingType != CT_NONE ) &&
          ( iRecCodingType != CT_CELT ) &&
-         ( iRecCodingType != CT_OPUS ) )
+         ( iRecCodingType != CT_OPUS ) &&
+         ( iRecCodingType != CT_OPUS64 ) )
     {
         return true;
     }
@@ -1344,6 +1571,492 @@ bool CProtocol::EvaluateOpusSupportedMes()
     return false; // no error
 }
 
+void CProtocol::CreateFederationLinkMes()
+{
+    CreateAndSendMessage ( PROTMESSID_FEDERATION_LINK,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateFederationLinkMes()
+{
+    // invoke message action
+    emit FederationLinkReceived();
+
+    return false; // no error
+}
+
+void CProtocol::CreateChanBusMes ( const QString strBusName )
+{
+    int iPos = 0; // init position pointer
+
+    // convert bus name string to utf-8
+    const QByteArray strUTF8BusName = strBusName.toUtf8();
+
+    // size of message body
+    const int iEntrLen = 2 /* utf-8 string size */ + strUTF8BusName.size();
+
+    // build data vector
+    CVector<uint8_t> vecData ( iEntrLen );
+
+    // bus name
+    PutStringUTF8OnStream ( vecData, iPos, strUTF8BusName );
+
+    CreateAndSendMessage ( PROTMESSID_CHANNEL_BUS, vecData );
+}
+
+bool CProtocol::EvaluateChanBusMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // bus name
+    QString strBusName;
+    if ( GetStringFromStream ( vecData,
+                               iPos,
+                               MAX_LEN_BUS_NAME,
+                               strBusName ) )
+    {
+        return true; // return error code
+    }
+
+    // check size: all data is read, the position must now be at the end
+    if ( iPos != vecData.Size() )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit ChangeChanBus ( strBusName );
+
+    return false; // no error
+}
+
+void CProtocol::CreateBusGainMes ( const QString strBusName,
+                                   const double  dGain )
+{
+    int iPos = 0; // init position pointer
+
+    // convert bus name string to utf-8
+    const QByteArray strUTF8BusName = strBusName.toUtf8();
+
+    // size of message body
+    const int iEntrLen = 2 /* utf-8 string size */ + strUTF8BusName.size() +
+                         2 /* gain */;
+
+    // build data vector
+    CVector<uint8_t> vecData ( iEntrLen );
+
+    // bus name
+    PutStringUTF8OnStream ( vecData, iPos, strUTF8BusName );
+
+    // actual gain, we convert from double with range 0..1 to integer
+    const int iCurGain = static_cast<int> ( dGain * ( 1 << 15 ) );
+
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iCurGain ), 2 );
+
+    CreateAndSendMessage ( PROTMESSID_BUS_GAIN, vecData );
+}
+
+bool CProtocol::EvaluateBusGainMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // bus name
+    QString strBusName;
+    if ( GetStringFromStream ( vecData,
+                               iPos,
+                               MAX_LEN_BUS_NAME,
+                               strBusName ) )
+    {
+        return true; // return error code
+    }
+
+    // check size
+    if ( vecData.Size() - iPos != 2 )
+    {
+        return true; // return error code
+    }
+
+    // gain (read integer value)
+    const int iData =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+
+    // we convert the gain from integer to double with range 0..1
+    const double dNewGain = static_cast<double> ( iData ) / ( 1 << 15 );
+
+    // invoke message action
+    emit ChangeBusGain ( strBusName, dNewGain );
+
+    return false; // no error
+}
+
+void CProtocol::CreateReqForwardingMes()
+{
+    CreateAndSendMessage ( PROTMESSID_REQ_FORWARDING,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateReqForwardingMes()
+{
+    // invoke message action
+    emit ReqForwarding();
+
+    return false; // no error
+}
+
+void CProtocol::CreateForwardingMes ( const int iOwnChanID )
+{
+    int iPos = 0; // init position pointer
+
+    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
+
+    // own channel ID
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iOwnChanID ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_FORWARDING, vecData );
+}
+
+bool CProtocol::EvaluateForwardingMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 1 )
+    {
+        return true; // return error code
+    }
+
+    // own channel ID
+    const int iOwnChanID =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( iOwnChanID >= MAX_NUM_CHANNELS )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit ForwardingReceived ( iOwnChanID );
+
+    return false; // no error
+}
+
+void CProtocol::CreateReqP2PMes()
+{
+    CreateAndSendMessage ( PROTMESSID_REQ_P2P,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateReqP2PMes()
+{
+    // invoke message action
+    emit ReqP2P();
+
+    return false; // no error
+}
+
+void CProtocol::CreateSeqNumSupportedMes()
+{
+    CreateAndSendMessage ( PROTMESSID_SEQ_NUM_SUPPORTED,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateSeqNumSupportedMes()
+{
+    // invoke message action
+    emit SeqNumSupported();
+
+    return false; // no error
+}
+
+void CProtocol::CreateReqRedundancyMes ( const int iNumFrames )
+{
+    int iPos = 0; // init position pointer
+
+    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
+
+    // number of frames protected by one redundancy frame
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( iNumFrames ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_REQ_REDUNDANCY, vecData );
+}
+
+bool CProtocol::EvaluateReqRedundancyMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 1 )
+    {
+        return true; // return error code
+    }
+
+    // number of frames protected by one redundancy frame
+    const int iData =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( iData > MAX_NUM_REDUNDANCY_FRAMES )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit ReqRedundancy ( iData );
+
+    return false; // no error
+}
+
+void CProtocol::CreateOpus64SupportedMes()
+{
+    CreateAndSendMessage ( PROTMESSID_OPUS64_SUPPORTED,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateOpus64SupportedMes()
+{
+    // invoke message action
+    emit Opus64Supported();
+
+    return false; // no error
+}
+
+void CProtocol::CreateRawAudioSupportedMes()
+{
+    CreateAndSendMessage ( PROTMESSID_RAW_AUDIO_SUPPORTED,
+                           CVector<uint8_t> ( 0 ) );
+}
+
+bool CProtocol::EvaluateRawAudioSupportedMes()
+{
+    // invoke message action
+    emit RawAudioSupported();
+
+    return false; // no error
+}
+
+void CProtocol::CreateMixMinusMes ( const bool bMixMinus )
+{
+    int iPos = 0; // init position pointer
+
+    CVector<uint8_t> vecData ( 1 ); // 1 byte of data
+
+    // mix-minus flag
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bMixMinus ? 1 : 0 ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_MIX_MINUS, vecData );
+}
+
+bool CProtocol::EvaluateMixMinusMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 1 )
+    {
+        return true; // return error code
+    }
+
+    // mix-minus flag
+    const int iData =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( ( iData != 0 ) && ( iData != 1 ) )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit MixMinus ( iData == 1 );
+
+    return false; // no error
+}
+
+void CProtocol::CreateLatencyProbeMes ( const int iSeqNum,
+                                        const int iTimeStampUs )
+{
+    int iPos = 0; // init position pointer
+
+    CVector<uint8_t> vecData ( 5 ); // 5 bytes of data
+
+    // sequence number (1 byte)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iSeqNum ), 1 );
+
+    // time stamp (4 bytes)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iTimeStampUs ), 4 );
+
+    CreateAndSendMessage ( PROTMESSID_LATENCY_PROBE, vecData );
+}
+
+bool CProtocol::EvaluateLatencyProbeMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 5 )
+    {
+        return true; // return error code
+    }
+
+    // sequence number
+    const int iSeqNum =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // time stamp
+    const int iTimeStampUs =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+
+    // invoke message action
+    emit LatencyProbe ( iSeqNum, iTimeStampUs );
+
+    return false; // no error
+}
+
+void CProtocol::CreateLatencyProbeEchoMes ( const int iSeqNum,
+                                            const int iTimeStampUs )
+{
+    int iPos = 0; // init position pointer
+
+    CVector<uint8_t> vecData ( 5 ); // 5 bytes of data
+
+    // sequence number (1 byte)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iSeqNum ), 1 );
+
+    // time stamp (4 bytes)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iTimeStampUs ), 4 );
+
+    CreateAndSendMessage ( PROTMESSID_LATENCY_PROBE_ECHO, vecData );
+}
+
+bool CProtocol::EvaluateLatencyProbeEchoMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 5 )
+    {
+        return true; // return error code
+    }
+
+    // sequence number
+    const int iSeqNum =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // time stamp
+    const int iTimeStampUs =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+
+    // invoke message action
+    emit LatencyProbeEcho ( iSeqNum, iTimeStampUs );
+
+    return false; // no error
+}
+
+void CProtocol::CreateChanGainOverrideMes ( const int    iChanID,
+                                            const bool   bOverride,
+                                            const double dGain )
+{
+    int iPos = 0; // init position pointer
+
+    CVector<uint8_t> vecData ( 4 ); // 4 bytes of data
+
+    // channel ID
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iChanID ), 1 );
+
+    // override flag
+    PutValOnStream ( vecData, iPos,
+        static_cast<uint32_t> ( bOverride ? 1 : 0 ), 1 );
+
+    // actual gain, we convert from double with range 0..1 to integer
+    const int iCurGain = static_cast<int> ( dGain * ( 1 << 15 ) );
+
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iCurGain ), 2 );
+
+    CreateAndSendMessage ( PROTMESSID_CHANNEL_GAIN_OVERRIDE, vecData );
+}
+
+bool CProtocol::EvaluateChanGainOverrideMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 4 )
+    {
+        return true; // return error code
+    }
+
+    // channel ID
+    const int iCurID =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // override flag
+    const int iOverride =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( ( iOverride != 0 ) && ( iOverride != 1 ) )
+    {
+        return true; // return error code
+    }
+
+    // gain (read integer value)
+    const int iData =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+
+    // we convert the gain from integer to double with range 0..1
+    const double dNewGain = static_cast<double> ( iData ) / ( 1 << 15 );
+
+    // invoke message action
+    emit ChangeChanGainOverride ( iCurID, iOverride == 1, dNewGain );
+
+    return false; // no error
+}
+
+void CProtocol::CreateP2PChanIDsMes ( const int iOwnChanID,
+                                      const int iPeerChanID )
+{
+    int iPos = 0; // init position pointer
+
+    CVector<uint8_t> vecData ( 2 ); // 2 bytes of data
+
+    // own channel ID
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iOwnChanID ), 1 );
+
+    // channel ID of the peer
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iPeerChanID ), 1 );
+
+    CreateAndSendMessage ( PROTMESSID_P2P_CHANNEL_IDS, vecData );
+}
+
+bool CProtocol::EvaluateP2PChanIDsMes ( const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 2 )
+    {
+        return true; // return error code
+    }
+
+    // own channel ID
+    const int iOwnChanID =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    // channel ID of the peer
+    const int iPeerChanID =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 1 ) );
+
+    if ( ( iOwnChanID >= MAX_NUM_CHANNELS ) ||
+         ( iPeerChanID >= MAX_NUM_CHANNELS ) )
+    {
+        return true; // return error code
+    }
+
+    // invoke message action
+    emit P2PChanIDsReceived ( iOwnChanID, iPeerChanID );
+
+    return false; // no error
+}
+
 
 // Connection less messages ----------------------------------------------------
 void CProtocol::CreateCLPingMes ( const CHostAddress& InetAddr, const int iMs )
@@ -1765,7 +2478,8 @@ void CProtocol::CreateCLSendEmptyMesMes ( const CHostAddress& InetAddr,
                                      InetAddr );
 }
 
-bool CProtocol::EvaluateCLSendEmptyMesMes ( const CVector<uint8_t>& vecData )
+bool CProtocol::EvaluateCLSendEmptyMesMes ( const CHostAddress&     InetAddr,
+                                            const CVector<uint8_t>& vecData )
 {
     int iPos = 0; // init position pointer
 
@@ -1784,7 +2498,8 @@ bool CProtocol::EvaluateCLSendEmptyMesMes ( const CVector<uint8_t>& vecData )
         static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
 
     // invoke message action
-    emit CLSendEmptyMes ( CHostAddress ( QHostAddress ( iIpAddr ), iPort ) );
+    emit CLSendEmptyMes ( InetAddr,
+                          CHostAddress ( QHostAddress ( iIpAddr ), iPort ) );
 
     return false; // no error
 }
@@ -1813,6 +2528,51 @@ bool CProtocol::EvaluateCLDisconnectionMes ( const CHostAddress& InetAddr )
     return false; // no error
 }
 
+void CProtocol::CreateCLProbeMes ( const CHostAddress& InetAddr,
+                                   const int           iProbeIdx,
+                                   const int           iMs )
+{
+    int iPos = 0; // init position pointer
+
+    // build data vector (6 bytes long)
+    CVector<uint8_t> vecData ( 6 );
+
+    // probe number (2 bytes)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iProbeIdx ), 2 );
+
+    // transmit time (4 bytes)
+    PutValOnStream ( vecData, iPos, static_cast<uint32_t> ( iMs ), 4 );
+
+    CreateAndImmSendConLessMessage ( PROTMESSID_CLM_PROBE,
+                                     vecData,
+                                     InetAddr );
+}
+
+bool CProtocol::EvaluateCLProbeMes ( const CHostAddress&     InetAddr,
+                                     const CVector<uint8_t>& vecData )
+{
+    int iPos = 0; // init position pointer
+
+    // check size
+    if ( vecData.Size() != 6 )
+    {
+        return true; // return error code
+    }
+
+    // probe number
+    const int iProbeIdx =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 2 ) );
+
+    // transmit time
+    const int iMs =
+        static_cast<int> ( GetValFromStream ( vecData, iPos, 4 ) );
+
+    // invoke message action
+    emit CLProbeReceived ( InetAddr, iProbeIdx, iMs );
+
+    return false; // no error
+}
+
 
 /******************************************************************************\
 * Message generation and parsing                                               *
@@ -1895,6 +2655,56 @@ bool CProtocol::ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
     return false; // no error
 }
 
+bool CProtocol::IsCLPingMessage ( const CVector<uint8_t>& vecbyData,
+                                  const int               iNumBytesIn,
+                                  int&                    iTimeStamp )
+{
+/*
+    note: only the header is checked, the message is evaluated later by the
+          regular parsing functions (this function is called by the socket
+          to take the receive time of the ping messages)
+*/
+    // vector must be at least "MESS_LEN_WITHOUT_DATA_BYTE" bytes long
+    if ( iNumBytesIn < MESS_LEN_WITHOUT_DATA_BYTE )
+    {
+        return false;
+    }
+
+    int iCurPos = 0; // start from beginning
+
+    // 2 bytes TAG, 2 bytes ID, 1 byte cnt, 2 bytes length
+    const int iTag = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
+    const int iID  = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
+    iCurPos++;
+    const int iLenBy = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 2 ) );
+
+    if ( ( iTag != 0 ) || ( iLenBy != iNumBytesIn - MESS_LEN_WITHOUT_DATA_BYTE ) )
+    {
+        return false;
+    }
+
+    bool bIsPing = false;
+
+    if ( ( ( iID == PROTMESSID_CLM_PING_MS ) ||
+           ( iID == PROTMESSID_CLM_PING_MS_WITHNUMCLIENTS ) ) && ( iLenBy >= 4 ) )
+    {
+        bIsPing = true;
+    }
+    else if ( ( iID == PROTMESSID_CLM_PROBE ) && ( iLenBy >= 6 ) )
+    {
+        // the probe number precedes the time stamp
+        iCurPos += 2;
+        bIsPing  = true;
+    }
+
+    if ( bIsPing )
+    {
+        iTimeStamp = static_cast<int> ( GetValFromStream ( vecbyData, iCurPos, 4 ) );
+    }
+
+    return bIsPing;
+}
+
 uint32_t CProtocol::GetValFromStream ( const CVector<uint8_t>& vecIn,
                                        int&                    iPos,
                                        const int               iNumOfBytes )
@@ -54,6 +54,21 @@
 #define PROTMESSID_CONN_CLIENTS_LIST          24 // channel infos for connected clients
 #define PROTMESSID_CHANNEL_INFOS              25 // set channel infos
 #define PROTMESSID_OPUS_SUPPORTED             26 // tells that OPUS codec is supported
+#define PROTMESSID_FEDERATION_LINK            27 // channel is a linked server
+#define PROTMESSID_CHANNEL_BUS                28 // set the submix bus of the channel
+#define PROTMESSID_BUS_GAIN                   29 // set bus gain for mix
+#define PROTMESSID_REQ_FORWARDING             30 // request forwarding of all streams
+#define PROTMESSID_FORWARDING                 31 // streams are forwarded (no server mix)
+#define PROTMESSID_REQ_P2P                    32 // request direct peer-to-peer audio
+#define PROTMESSID_SEQ_NUM_SUPPORTED          33 // tells that audio sequence numbers are supported
+#define PROTMESSID_REQ_REDUNDANCY             34 // request redundancy in the audio packets
+#define PROTMESSID_OPUS64_SUPPORTED           35 // tells that OPUS with small frame size is supported
+#define PROTMESSID_RAW_AUDIO_SUPPORTED        36 // tells that uncompressed audio is supported
+#define PROTMESSID_MIX_MINUS                  37 // exclude own signal from the mix
+#define PROTMESSID_LATENCY_PROBE              38 // time stamp of an audio frame
+#define PROTMESSID_LATENCY_PROBE_ECHO         39 // time stamp echo on the mix
+#define PROTMESSID_CHANNEL_GAIN_OVERRIDE      40 // override the bus gain of a channel
+#define PROTMESSID_P2P_CHANNEL_IDS            41 // channel IDs of a peer-to-peer connection
 
 // message IDs of connection less messages (CLM)
 // DEFINITION -> start at 1000, end at 1999, see IsConnectionLessMessageID
@@ -67,6 +82,7 @@
 #define PROTMESSID_CLM_SEND_EMPTY_MESSAGE     1008 // an empty message shall be send
 #define PROTMESSID_CLM_EMPTY_MESSAGE          1009 // empty message
 #define PROTMESSID_CLM_DISCONNECTION          1010 // disconnection
+#define PROTMESSID_CLM_PROBE                  1011 // network probe before connecting
 
 
 // lengths of message as defined in protocol.cpp file
@@ -100,6 +116,21 @@ public:
     void CreateNetwTranspPropsMes ( const CNetworkTransportProps& NetTrProps );
     void CreateReqNetwTranspPropsMes();
     void CreateOpusSupportedMes();
+    void CreateFederationLinkMes();
+    void CreateChanBusMes ( const QString strBusName );
+    void CreateBusGainMes ( const QString strBusName, const double dGain );
+    void CreateReqForwardingMes();
+    void CreateForwardingMes ( const int iOwnChanID );
+    void CreateReqP2PMes();
+    void CreateSeqNumSupportedMes();
+    void CreateReqRedundancyMes ( const int iNumFrames );
+    void CreateOpus64SupportedMes();
+    void CreateRawAudioSupportedMes();
+    void CreateMixMinusMes ( const bool bMixMinus );
+    void CreateLatencyProbeMes ( const int iSeqNum, const int iTimeStampUs );
+    void CreateLatencyProbeEchoMes ( const int iSeqNum, const int iTimeStampUs );
+    void CreateChanGainOverrideMes ( const int iChanID, const bool bOverride, const double dGain );
+    void CreateP2PChanIDsMes ( const int iOwnChanID, const int iPeerChanID );
 
     void CreateCLPingMes ( const CHostAddress& InetAddr, const int iMs );
     void CreateCLPingWithNumClientsMes ( const CHostAddress& InetAddr,
@@ -116,6 +147,9 @@ public:
                                    const CHostAddress& TargetInetAddr );
     void CreateCLEmptyMes ( const CHostAddress& InetAddr );
     void CreateCLDisconnection ( const CHostAddress& InetAddr );
+    void CreateCLProbeMes ( const CHostAddress& InetAddr,
+                            const int           iProbeIdx,
+                            const int           iMs );
 
     bool ParseMessageFrame ( const CVector<uint8_t>& vecbyData,
                              const int               iNumBytesIn,
@@ -138,6 +172,12 @@ public:
     bool IsConnectionLessMessageID ( const int iID ) const
         { return (iID >= 1000) & (iID < 2000); }
 
+    // checks if the frame is a connection less ping (or probe) message and
+    // extracts the transmit time stamp without parsing the complete message
+    static bool IsCLPingMessage ( const CVector<uint8_t>& vecbyData,
+                                  const int               iNumBytesIn,
+                                  int&                    iTimeStamp );
+
     // this function is public because we need it in the test bench
     void CreateAndImmSendAcknMess ( const int& iID,
                                     const int& iCnt );
@@ -184,9 +224,9 @@ protected:
                                  int&              iPos,
                                  const QByteArray& sStringUTF8 );
 
-    uint32_t GetValFromStream ( const CVector<uint8_t>& vecIn,
-                                int&                    iPos,
-                                const int               iNumOfBytes );
+    static uint32_t GetValFromStream ( const CVector<uint8_t>& vecIn,
+                                       int&                    iPos,
+                                       const int               iNumOfBytes );
 
     bool GetStringFromStream ( const CVector<uint8_t>& vecIn,
                                int&                    iPos,
@@ -215,6 +255,21 @@ protected:
     bool EvaluateNetwTranspPropsMes    ( const CVector<uint8_t>& vecData );
     bool EvaluateReqNetwTranspPropsMes();
     bool EvaluateOpusSupportedMes();
+    bool EvaluateFederationLinkMes();
+    bool EvaluateChanBusMes            ( const CVector<uint8_t>& vecData );
+    bool EvaluateBusGainMes            ( const CVector<uint8_t>& vecData );
+    bool EvaluateReqForwardingMes();
+    bool EvaluateForwardingMes ( const CVector<uint8_t>& vecData );
+    bool EvaluateReqP2PMes();
+    bool EvaluateSeqNumSupportedMes();
+    bool EvaluateReqRedundancyMes      ( const CVector<uint8_t>& vecData );
+    bool EvaluateOpus64SupportedMes();
+    bool EvaluateRawAudioSupportedMes();
+    bool EvaluateMixMinusMes           ( const CVector<uint8_t>& vecData );
+    bool EvaluateLatencyProbeMes       ( const CVector<uint8_t>& vecData );
+    bool EvaluateLatencyProbeEchoMes   ( const CVector<uint8_t>& vecData );
+    bool EvaluateChanGainOverrideMes   ( const CVector<uint8_t>& vecData );
+    bool EvaluateP2PChanIDsMes         ( const CVector<uint8_t>& vecData );
 
     bool EvaluateCLPingMes               ( const CHostAddress&     InetAddr,
                                            const CVector<uint8_t>& vecData );
@@ -227,8 +282,11 @@ protected:
     bool EvaluateCLServerListMes         ( const CHostAddress&     InetAddr,
                                            const CVector<uint8_t>& vecData );
     bool EvaluateCLReqServerListMes      ( const CHostAddress& InetAddr );
-    bool EvaluateCLSendEmptyMesMes       ( const CVector<uint8_t>& vecData );
+    bool EvaluateCLSendEmptyMesMes       ( const CHostAddress&     InetAddr,
+                                           const CVector<uint8_t>& vecData );
     bool EvaluateCLDisconnectionMes      ( const CHostAddress& InetAddr );
+    bool EvaluateCLProbeMes              ( const CHostAddress&     InetAddr,
+                                           const CVector<uint8_t>& vecData );
 
     int                     iOldRecID;
     int                     iOldRecCnt;
@@ -262,6 +320,21 @@ signals:
     void ChangeChanInfo ( CChannelCoreInfo ChanInfo );
     void ReqChanInfo();
     void OpusSupported();
+    void FederationLinkReceived();
+    void ChangeChanBus ( QString strBusName );
+    void ChangeBusGain ( QString strBusName, double dNewGain );
+    void ReqForwarding();
+    void ForwardingReceived ( int iOwnChanID );
+    void ReqP2P();
+    void SeqNumSupported();
+    void ReqRedundancy ( int iNumFrames );
+    void Opus64Supported();
+    void RawAudioSupported();
+    void MixMinus ( bool bMixMinus );
+    void LatencyProbe ( int iSeqNum, int iTimeStampUs );
+    void LatencyProbeEcho ( int iSeqNum, int iTimeStampUs );
+    void ChangeChanGainOverride ( int iChanID, bool bOverride, double dNewGain );
+    void P2PChanIDsReceived ( int iOwnChanID, int iPeerChanID );
     void ChatTextReceived ( QString strChatText );
     void NetTranspPropsReceived ( CNetworkTransportProps NetworkTransportProps );
     void ReqNetTranspProps();
@@ -277,8 +350,12 @@ signals:
     void CLServerListReceived         ( CHostAddress         InetAddr,
                                         CVector<CServerInfo> vecServerInfo );
     void CLReqServerList              ( CHostAddress         InetAddr );
-    void CLSendEmptyMes               ( CHostAddress         TargetInetAddr );
+    void CLSendEmptyMes               ( CHostAddress         InetAddr,
+                                        CHostAddress         TargetInetAddr );
     void CLDisconnection              ( CHostAddress         InetAddr );
+    void CLProbeReceived              ( CHostAddress         InetAddr,
+                                        int                  iProbeIdx,
+                                        int                  iMs );
 };
 
 #endif /* !defined ( PROTOCOL_H__3B123453_4344_BB2392354455IUHF1912__INCLUDED_ ) */
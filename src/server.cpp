@@ -27,12 +27,12 @@
 
 // CHighPrecisionTimer implementation ******************************************
 #ifdef _WIN32
-CHighPrecisionTimer::CHighPrecisionTimer()
+CHighPrecisionTimer::CHighPrecisionTimer ( const int iNewFrameSizeSamples )
 {
     // add some error checking, the high precision timer implementation only
-    // supports 128 samples frame size at 48 kHz sampling rate
-#if ( SYSTEM_FRAME_SIZE_SAMPLES != 128 )
-# error "Only system frame size of 128 samples is supported by this module"
+    // supports 128 and 64 samples frame size at 48 kHz sampling rate
+#if ( SYSTEM_FRAME_SIZE_SAMPLES != 128 ) || ( SYSTEM_FRAME_SIZE_SAMPLES_SMALL != 64 )
+# error "Only system frame sizes of 128 and 64 samples are supported by this module"
 #endif
 #if ( SYSTEM_SAMPLE_RATE_HZ != 48000 )
 # error "Only a system sample rate of 48 kHz is supported by this module"
@@ -43,12 +43,25 @@ CHighPrecisionTimer::CHighPrecisionTimer()
     // frame size at 48 kHz sampling rate.
     // To support this interval, we use a timer with 2 ms
     // resolution and fire the actual frame timer if the error to the actual
-    // required interval is minimum.
+    // required interval is minimum. For the small frame size of 64 samples,
+    // the same pattern is used with a 1 ms resolution.
+    if ( iNewFrameSizeSamples == SYSTEM_FRAME_SIZE_SAMPLES_SMALL )
+    {
+        iTimerResolutionMs = 1;
+    }
+    else
+    {
+        iTimerResolutionMs = 2;
+    }
+
     veciTimeOutIntervals.Init ( 3 );
 
     // for 128 sample frame size at 48 kHz sampling rate:
     // actual intervals:  0.0  2.666  5.333  8.0
     // quantized to 2 ms: 0    2      6      8 (0)
+    // for 64 sample frame size at 48 kHz sampling rate:
+    // actual intervals:  0.0  1.333  2.666  4.0
+    // quantized to 1 ms: 0    1      3      4 (0)
     veciTimeOutIntervals[0] = 0;
     veciTimeOutIntervals[1] = 1;
     veciTimeOutIntervals[2] = 0;
@@ -64,8 +77,8 @@ void CHighPrecisionTimer::Start()
     iCurPosInVector  = 0;
     iIntervalCounter = 0;
 
-    // start internal timer with 2 ms resolution
-    Timer.start ( 2 );
+    // start internal timer with 2 ms (or 1 ms) resolution
+    Timer.start ( iTimerResolutionMs );
 }
 
 void CHighPrecisionTimer::Stop()
@@ -101,12 +114,12 @@ void CHighPrecisionTimer::OnTimer()
     }
 }
 #else // Mac and Linux
-CHighPrecisionTimer::CHighPrecisionTimer() :
+CHighPrecisionTimer::CHighPrecisionTimer ( const int iNewFrameSizeSamples ) :
     bRun ( false )
 {
     // calculate delay in ns
     const uint64_t iNsDelay =
-        ( (uint64_t) SYSTEM_FRAME_SIZE_SAMPLES * 1000000000 ) /
+        ( (uint64_t) iNewFrameSizeSamples * 1000000000 ) /
         (uint64_t) SYSTEM_SAMPLE_RATE_HZ; // in ns
 
 #if defined ( __APPLE__ ) || defined ( __MACOSX )
@@ -201,10 +214,19 @@ CServer::CServer ( const int      iNewNumChan,
                    const QString& strCentralServer,
                    const QString& strServerInfo,
                    const QString& strNewWelcomeMessage,
-                   const bool     bNCentServPingServerInList ) :
+                   const bool     bNCentServPingServerInList,
+                   const QString& strFederationUpstream,
+                   const bool     bNUseForwarding,
+                   const bool     bNUseFastUpdate,
+                   const bool     bNLogProcTime ) :
     iNumChannels         ( iNewNumChan ),
+    iServerFrameSizeSamples ( bNUseFastUpdate ?
+                              SYSTEM_FRAME_SIZE_SAMPLES_SMALL :
+                              SYSTEM_FRAME_SIZE_SAMPLES ),
+    bSecondHalfTick      ( false ),
     Socket               ( this, iPortNumber ),
     bWriteStatusHTMLFile ( false ),
+    HighPrecisionTimer   ( iServerFrameSizeSamples ),
     ServerListManager    ( iPortNumber,
                            strCentralServer,
                            strServerInfo,
@@ -212,7 +234,16 @@ CServer::CServer ( const int      iNewNumChan,
                            bNCentServPingServerInList,
                            &ConnLessProtocol ),
     bAutoRunMinimized    ( false ),
-    strWelcomeMessage    ( strNewWelcomeMessage )
+    strWelcomeMessage    ( strNewWelcomeMessage ),
+    bUseFederationUplink ( false ),
+    FederationChannel    ( false ), // the uplink is a client type channel
+    bLogProcTime         ( bNLogProcTime ),
+    iProcTimeNumTicks    ( 0 ),
+    iProcTimeNumClientTicks ( 0 ),
+    iProcTimeSumUs       ( 0 ),
+    iProcTimeMaxUs       ( 0 ),
+    iBusInfoChanged      ( 1 ),
+    vecChanBusIdx        ( MAX_NUM_CHANNELS, -1 )
 {
     int iOpusError;
     int i;
@@ -295,8 +326,65 @@ CServer::CServer ( const int      iNewNumChan,
         opus_custom_encoder_ctl ( OpusEncoderStereo[i],
                                   OPUS_SET_COMPLEXITY ( 1 ) );
 #endif
+
+        // init OPUS encoder/decoder with the small frame size (mono and stereo)
+        Opus64Mode[i] = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
+                                                  SYSTEM_FRAME_SIZE_SAMPLES_SMALL,
+                                                  &iOpusError );
+
+        Opus64EncoderMono[i] = opus_custom_encoder_create ( Opus64Mode[i],
+                                                            1,
+                                                            &iOpusError );
+
+        Opus64DecoderMono[i] = opus_custom_decoder_create ( Opus64Mode[i],
+                                                            1,
+                                                            &iOpusError );
+
+        Opus64EncoderStereo[i] = opus_custom_encoder_create ( Opus64Mode[i],
+                                                              2,
+                                                              &iOpusError );
+
+        Opus64DecoderStereo[i] = opus_custom_decoder_create ( Opus64Mode[i],
+                                                              2,
+                                                              &iOpusError );
+
+        // we require a constant bit rate with as low delay as possible
+        opus_custom_encoder_ctl ( Opus64EncoderMono[i],
+                                  OPUS_SET_VBR ( 0 ) );
+
+        opus_custom_encoder_ctl ( Opus64EncoderMono[i],
+                                  OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+        opus_custom_encoder_ctl ( Opus64EncoderStereo[i],
+                                  OPUS_SET_VBR ( 0 ) );
+
+        opus_custom_encoder_ctl ( Opus64EncoderStereo[i],
+                                  OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+#ifdef USE_LOW_COMPLEXITY_CELT_ENC
+        // set encoder low complexity
+        opus_custom_encoder_ctl ( Opus64EncoderMono[i],
+                                  OPUS_SET_COMPLEXITY ( 1 ) );
+
+        opus_custom_encoder_ctl ( Opus64EncoderStereo[i],
+                                  OPUS_SET_COMPLEXITY ( 1 ) );
+#endif
     }
 
+    // frame size conversion buffers for the fast update mode (one full frame
+    // with the normal frame size, stereo)
+    vecvecsFrameConvIn.Init  ( MAX_NUM_CHANNELS );
+    vecvecsFrameConvOut.Init ( MAX_NUM_CHANNELS );
+
+    for ( i = 0; i < MAX_NUM_CHANNELS; i++ )
+    {
+        vecvecsFrameConvIn[i].Init  ( 2 * SYSTEM_FRAME_SIZE_SAMPLES );
+        vecvecsFrameConvOut[i].Init ( 2 * SYSTEM_FRAME_SIZE_SAMPLES );
+    }
+
+    // resolved bus gains of the mix of each channel
+    vecvecdListenerBusGains.Init ( MAX_NUM_CHANNELS );
+
     // define colors for chat window identifiers
     vstrChatColors.Init ( 6 );
     vstrChatColors[0] = "mediumblue";
@@ -349,6 +437,86 @@ CServer::CServer ( const int      iNewNumChan,
     for ( i = 0; i < iNumChannels; i++ )
     {
         vecChannels[i].SetEnable ( true );
+
+        // the channel ID is sent to a client in the forwarding mode
+        vecChannels[i].SetChanID ( i );
+
+        // forwarding mode: clients may request the streams instead of a mix
+        // (the forwarded streams must have the normal frame size, therefore
+        // the forwarding is not available in the fast update mode)
+        vecChannels[i].SetForwardingAllowed ( bNUseForwarding && !bNUseFastUpdate );
+
+        // fast update mode: the clients may use the small frame size
+        vecChannels[i].SetOpus64Supported ( bNUseFastUpdate );
+
+        // peer-to-peer mode: two clients may exchange the audio directly
+        QObject::connect ( &vecChannels[i], SIGNAL ( P2PRequested() ),
+            this, SLOT ( OnP2PRequested() ) );
+
+        // submix buses: a changed bus name or bus gain is resolved on the
+        // next timer tick
+        QObject::connect ( &vecChannels[i], SIGNAL ( BusInfoHasChanged() ),
+            this, SLOT ( OnBusInfoHasChanged() ) );
+    }
+
+    // server federation: link this server to an upstream server (if requested)
+    ResetFederationLinkStats();
+
+    // (the link uses the normal frame size, therefore it is not available in
+    // the fast update mode, the command line parser rejects this combination)
+    if ( !strFederationUpstream.isEmpty() && !bNUseFastUpdate )
+    {
+        if ( NetworkUtil().ParseNetworkAddress ( strFederationUpstream,
+                                                 FederationUpstreamAddr ) )
+        {
+            bUseFederationUplink = true;
+
+            // the link always uses a stereo OPUS stream
+            OpusModeFederation = opus_custom_mode_create ( SYSTEM_SAMPLE_RATE_HZ,
+                                                           SYSTEM_FRAME_SIZE_SAMPLES,
+                                                           &iOpusError );
+
+            OpusEncoderFederation = opus_custom_encoder_create ( OpusModeFederation,
+                                                                 2,
+                                                                 &iOpusError );
+
+            OpusDecoderFederation = opus_custom_decoder_create ( OpusModeFederation,
+                                                                 2,
+                                                                 &iOpusError );
+
+            // we require a constant bit rate with as low delay as possible
+            opus_custom_encoder_ctl ( OpusEncoderFederation,
+                                      OPUS_SET_VBR ( 0 ) );
+
+            opus_custom_encoder_ctl ( OpusEncoderFederation,
+                                      OPUS_SET_APPLICATION ( OPUS_APPLICATION_RESTRICTED_LOWDELAY ) );
+
+            // the number of coded bytes of the link never changes, we can set
+            // the bit rate once here
+            opus_custom_encoder_ctl ( OpusEncoderFederation,
+                                      OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( FEDERATION_LINK_NUM_CODED_BYTES ) ) );
+
+            // the uplink channel behaves like the channel of a client which is
+            // connected to the upstream server
+            FederationChannel.SetAddress ( FederationUpstreamAddr );
+
+            FederationChannel.SetAudioStreamProperties ( CT_OPUS,
+                                                         FEDERATION_LINK_NUM_CODED_BYTES,
+                                                         FRAME_SIZE_FACTOR_PREFERRED,
+                                                         2 );
+
+            FederationChannel.SetEnable ( true );
+
+            // start the link statistics measurement
+            TimerFederationStats.start ( FEDERATION_STATS_INTERVAL_MS );
+        }
+    }
+
+    // if enabled, the processing time is reported periodically while clients
+    // are connected
+    if ( bLogProcTime )
+    {
+        TimerProcTimeStats.start ( PROC_TIME_STATS_INTERVAL_MS );
     }
 
 
@@ -382,13 +550,52 @@ CServer::CServer ( const int      iNewNumChan,
         this, SLOT ( OnCLReqServerList ( CHostAddress ) ) );
 
     QObject::connect ( &ConnLessProtocol,
-        SIGNAL ( CLSendEmptyMes ( CHostAddress ) ),
-        this, SLOT ( OnCLSendEmptyMes ( CHostAddress ) ) );
+        SIGNAL ( CLSendEmptyMes ( CHostAddress, CHostAddress ) ),
+        this, SLOT ( OnCLSendEmptyMes ( CHostAddress, CHostAddress ) ) );
 
     QObject::connect ( &ConnLessProtocol,
         SIGNAL ( CLDisconnection ( CHostAddress ) ),
         this, SLOT ( OnCLDisconnection ( CHostAddress ) ) );
 
+    QObject::connect ( &ConnLessProtocol,
+        SIGNAL ( CLProbeReceived ( CHostAddress, int, int ) ),
+        this, SLOT ( OnCLProbeReceived ( CHostAddress, int, int ) ) );
+
+    QObject::connect ( &TimerProcTimeStats, SIGNAL ( timeout() ),
+        this, SLOT ( OnTimerProcTimeStats() ) );
+
+    // server federation
+    QObject::connect ( &TimerFederationStats, SIGNAL ( timeout() ),
+        this, SLOT ( OnTimerFederationStats() ) );
+
+    QObject::connect ( &FederationChannel,
+        SIGNAL ( MessReadyForSending ( CVector<uint8_t> ) ),
+        this, SLOT ( OnSendFederationProtMessage ( CVector<uint8_t> ) ) );
+
+    QObject::connect ( &FederationChannel,
+        SIGNAL ( DetectedCLMessage ( CVector<uint8_t>, int ) ),
+        this, SLOT ( OnFederationDetCLMess ( CVector<uint8_t>, int ) ) );
+
+    QObject::connect ( &FederationChannel, SIGNAL ( ReqJittBufSize() ),
+        this, SLOT ( OnFederationReqJittBufSize() ) );
+
+    QObject::connect ( &FederationChannel, SIGNAL ( JittBufSizeChanged ( int ) ),
+        this, SLOT ( OnFederationJittBufSizeChanged ( int ) ) );
+
+    QObject::connect ( &FederationChannel, SIGNAL ( ReqChanInfo() ),
+        this, SLOT ( OnFederationReqChanInfo() ) );
+
+    QObject::connect ( &FederationChannel, SIGNAL ( NewConnection() ),
+        this, SLOT ( OnFederationNewConnection() ) );
+
+    QObject::connect ( &FederationConnLessProtocol,
+        SIGNAL ( CLMessReadyForSending ( CHostAddress, CVector<uint8_t> ) ),
+        this, SLOT ( OnSendCLProtMessage ( CHostAddress, CVector<uint8_t> ) ) );
+
+    QObject::connect ( &FederationConnLessProtocol,
+        SIGNAL ( CLPingReceived ( CHostAddress, int ) ),
+        this, SLOT ( OnFederationCLPingReceived ( CHostAddress, int ) ) );
+
 
     // CODE TAG: MAX_NUM_CHANNELS_TAG
     // make sure we have MAX_NUM_CHANNELS connections!!!
@@ -600,6 +807,182 @@ void CServer::OnCLDisconnection ( CHostAddress InetAddr )
     }
 }
 
+void CServer::OnFederationNewConnection()
+{
+    // the link to the upstream server is (re-)established, restart the
+    // measurement of the link statistics
+    Mutex.lock();
+    {
+        ResetFederationLinkStats();
+    }
+    Mutex.unlock();
+}
+
+void CServer::OnFederationReqChanInfo()
+{
+    // the upstream server requests our channel infos, we use the server name
+    // as the fader tag so that the linked server can be identified
+    CChannelCoreInfo LinkChanInfo;
+    LinkChanInfo.strName = GetServerName().left ( MAX_LEN_FADER_TAG );
+
+    if ( LinkChanInfo.strName.isEmpty() )
+    {
+        LinkChanInfo.strName = "Linked Server";
+    }
+
+    FederationChannel.SetRemoteInfo ( LinkChanInfo );
+
+    // The upstream server requests the channel infos on each new connection.
+    // We use this to tell the upstream server that this channel is a linked
+    // server so that our own submix is excluded from the mix we get back.
+    FederationChannel.CreateFederationLinkMes();
+}
+
+void CServer::OnFederationCLPingReceived ( CHostAddress, int iTimeStampUs )
+{
+    int iRecTimeUs;
+
+    // use the receive time of the socket if available
+    if ( !Socket.GetPingRecTimeUs ( iTimeStampUs, iRecTimeUs ) )
+    {
+        iRecTimeUs = PreciseTime.elapsedUs();
+    }
+
+    // take care of wrap arounds (if wrapping, do not use result)
+    const int iCurDiffUs = CPreciseTime::DiffUs ( iRecTimeUs, iTimeStampUs );
+
+    if ( iCurDiffUs >= 0 )
+    {
+        iFederationPingTimeMs = MathUtils::round ( iCurDiffUs / 1000.0 );
+        FederationRttStats.Update ( iCurDiffUs );
+    }
+}
+
+void CServer::OnTimerFederationStats()
+{
+    // measure the round trip time of the link by a connection less ping
+    FederationConnLessProtocol.CreateCLPingMes ( FederationUpstreamAddr,
+                                                 PreciseTime.elapsedUs() );
+
+    if ( FederationChannel.IsConnected() )
+    {
+        Mutex.lock();
+        {
+            // The difference of received frames and local timer ticks
+            // contains the fill state of the jitter buffer. Therefore the
+            // first measurement after the link is established is used as the
+            // reference and only the change of the difference is evaluated.
+            if ( !bFederationRefIsValid )
+            {
+                iFederationRefFrameDiff =
+                    iFederationNumFramesRec - iFederationNumTicks;
+
+                iFederationRefNumTicks = iFederationNumTicks;
+                bFederationRefIsValid  = true;
+            }
+        }
+        Mutex.unlock();
+
+        // report the current link statistics
+        int    iPingTimeMs;
+        int    iOneHopDelayMs;
+        double dClockOffsetPPM;
+
+        GetFederationLinkStats ( iPingTimeMs, iOneHopDelayMs, dClockOffsetPPM );
+
+        Logging.AddFederationLinkStats ( FederationUpstreamAddr.InetAddr,
+                                         iPingTimeMs,
+                                         iOneHopDelayMs,
+                                         dClockOffsetPPM,
+                                         FederationRttStats.GetText() );
+    }
+}
+
+void CServer::OnTimerProcTimeStats()
+{
+    // only report if the server was running in the last interval
+    if ( iProcTimeNumTicks > 0 )
+    {
+        const double dTickDurationUs = static_cast<double> (
+            iServerFrameSizeSamples ) * 1000000 / SYSTEM_SAMPLE_RATE_HZ;
+
+        const double dMeanTimeUs =
+            static_cast<double> ( iProcTimeSumUs ) / iProcTimeNumTicks;
+
+        const double dMeanNumClients =
+            static_cast<double> ( iProcTimeNumClientTicks ) / iProcTimeNumTicks;
+
+        Logging.AddProcTimeStats ( iServerFrameSizeSamples,
+                                   dTickDurationUs,
+                                   dMeanTimeUs,
+                                   iProcTimeMaxUs,
+                                   dMeanNumClients );
+    }
+
+    iProcTimeNumTicks       = 0;
+    iProcTimeNumClientTicks = 0;
+    iProcTimeSumUs          = 0;
+    iProcTimeMaxUs          = 0;
+}
+
+void CServer::GetFederationLinkStats ( int&    iPingTimeMs,
+                                       int&    iOneHopDelayMs,
+                                       double& dClockOffsetPPM )
+{
+    dClockOffsetPPM = 0;
+
+    Mutex.lock();
+    {
+        // relative clock offset of the upstream server compared to the local
+        // timer, a positive value means that the upstream clock is faster
+        const int iNumTicksSinceRef =
+            iFederationNumTicks - iFederationRefNumTicks;
+
+        if ( bFederationRefIsValid && ( iNumTicksSinceRef > 0 ) )
+        {
+            const int iFrameDiffSinceRef =
+                iFederationNumFramesRec - iFederationNumTicks -
+                iFederationRefFrameDiff;
+
+            dClockOffsetPPM = static_cast<double> ( iFrameDiffSinceRef ) /
+                iNumTicksSinceRef * 1000000;
+        }
+    }
+    Mutex.unlock();
+
+    iPingTimeMs = iFederationPingTimeMs;
+
+    // The one-hop latency is the delay from the local mix to the mix of the
+    // upstream server: half of the round trip time, the network frame and the
+    // jitter buffer of the upstream server for our link channel.
+    iOneHopDelayMs = MathUtils::round ( iPingTimeMs / 2.0 +
+        ( 1 + iFederationUpstreamJitBufNumFrames ) * SYSTEM_BLOCK_DURATION_MS_FLOAT );
+}
+
+void CServer::ResetFederationLinkStats()
+{
+    iFederationNumFramesRec            = 0;
+    iFederationNumTicks                = 0;
+    iFederationRefFrameDiff            = 0;
+    iFederationRefNumTicks             = 0;
+    bFederationRefIsValid              = false;
+    iFederationPingTimeMs              = 0;
+    iFederationUpstreamJitBufNumFrames = DEF_NET_BUF_SIZE_NUM_BL;
+
+    FederationRttStats.Reset();
+}
+
+CServer::~CServer()
+{
+    // the uplink of a federation link has its own OPUS encoder and decoder
+    if ( bUseFederationUplink )
+    {
+        opus_custom_encoder_destroy ( OpusEncoderFederation );
+        opus_custom_decoder_destroy ( OpusDecoderFederation );
+        opus_custom_mode_destroy    ( OpusModeFederation );
+    }
+}
+
 void CServer::Start()
 {
     // only start if not already running
@@ -636,13 +1019,29 @@ void CServer::OnTimer()
 {
     int i, j;
 
+    const int iStartTimeUs = PreciseTime.elapsedUs();
+
     CVector<int>               vecChanID;
     CVector<CVector<double> >  vecvecdGains;
     CVector<CVector<int16_t> > vecvecsData;
     CVector<int>               vecNumAudioChannels;
+    CVector<CVector<int32_t> > vecveciBusData;
+    CVector<CVector<double> >  vecvecdBusGains;
+    CVector<int>               vecIsForwarding;
+    CVector<uint8_t>           vecbyForwardStreams;
+    CVector<int>               veciForwardStreamPos;
+    CVector<CVector<uint8_t> > vecvecbyForwardPackets;
 
     // Get data from all connected clients -------------------------------------
     bool bChannelIsNowDisconnected = false;
+    bool bMixingRequired           = true;
+
+    // in the fast update mode, a frame with the normal frame size covers two
+    // timer ticks
+    if ( iServerFrameSizeSamples != SYSTEM_FRAME_SIZE_SAMPLES )
+    {
+        bSecondHalfTick = !bSecondHalfTick;
+    }
 
     // Make put and get calls thread safe. Do not forget to unlock mutex
     // afterwards!
@@ -662,10 +1061,81 @@ void CServer::OnTimer()
         // process connected channels
         const int iNumCurConnChan = vecChanID.Size();
 
+        // In forwarding mode the clients mix the streams locally. The server
+        // only has to decode and mix if at least one client (or the uplink of
+        // a federation link) requires a mix.
+        bool bForwardingRequired = false;
+        bMixingRequired          = bUseFederationUplink;
+
+        vecIsForwarding.Init      ( iNumCurConnChan );
+        vecbyForwardStreams.Init  ( 0 );
+        veciForwardStreamPos.Init ( 0 );
+
+        for ( i = 0; i < iNumCurConnChan; i++ )
+        {
+            vecIsForwarding[i] = vecChannels[vecChanID[i]].IsForwarding();
+
+            if ( vecIsForwarding[i] )
+            {
+                bForwardingRequired = true;
+            }
+            else
+            {
+                bMixingRequired = true;
+            }
+        }
+
+        // in case of a federation link, the mix of the upstream server is
+        // added as an additional input (after the connected channels)
+        const int iFirstBusIdx =
+            bUseFederationUplink ? iNumCurConnChan + 1 : iNumCurConnChan;
+
+        // resolve the bus assignment of the channels and the bus gains of the
+        // listeners again only if a channel joined or left or if a bus name
+        // or a bus gain was changed (the flag is cleared before the update so
+        // that a change during the update is not lost)
+        if ( AtomicLoadAcquire ( iBusInfoChanged ) != 0 )
+        {
+            AtomicStoreRelease ( iBusInfoChanged, 0 );
+            UpdateBusInfo();
+        }
+
+        // each bus in use is an additional mix input (after all other inputs)
+        // which holds the sum of all channels assigned to this bus, the bus
+        // sums are stored separately since they are not clipped
+        const int iNumBuses     = vecstrBusNames.Size();
+        const int iNumMixInputs = iFirstBusIdx + iNumBuses;
+
         // init temporary vectors
         vecvecdGains.Init        ( iNumCurConnChan );
-        vecvecsData.Init         ( iNumCurConnChan );
-        vecNumAudioChannels.Init ( iNumCurConnChan );
+        vecvecsData.Init         ( iFirstBusIdx );
+        vecveciBusData.Init      ( iNumBuses );
+        vecNumAudioChannels.Init ( iNumMixInputs );
+        vecvecdBusGains.Init     ( iNumBuses );
+
+        // a bus is stereo if at least one of its channels is stereo (the bus
+        // gains have an entry for each mix input, a bus is never an input of
+        // another bus)
+        for ( j = 0; j < iNumBuses; j++ )
+        {
+            vecvecdBusGains[j].Init ( iNumMixInputs, 0 );
+            vecNumAudioChannels[iFirstBusIdx + j] = 1;
+        }
+
+        for ( i = 0; i < iNumCurConnChan; i++ )
+        {
+            const int iCurBusIdx = vecChanBusIdx[vecChanID[i]];
+
+            if ( iCurBusIdx >= 0 )
+            {
+                vecvecdBusGains[iCurBusIdx][i] = 1.0;
+
+                if ( vecChannels[vecChanID[i]].GetNumAudioChannels() == 2 )
+                {
+                    vecNumAudioChannels[iFirstBusIdx + iCurBusIdx] = 2;
+                }
+            }
+        }
 
         for ( i = 0; i < iNumCurConnChan; i++ )
         {
@@ -678,9 +1148,10 @@ void CServer::OnTimer()
 
             vecNumAudioChannels[i] = iCurNumAudChan;
 
-            // init vectors storing information of all channels
-            vecvecdGains[i].Init ( iNumCurConnChan );
-            vecvecsData[i].Init  ( iCurNumAudChan * SYSTEM_FRAME_SIZE_SAMPLES );
+            // init vectors storing information of all channels (the gain of
+            // the upstream mix of a federation link is always one)
+            vecvecdGains[i].Init ( iNumMixInputs, 1.0 );
+            vecvecsData[i].Init  ( iCurNumAudChan * iServerFrameSizeSamples );
 
             // get gains of all connected channels
             for ( j = 0; j < iNumCurConnChan; j++ )
@@ -692,6 +1163,87 @@ void CServer::OnTimer()
                     vecChannels[iCurChanID].GetGain( vecChanID[j] );
             }
 
+            // Channels which are assigned to a bus are mixed via the bus sum
+            // with the bus gain, the channel gain of the fader is not used for
+            // these channels. An override gain which was explicitly set by
+            // the listener replaces the bus gain for a single channel. In that
+            // case we only add the difference between both gains so that the
+            // bus sum can still be used for this mix.
+            for ( j = 0; j < iNumBuses; j++ )
+            {
+                vecvecdGains[i][iFirstBusIdx + j] =
+                    vecvecdListenerBusGains[iCurChanID][j];
+            }
+
+            for ( j = 0; j < iNumCurConnChan; j++ )
+            {
+                const int iCurBusIdx = vecChanBusIdx[vecChanID[j]];
+
+                if ( iCurBusIdx >= 0 )
+                {
+                    double dOverrideGain;
+
+                    if ( vecChannels[iCurChanID].GetGainOverride ( vecChanID[j],
+                                                                  dOverrideGain ) )
+                    {
+                        vecvecdGains[i][j] = dOverrideGain -
+                            vecvecdGains[i][iFirstBusIdx + iCurBusIdx];
+                    }
+                    else
+                    {
+                        vecvecdGains[i][j] = 0;
+                    }
+                }
+            }
+
+            // a linked downstream server must not get its own submix back
+            // since this would create an echo loop between the servers, a
+            // client which monitors its own signal locally does not get it
+            // back either (mix-minus), if the own channel is part of a bus
+            // its signal is removed from the bus sum
+            if ( vecChannels[iCurChanID].IsFederationLink() ||
+                 vecChannels[iCurChanID].GetMixMinus() )
+            {
+                if ( vecChanBusIdx[iCurChanID] >= 0 )
+                {
+                    vecvecdGains[i][i] =
+                        -vecvecdGains[i][iFirstBusIdx + vecChanBusIdx[iCurChanID]];
+                }
+                else
+                {
+                    vecvecdGains[i][i] = 0;
+                }
+            }
+
+            // fast update mode: a channel with the normal frame size is decoded
+            // on the first half tick, on the second half tick we only take the
+            // second half of the decoded frame
+            const int  iCurFrameSize   = vecChannels[iCurChanID].GetFrameSizeSamples();
+            const bool bConvFrameSize  = ( iCurFrameSize != iServerFrameSizeSamples );
+            const int  iNumHalfSamples = iCurNumAudChan * iServerFrameSizeSamples;
+
+            if ( bConvFrameSize && bSecondHalfTick )
+            {
+                for ( j = 0; j < iNumHalfSamples; j++ )
+                {
+                    vecvecsData[i][j] = vecvecsFrameConvIn[iCurChanID][iNumHalfSamples + j];
+                }
+                continue;
+            }
+
+            int16_t* psDecData = bConvFrameSize ?
+                &vecvecsFrameConvIn[iCurChanID][0] : &vecvecsData[i][0];
+
+            // select the OPUS decoder which matches the frame size
+            OpusCustomDecoder* CurOpusDecoderMono   = OpusDecoderMono[iCurChanID];
+            OpusCustomDecoder* CurOpusDecoderStereo = OpusDecoderStereo[iCurChanID];
+
+            if ( vecChannels[iCurChanID].GetAudioCompressionType() == CT_OPUS64 )
+            {
+                CurOpusDecoderMono   = Opus64DecoderMono[iCurChanID];
+                CurOpusDecoderStereo = Opus64DecoderStereo[iCurChanID];
+            }
+
             // get current number of CELT coded bytes
             const int iCeltNumCodedBytes =
                 vecChannels[iCurChanID].GetNetwFrameSize();
@@ -710,8 +1262,49 @@ void CServer::OnTimer()
                 bChannelIsNowDisconnected = true;
             }
 
+            // forwarding mode: add the coded frame to the streams of all
+            // channels, the clients decode all codecs with the normal frame
+            // size (the frame size of uncompressed audio is larger, therefore
+            // the size of the frames is limited)
+            if ( bForwardingRequired &&
+                 ( iCurFrameSize == SYSTEM_FRAME_SIZE_SAMPLES ) &&
+                 ( iCeltNumCodedBytes <= FORWARD_MAX_STREAM_SIZE ) &&
+                 ( ( eGetStat == GS_BUFFER_OK ) || ( eGetStat == GS_BUFFER_UNDERRUN ) ) )
+            {
+                const int iPos = vecbyForwardStreams.Size();
+
+                veciForwardStreamPos.Add ( iPos );
+                vecbyForwardStreams.Enlarge ( FORWARD_STREAM_HEADER_SIZE + iCeltNumCodedBytes );
+
+                vecbyForwardStreams[iPos]     = static_cast<uint8_t> ( iCurChanID );
+                vecbyForwardStreams[iPos + 1] = static_cast<uint8_t> (
+                    vecChannels[iCurChanID].GetAudioCompressionType() );
+                vecbyForwardStreams[iPos + 2] = static_cast<uint8_t> ( iCurNumAudChan );
+                vecbyForwardStreams[iPos + 3] = ( eGetStat == GS_BUFFER_OK ) ? 1 : 0;
+                vecbyForwardStreams[iPos + 4] = static_cast<uint8_t> ( iCeltNumCodedBytes & 255 );
+                vecbyForwardStreams[iPos + 5] = static_cast<uint8_t> ( iCeltNumCodedBytes >> 8 );
+
+                for ( j = 0; j < iCeltNumCodedBytes; j++ )
+                {
+                    vecbyForwardStreams[iPos + FORWARD_STREAM_HEADER_SIZE + j] =
+                        vecbyData[j];
+                }
+            }
+
             // CELT decode received data stream
-            if ( eGetStat == GS_BUFFER_OK )
+            if ( !bMixingRequired )
+            {
+                // all clients mix locally, no decoding required
+            }
+            else if ( vecChannels[iCurChanID].GetAudioCompressionType() == CT_NONE )
+            {
+                // uncompressed audio, only the byte order must be converted
+                // (a lost packet is muted)
+                UnpackRawAudio ( ( eGetStat == GS_BUFFER_OK ) ? &vecbyData[0] : NULL,
+                                 iCurNumAudChan * iCurFrameSize,
+                                 psDecData );
+            }
+            else if ( eGetStat == GS_BUFFER_OK )
             {
                 if ( iCurNumAudChan == 1 )
                 {
@@ -722,15 +1315,15 @@ void CServer::OnTimer()
                         cc6_celt_decode ( CeltDecoderMono[iCurChanID],
                                           &vecbyData[0],
                                           iCeltNumCodedBytes,
-                                          &vecvecsData[i][0] );
+                                          psDecData );
                     }
                     else
                     {
-                        opus_custom_decode ( OpusDecoderMono[iCurChanID],
+                        opus_custom_decode ( CurOpusDecoderMono,
                                              &vecbyData[0],
                                              iCeltNumCodedBytes,
-                                             &vecvecsData[i][0],
-                                             SYSTEM_FRAME_SIZE_SAMPLES );
+                                             psDecData,
+                                             iCurFrameSize );
                     }
                 }
                 else
@@ -742,15 +1335,15 @@ void CServer::OnTimer()
                         cc6_celt_decode ( CeltDecoderStereo[iCurChanID],
                                           &vecbyData[0],
                                           iCeltNumCodedBytes,
-                                          &vecvecsData[i][0] );
+                                          psDecData );
                     }
                     else
                     {
-                        opus_custom_decode ( OpusDecoderStereo[iCurChanID],
+                        opus_custom_decode ( CurOpusDecoderStereo,
                                              &vecbyData[0],
                                              iCeltNumCodedBytes,
-                                             &vecvecsData[i][0],
-                                             SYSTEM_FRAME_SIZE_SAMPLES );
+                                             psDecData,
+                                             iCurFrameSize );
                     }
                 }
             }
@@ -766,15 +1359,15 @@ void CServer::OnTimer()
                         cc6_celt_decode ( CeltDecoderMono[iCurChanID],
                                           NULL,
                                           0,
-                                          &vecvecsData[i][0] );
+                                          psDecData );
                     }
                     else
                     {
-                        opus_custom_decode ( OpusDecoderMono[iCurChanID],
+                        opus_custom_decode ( CurOpusDecoderMono,
                                              NULL,
                                              iCeltNumCodedBytes,
-                                             &vecvecsData[i][0],
-                                             SYSTEM_FRAME_SIZE_SAMPLES );
+                                             psDecData,
+                                             iCurFrameSize );
                     }
                 }
                 else
@@ -786,15 +1379,15 @@ void CServer::OnTimer()
                         cc6_celt_decode ( CeltDecoderStereo[iCurChanID],
                                           NULL,
                                           0,
-                                          &vecvecsData[i][0] );
+                                          psDecData );
                     }
                     else
                     {
-                        opus_custom_decode ( OpusDecoderStereo[iCurChanID],
+                        opus_custom_decode ( CurOpusDecoderStereo,
                                              NULL,
                                              iCeltNumCodedBytes,
-                                             &vecvecsData[i][0],
-                                             SYSTEM_FRAME_SIZE_SAMPLES );
+                                             psDecData,
+                                             iCurFrameSize );
                     }
                 }
             }
@@ -808,6 +1401,52 @@ void CServer::OnTimer()
             {
                 PostWinMessage ( MS_JIT_BUF_GET, MUL_COL_LED_RED, iCurChanID );
             }
+
+            // fast update mode: take the first half of the decoded frame
+            if ( bConvFrameSize )
+            {
+                for ( j = 0; j < iNumHalfSamples; j++ )
+                {
+                    vecvecsData[i][j] = vecvecsFrameConvIn[iCurChanID][j];
+                }
+            }
+        }
+
+        // get the mix of the upstream server (federation link)
+        if ( bUseFederationUplink )
+        {
+            // the link is always stereo
+            vecNumAudioChannels[iNumCurConnChan] = 2;
+            vecvecsData[iNumCurConnChan].Init ( 2 * SYSTEM_FRAME_SIZE_SAMPLES );
+
+            CVector<uint8_t> vecbyData ( FEDERATION_LINK_NUM_CODED_BYTES );
+
+            const EGetDataStat eGetStat = FederationChannel.GetData ( vecbyData );
+
+            if ( eGetStat == GS_BUFFER_OK )
+            {
+                opus_custom_decode ( OpusDecoderFederation,
+                                     &vecbyData[0],
+                                     FEDERATION_LINK_NUM_CODED_BYTES,
+                                     &vecvecsData[iNumCurConnChan][0],
+                                     SYSTEM_FRAME_SIZE_SAMPLES );
+            }
+            else if ( eGetStat == GS_BUFFER_UNDERRUN )
+            {
+                // lost packet
+                opus_custom_decode ( OpusDecoderFederation,
+                                     NULL,
+                                     FEDERATION_LINK_NUM_CODED_BYTES,
+                                     &vecvecsData[iNumCurConnChan][0],
+                                     SYSTEM_FRAME_SIZE_SAMPLES );
+            }
+
+            // the local timer ticks are the reference for the clock offset
+            // estimation (only count if the link is established)
+            if ( FederationChannel.IsConnected() )
+            {
+                iFederationNumTicks++;
+            }
         }
 
         // a channel is now disconnected, take action on it
@@ -815,6 +1454,9 @@ void CServer::OnTimer()
         {
             // update channel list for all currently connected clients
             CreateAndSendChanListForAllConChannels();
+
+            // the channel is no longer part of its bus
+            AtomicStoreRelease ( iBusInfoChanged, 1 );
         }
     }
     Mutex.unlock(); // release mutex
@@ -824,21 +1466,105 @@ void CServer::OnTimer()
     const int iNumClients = vecChanID.Size();
 
     // Check if at least one client is connected. If not, stop server until
-    // one client is connected.
-    if ( iNumClients != 0 )
+    // one client is connected. An established federation link keeps the
+    // server running so that the upstream server still gets our (silent)
+    // submix and does not disconnect the link.
+    if ( ( iNumClients != 0 ) ||
+         ( bUseFederationUplink && FederationChannel.IsConnected() ) )
     {
+        // each bus is summed only once for all mixes, the bus sums are not
+        // clipped (the bus inputs are stored after all other mix inputs)
+        if ( bMixingRequired )
+        {
+            const int iFirstBusIdx = vecvecsData.Size();
+
+            for ( j = 0; j < vecveciBusData.Size(); j++ )
+            {
+                MixData ( vecNumAudioChannels[iFirstBusIdx + j],
+                          vecvecsData,
+                          vecveciBusData,
+                          vecvecdBusGains[j],
+                          vecNumAudioChannels,
+                          vecveciBusData[j] );
+            }
+        }
+
+        // the end of the last forwarded stream is the last stream position
+        veciForwardStreamPos.Add ( vecbyForwardStreams.Size() );
+
         for ( int i = 0; i < iNumClients; i++ )
         {
             // get actual ID of current channel
             const int iCurChanID = vecChanID[i];
 
+            // forwarding mode: the client mixes the streams locally, send the
+            // bundle of the coded streams of all other channels without
+            // transcoding (split in packets which do not exceed the MTU)
+            if ( vecIsForwarding[i] )
+            {
+                vecChannels[iCurChanID].PrepForwardPackets ( vecbyForwardStreams,
+                                                             veciForwardStreamPos,
+                                                             vecvecbyForwardPackets );
+
+                for ( j = 0; j < vecvecbyForwardPackets.Size(); j++ )
+                {
+                    Socket.SendPacket ( vecvecbyForwardPackets[j],
+                                        vecChannels[iCurChanID].GetAddress() );
+                }
+
+                // update socket buffer size
+                vecChannels[iCurChanID].UpdateSocketBufferSize();
+                continue;
+            }
+
             // generate a sparate mix for each channel
             // actual processing of audio data -> mix
-            CVector<short> vecsSendData ( ProcessData ( i,
+            CVector<short> vecsSendData ( ProcessData ( vecNumAudioChannels[i],
                                                         vecvecsData,
+                                                        vecveciBusData,
                                                         vecvecdGains[i],
                                                         vecNumAudioChannels ) );
 
+            // fast update mode: a channel with the normal frame size gets the
+            // first half of the frame on the first half tick and the frame is
+            // encoded and sent on the second half tick
+            const int iCurFrameSize = vecChannels[iCurChanID].GetFrameSizeSamples();
+
+            if ( iCurFrameSize != iServerFrameSizeSamples )
+            {
+                const int iNumHalfSamples = vecsSendData.Size();
+                const int iOffset         = bSecondHalfTick ? iNumHalfSamples : 0;
+
+                for ( j = 0; j < iNumHalfSamples; j++ )
+                {
+                    vecvecsFrameConvOut[iCurChanID][iOffset + j] = vecsSendData[j];
+                }
+
+                if ( !bSecondHalfTick )
+                {
+                    // update socket buffer size
+                    vecChannels[iCurChanID].UpdateSocketBufferSize();
+                    continue;
+                }
+
+                vecsSendData.Init ( 2 * iNumHalfSamples );
+
+                for ( j = 0; j < 2 * iNumHalfSamples; j++ )
+                {
+                    vecsSendData[j] = vecvecsFrameConvOut[iCurChanID][j];
+                }
+            }
+
+            // select the OPUS encoder which matches the frame size
+            OpusCustomEncoder* CurOpusEncoderMono   = OpusEncoderMono[iCurChanID];
+            OpusCustomEncoder* CurOpusEncoderStereo = OpusEncoderStereo[iCurChanID];
+
+            if ( vecChannels[iCurChanID].GetAudioCompressionType() == CT_OPUS64 )
+            {
+                CurOpusEncoderMono   = Opus64EncoderMono[iCurChanID];
+                CurOpusEncoderStereo = Opus64EncoderStereo[iCurChanID];
+            }
+
             // get current number of CELT coded bytes
             const int iCeltNumCodedBytes =
                 vecChannels[iCurChanID].GetNetwFrameSize();
@@ -846,7 +1572,14 @@ void CServer::OnTimer()
             // CELT encoding
             CVector<unsigned char> vecCeltData ( iCeltNumCodedBytes );
 
-            if ( vecChannels[iCurChanID].GetNumAudioChannels() == 1 )
+            if ( vecChannels[iCurChanID].GetAudioCompressionType() == CT_NONE )
+            {
+                // uncompressed audio, no encoding required
+                PackRawAudio ( &vecsSendData[0],
+                               vecsSendData.Size(),
+                               &vecCeltData[0] );
+            }
+            else if ( vecChannels[iCurChanID].GetNumAudioChannels() == 1 )
             {
                 // mono:
 
@@ -864,12 +1597,12 @@ void CServer::OnTimer()
 // TODO find a better place than this: the setting does not change all the time
 //      so for speed optimization it would be better to set it only if the network
 //      frame size is changed
-opus_custom_encoder_ctl ( OpusEncoderMono[iCurChanID],
-                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes ) ) );
+opus_custom_encoder_ctl ( CurOpusEncoderMono,
+                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iCurFrameSize ) ) );
 
-                    opus_custom_encode ( OpusEncoderMono[iCurChanID],
+                    opus_custom_encode ( CurOpusEncoderMono,
                                          &vecsSendData[0],
-                                         SYSTEM_FRAME_SIZE_SAMPLES,
+                                         iCurFrameSize,
                                          &vecCeltData[0],
                                          iCeltNumCodedBytes );
                 }
@@ -891,12 +1624,12 @@ opus_custom_encoder_ctl ( OpusEncoderMono[iCurChanID],
 // TODO find a better place than this: the setting does not change all the time
 //      so for speed optimization it would be better to set it only if the network
 //      frame size is changed
-opus_custom_encoder_ctl ( OpusEncoderStereo[iCurChanID],
-                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes ) ) );
+opus_custom_encoder_ctl ( CurOpusEncoderStereo,
+                          OPUS_SET_BITRATE ( CalcBitRateBitsPerSecFromCodedBytes ( iCeltNumCodedBytes, iCurFrameSize ) ) );
 
-                    opus_custom_encode ( OpusEncoderStereo[iCurChanID],
+                    opus_custom_encode ( CurOpusEncoderStereo,
                                          &vecsSendData[0],
-                                         SYSTEM_FRAME_SIZE_SAMPLES,
+                                         iCurFrameSize,
                                          &vecCeltData[0],
                                          iCeltNumCodedBytes );
                 }
@@ -910,6 +1643,55 @@ opus_custom_encoder_ctl ( OpusEncoderStereo[iCurChanID],
             // update socket buffer size
             vecChannels[iCurChanID].UpdateSocketBufferSize();
         }
+
+        // send the submix of all local clients to the upstream server
+        if ( bUseFederationUplink )
+        {
+            // the submix must neither contain the mix of the upstream server
+            // nor the bus sums (all local clients are mixed directly)
+            CVector<double> vecdUplinkGains ( vecNumAudioChannels.Size(), 0 );
+
+            for ( j = 0; j < iNumClients; j++ )
+            {
+                vecdUplinkGains[j] = 1.0;
+            }
+
+            // the link is always stereo
+            CVector<short> vecsSendData ( ProcessData ( 2,
+                                                        vecvecsData,
+                                                        vecveciBusData,
+                                                        vecdUplinkGains,
+                                                        vecNumAudioChannels ) );
+
+            CVector<unsigned char> vecCeltData ( FEDERATION_LINK_NUM_CODED_BYTES );
+
+            opus_custom_encode ( OpusEncoderFederation,
+                                 &vecsSendData[0],
+                                 SYSTEM_FRAME_SIZE_SAMPLES,
+                                 &vecCeltData[0],
+                                 FEDERATION_LINK_NUM_CODED_BYTES );
+
+            Socket.SendPacket ( FederationChannel.PrepSendPacket ( vecCeltData ),
+                                FederationUpstreamAddr );
+
+            FederationChannel.UpdateSocketBufferSize();
+        }
+
+        // processing time statistic of the timer tick
+        if ( bLogProcTime )
+        {
+            const int iProcTimeUs =
+                CPreciseTime::DiffUs ( PreciseTime.elapsedUs(), iStartTimeUs );
+
+            iProcTimeNumTicks++;
+            iProcTimeNumClientTicks += iNumClients;
+            iProcTimeSumUs          += iProcTimeUs;
+
+            if ( iProcTimeUs > iProcTimeMaxUs )
+            {
+                iProcTimeMaxUs = iProcTimeUs;
+            }
+        }
     }
     else
     {
@@ -919,74 +1701,59 @@ opus_custom_encoder_ctl ( OpusEncoderStereo[iCurChanID],
     }
 }
 
-CVector<int16_t> CServer::ProcessData ( const int                   iCurIndex,
-                                        CVector<CVector<int16_t> >& vecvecsData,
-                                        CVector<double>&            vecdGains,
-                                        CVector<int>&               vecNumAudioChannels )
+// adds an input with the given gain to a mix which is not clipped, a stereo
+// input is attenuated for a mono mix and a mono input is copied in both audio
+// channels of a stereo mix
+template<class TData> void AddToMix ( const int              iCurNumAudChan,
+                                      const int              iInNumAudChan,
+                                      const int              iFrameSizeSamples,
+                                      const CVector<TData>&  vecInData,
+                                      const double           dGain,
+                                      CVector<int32_t>&      veciOutData )
 {
-    int i, j, k;
-
-    // get number of audio channels of current channel
-    const int iCurNumAudChan = vecNumAudioChannels[iCurIndex];
-
-    // number of samples for output vector
-    const int iNumOutSamples = iCurNumAudChan * SYSTEM_FRAME_SIZE_SAMPLES;
+    int i, k;
 
-    // init return vector with zeros since we mix all channels on that vector
-    CVector<int16_t> vecsOutData ( iNumOutSamples, 0 );
-
-    const int iNumClients = vecvecsData.Size();
-
-    // mix all audio data from all clients together
     if ( iCurNumAudChan == 1 )
     {
         // Mono target channel -------------------------------------------------
-        for ( j = 0; j < iNumClients; j++ )
+        // if channel gain is 1, avoid multiplication for speed optimization
+        if ( dGain == static_cast<double> ( 1.0 ) )
         {
-            // if channel gain is 1, avoid multiplication for speed optimization
-            if ( vecdGains[j] == static_cast<double> ( 1.0 ) )
+            if ( iInNumAudChan == 1 )
             {
-                if ( vecNumAudioChannels[j] == 1 )
+                // mono
+                for ( i = 0; i < iFrameSizeSamples; i++ )
                 {
-                    // mono
-                    for ( i = 0; i < SYSTEM_FRAME_SIZE_SAMPLES; i++ )
-                    {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] + vecvecsData[j][i] );
-                    }
+                    veciOutData[i] += vecInData[i];
                 }
-                else
+            }
+            else
+            {
+                // stereo: apply stereo-to-mono attenuation
+                for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
                 {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < SYSTEM_FRAME_SIZE_SAMPLES; i++, k += 2 )
-                    {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] +
-                            ( vecvecsData[j][k] + vecvecsData[j][k + 1] ) / 2 );
-                    }
+                    veciOutData[i] += ( vecInData[k] + vecInData[k + 1] ) / 2;
                 }
             }
-            else
+        }
+        else
+        {
+            if ( iInNumAudChan == 1 )
             {
-                if ( vecNumAudioChannels[j] == 1 )
+                // mono
+                for ( i = 0; i < iFrameSizeSamples; i++ )
                 {
-                    // mono
-                    for ( i = 0; i < SYSTEM_FRAME_SIZE_SAMPLES; i++ )
-                    {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] +
-                            vecvecsData[j][i] * vecdGains[j] );
-                    }
+                    veciOutData[i] +=
+                        static_cast<int32_t> ( vecInData[i] * dGain );
                 }
-                else
+            }
+            else
+            {
+                // stereo: apply stereo-to-mono attenuation
+                for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
                 {
-                    // stereo: apply stereo-to-mono attenuation
-                    for ( i = 0, k = 0; i < SYSTEM_FRAME_SIZE_SAMPLES; i++, k += 2 )
-                    {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] + vecdGains[j] *
-                            ( vecvecsData[j][k] + vecvecsData[j][k + 1] ) / 2 );
-                    }
+                    veciOutData[i] += static_cast<int32_t> ( dGain *
+                        ( vecInData[k] + vecInData[k + 1] ) / 2 );
                 }
             }
         }
@@ -994,66 +1761,174 @@ CVector<int16_t> CServer::ProcessData ( const int                   iCurIndex,
     else
     {
         // Stereo target channel -----------------------------------------------
-        for ( j = 0; j < iNumClients; j++ )
+        // if channel gain is 1, avoid multiplication for speed optimization
+        if ( dGain == static_cast<double> ( 1.0 ) )
         {
-            // if channel gain is 1, avoid multiplication for speed optimization
-            if ( vecdGains[j] == static_cast<double> ( 1.0 ) )
+            if ( iInNumAudChan == 1 )
             {
-                if ( vecNumAudioChannels[j] == 1 )
+                // mono: copy same mono data in both out stereo audio channels
+                for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
                 {
-                    // mono: copy same mono data in both out stereo audio channels
-                    for ( i = 0, k = 0; i < SYSTEM_FRAME_SIZE_SAMPLES; i++, k += 2 )
-                    {
-                        // left channel
-                        vecsOutData[k] =
-                            Double2Short ( vecsOutData[k] + vecvecsData[j][i] );
-
-                        // right channel
-                        vecsOutData[k + 1] =
-                            Double2Short ( vecsOutData[k + 1] + vecvecsData[j][i] );
-                    }
+                    veciOutData[k]     += vecInData[i]; // left channel
+                    veciOutData[k + 1] += vecInData[i]; // right channel
                 }
-                else
+            }
+            else
+            {
+                // stereo
+                for ( i = 0; i < 2 * iFrameSizeSamples; i++ )
                 {
-                    // stereo
-                    for ( i = 0; i < iNumOutSamples; i++ )
-                    {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] + vecvecsData[j][i] );
-                    }
+                    veciOutData[i] += vecInData[i];
                 }
             }
-            else
+        }
+        else
+        {
+            if ( iInNumAudChan == 1 )
             {
-                if ( vecNumAudioChannels[j] == 1 )
+                // mono: copy same mono data in both out stereo audio channels
+                for ( i = 0, k = 0; i < iFrameSizeSamples; i++, k += 2 )
                 {
-                    // mono: copy same mono data in both out stereo audio channels
-                    for ( i = 0, k = 0; i < SYSTEM_FRAME_SIZE_SAMPLES; i++, k += 2 )
-                    {
-                        // left channel
-                        vecsOutData[k] = Double2Short (
-                            vecsOutData[k] + vecvecsData[j][i] * vecdGains[j] );
+                    const int32_t iCurSample =
+                        static_cast<int32_t> ( vecInData[i] * dGain );
 
-                        // right channel
-                        vecsOutData[k + 1] = Double2Short (
-                            vecsOutData[k + 1] + vecvecsData[j][i] * vecdGains[j] );
-                    }
+                    veciOutData[k]     += iCurSample; // left channel
+                    veciOutData[k + 1] += iCurSample; // right channel
                 }
-                else
+            }
+            else
+            {
+                // stereo
+                for ( i = 0; i < 2 * iFrameSizeSamples; i++ )
                 {
-                    // stereo
-                    for ( i = 0; i < iNumOutSamples; i++ )
+                    veciOutData[i] +=
+                        static_cast<int32_t> ( vecInData[i] * dGain );
+                }
+            }
+        }
+    }
+}
+
+void CServer::MixData ( const int                   iCurNumAudChan,
+                        CVector<CVector<int16_t> >& vecvecsData,
+                        CVector<CVector<int32_t> >& vecveciBusData,
+                        CVector<double>&            vecdGains,
+                        CVector<int>&               vecNumAudioChannels,
+                        CVector<int32_t>&           veciOutData )
+{
+    int j;
+
+    // the gains and the numbers of audio channels of the bus sums are stored
+    // after the ones of all other inputs
+    const int iFirstBusIdx = vecvecsData.Size();
+
+    // init output vector with zeros since we mix all inputs on that vector
+    veciOutData.Init ( iCurNumAudChan * iServerFrameSizeSamples, 0 );
+
+    // mix all audio data from all clients together, inputs with zero gain are
+    // skipped (e.g. channels which are mixed via a bus)
+    for ( j = 0; j < iFirstBusIdx; j++ )
+    {
+        if ( vecdGains[j] != 0 )
+        {
+            AddToMix ( iCurNumAudChan,
+                       vecNumAudioChannels[j],
+                       iServerFrameSizeSamples,
+                       vecvecsData[j],
+                       vecdGains[j],
+                       veciOutData );
+        }
+    }
+
+    // add the bus sums
+    for ( j = 0; j < vecveciBusData.Size(); j++ )
+    {
+        if ( vecdGains[iFirstBusIdx + j] != 0 )
+        {
+            AddToMix ( iCurNumAudChan,
+                       vecNumAudioChannels[iFirstBusIdx + j],
+                       iServerFrameSizeSamples,
+                       vecveciBusData[j],
+                       vecdGains[iFirstBusIdx + j],
+                       veciOutData );
+        }
+    }
+}
+
+CVector<int16_t> CServer::ProcessData ( const int                   iCurNumAudChan,
+                                        CVector<CVector<int16_t> >& vecvecsData,
+                                        CVector<CVector<int32_t> >& vecveciBusData,
+                                        CVector<double>&            vecdGains,
+                                        CVector<int>&               vecNumAudioChannels )
+{
+    CVector<int32_t> veciMixData;
+
+    MixData ( iCurNumAudChan,
+              vecvecsData,
+              vecveciBusData,
+              vecdGains,
+              vecNumAudioChannels,
+              veciMixData );
+
+    // the mix is only clipped at the output
+    CVector<int16_t> vecsOutData ( veciMixData.Size() );
+
+    for ( int i = 0; i < veciMixData.Size(); i++ )
+    {
+        vecsOutData[i] = Double2Short ( veciMixData[i] );
+    }
+
+    return vecsOutData;
+}
+
+void CServer::UpdateBusInfo()
+{
+    int i, j;
+
+    // get the submix buses which are in use by the connected channels
+    // (a bus index of -1 means that the channel is not assigned to a bus)
+    vecstrBusNames.Init ( 0 );
+
+    for ( i = 0; i < iNumChannels; i++ )
+    {
+        vecChanBusIdx[i] = -1;
+
+        if ( vecChannels[i].IsConnected() )
+        {
+            const QString strBusName = vecChannels[i].GetBusName();
+
+            if ( !strBusName.isEmpty() )
+            {
+                // look for the bus in the list of buses in use
+                for ( j = 0; j < vecstrBusNames.Size(); j++ )
+                {
+                    if ( vecstrBusNames[j] == strBusName )
                     {
-                        vecsOutData[i] =
-                            Double2Short ( vecsOutData[i] +
-                            vecvecsData[j][i] * vecdGains[j] );
+                        vecChanBusIdx[i] = j;
                     }
                 }
+
+                // not yet in use, add a new bus
+                if ( vecChanBusIdx[i] < 0 )
+                {
+                    vecChanBusIdx[i] = vecstrBusNames.Size();
+                    vecstrBusNames.Add ( strBusName );
+                }
             }
         }
     }
 
-    return vecsOutData;
+    // get the bus gains of the mix of each channel
+    for ( i = 0; i < iNumChannels; i++ )
+    {
+        vecvecdListenerBusGains[i].Init ( vecstrBusNames.Size() );
+
+        for ( j = 0; j < vecstrBusNames.Size(); j++ )
+        {
+            vecvecdListenerBusGains[i][j] =
+                vecChannels[i].GetBusGain ( vecstrBusNames[j] );
+        }
+    }
 }
 
 CVector<CChannelInfo> CServer::CreateChannelList()
@@ -1093,6 +1968,10 @@ vecChannels[i].CreateConClientListNameMes ( vecChanInfo );
         }
     }
 
+    // the number of connected clients has changed, check if a direct
+    // connection of two clients is possible
+    BrokerP2PConnection();
+
     // create status HTML file if enabled
     if ( bWriteStatusHTMLFile )
     {
@@ -1111,6 +1990,51 @@ vecChannels[iCurChanID].CreateConClientListNameMes ( vecChanInfo );
     vecChannels[iCurChanID].CreateConClientListMes ( vecChanInfo );
 }
 
+void CServer::BrokerP2PConnection()
+{
+    // A direct peer-to-peer connection is only possible for a duet, i.e.,
+    // exactly two clients are connected and both requested it. The server
+    // tells each client the address of the other one, the clients then open
+    // the NAT with an empty message and send the audio directly to each other
+    // (the connection to the server is kept for the fallback).
+    CVector<int> vecConChanIDs;
+
+    for ( int i = 0; i < iNumChannels; i++ )
+    {
+        if ( vecChannels[i].IsConnected() )
+        {
+            vecConChanIDs.Add ( i );
+        }
+    }
+
+    // (the peers exchange frames with the normal frame size, therefore it is
+    // not supported in the fast update mode)
+    if ( ( iServerFrameSizeSamples == SYSTEM_FRAME_SIZE_SAMPLES ) &&
+         ( vecConChanIDs.Size() == 2 ) &&
+         vecChannels[vecConChanIDs[0]].IsP2PRequested() &&
+         vecChannels[vecConChanIDs[1]].IsP2PRequested() )
+    {
+        const CHostAddress FirstAddr  = vecChannels[vecConChanIDs[0]].GetAddress();
+        const CHostAddress SecondAddr = vecChannels[vecConChanIDs[1]].GetAddress();
+
+        // a client which uses the local transport can only be reached by
+        // another co-located client
+        if ( FirstAddr.IsLocalTransport() == SecondAddr.IsLocalTransport() )
+        {
+            ConnLessProtocol.CreateCLSendEmptyMesMes ( FirstAddr,  SecondAddr );
+            ConnLessProtocol.CreateCLSendEmptyMesMes ( SecondAddr, FirstAddr );
+
+            // the clients apply their channel gains of these IDs to the
+            // local mix of the direct connection
+            vecChannels[vecConChanIDs[0]].CreateP2PChanIDsMes ( vecConChanIDs[0],
+                                                                vecConChanIDs[1] );
+
+            vecChannels[vecConChanIDs[1]].CreateP2PChanIDsMes ( vecConChanIDs[1],
+                                                                vecConChanIDs[0] );
+        }
+    }
+}
+
 void CServer::CreateAndSendChatTextForAllConChannels ( const int      iCurChanID,
                                                        const QString& strChatText )
 {
@@ -1219,12 +2143,34 @@ int CServer::CheckAddr ( const CHostAddress& Addr )
 
 bool CServer::PutData ( const CVector<uint8_t>& vecbyRecBuf,
                         const int               iNumBytesRead,
-                        const CHostAddress&     HostAdr )
+                        const CHostAddress&     HostAdr,
+                        const int               iRecTimeUs )
 {
     bool bChanOK                        = true; // init with ok, might be overwritten
     bool bNewChannelReserved            = false;
     bool bIsNotEvaluatedProtocolMessage = false;
 
+    // packets from the upstream server of a federation link are processed by
+    // the uplink channel, these packets shall not start the server
+    if ( bUseFederationUplink && ( FederationUpstreamAddr == HostAdr ) )
+    {
+        const EPutDataStat eStat =
+            FederationChannel.PutData ( vecbyRecBuf, iNumBytesRead, iRecTimeUs );
+
+        if ( ( eStat == PS_AUDIO_OK ) || ( eStat == PS_AUDIO_ERR ) )
+        {
+            // count received frames for the clock offset estimation (the
+            // link uses the preferred frame size factor of one)
+            Mutex.lock();
+            {
+                iFederationNumFramesRec++;
+            }
+            Mutex.unlock();
+        }
+
+        return false;
+    }
+
     Mutex.lock();
     {
         // Get channel ID ------------------------------------------------------
@@ -1250,6 +2196,13 @@ bool CServer::PutData ( const CVector<uint8_t>& vecbyRecBuf,
 
                     // reset channel info
                     vecChannels[iCurChanID].ResetInfo();
+                    vecChannels[iCurChanID].ResetBusInfo();
+                    AtomicStoreRelease ( iBusInfoChanged, 1 );
+                    vecChannels[iCurChanID].SetIsFederationLink ( false );
+                    vecChannels[iCurChanID].SetIsForwarding ( false );
+                    vecChannels[iCurChanID].SetP2PRequested ( false );
+                    vecChannels[iCurChanID].SetMixMinus ( false );
+                    vecChannels[iCurChanID].SetIsLocal ( HostAdr.IsLocalTransport() );
 
                     // reset the channel gains of current channel, at the same
                     // time reset gains of this channel ID for all other channels
@@ -1260,6 +2213,7 @@ bool CServer::PutData ( const CVector<uint8_t>& vecbyRecBuf,
                         // other channels (we do not distinguish the case if
                         // i == iCurChanID for simplicity)
                         vecChannels[i].SetGain ( iCurChanID, (double) 1.0 );
+                        vecChannels[i].SetGainOverride ( iCurChanID, false, (double) 1.0 );
                     }
 
                     // set flag for new reserved channel
@@ -1287,7 +2241,9 @@ bool CServer::PutData ( const CVector<uint8_t>& vecbyRecBuf,
         if ( bChanOK )
         {
             // put packet in socket buffer
-            switch ( vecChannels[iCurChanID].PutData ( vecbyRecBuf, iNumBytesRead ) )
+            switch ( vecChannels[iCurChanID].PutData ( vecbyRecBuf,
+                                                       iNumBytesRead,
+                                                       iRecTimeUs ) )
             {
             case PS_AUDIO_OK:
                 PostWinMessage ( MS_JIT_BUF_PUT, MUL_COL_LED_GREEN, iCurChanID );
@@ -1365,15 +2321,19 @@ CreateAndSendChanListForAllConChannels();
 void CServer::GetConCliParam ( CVector<CHostAddress>& vecHostAddresses,
                                CVector<QString>&      vecsName,
                                CVector<int>&          veciJitBufNumFrames,
-                               CVector<int>&          veciNetwFrameSizeFact )
+                               CVector<int>&          veciNetwFrameSizeFact,
+                               CVector<double>&       vecdClockDriftPpm,
+                               CVector<int>&          veciInterArrivalJitterUs )
 {
     CHostAddress InetAddr;
 
     // init return values
-    vecHostAddresses.Init      ( iNumChannels );
-    vecsName.Init              ( iNumChannels );
-    veciJitBufNumFrames.Init   ( iNumChannels );
-    veciNetwFrameSizeFact.Init ( iNumChannels );
+    vecHostAddresses.Init         ( iNumChannels );
+    vecsName.Init                 ( iNumChannels );
+    veciJitBufNumFrames.Init      ( iNumChannels );
+    veciNetwFrameSizeFact.Init    ( iNumChannels );
+    vecdClockDriftPpm.Init        ( iNumChannels );
+    veciInterArrivalJitterUs.Init ( iNumChannels );
 
     // check all possible channels
     for ( int i = 0; i < iNumChannels; i++ )
@@ -1381,10 +2341,12 @@ void CServer::GetConCliParam ( CVector<CHostAddress>& vecHostAddresses,
         if ( vecChannels[i].GetAddress ( InetAddr ) )
         {
             // get requested data
-            vecHostAddresses[i]      = InetAddr;
-            vecsName[i]              = vecChannels[i].GetName();
-            veciJitBufNumFrames[i]   = vecChannels[i].GetSockBufNumFrames();
-            veciNetwFrameSizeFact[i] = vecChannels[i].GetNetwFrameSizeFact();
+            vecHostAddresses[i]         = InetAddr;
+            vecsName[i]                 = vecChannels[i].GetName();
+            veciJitBufNumFrames[i]      = vecChannels[i].GetSockBufNumFrames();
+            veciNetwFrameSizeFact[i]    = vecChannels[i].GetNetwFrameSizeFact();
+            vecdClockDriftPpm[i]        = vecChannels[i].GetClockDriftPpm();
+            veciInterArrivalJitterUs[i] = vecChannels[i].GetInterArrivalJitterUs();
         }
     }
 }
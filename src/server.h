@@ -43,6 +43,18 @@
 // no valid channel number
 #define INVALID_CHANNEL_ID                  ( MAX_NUM_CHANNELS + 1 )
 
+// server federation: the link to the upstream server always uses a stereo OPUS
+// stream in high quality (same number of coded bytes as the client setting
+// "OPUS_NUM_BYTES_STEREO_HIGH_QUALITY")
+#define FEDERATION_LINK_NUM_CODED_BYTES     142
+
+// interval for measuring and reporting the federation link statistics
+#define FEDERATION_STATS_INTERVAL_MS        10000 // ms
+
+// interval for reporting the processing time of the timer tick (the cost per
+// client is logged so that the normal and the fast update mode can be compared)
+#define PROC_TIME_STATS_INTERVAL_MS         10000 // ms
+
 
 /* Classes ********************************************************************/
 #if ( defined ( WIN32 ) || defined ( _WIN32 ) )
@@ -52,7 +64,7 @@ class CHighPrecisionTimer : public QObject
     Q_OBJECT
 
 public:
-    CHighPrecisionTimer();
+    CHighPrecisionTimer ( const int iNewFrameSizeSamples );
 
     void Start();
     void Stop();
@@ -60,6 +72,7 @@ public:
 
 protected:
     QTimer       Timer;
+    int          iTimerResolutionMs;
     CVector<int> veciTimeOutIntervals;
     int          iCurPosInVector;
     int          iIntervalCounter;
@@ -85,7 +98,7 @@ class CHighPrecisionTimer : public QThread
     Q_OBJECT
 
 public:
-    CHighPrecisionTimer();
+    CHighPrecisionTimer ( const int iNewFrameSizeSamples );
 
     void Start();
     void Stop();
@@ -124,7 +137,13 @@ public:
               const QString& strCentralServer,
               const QString& strServerInfo,
               const QString& strNewWelcomeMessage,
-              const bool     bNCentServPingServerInList );
+              const bool     bNCentServPingServerInList,
+              const QString& strFederationUpstream,
+              const bool     bNUseForwarding,
+              const bool     bNUseFastUpdate,
+              const bool     bNLogProcTime );
+
+    virtual ~CServer();
 
     void Start();
     void Stop();
@@ -132,12 +151,15 @@ public:
 
     bool PutData ( const CVector<uint8_t>& vecbyRecBuf,
                    const int               iNumBytesRead,
-                   const CHostAddress&     HostAdr );
+                   const CHostAddress&     HostAdr,
+                   const int               iRecTimeUs );
 
     void GetConCliParam ( CVector<CHostAddress>& vecHostAddresses,
                           CVector<QString>&      vecsName,
                           CVector<int>&          veciJitBufNumFrames,
-                          CVector<int>&          veciNetwFrameSizeFact );
+                          CVector<int>&          veciNetwFrameSizeFact,
+                          CVector<double>&       vecdClockDriftPpm,
+                          CVector<int>&          veciInterArrivalJitterUs );
 
 
     // Server list management --------------------------------------------------
@@ -179,6 +201,14 @@ public:
         { return ServerListManager.GetServerCountry(); }
 
 
+    // Server federation -------------------------------------------------------
+    bool GetFederationLinkEnabled() const { return bUseFederationUplink; }
+
+    void GetFederationLinkStats ( int&    iPingTimeMs,
+                                  int&    iOneHopDelayMs,
+                                  double& dClockOffsetPPM );
+
+
     // GUI settings ------------------------------------------------------------
     void SetAutoRunMinimized ( const bool NAuRuMin )
         { bAutoRunMinimized = NAuRuMin; }
@@ -202,10 +232,22 @@ protected:
     void CreateAndSendChanListForThisChan ( const int iCurChanID );
     void CreateAndSendChatTextForAllConChannels ( const int      iCurChanID,
                                                   const QString& strChatText );
+    void BrokerP2PConnection();
     void WriteHTMLChannelList();
+    void ResetFederationLinkStats();
+
+    void UpdateBusInfo();
+
+    void MixData ( const int                   iCurNumAudChan,
+                   CVector<CVector<int16_t> >& vecvecsData,
+                   CVector<CVector<int32_t> >& vecveciBusData,
+                   CVector<double>&            vecdGains,
+                   CVector<int>&               vecNumAudioChannels,
+                   CVector<int32_t>&           veciOutData );
 
-    CVector<int16_t> ProcessData ( const int                   iCurIndex,
+    CVector<int16_t> ProcessData ( const int                   iCurNumAudChan,
                                    CVector<CVector<int16_t> >& vecvecsData,
+                                   CVector<CVector<int32_t> >& vecveciBusData,
                                    CVector<double>&            vecdGains,
                                    CVector<int>&               vecNumAudioChannels );
 
@@ -230,6 +272,19 @@ protected:
     OpusCustomDecoder*  OpusDecoderMono[MAX_NUM_CHANNELS];
     OpusCustomEncoder*  OpusEncoderStereo[MAX_NUM_CHANNELS];
     OpusCustomDecoder*  OpusDecoderStereo[MAX_NUM_CHANNELS];
+    OpusCustomMode*     Opus64Mode[MAX_NUM_CHANNELS];
+    OpusCustomEncoder*  Opus64EncoderMono[MAX_NUM_CHANNELS];
+    OpusCustomDecoder*  Opus64DecoderMono[MAX_NUM_CHANNELS];
+    OpusCustomEncoder*  Opus64EncoderStereo[MAX_NUM_CHANNELS];
+    OpusCustomDecoder*  Opus64DecoderStereo[MAX_NUM_CHANNELS];
+
+    // fast update mode: the server runs with the small frame size, channels
+    // with the normal frame size deliver and get a frame only every other
+    // timer tick, therefore their frames are split in two halves
+    int                 iServerFrameSizeSamples;
+    bool                bSecondHalfTick;
+    CVector<CVector<int16_t> > vecvecsFrameConvIn;
+    CVector<CVector<int16_t> > vecvecsFrameConvOut;
 
     CVector<QString>    vstrChatColors;
 
@@ -255,6 +310,49 @@ protected:
     // messaging
     QString             strWelcomeMessage;
 
+    // server federation: the uplink to the upstream server is a client type
+    // channel which transmits the submix of all local clients and receives
+    // the mix of all other clients of the federation
+    bool                bUseFederationUplink;
+    CHostAddress        FederationUpstreamAddr;
+    CChannel            FederationChannel;
+    CProtocol           FederationConnLessProtocol;
+    OpusCustomMode*     OpusModeFederation;
+    OpusCustomEncoder*  OpusEncoderFederation;
+    OpusCustomDecoder*  OpusDecoderFederation;
+    CPreciseTime        PreciseTime;
+    QTimer              TimerFederationStats;
+
+    // federation link statistics: the relative clock offset is estimated by
+    // comparing the number of received upstream frames with the number of
+    // local timer ticks
+    int                 iFederationNumFramesRec;
+    int                 iFederationNumTicks;
+    int                 iFederationRefFrameDiff;
+    int                 iFederationRefNumTicks;
+    bool                bFederationRefIsValid;
+    int                 iFederationPingTimeMs;
+    CRttStatistics      FederationRttStats;
+    int                 iFederationUpstreamJitBufNumFrames;
+
+    // processing time statistic of the timer tick (the timer tick and the
+    // report are both processed in the thread of the server object), only
+    // measured and logged if enabled on the command line
+    bool                bLogProcTime;
+    QTimer              TimerProcTimeStats;
+    int                 iProcTimeNumTicks;
+    int                 iProcTimeNumClientTicks;
+    qint64              iProcTimeSumUs;
+    int                 iProcTimeMaxUs;
+
+    // submix buses: the buses in use, the bus of each channel and the bus
+    // gains of the mix of each channel are only resolved again if a channel
+    // joined or left or a bus name or a bus gain was changed
+    QAtomicInt          iBusInfoChanged;
+    CVector<QString>    vecstrBusNames;
+    CVector<int>        vecChanBusIdx;
+    CVector<CVector<double> > vecvecdListenerBusGains;
+
 signals:
     void Started();
     void Stopped();
@@ -272,6 +370,9 @@ public slots:
     void OnCLPingReceived ( CHostAddress InetAddr, int iMs )
         { ConnLessProtocol.CreateCLPingMes ( InetAddr, iMs ); }
 
+    void OnCLProbeReceived ( CHostAddress InetAddr, int iProbeIdx, int iMs )
+        { ConnLessProtocol.CreateCLProbeMes ( InetAddr, iProbeIdx, iMs ); }
+
     void OnCLPingWithNumClientsReceived ( CHostAddress InetAddr,
                                           int          iMs,
                                           int )
@@ -281,7 +382,7 @@ public slots:
                                                          GetNumberOfConnectedClients() );
     }
 
-    void OnCLSendEmptyMes ( CHostAddress TargetInetAddr )
+    void OnCLSendEmptyMes ( CHostAddress, CHostAddress TargetInetAddr )
     {
         // only send empty message if server list is enabled and this is not
         // the central server
@@ -308,6 +409,35 @@ public slots:
 
     void OnCLDisconnection ( CHostAddress InetAddr );
 
+    void OnP2PRequested() { BrokerP2PConnection(); }
+    void OnBusInfoHasChanged() { AtomicStoreRelease ( iBusInfoChanged, 1 ); }
+
+    // server federation
+    void OnTimerFederationStats();
+    void OnTimerProcTimeStats();
+
+    void OnSendFederationProtMessage ( CVector<uint8_t> vecMessage )
+        { Socket.SendPacket ( vecMessage, FederationUpstreamAddr ); }
+
+    void OnFederationDetCLMess ( CVector<uint8_t> vecbyMesBodyData,
+                                 int              iRecID )
+    {
+        FederationConnLessProtocol.ParseConnectionLessMessageBody ( vecbyMesBodyData,
+                                                                    iRecID,
+                                                                    FederationUpstreamAddr );
+    }
+
+    void OnFederationCLPingReceived ( CHostAddress InetAddr, int iTimeStampUs );
+
+    void OnFederationReqJittBufSize()
+        { FederationChannel.CreateJitBufMes ( AUTO_NET_BUF_SIZE_FOR_PROTOCOL ); }
+
+    void OnFederationJittBufSizeChanged ( int iNewJitBufSize )
+        { iFederationUpstreamJitBufNumFrames = iNewJitBufSize; }
+
+    void OnFederationReqChanInfo();
+    void OnFederationNewConnection();
+
 
     // CODE TAG: MAX_NUM_CHANNELS_TAG
     // make sure we have MAX_NUM_CHANNELS connections!!!
@@ -45,7 +45,8 @@ CServerDlg::CServerDlg ( CServer*        pNServP,
     lvwClients->setWhatsThis ( tr ( "<b>Client List:</b> The client list "
         "shows all clients which are currently connected to this server. Some "
         "informations about the clients like the IP address, name, buffer "
-        "state are given for each connected client." ) );
+        "state, the clock drift relative to the server and the inter-arrival "
+        "jitter of the audio packets are given for each connected client." ) );
 
     lvwClients->setAccessibleName ( tr ( "Connected clients list view" ) );
 
@@ -437,13 +438,17 @@ void CServerDlg::OnTimer()
     CVector<QString>      vecsName;
     CVector<int>          veciJitBufNumFrames;
     CVector<int>          veciNetwFrameSizeFact;
+    CVector<double>       vecdClockDriftPpm;
+    CVector<int>          veciInterArrivalJitterUs;
 
     ListViewMutex.lock();
     {
         pServer->GetConCliParam ( vecHostAddresses,
                                   vecsName,
                                   veciJitBufNumFrames,
-                                  veciNetwFrameSizeFact );
+                                  veciNetwFrameSizeFact,
+                                  vecdClockDriftPpm,
+                                  veciInterArrivalJitterUs );
 
         // we assume that all vectors have the same length
         const int iNumChannels = vecHostAddresses.Size();
@@ -470,6 +475,14 @@ void CServerDlg::OnTimer()
                     veciNetwFrameSizeFact[i] * SYSTEM_BLOCK_DURATION_MS_FLOAT
                     ), 'f', 2 ) );
 
+                // clock drift of the client relative to the server
+                vecpListViewItems[i]->setText ( 5,
+                    QString().setNum ( vecdClockDriftPpm[i], 'f', 1 ) );
+
+                // inter-arrival jitter of the audio packets of the client
+                vecpListViewItems[i]->setText ( 6,
+                    QString().setNum ( veciInterArrivalJitterUs[i] / 1000.0, 'f', 2 ) );
+
                 vecpListViewItems[i]->setHidden ( false );
             }
             else
@@ -366,6 +366,62 @@ void CServerLogging::AddServerStopped()
     HistoryGraph.Update();
 }
 
+void CServerLogging::AddFederationLinkStats ( const QHostAddress& UpstreamInetAddr,
+                                              const int           iPingTimeMs,
+                                              const int           iOneHopDelayMs,
+                                              const double        dClockOffsetPPM,
+                                              const QString&      strRttStats )
+{
+    // logging of the federation link statistics (note that this line has
+    // more fields than a connection entry so that it is ignored by the log
+    // file parser for the history graph)
+    const QString strLogStr = CurTimeDatetoLogString() + ", " +
+        UpstreamInetAddr.toString() + ", federation link, ping " +
+        QString().setNum ( iPingTimeMs ) + " ms, one-hop latency " +
+        QString().setNum ( iOneHopDelayMs ) + " ms, clock offset " +
+        QString().setNum ( dClockOffsetPPM, 'f', 1 ) + " ppm, round trip " +
+        strRttStats;
+
+#ifndef _WIN32
+    QTextStream tsConsoleStream ( stdout );
+    tsConsoleStream << strLogStr << endl; // on console
+#endif
+    *this << strLogStr; // in log file
+}
+
+void CServerLogging::AddProcTimeStats ( const int    iFrameSizeSamples,
+                                        const double dTickDurationUs,
+                                        const double dMeanTimeUs,
+                                        const int    iMaxTimeUs,
+                                        const double dMeanNumClients )
+{
+    // logging of the processing time of the server timer tick, the cost per
+    // client is given relative to the tick duration, i.e., as CPU load of one
+    // core (this line has more fields than a connection entry so that it is
+    // ignored by the log file parser for the history graph)
+    double dCostPerClientPercent = 0;
+
+    if ( dMeanNumClients > 0 )
+    {
+        dCostPerClientPercent =
+            dMeanTimeUs / dMeanNumClients / dTickDurationUs * 100;
+    }
+
+    const QString strLogStr = CurTimeDatetoLogString() + ", " +
+        "processing time, frame size " + QString().setNum ( iFrameSizeSamples ) +
+        " samples, mean " + QString().setNum ( dMeanTimeUs, 'f', 0 ) +
+        " us (max " + QString().setNum ( iMaxTimeUs ) + " us) of " +
+        QString().setNum ( dTickDurationUs, 'f', 0 ) + " us per tick, " +
+        QString().setNum ( dMeanNumClients, 'f', 1 ) + " clients, " +
+        QString().setNum ( dCostPerClientPercent, 'f', 2 ) + " % per client";
+
+#ifndef _WIN32
+    QTextStream tsConsoleStream ( stdout );
+    tsConsoleStream << strLogStr << endl; // on console
+#endif
+    *this << strLogStr; // in log file
+}
+
 void CServerLogging::operator<< ( const QString& sNewStr )
 {
     if ( bDoLogging )
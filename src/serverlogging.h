@@ -124,6 +124,16 @@ public:
     void EnableHistory ( const QString& strHistoryFileName );
     void AddNewConnection ( const QHostAddress& ClientInetAddr );
     void AddServerStopped();
+    void AddFederationLinkStats ( const QHostAddress& UpstreamInetAddr,
+                                  const int           iPingTimeMs,
+                                  const int           iOneHopDelayMs,
+                                  const double        dClockOffsetPPM,
+                                  const QString&      strRttStats );
+    void AddProcTimeStats ( const int    iFrameSizeSamples,
+                            const double dTickDurationUs,
+                            const double dMeanTimeUs,
+                            const int    iMaxTimeUs,
+                            const double dMeanNumClients );
     void ParseLogFile ( const QString& strFileName );
 
 protected:
@@ -85,10 +85,48 @@ void CSettings::Load()
             }
         }
 
+        // stored jitter buffer sizes per server
+        for ( iIdx = 0; iIdx < MAX_NUM_STORED_JIT_BUF_SIZES; iIdx++ )
+        {
+            pClient->vecStoredJitBufAddr[iIdx] =
+                GetIniSetting ( IniXMLDocument, "client",
+                                QString ( "storedjitbufaddr%1" ).arg ( iIdx ), "" );
+
+            if ( GetNumericIniSet ( IniXMLDocument, "client", QString ( "storedjitbuf%1" ).arg ( iIdx ),
+                 MIN_NET_BUF_SIZE_NUM_BL, MAX_NET_BUF_SIZE_NUM_BL, iValue ) )
+            {
+                pClient->vecStoredJitBufSizes[iIdx] = iValue;
+            }
+
+            if ( GetNumericIniSet ( IniXMLDocument, "client", QString ( "storedjitbufserver%1" ).arg ( iIdx ),
+                 MIN_NET_BUF_SIZE_NUM_BL, MAX_NET_BUF_SIZE_NUM_BL, iValue ) )
+            {
+                pClient->vecStoredServerJitBufSizes[iIdx] = iValue;
+            }
+        }
+
         // name
         pClient->ChannelInfo.strName =
             GetIniSetting ( IniXMLDocument, "client", "name" );
 
+        // submix bus
+        pClient->strBusName =
+            GetIniSetting ( IniXMLDocument, "client", "busname" ).left ( MAX_LEN_BUS_NAME );
+
+        // submix bus gains
+        for ( iIdx = 0; iIdx < MAX_NUM_STORED_BUS_GAINS; iIdx++ )
+        {
+            pClient->vecStoredBusNames[iIdx] =
+                GetIniSetting ( IniXMLDocument, "client",
+                                QString ( "storedbusname%1" ).arg ( iIdx ), "" ).left ( MAX_LEN_BUS_NAME );
+
+            if ( GetNumericIniSet ( IniXMLDocument, "client", QString ( "storedbusgain%1" ).arg ( iIdx ),
+                 0, AUD_MIX_FADER_MAX, iValue ) )
+            {
+                pClient->vecStoredBusGains[iIdx] = iValue;
+            }
+        }
+
         // instrument
         if ( GetNumericIniSet ( IniXMLDocument, "client", "instrument",
              0, CInstPictures::GetNumAvailableInst() - 1, iValue ) )
@@ -116,6 +154,13 @@ void CSettings::Load()
             pClient->SetReverbOnLeftChan ( bValue );
         }
 
+        // local monitoring level
+        if ( GetNumericIniSet ( IniXMLDocument, "client", "monitorlevel",
+             0, AUD_MONITOR_MAX, iValue ) )
+        {
+            pClient->SetMonitorLevel ( iValue );
+        }
+
         // sound card selection
         // special case with this setting: the sound card initialization depends
         // on this setting call, therefore, if no setting file parameter could
@@ -225,6 +270,56 @@ void CSettings::Load()
             pClient->SetUseStereo ( bValue );
         }
 
+        // flag whether the streams shall be mixed locally (forwarding mode)
+        if ( GetFlagIniSet ( IniXMLDocument, "client", "forwarding", bValue ) )
+        {
+            pClient->SetUseForwarding ( bValue );
+        }
+
+        // flag whether a direct connection to the peer shall be used (duet)
+        if ( GetFlagIniSet ( IniXMLDocument, "client", "p2p", bValue ) )
+        {
+            pClient->SetUseP2P ( bValue );
+        }
+
+        // flag whether the local transport shall be used for a server on the
+        // same host
+        if ( GetFlagIniSet ( IniXMLDocument, "client", "localtransport", bValue ) )
+        {
+            pClient->SetUseLocalTransport ( bValue );
+        }
+
+        // flag whether uncompressed audio shall be used
+        if ( GetFlagIniSet ( IniXMLDocument, "client", "rawaudio", bValue ) )
+        {
+            pClient->SetUseRawAudio ( bValue );
+        }
+
+        // flag whether the target server is pinged before a server switch
+        if ( GetFlagIniSet ( IniXMLDocument, "client", "preprobeserver", bValue ) )
+        {
+            pClient->SetPreProbeServer ( bValue );
+        }
+
+        // flag whether the adaptive playout shall be used
+        if ( GetFlagIniSet ( IniXMLDocument, "client", "adaptiveplayout", bValue ) )
+        {
+            pClient->SetUseAdaptivePlayout ( bValue );
+        }
+
+        // flag whether the clock drift compensation shall be used
+        if ( GetFlagIniSet ( IniXMLDocument, "client", "driftcompensation", bValue ) )
+        {
+            pClient->SetUseDriftCompensation ( bValue );
+        }
+
+        // number of frames protected by one redundancy frame
+        if ( GetNumericIniSet ( IniXMLDocument, "client", "redundancy",
+             0, MAX_NUM_REDUNDANCY_FRAMES, iValue ) )
+        {
+            pClient->SetRedundancy ( iValue );
+        }
+
         // central server address
         pClient->SetServerListCentralServerAddress (
             GetIniSetting ( IniXMLDocument, "client", "centralservaddr" ) );
@@ -347,10 +442,42 @@ void CSettings::Save()
                                pClient->vecStoredFaderLevels[iIdx] );
         }
 
+        // stored jitter buffer sizes per server
+        for ( iIdx = 0; iIdx < MAX_NUM_STORED_JIT_BUF_SIZES; iIdx++ )
+        {
+            PutIniSetting ( IniXMLDocument, "client",
+                            QString ( "storedjitbufaddr%1" ).arg ( iIdx ),
+                            pClient->vecStoredJitBufAddr[iIdx] );
+
+            SetNumericIniSet ( IniXMLDocument, "client",
+                               QString ( "storedjitbuf%1" ).arg ( iIdx ),
+                               pClient->vecStoredJitBufSizes[iIdx] );
+
+            SetNumericIniSet ( IniXMLDocument, "client",
+                               QString ( "storedjitbufserver%1" ).arg ( iIdx ),
+                               pClient->vecStoredServerJitBufSizes[iIdx] );
+        }
+
         // name
         PutIniSetting ( IniXMLDocument, "client", "name",
             pClient->ChannelInfo.strName );
 
+        // submix bus
+        PutIniSetting ( IniXMLDocument, "client", "busname",
+            pClient->strBusName );
+
+        // submix bus gains
+        for ( iIdx = 0; iIdx < MAX_NUM_STORED_BUS_GAINS; iIdx++ )
+        {
+            PutIniSetting ( IniXMLDocument, "client",
+                            QString ( "storedbusname%1" ).arg ( iIdx ),
+                            pClient->vecStoredBusNames[iIdx] );
+
+            SetNumericIniSet ( IniXMLDocument, "client",
+                               QString ( "storedbusgain%1" ).arg ( iIdx ),
+                               pClient->vecStoredBusGains[iIdx] );
+        }
+
         // instrument
         SetNumericIniSet ( IniXMLDocument, "client", "instrument",
             pClient->ChannelInfo.iInstrument );
@@ -367,6 +494,10 @@ void CSettings::Save()
         SetFlagIniSet ( IniXMLDocument, "client", "reverblchan",
             pClient->IsReverbOnLeftChan() );
 
+        // local monitoring level
+        SetNumericIniSet ( IniXMLDocument, "client", "monitorlevel",
+            pClient->GetMonitorLevel() );
+
         // sound card selection
         SetNumericIniSet ( IniXMLDocument, "client", "auddevidx",
             pClient->GetSndCrdDev() );
@@ -419,6 +550,39 @@ void CSettings::Save()
         SetFlagIniSet ( IniXMLDocument, "client", "stereoaudio",
             pClient->GetUseStereo() );
 
+        // flag whether the streams shall be mixed locally (forwarding mode)
+        SetFlagIniSet ( IniXMLDocument, "client", "forwarding",
+            pClient->GetUseForwarding() );
+
+        // flag whether a direct connection to the peer shall be used (duet)
+        SetFlagIniSet ( IniXMLDocument, "client", "p2p",
+            pClient->GetUseP2P() );
+
+        // flag whether the local transport shall be used for a server on the
+        // same host
+        SetFlagIniSet ( IniXMLDocument, "client", "localtransport",
+            pClient->GetUseLocalTransport() );
+
+        // flag whether uncompressed audio shall be used
+        SetFlagIniSet ( IniXMLDocument, "client", "rawaudio",
+            pClient->GetUseRawAudio() );
+
+        // flag whether the target server is pinged before a server switch
+        SetFlagIniSet ( IniXMLDocument, "client", "preprobeserver",
+            pClient->GetPreProbeServer() );
+
+        // flag whether the adaptive playout shall be used
+        SetFlagIniSet ( IniXMLDocument, "client", "adaptiveplayout",
+            pClient->GetUseAdaptivePlayout() );
+
+        // flag whether the clock drift compensation shall be used
+        SetFlagIniSet ( IniXMLDocument, "client", "driftcompensation",
+            pClient->GetUseDriftCompensation() );
+
+        // number of frames protected by one redundancy frame
+        SetNumericIniSet ( IniXMLDocument, "client", "redundancy",
+            pClient->GetRedundancy() );
+
         // central server address
         PutIniSetting ( IniXMLDocument, "client", "centralservaddr",
             pClient->GetServerListCentralServerAddress() );
@@ -24,6 +24,20 @@
 
 #include "socket.h"
 #include "server.h"
+#ifndef _WIN32
+# include <sys/types.h>
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <arpa/inet.h>
+# include <sys/ioctl.h>
+# include <errno.h>
+# include <sys/un.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# include <string.h>
+# include <time.h>
+#endif
 
 
 /* Implementation *************************************************************/
@@ -32,6 +46,12 @@ void CSocket::Init ( const quint16 iPortNumber )
     // allocate memory for network receive and send buffer in samples
     vecbyRecBuf.Init ( MAX_SIZE_BYTES_NETW_BUF );
 
+    // receive times of the ping messages
+    veciPingTimeStamp.Init    ( NUM_PING_REC_TIMES, 0 );
+    veciPingRecTimeUs.Init    ( NUM_PING_REC_TIMES, 0 );
+    vecbPingRecTimeValid.Init ( NUM_PING_REC_TIMES, false );
+    iPingRecTimeIdx = 0;
+
     // initialize the listening socket
     bool bSuccess;
 
@@ -69,51 +89,277 @@ void CSocket::Init ( const quint16 iPortNumber )
             "the software is already running).", "Network Error" );
     }
 
-    // connect the "activated" signal
-#ifdef ENABLE_RECEIVE_SOCKET_IN_SEPARATE_THREAD
-    if ( bIsClient )
+    // the local transport is named by the UDP port number we just got
+    InitLocalTransport ( SocketDevice.localPort() );
+
+    InitKernelRecTimeStamp();
+
+    // connect the "activated" signal (if a separate socket thread is used, the
+    // socket device is moved to the socket thread together with this object,
+    // therefore the slot is directly called in the socket thread and the
+    // receiving does not depend on the event loop of the GUI thread)
+    QObject::connect ( &SocketDevice, SIGNAL ( readyRead() ),
+        this, SLOT ( OnDataReceived() ) );
+}
+
+CSocket::~CSocket()
+{
+#ifndef _WIN32
+    if ( iLocalSocket >= 0 )
     {
-        // We have to use a blocked queued connection since in case we use a
-        // separate socket thread, the "readyRead" signal would occur and our
-        // "OnDataReceived" function would be run in another thread. This could
-        // lead to a situation that a new "readRead" occurs while the processing
-        // of the previous signal was not finished -> the error: "Multiple
-        // socket notifiers for same socket" may occur.
-        QObject::connect ( &SocketDevice, SIGNAL ( readyRead() ),
-            this, SLOT ( OnDataReceived() ), Qt::BlockingQueuedConnection );
+        close ( iLocalSocket );
+        unlink ( QFile::encodeName ( strLocalSocketFileName ).constData() );
     }
-    else
+#endif
+}
+
+QString CSocket::GetLocalTransportDir()
+{
+#ifdef _WIN32
+    return QString();
+#else
+    return QDir::tempPath() + "/" + LOCAL_TRANSPORT_DIR_PREFIX +
+        QString().setNum ( static_cast<qulonglong> ( getuid() ) );
+#endif
+}
+
+QString CSocket::GetLocalTransportFileName ( const quint16 iPortNumber )
+{
+    return GetLocalTransportDir() + "/" + QString().setNum ( iPortNumber );
+}
+
+bool CSocket::CreateLocalTransportDir()
+{
+#ifdef _WIN32
+    return false;
+#else
+    const QByteArray strDirName = QFile::encodeName ( GetLocalTransportDir() );
+
+    // the directory is only accessible by the owner (if it already exists,
+    // e.g. created by another instance, the mode is not changed)
+    if ( ( mkdir ( strDirName.constData(), S_IRWXU ) != 0 ) && ( errno != EEXIST ) )
     {
-        // the server does not use a separate socket thread right now, in that
-        // case we must not use the blocking queued connection, otherwise we
-        // would get a dead lock
-        QObject::connect ( &SocketDevice, SIGNAL ( readyRead() ),
-            this, SLOT ( OnDataReceived() ) );
+        return false;
     }
+
+    // the temporary directory is writable by everybody, therefore we must not
+    // use a directory (or a symbolic link) which was created by another user
+    // or which is accessible by other users
+    struct stat DirStat;
+
+    return ( lstat ( strDirName.constData(), &DirStat ) == 0 ) &&
+           S_ISDIR ( DirStat.st_mode ) &&
+           ( DirStat.st_uid == getuid() ) &&
+           ( ( DirStat.st_mode & ( S_IRWXG | S_IRWXO ) ) == 0 );
+#endif
+}
+
+bool CSocket::LocalTransportAvailable ( const quint16 iPortNumber )
+{
+#ifdef _WIN32
+    // Unix datagram sockets are not available on Windows
+    return false;
 #else
-    QObject::connect ( &SocketDevice, SIGNAL ( readyRead() ),
-        this, SLOT ( OnDataReceived() ) );
+    return QFile::exists ( GetLocalTransportFileName ( iPortNumber ) );
 #endif
 }
 
+void CSocket::InitLocalTransport ( const quint16 iPortNumber )
+{
+    // init with "not available", the local transport is optional and we
+    // silently fall back to UDP if it cannot be initialized
+    iLocalSocket         = -1;
+    pLocalSocketNotifier = NULL;
+
+#ifndef _WIN32
+    if ( !CreateLocalTransportDir() )
+    {
+        return;
+    }
+
+    strLocalSocketFileName = GetLocalTransportFileName ( iPortNumber );
+
+    const QByteArray strFileName = QFile::encodeName ( strLocalSocketFileName );
+
+    sockaddr_un LocalAddr;
+
+    if ( strFileName.size() >= static_cast<int> ( sizeof ( LocalAddr.sun_path ) ) )
+    {
+        return;
+    }
+
+    memset ( &LocalAddr, 0, sizeof ( LocalAddr ) );
+    LocalAddr.sun_family = AF_UNIX;
+    strcpy ( LocalAddr.sun_path, strFileName.constData() );
+
+    iLocalSocket = socket ( AF_UNIX, SOCK_DGRAM, 0 );
+
+    if ( iLocalSocket < 0 )
+    {
+        return;
+    }
+
+    // a socket file with our port number can only be a left over of a crashed
+    // instance since we own the UDP port with this number
+    unlink ( strFileName.constData() );
+
+    if ( bind ( iLocalSocket,
+                reinterpret_cast<sockaddr*> ( &LocalAddr ),
+                sizeof ( LocalAddr ) ) != 0 )
+    {
+        close ( iLocalSocket );
+        iLocalSocket = -1;
+        return;
+    }
+
+    // only the owner may send to the socket (the directory already protects
+    // it, this is an additional safety measure)
+    chmod ( strFileName.constData(), S_IRUSR | S_IWUSR );
+
+    // we read all pending datagrams on a notification without blocking
+    fcntl ( iLocalSocket, F_SETFL, fcntl ( iLocalSocket, F_GETFL ) | O_NONBLOCK );
+
+    // the notifier is a child of this object so that it is moved with us to
+    // the socket thread
+    pLocalSocketNotifier =
+        new QSocketNotifier ( iLocalSocket, QSocketNotifier::Read, this );
+
+    QObject::connect ( pLocalSocketNotifier, SIGNAL ( activated ( int ) ),
+        this, SLOT ( OnLocalDataReceived() ) );
+#endif
+}
+
+void CSocket::InitKernelRecTimeStamp()
+{
+    // the kernel time stamps the received datagrams if supported (Linux),
+    // otherwise the time of reading the datagram is used (the first query
+    // enables the time stamps of the socket, it fails since no datagram was
+    // received yet)
+    bKernelRecTimeStamp = false;
+
+#ifdef SIOCGSTAMPNS
+    timespec KernelTime;
+
+    bKernelRecTimeStamp = ( ioctl ( SocketDevice.socketDescriptor(),
+                                    SIOCGSTAMPNS,
+                                    &KernelTime ) == 0 ) ||
+                          ( errno == ENOENT );
+#endif
+}
+
+int CSocket::GetKernelRecTimeUs ( const int iReadTimeUs )
+{
+    // the read time is used if no kernel time stamp is available
+    int iRecTimeUs = iReadTimeUs;
+
+#ifdef SIOCGSTAMPNS
+    if ( bKernelRecTimeStamp )
+    {
+        // the kernel time stamp of the last read datagram (must be queried
+        // before the next datagram is read)
+        timespec KernelTime;
+
+        if ( ioctl ( SocketDevice.socketDescriptor(),
+                     SIOCGSTAMPNS,
+                     &KernelTime ) == 0 )
+        {
+            // the kernel time stamp is in real time, therefore we convert its
+            // age to our monotonic time base
+            timespec  CurTime;
+            const int iCurTimeUs = PreciseTime.elapsedUs();
+
+            clock_gettime ( CLOCK_REALTIME, &CurTime );
+
+            const qint64 iAgeUs =
+                static_cast<qint64> ( CurTime.tv_sec - KernelTime.tv_sec ) * 1000000 +
+                ( CurTime.tv_nsec - KernelTime.tv_nsec ) / 1000;
+
+            if ( ( iAgeUs >= 0 ) && ( iAgeUs < MAX_KERNEL_REC_TIME_AGE_US ) )
+            {
+                iRecTimeUs = iCurTimeUs - static_cast<int> ( iAgeUs );
+            }
+        }
+    }
+#endif
+
+    return iRecTimeUs;
+}
+
+bool CSocket::GetPingRecTimeUs ( const int iTimeStamp, int& iRecTimeUs )
+{
+    QMutexLocker locker ( &PingRecTimeMutex );
+
+    bool bFound = false;
+
+    for ( int i = 0; i < NUM_PING_REC_TIMES; i++ )
+    {
+        if ( vecbPingRecTimeValid[i] && ( veciPingTimeStamp[i] == iTimeStamp ) )
+        {
+            iRecTimeUs              = veciPingRecTimeUs[i];
+            vecbPingRecTimeValid[i] = false;
+            bFound                  = true;
+        }
+    }
+
+    return bFound;
+}
+
 void CSocket::SendPacket ( const CVector<uint8_t>& vecbySendBuf,
                            const CHostAddress&     HostAddr )
 {
-    QMutexLocker locker ( &Mutex );
-
+    // This function is called by several threads (the audio packets are sent
+    // by the send thread of the client, the protocol messages by the GUI
+    // thread) while the socket device receives in the socket thread. Since a
+    // QUdpSocket must only be used by one thread, we send with the native
+    // socket functions which may be called concurrently from any thread,
+    // therefore no mutex is required.
     const int iVecSizeOut = vecbySendBuf.Size();
 
-    if ( iVecSizeOut != 0 )
+    if ( HostAddr.IsLocalTransport() )
+    {
+#ifndef _WIN32
+        // co-located peer: send the packet through the local transport
+        if ( ( iVecSizeOut != 0 ) && ( iLocalSocket >= 0 ) )
+        {
+            const QByteArray strFileName =
+                QFile::encodeName ( GetLocalTransportFileName ( HostAddr.iPort ) );
+
+            sockaddr_un PeerAddr;
+
+            if ( strFileName.size() < static_cast<int> ( sizeof ( PeerAddr.sun_path ) ) )
+            {
+                memset ( &PeerAddr, 0, sizeof ( PeerAddr ) );
+                PeerAddr.sun_family = AF_UNIX;
+                strcpy ( PeerAddr.sun_path, strFileName.constData() );
+
+                // do not block if the peer does not read its packets
+                sendto ( iLocalSocket,
+                         reinterpret_cast<const char*> ( &vecbySendBuf.front() ),
+                         iVecSizeOut,
+                         MSG_DONTWAIT,
+                         reinterpret_cast<sockaddr*> ( &PeerAddr ),
+                         sizeof ( PeerAddr ) );
+            }
+        }
+#endif
+    }
+    else if ( iVecSizeOut != 0 )
     {
-        // send packet through network (we have to convert the constant unsigned
-        // char vector in "const char*", for this we first convert the const
-        // uint8_t vector in a read/write uint8_t vector and then do the cast to
-        // const char*)
-        SocketDevice.writeDatagram (
-            (const char*) &( (CVector<uint8_t>) vecbySendBuf )[0],
-            iVecSizeOut,
-            HostAddr.InetAddr,
-            HostAddr.iPort );
+        // send packet through network on the descriptor of the socket device
+        // (on Windows the socket functions are declared by windows.h)
+        sockaddr_in PeerAddr;
+
+        memset ( &PeerAddr, 0, sizeof ( PeerAddr ) );
+        PeerAddr.sin_family      = AF_INET;
+        PeerAddr.sin_port        = htons ( HostAddr.iPort );
+        PeerAddr.sin_addr.s_addr = htonl ( HostAddr.InetAddr.toIPv4Address() );
+
+        sendto ( SocketDevice.socketDescriptor(),
+                 reinterpret_cast<const char*> ( &vecbySendBuf.front() ),
+                 iVecSizeOut,
+                 0,
+                 reinterpret_cast<sockaddr*> ( &PeerAddr ),
+                 sizeof ( PeerAddr ) );
     }
 }
 
@@ -124,6 +370,10 @@ void CSocket::OnDataReceived()
         QHostAddress SenderAddress;
         quint16      SenderPort;
 
+        // the receive time must be taken before the datagram is read (for the
+        // ping messages the kernel time stamp is queried afterwards)
+        const int iRecTimeUs = PreciseTime.elapsedUs();
+
         // read block from network interface and query address of sender
         const int iNumBytesRead =
             SocketDevice.readDatagram ( (char*) &vecbyRecBuf[0],
@@ -140,56 +390,137 @@ void CSocket::OnDataReceived()
         // convert address of client
         const CHostAddress RecHostAddr ( SenderAddress, SenderPort );
 
-        if ( bIsClient )
+        ProcessReceivedPacket ( iNumBytesRead, RecHostAddr, iRecTimeUs, true );
+    }
+}
+
+void CSocket::OnLocalDataReceived()
+{
+#ifndef _WIN32
+    // only sockets in our own directory are accepted as senders
+    const QString strPrefix = GetLocalTransportDir() + "/";
+
+    int iNumBytesRead;
+
+    do
+    {
+        sockaddr_un SenderAddr;
+        socklen_t   iSenderAddrLen = sizeof ( SenderAddr );
+
+        memset ( &SenderAddr, 0, sizeof ( SenderAddr ) );
+
+        // read block from the local socket and query the file name of the
+        // sender socket (returns an error if no more datagrams are pending)
+        iNumBytesRead = recvfrom ( iLocalSocket,
+                                   reinterpret_cast<char*> ( &vecbyRecBuf[0] ),
+                                   MAX_SIZE_BYTES_NETW_BUF,
+                                   0,
+                                   reinterpret_cast<sockaddr*> ( &SenderAddr ),
+                                   &iSenderAddrLen );
+
+        // the sender is identified by the port number in its file name
+        const QString strSenderFileName = QFile::decodeName ( SenderAddr.sun_path );
+
+        if ( ( iNumBytesRead >= 0 ) && strSenderFileName.startsWith ( strPrefix ) )
         {
-            // client:
+            bool          bPortOk;
+            const quint16 iSenderPort =
+                strSenderFileName.mid ( strPrefix.length() ).toUShort ( &bPortOk );
 
-            // check if packet comes from the server we want to connect and that
-            // the channel is enabled
-            if ( ( pChannel->GetAddress() == RecHostAddr ) &&
-                 pChannel->IsEnabled() )
+            if ( bPortOk && ( iSenderPort != 0 ) )
             {
-                // this network packet is valid, put it in the channel
-                switch ( pChannel->PutData ( vecbyRecBuf, iNumBytesRead ) )
-                {
-                case PS_AUDIO_OK:
-                    PostWinMessage ( MS_JIT_BUF_PUT, MUL_COL_LED_GREEN );
-                    break;
-
-                case PS_AUDIO_ERR:
-                case PS_GEN_ERROR:
-                    PostWinMessage ( MS_JIT_BUF_PUT, MUL_COL_LED_RED );
-                    break;
-
-                case PS_PROT_ERR:
-                    PostWinMessage ( MS_JIT_BUF_PUT, MUL_COL_LED_YELLOW );
-                    break;
-
-                default:
-                    // other put data states need not to be considered here
-                    break;
-                }
+                ProcessReceivedPacket ( iNumBytesRead,
+                                        CHostAddress::LocalTransport ( iSenderPort ),
+                                        PreciseTime.elapsedUs(),
+                                        false );
             }
-            else
+        }
+    }
+    while ( iNumBytesRead >= 0 );
+#endif
+}
+
+void CSocket::ProcessReceivedPacket ( const int           iNumBytesRead,
+                                      const CHostAddress& RecHostAddr,
+                                      const int           iRecTimeUs,
+                                      const bool          bIsUdpPacket )
+{
+    int iPingTimeStamp;
+
+    // store the receive time of ping messages for the ping evaluation (the
+    // kernel time stamp is only queried for these messages so that the audio
+    // packets do not cause an additional system call)
+    if ( CProtocol::IsCLPingMessage ( vecbyRecBuf, iNumBytesRead, iPingTimeStamp ) )
+    {
+        const int iPingRecTimeUs =
+            bIsUdpPacket ? GetKernelRecTimeUs ( iRecTimeUs ) : iRecTimeUs;
+
+        QMutexLocker locker ( &PingRecTimeMutex );
+
+        veciPingTimeStamp[iPingRecTimeIdx]    = iPingTimeStamp;
+        veciPingRecTimeUs[iPingRecTimeIdx]    = iPingRecTimeUs;
+        vecbPingRecTimeValid[iPingRecTimeIdx] = true;
+
+        iPingRecTimeIdx = ( iPingRecTimeIdx + 1 ) % NUM_PING_REC_TIMES;
+    }
+
+    if ( bIsClient )
+    {
+        // client:
+
+        // check if packet comes from the server we want to connect and that
+        // the channel is enabled
+        if ( ( pChannel->GetAddress() == RecHostAddr ) &&
+             pChannel->IsEnabled() )
+        {
+            // this network packet is valid, put it in the channel
+            switch ( pChannel->PutData ( vecbyRecBuf, iNumBytesRead, iRecTimeUs ) )
             {
-                // inform about received invalid packet by fireing an event
-                emit InvalidPacketReceived ( vecbyRecBuf,
-                                             iNumBytesRead,
-                                             RecHostAddr );
+            case PS_AUDIO_OK:
+                PostWinMessage ( MS_JIT_BUF_PUT, MUL_COL_LED_GREEN );
+                break;
+
+            case PS_AUDIO_ERR:
+            case PS_GEN_ERROR:
+                PostWinMessage ( MS_JIT_BUF_PUT, MUL_COL_LED_RED );
+                break;
+
+            case PS_PROT_ERR:
+                PostWinMessage ( MS_JIT_BUF_PUT, MUL_COL_LED_YELLOW );
+                break;
+
+            default:
+                // other put data states need not to be considered here
+                break;
             }
         }
+        else if ( ( pP2PChannel != NULL ) &&
+                  pP2PChannel->IsEnabled() &&
+                  ( pP2PChannel->GetAddress() == RecHostAddr ) )
+        {
+            // this network packet comes directly from the peer in
+            // peer-to-peer mode
+            pP2PChannel->PutData ( vecbyRecBuf, iNumBytesRead, iRecTimeUs );
+        }
         else
         {
-            // server:
+            // inform about received invalid packet by fireing an event
+            emit InvalidPacketReceived ( vecbyRecBuf,
+                                         iNumBytesRead,
+                                         RecHostAddr );
+        }
+    }
+    else
+    {
+        // server:
 
-            if ( pServer->PutData ( vecbyRecBuf, iNumBytesRead, RecHostAddr ) )
-            {
-                // this was an audio packet, start server
-                // tell the server object to wake up if it
-                // is in sleep mode (Qt will delete the event object when done)
-                QCoreApplication::postEvent ( pServer,
-                    new CCustomEvent ( MS_PACKET_RECEIVED, 0, 0 ) );
-            }
+        if ( pServer->PutData ( vecbyRecBuf, iNumBytesRead, RecHostAddr, iRecTimeUs ) )
+        {
+            // this was an audio packet, start server
+            // tell the server object to wake up if it
+            // is in sleep mode (Qt will delete the event object when done)
+            QCoreApplication::postEvent ( pServer,
+                new CCustomEvent ( MS_PACKET_RECEIVED, 0, 0 ) );
         }
     }
 }
@@ -31,6 +31,8 @@
 #include <QSocketNotifier>
 #include <QThread>
 #include <QMutex>
+#include <QDir>
+#include <QFile>
 #include <vector>
 #include "global.h"
 #include "channel.h"
@@ -47,6 +49,21 @@ class CServer; // forward declaration of CServer
 // number of ports we try to bind until we give up
 #define NUM_SOCKET_PORTS_TO_TRY         50
 
+// Co-located clients and servers can exchange the packets via Unix datagram
+// sockets (local transport) instead of UDP. The socket files are in a
+// directory in the temporary directory which is named by the prefix and the
+// user ID and is only accessible by this user, i.e., other users can neither
+// send to our sockets nor pretend to be a sender. The socket file of each
+// instance is named by the UDP port number of the instance.
+#define LOCAL_TRANSPORT_DIR_PREFIX      "llcon-"
+
+// number of ping messages for which the receive time is stored
+#define NUM_PING_REC_TIMES              16
+
+// kernel receive time stamps older than this value are not used (e.g. if the
+// real time clock of the system was changed)
+#define MAX_KERNEL_REC_TIME_AGE_US      1000000 // us
+
 
 /* Classes ********************************************************************/
 /* Base socket class ---------------------------------------------------------*/
@@ -56,32 +73,76 @@ class CSocket : public QObject
 
 public:
     CSocket ( CChannel*     pNewChannel,
-              const quint16 iPortNumber )
-        : pChannel( pNewChannel ), bIsClient ( true ) { Init ( iPortNumber ); }
+              const quint16 iPortNumber,
+              CChannel*     pNewP2PChannel = NULL )
+        : SocketDevice ( this ), pChannel( pNewChannel ),
+          pP2PChannel ( pNewP2PChannel ), bIsClient ( true ) { Init ( iPortNumber ); }
 
     CSocket ( CServer*      pNServP,
               const quint16 iPortNumber )
-        : pServer ( pNServP ), bIsClient ( false ) { Init ( iPortNumber ); }
+        : SocketDevice ( this ), pP2PChannel ( NULL ), pServer ( pNServP ),
+          bIsClient ( false ) { Init ( iPortNumber ); }
+
+    virtual ~CSocket();
 
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf,
                       const CHostAddress&     HostAddr );
 
+    // checks if the instance with the given port number on this host offers
+    // the local transport
+    static bool LocalTransportAvailable ( const quint16 iPortNumber );
+
+    // the ping messages are evaluated in an other thread, therefore the
+    // receive time of a ping is looked up by its transmit time stamp
+    bool GetPingRecTimeUs ( const int iTimeStamp, int& iRecTimeUs );
+
+    bool IsKernelRecTimeStampEnabled() const { return bKernelRecTimeStamp; }
+
 protected:
     void Init ( const quint16 iPortNumber = LLCON_DEFAULT_PORT_NUMBER );
-
+    void InitLocalTransport ( const quint16 iPortNumber );
+    void InitKernelRecTimeStamp();
+    int  GetKernelRecTimeUs ( const int iReadTimeUs );
+    void ProcessReceivedPacket ( const int           iNumBytesRead,
+                                 const CHostAddress& RecHostAddr,
+                                 const int           iRecTimeUs,
+                                 const bool          bIsUdpPacket );
+
+    static QString GetLocalTransportDir();
+    static QString GetLocalTransportFileName ( const quint16 iPortNumber );
+    static bool    CreateLocalTransportDir();
+
+    // the socket device is a child of this object so that it is moved with us
+    // to the socket thread, it is only used by this thread (packets are sent
+    // with the native socket functions on its descriptor)
     QUdpSocket       SocketDevice;
-    QMutex           Mutex;
 
     CVector<uint8_t> vecbyRecBuf;
     CHostAddress     RecHostAddr;
 
-    CChannel*        pChannel; // for client
-    CServer*         pServer;  // for server
+    CChannel*        pChannel;    // for client
+    CChannel*        pP2PChannel; // for client (direct connection to a peer)
+    CServer*         pServer;     // for server
 
     bool             bIsClient;
 
+    // receive time stamps
+    CPreciseTime     PreciseTime;
+    bool             bKernelRecTimeStamp;
+    QMutex           PingRecTimeMutex;
+    CVector<int>     veciPingTimeStamp;
+    CVector<int>     veciPingRecTimeUs;
+    CVector<bool>    vecbPingRecTimeValid;
+    int              iPingRecTimeIdx;
+
+    // local transport
+    int              iLocalSocket;
+    QString          strLocalSocketFileName;
+    QSocketNotifier* pLocalSocketNotifier;
+
 public slots:
     void OnDataReceived();
+    void OnLocalDataReceived();
 
 signals:
     void InvalidPacketReceived ( CVector<uint8_t> vecbyRecBuf,
@@ -98,7 +159,8 @@ class CHighPrioSocket : public QObject
 
 public:
     CHighPrioSocket ( CChannel*     pNewChannel,
-                      const quint16 iPortNumber )
+                      const quint16 iPortNumber,
+                      CChannel*     pNewP2PChannel = NULL )
     {
         // we have to register some classes to the Qt signal/slot mechanism
         // since we have thread crossings with the threaded code
@@ -110,7 +172,7 @@ public:
         // filled with the network audio packets and does not get interrupted
         // by other GUI threads. The following code is based on:
         // http://qt-project.org/wiki/Threads_Events_QObjects
-        pSocket = new CSocket ( pNewChannel, iPortNumber );
+        pSocket = new CSocket ( pNewChannel, iPortNumber, pNewP2PChannel );
         pSocket->moveToThread ( &NetworkWorkerThread );
         NetworkWorkerThread.start ( QThread::TimeCriticalPriority );
 
@@ -123,6 +185,10 @@ public:
     virtual ~CHighPrioSocket()
     {
         NetworkWorkerThread.exit();
+
+        // the socket must not be deleted while its thread is still running
+        NetworkWorkerThread.wait ( 5000 );
+        delete pSocket;
     }
 
     void SendPacket ( const CVector<uint8_t>& vecbySendBuf,
@@ -131,6 +197,12 @@ public:
         pSocket->SendPacket ( vecbySendBuf, HostAddr );
     }
 
+    bool GetPingRecTimeUs ( const int iTimeStamp, int& iRecTimeUs )
+        { return pSocket->GetPingRecTimeUs ( iTimeStamp, iRecTimeUs ); }
+
+    bool IsKernelRecTimeStampEnabled() const
+        { return pSocket->IsKernelRecTimeStampEnabled(); }
+
 protected:
     QThread  NetworkWorkerThread;
     CSocket* pSocket;
@@ -31,7 +31,7 @@ CSoundBase::CSoundBase ( const QString& strNewSystemDriverTechniqueName,
                          void (*fpNewProcessCallback) ( CVector<int16_t>& psData, void* pParg ),
                          void* pParg ) :
     fpProcessCallback ( fpNewProcessCallback ),
-    pProcessCallbackArg ( pParg ), bRun ( false ),
+    pProcessCallbackArg ( pParg ), fpProcessCallbackFloat ( NULL ), bRun ( false ),
     bIsCallbackAudioInterface ( bNewIsCallbackAudioInterface ),
     strSystemDriverTechniqueName ( strNewSystemDriverTechniqueName )
 {
@@ -81,10 +81,24 @@ public:
 
     bool IsRunning() const { return bRun; }
 
+    // optional floating point callback, audio interfaces which natively work
+    // with floating point samples in the range -1..1 call it instead of the
+    // 16 bit callback if it is set
+    void SetProcessCallbackFloat (
+        void (*fpNewProcessCallbackFloat) ( CVector<float>& pfData, void* pParg ) )
+        { fpProcessCallbackFloat = fpNewProcessCallbackFloat; }
+
+    // number of buffer over- and underruns (xruns) reported by the audio
+    // interface, only available if the audio interface supports it
+    virtual bool IsXrunCountAvailable() { return false; }
+    int  GetNumXruns() const { return AtomicLoadAcquire ( iNumXruns ); }
+    void ResetNumXruns() { AtomicStoreRelease ( iNumXruns, 0 ); }
+
     // TODO this should be protected but since it is used
     // in a callback function it has to be public -> better solution
     void EmitReinitRequestSignal ( const ESndCrdResetType eSndCrdResetType )
         { emit ReinitRequest ( eSndCrdResetType ); }
+    void CountXrun() { iNumXruns.fetchAndAddOrdered ( 1 ); }
 
 protected:
     // driver handling
@@ -96,12 +110,22 @@ protected:
     void (*fpProcessCallback) ( CVector<int16_t>& psData, void* arg );
     void* pProcessCallbackArg;
 
+    // function pointer to the optional floating point callback function
+    void (*fpProcessCallbackFloat) ( CVector<float>& pfData, void* arg );
+
     // callback function call for derived classes
     void ProcessCallback ( CVector<int16_t>& psData )
     {
         (*fpProcessCallback) ( psData, pProcessCallbackArg );
     }
 
+    bool IsProcessCallbackFloatSet() const { return fpProcessCallbackFloat != NULL; }
+
+    void ProcessCallbackFloat ( CVector<float>& pfData )
+    {
+        (*fpProcessCallbackFloat) ( pfData, pProcessCallbackArg );
+    }
+
     // these functions should be overwritten by derived class for
     // non callback based audio interfaces
     virtual bool Read  ( CVector<int16_t>& ) { printf ( "no sound!" ); return false; }
@@ -115,6 +139,8 @@ protected:
 
     CVector<int16_t> vecsAudioSndCrdStereo;
 
+    QAtomicInt       iNumXruns;
+
     long             lNumDevs;
     long             lCurDev;
     QString          strDriverNames[MAX_NUMBER_SOUND_CARDS];
@@ -29,9 +29,12 @@
 #include <QTimer>
 #include <QDateTime>
 #include <QHostAddress>
+#include <QElapsedTimer>
+#include <QTextStream>
 #include "global.h"
 #include "socket.h"
 #include "protocol.h"
+#include "buffer.h"
 #include "util.h"
 
 
@@ -105,7 +108,7 @@ public slots:
         CChannelCoreInfo       ChannelCoreInfo;
 
         // generate random protocol message
-        switch ( GenRandomIntInRange ( 0, 24 ) )
+        switch ( GenRandomIntInRange ( 0, 40 ) )
         {
         case 0:
             Protocol.CreateJitBufMes ( GenRandomIntInRange ( 0, 10 ) );
@@ -265,6 +268,78 @@ public slots:
             break;
 
         case 24:
+            Protocol.CreateFederationLinkMes();
+            break;
+
+        case 25:
+            Protocol.CreateChanBusMes ( GenRandomString() );
+            break;
+
+        case 26:
+            Protocol.CreateBusGainMes ( GenRandomString(),
+                                        GenRandomIntInRange ( -100, 100 ) );
+            break;
+
+        case 27:
+            Protocol.CreateReqForwardingMes();
+            break;
+
+        case 28:
+            Protocol.CreateForwardingMes ( GenRandomIntInRange ( -2, 60 ) );
+            break;
+
+        case 29:
+            Protocol.CreateReqP2PMes();
+            break;
+
+        case 30:
+            Protocol.CreateSeqNumSupportedMes();
+            break;
+
+        case 31:
+            Protocol.CreateReqRedundancyMes ( GenRandomIntInRange ( -2, 10 ) );
+            break;
+
+        case 32:
+            Protocol.CreateCLProbeMes ( CurHostAddress,
+                                        GenRandomIntInRange ( -2, 100 ),
+                                        GenRandomIntInRange ( -2, 1000 ) );
+            break;
+
+        case 33:
+            Protocol.CreateOpus64SupportedMes();
+            break;
+
+        case 34:
+            Protocol.CreateRawAudioSupportedMes();
+            break;
+
+        case 35:
+            Protocol.CreateMixMinusMes ( static_cast<bool> ( GenRandomIntInRange ( 0, 1 ) ) );
+            break;
+
+        case 36:
+            Protocol.CreateLatencyProbeMes ( GenRandomIntInRange ( -2, 1000 ),
+                                             GenRandomIntInRange ( -2, 100000 ) );
+            break;
+
+        case 37:
+            Protocol.CreateLatencyProbeEchoMes ( GenRandomIntInRange ( -2, 1000 ),
+                                                 GenRandomIntInRange ( -2, 100000 ) );
+            break;
+
+        case 38:
+            Protocol.CreateChanGainOverrideMes ( GenRandomIntInRange ( 0, 20 ),
+                                                 static_cast<bool> ( GenRandomIntInRange ( 0, 1 ) ),
+                                                 GenRandomIntInRange ( -2, 20 ) );
+            break;
+
+        case 39:
+            Protocol.CreateP2PChanIDsMes ( GenRandomIntInRange ( -2, 60 ),
+                                           GenRandomIntInRange ( -2, 60 ) );
+            break;
+
+        case 40:
             // arbitrary "audio" packet (with random sizes)
             CVector<uint8_t> vecMessage ( GenRandomIntInRange ( 1, 1000 ) );
             OnSendProtMessage ( vecMessage );
@@ -284,4 +359,996 @@ public slots:
     }
 };
 
+
+/* Definitions ****************************************************************/
+// reverberation test: block size, duration of the test signals and the
+// maximum allowed difference to the reference implementation (the reference
+// truncates the delay line samples to integers)
+#define REVERB_TEST_BLOCK_SIZE_SAMPLES  128
+#define REVERB_TEST_DURATION_S          2
+#define REVERB_TEST_MAX_DIFF            16
+#define REVERB_TEST_NUM_BENCH_BLOCKS    20000
+
+// ring buffer test: buffer size and block sizes of the sound card conversion
+// buffer use case (stereo, 96 samples sound card block, 128 samples frame)
+#define BUFFER_TEST_MEM_SIZE            ( 2 * ( 128 + 96 ) )
+#define BUFFER_TEST_PUT_SIZE            ( 2 * 96 )
+#define BUFFER_TEST_GET_SIZE            ( 2 * 128 )
+#define BUFFER_TEST_NUM_ITERATIONS      200000
+
+// error rate statistic test: error probability and length of the random test
+// sequence and number of updates of the benchmark
+#define MOV_AV_BIT_TEST_ERROR_RATE      0.001
+#define MOV_AV_BIT_TEST_SEQ_LEN         65536 // must be a power of two
+#define MOV_AV_BIT_TEST_NUM_UPDATES     20000000
+
+// jitter buffer test: block size in bytes and number of blocks of the buffer
+#define NET_BUF_TEST_BLOCK_SIZE         10
+#define NET_BUF_TEST_NUM_BLOCKS         16
+
+
+/* Classes ********************************************************************/
+// Reference implementation of the reverberation which processes one sample per
+// call (this is the implementation which was used before the block-wise
+// floating point processing, it uses the same delay line lengths)
+class CAudioReverbReference : public CAudioReverb
+{
+public:
+    void Init ( const int iSampleRate, const double rT60 = (double) 5.0 )
+    {
+        int i;
+
+        CAudioReverb::Init ( iSampleRate, rT60 );
+
+        for ( i = 0; i < 3; i++ )
+        {
+            allpassDelays_[i].Init ( vecfAllpassDelays[i].Size(), 0 );
+        }
+
+        for ( i = 0; i < 4; i++ )
+        {
+            combDelays_[i].Init ( vecfCombDelays[i].Size(), 0 );
+
+            combCoefficient_[i] = pow ( (double) 10.0, (double) ( -3.0 *
+                combDelays_[i].Size() / ( rT60 * iSampleRate ) ) );
+        }
+
+        allpassCoefficient_ = (double) 0.7;
+    }
+
+    void Process ( CVector<int16_t>& vecsStereo,
+                   const int         iStereoBlockSize,
+                   const int         iChannel,
+                   const double      dLevel )
+    {
+        for ( int i = iChannel; i < iStereoBlockSize; i += 2 )
+        {
+            vecsStereo[i] = Double2Short ( vecsStereo[i] +
+                dLevel * ProcessSample ( vecsStereo[i] ) );
+        }
+    }
+
+protected:
+    double ProcessSample ( const double input )
+    {
+        // compute one output sample
+        double temp, temp0, temp1, temp2;
+
+        temp = allpassDelays_[0].Get();
+        temp0 = allpassCoefficient_ * temp;
+        temp0 += input;
+        allpassDelays_[0].Add ( (int) temp0 );
+        temp0 = - ( allpassCoefficient_ * temp0 ) + temp;
+
+        temp = allpassDelays_[1].Get();
+        temp1 = allpassCoefficient_ * temp;
+        temp1 += temp0;
+        allpassDelays_[1].Add ( (int) temp1 );
+        temp1 = - ( allpassCoefficient_ * temp1 ) + temp;
+
+        temp = allpassDelays_[2].Get();
+        temp2 = allpassCoefficient_ * temp;
+        temp2 += temp1;
+        allpassDelays_[2].Add ( (int) temp2 );
+        temp2 = - ( allpassCoefficient_ * temp2 ) + temp;
+
+        const double temp3 = temp2 + ( combCoefficient_[0] * combDelays_[0].Get() );
+        const double temp4 = temp2 + ( combCoefficient_[1] * combDelays_[1].Get() );
+        const double temp5 = temp2 + ( combCoefficient_[2] * combDelays_[2].Get() );
+        const double temp6 = temp2 + ( combCoefficient_[3] * combDelays_[3].Get() );
+
+        combDelays_[0].Add ( (int) temp3 );
+        combDelays_[1].Add ( (int) temp4 );
+        combDelays_[2].Add ( (int) temp5 );
+        combDelays_[3].Add ( (int) temp6 );
+
+        return ( temp3 + temp4 + temp5 + temp6 ) * (double) 0.5;
+    }
+
+    CFIFO<int> allpassDelays_[3];
+    CFIFO<int> combDelays_[4];
+    double     allpassCoefficient_;
+    double     combCoefficient_[4];
+};
+
+
+// Compares the block-wise reverberation with the reference implementation on
+// an impulse and on white noise and measures the processing time of both (the
+// results are written to the console)
+class CAudioReverbTestbench
+{
+public:
+    CAudioReverbTestbench() : tsConsole ( stdout )
+    {
+        CompareWithReference ( false );
+        CompareWithReference ( true );
+        CompareFloatWithShort();
+        Benchmark();
+    }
+
+protected:
+    void GenTestBlock ( CVector<int16_t>& vecsStereo,
+                        const int         iBlockIdx,
+                        const bool        bNoise )
+    {
+        for ( int i = 0; i < REVERB_TEST_BLOCK_SIZE_SAMPLES; i++ )
+        {
+            int16_t sSample = 0;
+
+            if ( bNoise )
+            {
+                sSample = static_cast<int16_t> ( rand() % 8001 - 4000 );
+            }
+            else if ( ( iBlockIdx == 0 ) && ( i == 0 ) )
+            {
+                sSample = 10000;
+            }
+
+            vecsStereo[2 * i] = vecsStereo[2 * i + 1] = sSample;
+        }
+    }
+
+    void CompareWithReference ( const bool bNoise )
+    {
+        const int iStereoBlockSize = 2 * REVERB_TEST_BLOCK_SIZE_SAMPLES;
+        const int iNumBlocks       = REVERB_TEST_DURATION_S *
+            SYSTEM_SAMPLE_RATE_HZ / REVERB_TEST_BLOCK_SIZE_SAMPLES;
+
+        CAudioReverb          AudioReverb;
+        CAudioReverbReference AudioReverbRef;
+        CVector<int16_t>      vecsBlock    ( iStereoBlockSize );
+        CVector<int16_t>      vecsBlockRef ( iStereoBlockSize );
+        double                dRefEnergy  = 0;
+        double                dDiffEnergy = 0;
+        int                   iMaxDiff    = 0;
+
+        AudioReverb.Init    ( SYSTEM_SAMPLE_RATE_HZ );
+        AudioReverbRef.Init ( SYSTEM_SAMPLE_RATE_HZ );
+        srand ( 1 );
+
+        for ( int iBlock = 0; iBlock < iNumBlocks; iBlock++ )
+        {
+            GenTestBlock ( vecsBlock, iBlock, bNoise );
+            vecsBlockRef = vecsBlock;
+
+            AudioReverb.Process    ( vecsBlock,    iStereoBlockSize, 0, 0.25 );
+            AudioReverbRef.Process ( vecsBlockRef, iStereoBlockSize, 0, 0.25 );
+
+            for ( int i = 0; i < iStereoBlockSize; i += 2 )
+            {
+                const int iDiff = abs ( vecsBlock[i] - vecsBlockRef[i] );
+
+                dRefEnergy  += static_cast<double> ( vecsBlockRef[i] ) * vecsBlockRef[i];
+                dDiffEnergy += static_cast<double> ( iDiff ) * iDiff;
+
+                if ( iDiff > iMaxDiff )
+                {
+                    iMaxDiff = iDiff;
+                }
+            }
+        }
+
+        tsConsole << "- reverb " << ( bNoise ? "noise" : "impulse" ) <<
+            ": max difference " << iMaxDiff << ", SNR " <<
+            ( dDiffEnergy > 0 ? 10 * log10 ( dRefEnergy / dDiffEnergy ) : 999.0 ) <<
+            " dB -> " << ( iMaxDiff <= REVERB_TEST_MAX_DIFF ? "OK" : "FAILED" ) << endl;
+    }
+
+    // the floating point processing must give the same result as the 16 bit
+    // processing (the samples are scaled by the 16 bit range)
+    void CompareFloatWithShort()
+    {
+        const int iStereoBlockSize = 2 * REVERB_TEST_BLOCK_SIZE_SAMPLES;
+        const int iNumBlocks       = REVERB_TEST_DURATION_S *
+            SYSTEM_SAMPLE_RATE_HZ / REVERB_TEST_BLOCK_SIZE_SAMPLES;
+
+        CAudioReverb     AudioReverb;
+        CAudioReverb     AudioReverbFloat;
+        CVector<int16_t> vecsBlock  ( iStereoBlockSize );
+        CVector<float>   vecfBlock  ( iStereoBlockSize );
+        int              iMaxDiff = 0;
+
+        AudioReverb.Init      ( SYSTEM_SAMPLE_RATE_HZ );
+        AudioReverbFloat.Init ( SYSTEM_SAMPLE_RATE_HZ );
+        srand ( 1 );
+
+        for ( int iBlock = 0; iBlock < iNumBlocks; iBlock++ )
+        {
+            GenTestBlock ( vecsBlock, iBlock, true );
+
+            for ( int i = 0; i < iStereoBlockSize; i++ )
+            {
+                vecfBlock[i] = static_cast<float> ( vecsBlock[i] ) / _MAXSHORT;
+            }
+
+            AudioReverb.Process      ( vecsBlock, iStereoBlockSize, 0, 0.25 );
+            AudioReverbFloat.Process ( vecfBlock, iStereoBlockSize, 0, 0.25 );
+
+            for ( int i = 0; i < iStereoBlockSize; i += 2 )
+            {
+                const int iDiff = abs ( vecsBlock[i] -
+                    Double2Short ( static_cast<double> ( vecfBlock[i] ) * _MAXSHORT ) );
+
+                if ( iDiff > iMaxDiff )
+                {
+                    iMaxDiff = iDiff;
+                }
+            }
+        }
+
+        tsConsole << "- reverb float: max difference " << iMaxDiff << " -> " <<
+            ( iMaxDiff <= REVERB_TEST_MAX_DIFF ? "OK" : "FAILED" ) << endl;
+    }
+
+    void Benchmark()
+    {
+        const int iStereoBlockSize = 2 * REVERB_TEST_BLOCK_SIZE_SAMPLES;
+
+        CAudioReverb          AudioReverb;
+        CAudioReverbReference AudioReverbRef;
+        CVector<int16_t>      vecsBlock ( iStereoBlockSize );
+        QElapsedTimer         Timer;
+        int                   i;
+
+        AudioReverb.Init    ( SYSTEM_SAMPLE_RATE_HZ );
+        AudioReverbRef.Init ( SYSTEM_SAMPLE_RATE_HZ );
+        GenTestBlock        ( vecsBlock, 0, true );
+
+        Timer.start();
+
+        for ( i = 0; i < REVERB_TEST_NUM_BENCH_BLOCKS; i++ )
+        {
+            AudioReverbRef.Process ( vecsBlock, iStereoBlockSize, 0, 0.25 );
+        }
+
+        const qint64 iRefTimeNs = Timer.nsecsElapsed();
+
+        Timer.restart();
+
+        for ( i = 0; i < REVERB_TEST_NUM_BENCH_BLOCKS; i++ )
+        {
+            AudioReverb.Process ( vecsBlock, iStereoBlockSize, 0, 0.25 );
+        }
+
+        const qint64 iTimeNs = Timer.nsecsElapsed();
+
+        tsConsole << "- reverb benchmark (" << REVERB_TEST_BLOCK_SIZE_SAMPLES <<
+            " samples per block): reference " <<
+            iRefTimeNs / REVERB_TEST_NUM_BENCH_BLOCKS << " ns, block-wise " <<
+            iTimeNs / REVERB_TEST_NUM_BENCH_BLOCKS << " ns per block" << endl;
+    }
+
+    QTextStream tsConsole;
+};
+
+// Reference implementation of the ring buffer which copies the data element by
+// element (this is the implementation which was used before the block copies)
+class CBufferBaseReference : public CBufferBase<int16_t>
+{
+public:
+    virtual bool Put ( const CVector<int16_t>& vecData,
+                       const int               iInSize )
+    {
+        // copy new data in internal buffer
+        int iCurPos = 0;
+        if ( iPutPos + iInSize > iMemSize )
+        {
+            // remaining space size for second block
+            const int iRemSpace = iPutPos + iInSize - iMemSize;
+
+            // data must be written in two steps because of wrap around
+            while ( iPutPos < iMemSize )
+            {
+                vecMemory[iPutPos++] = vecData[iCurPos++];
+            }
+
+            for ( iPutPos = 0; iPutPos < iRemSpace; iPutPos++ )
+            {
+                vecMemory[iPutPos] = vecData[iCurPos++];
+            }
+        }
+        else
+        {
+            // data can be written in one step
+            const int iEnd = iPutPos + iInSize;
+            while ( iPutPos < iEnd )
+            {
+                vecMemory[iPutPos++] = vecData[iCurPos++];
+            }
+        }
+
+        // take care about wrap around of put pointer
+        if ( iPutPos == iMemSize )
+        {
+            iPutPos = 0;
+        }
+
+        // set buffer state flag
+        if ( iPutPos == iGetPos )
+        {
+            eBufState = CBufferBase<int16_t>::BS_FULL;
+        }
+        else
+        {
+            eBufState = CBufferBase<int16_t>::BS_OK;
+        }
+
+        return true;
+    }
+
+    virtual bool Get ( CVector<int16_t>& vecData )
+    {
+        const int iInSize = vecData.Size();
+
+        // copy data from internal buffer in output buffer
+        int iCurPos = 0;
+        if ( iGetPos + iInSize > iMemSize )
+        {
+            // remaining data size for second block
+            const int iRemData = iGetPos + iInSize - iMemSize;
+
+            // data must be read in two steps because of wrap around
+            while ( iGetPos < iMemSize )
+            {
+                vecData[iCurPos++] = vecMemory[iGetPos++];
+            }
+
+            for ( iGetPos = 0; iGetPos < iRemData; iGetPos++ )
+            {
+                vecData[iCurPos++] = vecMemory[iGetPos];
+            }
+        }
+        else
+        {
+            // data can be read in one step
+            const int iEnd = iGetPos + iInSize;
+            while ( iGetPos < iEnd )
+            {
+                vecData[iCurPos++] = vecMemory[iGetPos++];
+            }
+        }
+
+        // take care about wrap around of get pointer
+        if ( iGetPos == iMemSize )
+        {
+            iGetPos = 0;
+        }
+
+        // set buffer state flag
+        if ( iPutPos == iGetPos )
+        {
+            eBufState = CBufferBase<int16_t>::BS_EMPTY;
+        }
+        else
+        {
+            eBufState = CBufferBase<int16_t>::BS_OK;
+        }
+
+        return true;
+    }
+};
+
+
+// Compares the ring buffer with the element-wise reference implementation on
+// the block sizes of the sound card conversion buffer (including the wrap
+// around and the resizing with preserved data) and measures the time of one
+// put and get (the results are written to the console)
+class CBufferBaseTestbench
+{
+public:
+    CBufferBaseTestbench() : tsConsole ( stdout )
+    {
+        CompareWithReference();
+        Benchmark ( false );
+        Benchmark ( true );
+    }
+
+protected:
+    void CompareWithReference()
+    {
+        CBufferBase<int16_t> Buffer;
+        CBufferBaseReference BufferRef;
+        CVector<int16_t>     vecsIn     ( BUFFER_TEST_MEM_SIZE );
+        CVector<int16_t>     vecsOut    ( BUFFER_TEST_GET_SIZE );
+        CVector<int16_t>     vecsOutRef ( BUFFER_TEST_GET_SIZE );
+        int                  iNumErrors = 0;
+        int                  i, j;
+
+        Buffer.Init    ( BUFFER_TEST_MEM_SIZE );
+        BufferRef.Init ( BUFFER_TEST_MEM_SIZE );
+        srand ( 1 );
+
+        for ( i = 0; i < BUFFER_TEST_NUM_ITERATIONS / 100; i++ )
+        {
+            // put and get blocks with random sizes so that all wrap around
+            // cases occur
+            const int iPutSize = 1 + rand() % BUFFER_TEST_PUT_SIZE;
+
+            if ( Buffer.GetAvailSpace() >= iPutSize )
+            {
+                for ( j = 0; j < iPutSize; j++ )
+                {
+                    vecsIn[j] = static_cast<int16_t> ( rand() );
+                }
+
+                Buffer.Put    ( vecsIn, iPutSize );
+                BufferRef.Put ( vecsIn, iPutSize );
+            }
+
+            const int iGetSize = 1 + rand() % BUFFER_TEST_GET_SIZE;
+
+            if ( Buffer.GetAvailData() >= iGetSize )
+            {
+                vecsOut.Init    ( iGetSize );
+                vecsOutRef.Init ( iGetSize );
+
+                Buffer.Get    ( vecsOut );
+                BufferRef.Get ( vecsOutRef );
+
+                if ( vecsOut != vecsOutRef )
+                {
+                    iNumErrors++;
+                }
+            }
+
+            if ( ( Buffer.GetAvailData() != BufferRef.GetAvailData() ) ||
+                 ( Buffer.GetAvailSpace() != BufferRef.GetAvailSpace() ) )
+            {
+                iNumErrors++;
+            }
+
+            // from time to time resize the buffer with preserving the data
+            if ( ( i % 97 ) == 0 )
+            {
+                const int iNewSize =
+                    BUFFER_TEST_MEM_SIZE - rand() % ( BUFFER_TEST_PUT_SIZE / 2 );
+
+                Buffer.Init    ( iNewSize, true );
+                BufferRef.Init ( iNewSize, true );
+            }
+        }
+
+        tsConsole << "- ring buffer: " << iNumErrors << " differences to the "
+            "reference -> " << ( iNumErrors == 0 ? "OK" : "FAILED" ) << endl;
+    }
+
+    void Benchmark ( const bool bReference )
+    {
+        CBufferBase<int16_t> Buffer;
+        CBufferBaseReference BufferRef;
+        CVector<int16_t>     vecsIn  ( BUFFER_TEST_PUT_SIZE, 0 );
+        CVector<int16_t>     vecsOut ( BUFFER_TEST_GET_SIZE );
+        QElapsedTimer        Timer;
+
+        // both implementations are used via the base class interface
+        CBufferBase<int16_t>* pBuffer =
+            bReference ? static_cast<CBufferBase<int16_t>*> ( &BufferRef ) : &Buffer;
+
+        pBuffer->Init ( BUFFER_TEST_MEM_SIZE );
+
+        Timer.start();
+
+        for ( int i = 0; i < BUFFER_TEST_NUM_ITERATIONS; i++ )
+        {
+            if ( pBuffer->GetAvailSpace() >= BUFFER_TEST_PUT_SIZE )
+            {
+                pBuffer->Put ( vecsIn, BUFFER_TEST_PUT_SIZE );
+            }
+
+            if ( pBuffer->GetAvailData() >= BUFFER_TEST_GET_SIZE )
+            {
+                pBuffer->Get ( vecsOut );
+            }
+        }
+
+        tsConsole << "- ring buffer benchmark (" <<
+            ( bReference ? "element-wise" : "block copies" ) << "): " <<
+            Timer.nsecsElapsed() / BUFFER_TEST_NUM_ITERATIONS <<
+            " ns per put/get" << endl;
+    }
+
+    QTextStream tsConsole;
+};
+
+
+// Compares the bit-packed moving average of the error rate statistic with the
+// moving average of bytes which was used before (the results must be
+// identical) and measures the update time of the error rates of the jitter
+// buffer statistic for different numbers of channels (the results are written
+// to the console)
+class CMovingAvBitTestbench
+{
+public:
+    CMovingAvBitTestbench() : tsConsole ( stdout ),
+        vecbyErrors ( MOV_AV_BIT_TEST_SEQ_LEN )
+    {
+        // random error sequence with the typical error probability
+        srand ( 1 );
+
+        for ( int i = 0; i < MOV_AV_BIT_TEST_SEQ_LEN; i++ )
+        {
+            vecbyErrors[i] =
+                ( rand() < MOV_AV_BIT_TEST_ERROR_RATE * RAND_MAX ) ? 1 : 0;
+        }
+
+        // the history length of the jitter buffer statistic and lengths which
+        // are no multiple of the word size of the bit-packed history
+        CompareWithReference ( MAX_STATISTIC_COUNT );
+        CompareWithReference ( 1 );
+        CompareWithReference ( 33 );
+        CompareWithReference ( 1000 );
+
+        Benchmark ( 1 );
+        Benchmark ( 10 );
+        Benchmark ( 50 );
+        Benchmark ( 150 );
+    }
+
+protected:
+    void CompareWithReference ( const int iHistoryLength )
+    {
+        CMovingAvBit    MovAv;
+        CMovingAv<char> MovAvRef;
+        int             iNumErrors = 0;
+
+        MovAv.Init    ( iHistoryLength, 1.0 );
+        MovAvRef.Init ( iHistoryLength, 1.0 );
+
+        // the "no data" result
+        if ( MovAv.GetAverage() != MovAvRef.GetAverage() )
+        {
+            iNumErrors++;
+        }
+
+        // a few times the history length with a higher error rate so that the
+        // set bits also leave the history
+        for ( int i = 0; i < 4 * iHistoryLength + MOV_AV_BIT_TEST_SEQ_LEN; i++ )
+        {
+            const bool bError = ( vecbyErrors[i % MOV_AV_BIT_TEST_SEQ_LEN] != 0 ) ||
+                                ( ( i % 7 ) == 0 );
+
+            MovAv.Add    ( bError );
+            MovAvRef.Add ( bError );
+
+            if ( ( MovAv.GetAverage() != MovAvRef.GetAverage() ) ||
+                 ( MovAv.InitializationState() != MovAvRef.InitializationState() ) )
+            {
+                iNumErrors++;
+            }
+
+            // the reset must behave like a new initialization
+            if ( i == 2 * iHistoryLength )
+            {
+                MovAv.Reset();
+                MovAvRef.Reset();
+            }
+        }
+
+        tsConsole << "- error rate history (length " << iHistoryLength <<
+            "): " << iNumErrors << " differences to the reference -> " <<
+            ( iNumErrors == 0 ? "OK" : "FAILED" ) << endl;
+    }
+
+    // the error rates of all channels are updated in turn like the jitter
+    // buffer statistics of the server
+    template<class TMovAv> qint64 UpdateTimeNs ( CVector<TMovAv>& vecMovAv )
+    {
+        QElapsedTimer Timer;
+        const int     iNumMovAv = vecMovAv.Size();
+        int           iMovAvIdx = 0;
+
+        for ( int i = 0; i < iNumMovAv; i++ )
+        {
+            vecMovAv[i].Init ( MAX_STATISTIC_COUNT, 1.0 );
+        }
+
+        Timer.start();
+
+        for ( int i = 0; i < MOV_AV_BIT_TEST_NUM_UPDATES; i++ )
+        {
+            vecMovAv[iMovAvIdx].Add (
+                vecbyErrors[i & ( MOV_AV_BIT_TEST_SEQ_LEN - 1 )] != 0 );
+
+            iMovAvIdx++;
+            if ( iMovAvIdx == iNumMovAv )
+            {
+                iMovAvIdx = 0;
+            }
+        }
+
+        return Timer.nsecsElapsed();
+    }
+
+    void Benchmark ( const int iNumChannels )
+    {
+        // each channel has one error rate per simulation buffer
+        const int iNumMovAv = iNumChannels * NUM_STAT_SIMULATION_BUFFERS;
+
+        CVector<CMovingAvBit>     vecMovAv    ( iNumMovAv );
+        CVector<CMovingAv<char> > vecMovAvRef ( iNumMovAv );
+
+        const qint64 iRefTimeNs = UpdateTimeNs ( vecMovAvRef );
+        const qint64 iTimeNs    = UpdateTimeNs ( vecMovAv );
+
+        tsConsole << "- error rate history benchmark (" << iNumChannels <<
+            " channels): bytes " <<
+            static_cast<double> ( iRefTimeNs ) / MOV_AV_BIT_TEST_NUM_UPDATES <<
+            " ns, bit-packed " <<
+            static_cast<double> ( iTimeNs ) / MOV_AV_BIT_TEST_NUM_UPDATES <<
+            " ns per update" << endl;
+    }
+
+    QTextStream      tsConsole;
+    CVector<uint8_t> vecbyErrors;
+};
+
+
+// Feeds the jitter buffer with fixed sequences of sequence numbered packets
+// (in order, reordered, duplicated, late and lost packets, also with packets of
+// several blocks and with the wrap around of the sequence number) and
+// redundancy frames and checks the read blocks, their states and the counters
+// (the results are written to the console)
+class CNetBufTestbench
+{
+public:
+    CNetBufTestbench() : tsConsole ( stdout )
+    {
+        TestInOrder();
+        TestReordered();
+        TestDuplicated();
+        TestLate();
+        TestLost();
+        TestSeqNumWrapAround();
+        TestMultiBlockPackets();
+        TestRedundancyRecovery();
+        TestRedundancyNotRecoverable();
+    }
+
+protected:
+    void Init ( const int iNumPacketBlocks )
+    {
+        NetBuf.Init ( NET_BUF_TEST_BLOCK_SIZE, NET_BUF_TEST_NUM_BLOCKS );
+        vecbyPacket.Init ( iNumPacketBlocks * NET_BUF_TEST_BLOCK_SIZE );
+        vecbyBlock.Init  ( NET_BUF_TEST_BLOCK_SIZE );
+        iNumErrors = 0;
+    }
+
+    // the payload is derived from the sequence number so that each read block
+    // can be checked (it never contains zeros which are used for silence)
+    static uint8_t GetPayload ( const int iSeqNum, const int iPos )
+        { return static_cast<uint8_t> ( 1 + ( iSeqNum * 31 + iPos * 7 ) % 255 ); }
+
+    bool Put ( const int iSeqNum )
+    {
+        for ( int i = 0; i < vecbyPacket.Size(); i++ )
+        {
+            vecbyPacket[i] = GetPayload ( iSeqNum, i );
+        }
+
+        return NetBuf.Put ( vecbyPacket, vecbyPacket.Size(), iSeqNum );
+    }
+
+    // the redundancy frame is the XOR of the packets before the given sequence
+    // number
+    bool PutRedundancy ( const int iSeqNum, const int iNumFrames )
+    {
+        CVector<uint8_t> vecbyRedundancy ( vecbyPacket.Size(), 0 );
+
+        for ( int i = 0; i < iNumFrames; i++ )
+        {
+            const int iCurSeqNum = ( iSeqNum - i - 1 + NET_BUF_SEQ_NUM_RANGE ) %
+                NET_BUF_SEQ_NUM_RANGE;
+
+            for ( int j = 0; j < vecbyRedundancy.Size(); j++ )
+            {
+                vecbyRedundancy[j] ^= GetPayload ( iCurSeqNum, j );
+            }
+        }
+
+        return NetBuf.PutRedundancy ( vecbyRedundancy, iSeqNum, iNumFrames );
+    }
+
+    // reads all blocks of one packet, a sequence number of -1 means that the
+    // packet is expected to be missing (error and silence)
+    void Get ( const int iExpSeqNum )
+    {
+        const int iNumPacketBlocks = vecbyPacket.Size() / NET_BUF_TEST_BLOCK_SIZE;
+
+        for ( int i = 0; i < iNumPacketBlocks; i++ )
+        {
+            const bool bGetOK = NetBuf.Get ( vecbyBlock );
+
+            if ( bGetOK != ( iExpSeqNum >= 0 ) )
+            {
+                iNumErrors++;
+            }
+
+            for ( int j = 0; j < NET_BUF_TEST_BLOCK_SIZE; j++ )
+            {
+                const uint8_t byExpData = ( iExpSeqNum >= 0 ) ?
+                    GetPayload ( iExpSeqNum, i * NET_BUF_TEST_BLOCK_SIZE + j ) : 0;
+
+                if ( vecbyBlock[j] != byExpData )
+                {
+                    iNumErrors++;
+                    break;
+                }
+            }
+        }
+    }
+
+    void Check ( const bool bCondition )
+    {
+        if ( !bCondition )
+        {
+            iNumErrors++;
+        }
+    }
+
+    void Report ( const QString& strTestName )
+    {
+        tsConsole << "- jitter buffer, " << strTestName << ": " << iNumErrors <<
+            " errors -> " << ( iNumErrors == 0 ? "OK" : "FAILED" ) << endl;
+    }
+
+    void TestInOrder()
+    {
+        Init ( 1 );
+
+        for ( int i = 0; i < 8; i++ )
+        {
+            Check ( Put ( i ) );
+        }
+
+        for ( int i = 0; i < 8; i++ )
+        {
+            Get ( i );
+        }
+
+        Check ( NetBuf.GetNumAvailBlocks() == 0 );
+        Check ( ( NetBuf.GetNumReordered() == 0 ) && ( NetBuf.GetNumLate() == 0 ) &&
+                ( NetBuf.GetNumConcealed() == 0 ) );
+
+        Report ( "in order" );
+    }
+
+    void TestReordered()
+    {
+        // the packet 1 arrives after the packets 2 and 3
+        Init ( 1 );
+
+        Check ( Put ( 0 ) );
+        Check ( Put ( 2 ) );
+        Check ( Put ( 3 ) );
+        Check ( Put ( 1 ) );
+
+        Get ( 0 );
+        Get ( 1 );
+        Get ( 2 );
+        Get ( 3 );
+
+        Check ( ( NetBuf.GetNumReordered() == 1 ) && ( NetBuf.GetNumLate() == 0 ) &&
+                ( NetBuf.GetNumConcealed() == 0 ) );
+
+        Report ( "reordered" );
+    }
+
+    void TestDuplicated()
+    {
+        // the packets 1 and 2 arrive twice, also after a reordering
+        Init ( 1 );
+
+        Check ( Put ( 0 ) );
+        Check ( Put ( 2 ) );
+        Check ( Put ( 1 ) );
+        Check ( !Put ( 1 ) );
+        Check ( !Put ( 2 ) );
+        Check ( Put ( 3 ) );
+
+        Get ( 0 );
+        Get ( 1 );
+        Get ( 2 );
+        Get ( 3 );
+
+        Check ( NetBuf.GetNumAvailBlocks() == 0 );
+        Check ( ( NetBuf.GetNumReordered() == 1 ) && ( NetBuf.GetNumLate() == 2 ) );
+
+        Report ( "duplicated" );
+    }
+
+    void TestLate()
+    {
+        // the packet 1 arrives after its (missing) block was already read, it
+        // must not be played at the position of a later packet
+        Init ( 1 );
+
+        Check ( Put ( 0 ) );
+        Check ( Put ( 2 ) );
+
+        Get ( 0 );
+        Get ( -1 );
+
+        Check ( !Put ( 1 ) );
+        Check ( Put ( 3 ) );
+
+        Get ( 2 );
+        Get ( 3 );
+
+        Check ( ( NetBuf.GetNumLate() == 1 ) && ( NetBuf.GetNumConcealed() == 1 ) );
+
+        Report ( "late" );
+    }
+
+    void TestLost()
+    {
+        // the packets 1, 2 and 5 are lost, their blocks are read with an error
+        // and contain silence (not the payload of another packet)
+        Init ( 1 );
+
+        Check ( Put ( 0 ) );
+        Check ( Put ( 3 ) );
+        Check ( Put ( 4 ) );
+        Check ( Put ( 6 ) );
+
+        Get ( 0 );
+        Get ( -1 );
+        Get ( -1 );
+        Get ( 3 );
+        Get ( 4 );
+        Get ( -1 );
+        Get ( 6 );
+
+        Check ( NetBuf.GetNumConcealed() == 3 );
+
+        Report ( "lost" );
+    }
+
+    void TestSeqNumWrapAround()
+    {
+        // reordering and loss at the wrap around of the sequence number
+        Init ( 1 );
+
+        Check ( Put ( NET_BUF_SEQ_NUM_RANGE - 2 ) );
+        Check ( Put ( 0 ) );
+        Check ( Put ( NET_BUF_SEQ_NUM_RANGE - 1 ) );
+        Check ( Put ( 2 ) );
+
+        Get ( NET_BUF_SEQ_NUM_RANGE - 2 );
+        Get ( NET_BUF_SEQ_NUM_RANGE - 1 );
+        Get ( 0 );
+        Get ( -1 );
+        Get ( 2 );
+
+        Check ( ( NetBuf.GetNumReordered() == 1 ) && ( NetBuf.GetNumConcealed() == 1 ) );
+
+        Report ( "sequence number wrap around" );
+    }
+
+    void TestMultiBlockPackets()
+    {
+        // packets of three blocks (block size factor) with a reordering and a
+        // loss, the blocks of the packets wrap around at the end of the buffer
+        // memory
+        Init ( 3 );
+
+        for ( int i = 0; i < 4; i++ )
+        {
+            Check ( Put ( i ) );
+            Get ( i );
+        }
+
+        Check ( Put ( 4 ) );
+        Check ( Put ( 6 ) );
+        Check ( Put ( 5 ) );
+        Check ( Put ( 8 ) );
+
+        Get ( 4 );
+        Get ( 5 );
+        Get ( 6 );
+        Get ( -1 );
+        Get ( 8 );
+
+        Check ( ( NetBuf.GetNumReordered() == 1 ) && ( NetBuf.GetNumConcealed() == 3 ) );
+
+        Report ( "packets of several blocks" );
+    }
+
+    void TestRedundancyRecovery()
+    {
+        // the lost packet 2 is recovered from the redundancy frame which is
+        // sent with the packet 4 (XOR of the packets 1 to 3), a late arrival
+        // of the recovered packet is dropped
+        Init ( 1 );
+
+        Check ( Put ( 0 ) );
+        Check ( Put ( 1 ) );
+        Check ( Put ( 3 ) );
+        Check ( Put ( 4 ) );
+        Check ( PutRedundancy ( 4, 3 ) );
+        Check ( !Put ( 2 ) );
+
+        Get ( 0 );
+        Get ( 1 );
+        Get ( 2 );
+        Get ( 3 );
+        Get ( 4 );
+
+        // the same with packets of two blocks
+        Init ( 2 );
+
+        Check ( Put ( 10 ) );
+        Check ( Put ( 12 ) );
+        Check ( PutRedundancy ( 13, 2 ) );
+
+        Get ( 10 );
+        Get ( 11 );
+        Get ( 12 );
+
+        Check ( ( NetBuf.GetNumRecovered() == 1 ) && ( NetBuf.GetNumConcealed() == 0 ) );
+
+        Report ( "redundancy recovery" );
+    }
+
+    void TestRedundancyNotRecoverable()
+    {
+        // two lost packets cannot be recovered from one redundancy frame
+        Init ( 1 );
+
+        Check ( Put ( 0 ) );
+        Check ( Put ( 3 ) );
+        Check ( !PutRedundancy ( 4, 3 ) );
+
+        Get ( 0 );
+        Get ( -1 );
+        Get ( -1 );
+        Get ( 3 );
+
+        Check ( NetBuf.GetNumRecovered() == 0 );
+
+        // a lost packet which was already read (and concealed) must not be
+        // recovered anymore
+        Init ( 1 );
+
+        Check ( Put ( 0 ) );
+        Check ( Put ( 2 ) );
+
+        Get ( 0 );
+        Get ( -1 );
+
+        Check ( !PutRedundancy ( 3, 2 ) );
+
+        Get ( 2 );
+
+        Check ( ( NetBuf.GetNumRecovered() == 0 ) && ( NetBuf.GetNumConcealed() == 1 ) );
+
+        Report ( "redundancy, not recoverable" );
+    }
+
+    QTextStream      tsConsole;
+    CNetBuf          NetBuf;
+    CVector<uint8_t> vecbyPacket;
+    CVector<uint8_t> vecbyBlock;
+    int              iNumErrors;
+};
+
 #endif /* !defined ( TESTBENCH_HOIHJH8_3_43445KJIUHF1912__INCLUDED_ ) */
@@ -64,6 +64,33 @@ void CStereoSignalLevelMeter::Update ( CVector<short>& vecsAudio )
     dCurLevelR = UpdateCurLevel ( dCurLevelR, sMaxR );
 }
 
+void CStereoSignalLevelMeter::Update ( CVector<float>& vecfAudio )
+{
+    // same as the 16 bit version but for floating point samples in the range
+    // -1..1 (the maximum is scaled to the 16 bit range)
+    const int iStereoVecSize = vecfAudio.Size();
+
+    float fMaxL = 0;
+    float fMaxR = 0;
+    for ( int i = 0; i < iStereoVecSize; i += 6 ) // 2 * 3 = 6 -> stereo
+    {
+        // left channel
+        if ( fMaxL < vecfAudio[i] )
+        {
+            fMaxL = vecfAudio[i];
+        }
+
+        // right channel
+        if ( fMaxR < vecfAudio[i + 1] )
+        {
+            fMaxR = vecfAudio[i + 1];
+        }
+    }
+
+    dCurLevelL = UpdateCurLevel ( dCurLevelL, Double2Short ( fMaxL * _MAXSHORT ) );
+    dCurLevelR = UpdateCurLevel ( dCurLevelR, Double2Short ( fMaxR * _MAXSHORT ) );
+}
+
 double CStereoSignalLevelMeter::UpdateCurLevel ( double       dCurLevel,
                                                  const short& sMax )
 {
@@ -197,16 +224,30 @@ void CAudioReverb::Init ( const int iSampleRate, const double rT60 )
 
     for ( i = 0; i < 3; i++ )
     {
-        allpassDelays_[i].Init ( lengths[i + 4] );
+        vecfAllpassDelays[i].Init ( lengths[i + 4] );
     }
 
     for ( i = 0; i < 4; i++ )
     {
-        combDelays_[i].Init ( lengths[i] );
+        vecfCombDelays[i].Init ( lengths[i] );
+    }
+
+    // the shortest delay line limits the block length
+    iMaxBlockLen = lengths[0];
+
+    for ( i = 1; i < 7; i++ )
+    {
+        if ( lengths[i] < iMaxBlockLen )
+        {
+            iMaxBlockLen = lengths[i];
+        }
     }
 
+    vecfBlock.Init    ( iMaxBlockLen );
+    vecfBlockOut.Init ( iMaxBlockLen );
+
     setT60 ( rT60, iSampleRate );
-    allpassCoefficient_ = (double) 0.7;
+    fAllpassCoefficient = 0.7f;
     Clear();
 }
 
@@ -241,14 +282,20 @@ bool CAudioReverb::isPrime ( const int number )
 
 void CAudioReverb::Clear()
 {
+    int i;
+
     // reset and clear all internal state
-    allpassDelays_[0].Reset ( 0 );
-    allpassDelays_[1].Reset ( 0 );
-    allpassDelays_[2].Reset ( 0 );
-    combDelays_[0].Reset    ( 0 );
-    combDelays_[1].Reset    ( 0 );
-    combDelays_[2].Reset    ( 0 );
-    combDelays_[3].Reset    ( 0 );
+    for ( i = 0; i < 3; i++ )
+    {
+        vecfAllpassDelays[i].Reset ( 0 );
+        iAllpassDelayIdx[i] = 0;
+    }
+
+    for ( i = 0; i < 4; i++ )
+    {
+        vecfCombDelays[i].Reset ( 0 );
+        iCombDelayIdx[i] = 0;
+    }
 }
 
 void CAudioReverb::setT60 ( const double rT60,
@@ -257,45 +304,320 @@ void CAudioReverb::setT60 ( const double rT60,
     // set the reverberation T60 decay time
     for ( int i = 0; i < 4; i++ )
     {
-        combCoefficient_[i] = pow ( (double) 10.0, (double) ( -3.0 *
-            combDelays_[i].Size() / ( rT60 * iSampleRate ) ) );
+        fCombCoefficient[i] = static_cast<float> ( pow ( (double) 10.0, (double) ( -3.0 *
+            vecfCombDelays[i].Size() / ( rT60 * iSampleRate ) ) ) );
+    }
+}
+
+void CAudioReverb::ProcessAllpass ( const int iIdx,
+                                    float*    pfData,
+                                    const int iLen )
+{
+    CVector<float>& vecfDelay = vecfAllpassDelays[iIdx];
+    int&            iDelayIdx = iAllpassDelayIdx[iIdx];
+    int             iPos      = 0;
+
+    // Since the block is not longer than the delay line, all delayed samples
+    // of the block are from previous blocks and each sample can be processed
+    // independently. We only have to split the block at the wrap around of
+    // the delay line memory.
+    while ( iPos < iLen )
+    {
+        int iSpanLen = vecfDelay.Size() - iDelayIdx;
+
+        if ( iSpanLen > iLen - iPos )
+        {
+            iSpanLen = iLen - iPos;
+        }
+
+        float* pfDelay = &vecfDelay[iDelayIdx];
+        float* pfSpan  = pfData + iPos;
+
+        for ( int k = 0; k < iSpanLen; k++ )
+        {
+            const float fDelayed = pfDelay[k];
+            const float fNew     = pfSpan[k] + fAllpassCoefficient * fDelayed;
+
+            pfDelay[k] = fNew;
+            pfSpan[k]  = fDelayed - fAllpassCoefficient * fNew;
+        }
+
+        iPos      += iSpanLen;
+        iDelayIdx += iSpanLen;
+
+        if ( iDelayIdx == vecfDelay.Size() )
+        {
+            iDelayIdx = 0;
+        }
+    }
+}
+
+void CAudioReverb::ProcessComb ( const int    iIdx,
+                                 const float* pfIn,
+                                 float*       pfOut,
+                                 const int    iLen )
+{
+    CVector<float>& vecfDelay = vecfCombDelays[iIdx];
+    int&            iDelayIdx = iCombDelayIdx[iIdx];
+    const float     fCoef     = fCombCoefficient[iIdx];
+    int             iPos      = 0;
+
+    // the comb output is added to the output block (same block splitting as
+    // for the allpass filter)
+    while ( iPos < iLen )
+    {
+        int iSpanLen = vecfDelay.Size() - iDelayIdx;
+
+        if ( iSpanLen > iLen - iPos )
+        {
+            iSpanLen = iLen - iPos;
+        }
+
+        float*       pfDelay   = &vecfDelay[iDelayIdx];
+        const float* pfSpanIn  = pfIn + iPos;
+        float*       pfSpanOut = pfOut + iPos;
+
+        for ( int k = 0; k < iSpanLen; k++ )
+        {
+            const float fNew = pfSpanIn[k] + fCoef * pfDelay[k];
+
+            pfDelay[k]    = fNew;
+            pfSpanOut[k] += fNew;
+        }
+
+        iPos      += iSpanLen;
+        iDelayIdx += iSpanLen;
+
+        if ( iDelayIdx == vecfDelay.Size() )
+        {
+            iDelayIdx = 0;
+        }
+    }
+}
+
+void CAudioReverb::ProcessBlock ( const int iLen )
+{
+    // three series allpass units followed by four parallel comb filters (the
+    // input is taken from "vecfBlock", the output is stored in "vecfBlockOut")
+    for ( int i = 0; i < iLen; i++ )
+    {
+        vecfBlockOut[i] = 0;
+    }
+
+    ProcessAllpass ( 0, &vecfBlock[0], iLen );
+    ProcessAllpass ( 1, &vecfBlock[0], iLen );
+    ProcessAllpass ( 2, &vecfBlock[0], iLen );
+
+    for ( int i = 0; i < 4; i++ )
+    {
+        ProcessComb ( i, &vecfBlock[0], &vecfBlockOut[0], iLen );
     }
 }
 
-double CAudioReverb::ProcessSample ( const double input )
+void CAudioReverb::Process ( CVector<int16_t>& vecsStereo,
+                             const int         iStereoBlockSize,
+                             const int         iChannel,
+                             const double      dLevel )
 {
-    // compute one output sample
-    double temp, temp0, temp1, temp2;
-
-    temp = allpassDelays_[0].Get();
-    temp0 = allpassCoefficient_ * temp;
-    temp0 += input;
-    allpassDelays_[0].Add ( (int) temp0 );
-    temp0 = - ( allpassCoefficient_ * temp0 ) + temp;
-
-    temp = allpassDelays_[1].Get();
-    temp1 = allpassCoefficient_ * temp;
-    temp1 += temp0;
-    allpassDelays_[1].Add ( (int) temp1 );
-    temp1 = - ( allpassCoefficient_ * temp1 ) + temp;
-
-    temp = allpassDelays_[2].Get();
-    temp2 = allpassCoefficient_ * temp;
-    temp2 += temp1;
-    allpassDelays_[2].Add ( (int) temp2 );
-    temp2 = - ( allpassCoefficient_ * temp2 ) + temp;
-
-    const double temp3 = temp2 + ( combCoefficient_[0] * combDelays_[0].Get() );
-    const double temp4 = temp2 + ( combCoefficient_[1] * combDelays_[1].Get() );
-    const double temp5 = temp2 + ( combCoefficient_[2] * combDelays_[2].Get() );
-    const double temp6 = temp2 + ( combCoefficient_[3] * combDelays_[3].Get() );
-
-    combDelays_[0].Add ( (int) temp3 );
-    combDelays_[1].Add ( (int) temp4 );
-    combDelays_[2].Add ( (int) temp5 );
-    combDelays_[3].Add ( (int) temp6 );
-
-    return ( temp3 + temp4 + temp5 + temp6 ) * (double) 0.5;
+    int       i, j;
+    const int iNumSamples = iStereoBlockSize / 2;
+
+    // the comb output sum is scaled by 0.5 (as in the original JCRev)
+    const float fOutLevel = static_cast<float> ( dLevel ) * 0.5f;
+
+    for ( int iStart = 0; iStart < iNumSamples; iStart += iMaxBlockLen )
+    {
+        int iLen = iNumSamples - iStart;
+
+        if ( iLen > iMaxBlockLen )
+        {
+            iLen = iMaxBlockLen;
+        }
+
+        // get the samples of the channel out of the interleaved block
+        for ( i = 0, j = 2 * iStart + iChannel; i < iLen; i++, j += 2 )
+        {
+            vecfBlock[i] = vecsStereo[j];
+        }
+
+        ProcessBlock ( iLen );
+
+        // add the reverberation signal to the channel
+        for ( i = 0, j = 2 * iStart + iChannel; i < iLen; i++, j += 2 )
+        {
+            vecsStereo[j] = Double2Short ( vecsStereo[j] + fOutLevel * vecfBlockOut[i] );
+        }
+    }
+}
+
+void CAudioReverb::Process ( CVector<float>& vecfStereo,
+                             const int       iStereoBlockSize,
+                             const int       iChannel,
+                             const double    dLevel )
+{
+    int       i, j;
+    const int iNumSamples = iStereoBlockSize / 2;
+
+    // the delay lines always hold samples in the 16 bit range so that the
+    // client can switch between both sample formats without a jump of the
+    // reverberation tail, the comb output sum is scaled by 0.5 (as in the
+    // original JCRev)
+    const float fInScale  = static_cast<float> ( _MAXSHORT );
+    const float fOutLevel = static_cast<float> ( dLevel ) * 0.5f / _MAXSHORT;
+
+    for ( int iStart = 0; iStart < iNumSamples; iStart += iMaxBlockLen )
+    {
+        int iLen = iNumSamples - iStart;
+
+        if ( iLen > iMaxBlockLen )
+        {
+            iLen = iMaxBlockLen;
+        }
+
+        // get the samples of the channel out of the interleaved block
+        for ( i = 0, j = 2 * iStart + iChannel; i < iLen; i++, j += 2 )
+        {
+            vecfBlock[i] = fInScale * vecfStereo[j];
+        }
+
+        ProcessBlock ( iLen );
+
+        // add the reverberation signal to the channel
+        for ( i = 0, j = 2 * iStart + iChannel; i < iLen; i++, j += 2 )
+        {
+            vecfStereo[j] += fOutLevel * vecfBlockOut[i];
+        }
+    }
+}
+
+
+/******************************************************************************\
+* Clock drift resampler                                                        *
+\******************************************************************************/
+void CDriftResampler::Init ( const int iNewNumChannels,
+                             const int iNewFrameSize )
+{
+    iNumChannels = iNewNumChannels;
+    iFrameSize   = iNewFrameSize;
+
+    // we need one frame plus the interpolation taps, the remaining space is
+    // for the maximum resampling ratio
+    vecsBuffer.Init ( ( 3 * iFrameSize + 4 ) * iNumChannels );
+
+    Reset();
+}
+
+void CDriftResampler::Reset()
+{
+    // the interpolation needs one sample before the read position, we start
+    // with one zero sample
+    vecsBuffer.Reset ( 0 );
+    iNumSamples = 1;
+    dReadPos    = 1.0;
+}
+
+bool CDriftResampler::NeedsFrame ( const double dRatio ) const
+{
+    // the interpolation of the last output sample of the frame needs two
+    // samples after its position
+    const int iLastPos =
+        static_cast<int> ( dReadPos + ( iFrameSize - 1 ) * dRatio );
+
+    return ( iLastPos + 2 >= iNumSamples );
+}
+
+void CDriftResampler::PutFrame ( const int16_t* psFrame )
+{
+    const int iNumNew = iFrameSize * iNumChannels;
+
+    // check for enough space (must not happen if the frames are only put if
+    // they are needed)
+    if ( ( iNumSamples + iFrameSize ) * iNumChannels <= vecsBuffer.Size() )
+    {
+        int16_t* psDest = &vecsBuffer[iNumSamples * iNumChannels];
+
+        for ( int i = 0; i < iNumNew; i++ )
+        {
+            psDest[i] = psFrame[i];
+        }
+
+        iNumSamples += iFrameSize;
+    }
+}
+
+void CDriftResampler::GetFrame ( int16_t*     psFrame,
+                                 const double dRatio )
+{
+    int i, j;
+
+    for ( i = 0; i < iFrameSize; i++ )
+    {
+        const double dPos  = dReadPos + i * dRatio;
+        const int    iPos  = static_cast<int> ( dPos );
+        const double dFrac = dPos - iPos;
+
+        // the samples must be available (see NeedsFrame), otherwise we keep
+        // the last output value
+        if ( iPos + 2 < iNumSamples )
+        {
+            const int16_t* psIn = &vecsBuffer[( iPos - 1 ) * iNumChannels];
+
+            for ( j = 0; j < iNumChannels; j++ )
+            {
+                // cubic Hermite (Catmull-Rom) interpolation
+                const double dXm1 = psIn[j];
+                const double dX0  = psIn[j + iNumChannels];
+                const double dX1  = psIn[j + 2 * iNumChannels];
+                const double dX2  = psIn[j + 3 * iNumChannels];
+
+                const double dC1 = 0.5 * ( dX1 - dXm1 );
+                const double dC2 = dXm1 - 2.5 * dX0 + 2.0 * dX1 - 0.5 * dX2;
+                const double dC3 = 0.5 * ( dX2 - dXm1 ) + 1.5 * ( dX0 - dX1 );
+
+                psFrame[i * iNumChannels + j] = Double2Short (
+                    ( ( dC3 * dFrac + dC2 ) * dFrac + dC1 ) * dFrac + dX0 );
+            }
+        }
+        else if ( i > 0 )
+        {
+            for ( j = 0; j < iNumChannels; j++ )
+            {
+                psFrame[i * iNumChannels + j] =
+                    psFrame[( i - 1 ) * iNumChannels + j];
+            }
+        }
+        else
+        {
+            for ( j = 0; j < iNumChannels; j++ )
+            {
+                psFrame[j] = 0;
+            }
+        }
+    }
+
+    // advance the read position and remove the samples which are not needed
+    // anymore (we keep one sample before the read position)
+    dReadPos += iFrameSize * dRatio;
+
+    int iNumRemove = static_cast<int> ( dReadPos ) - 1;
+
+    if ( iNumRemove > iNumSamples )
+    {
+        iNumRemove = iNumSamples;
+    }
+
+    if ( iNumRemove > 0 )
+    {
+        const int iNumKeep = ( iNumSamples - iNumRemove ) * iNumChannels;
+
+        for ( i = 0; i < iNumKeep; i++ )
+        {
+            vecsBuffer[i] = vecsBuffer[i + iNumRemove * iNumChannels];
+        }
+
+        iNumSamples -= iNumRemove;
+        dReadPos    -= iNumRemove;
+    }
 }
 
 
@@ -36,7 +36,11 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QLocale>
+#include <QAtomicInt>
+#include <QThread>
+#include <QElapsedTimer>
 #include <vector>
+#include <algorithm>
 #include "global.h"
 using namespace std; // because of the library: "vector"
 #ifdef _WIN32
@@ -49,6 +53,18 @@ using namespace std; // because of the library: "vector"
 /* Definitions ****************************************************************/
 #define METER_FLY_BACK              2
 
+// number of bins of the audio processing time histograms (the limits of the
+// bins are defined in percent of the sound card block duration)
+#define AUD_PROC_TIME_NUM_BINS      6
+
+// number of round trip times which are used for the mean value and the
+// percentiles of the round trip time statistic
+#define RTT_STAT_HISTORY_LEN        100
+
+// a gap between received packets which is larger than this value restarts the
+// inter-arrival jitter measurement (e.g., on a new connection)
+#define INTER_ARRIVAL_MAX_GAP_US    500000 // us
+
 
 /* Global functions ***********************************************************/
 // converting double to short
@@ -69,6 +85,27 @@ inline short Double2Short ( const double dInput )
     return (short) dInput;
 }
 
+// atomic access with memory ordering: QAtomicInt::loadAcquire() and
+// storeRelease() only exist in Qt 5, in Qt 4 we have to use the
+// read-modify-write operations with the same memory ordering
+inline int AtomicLoadAcquire ( const QAtomicInt& iAtomic )
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    return iAtomic.loadAcquire();
+#else
+    return const_cast<QAtomicInt&> ( iAtomic ).fetchAndAddAcquire ( 0 );
+#endif
+}
+
+inline void AtomicStoreRelease ( QAtomicInt& iAtomic, const int iNewValue )
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    iAtomic.storeRelease ( iNewValue );
+#else
+    iAtomic.fetchAndStoreRelease ( iNewValue );
+#endif
+}
+
 // debug error handling
 void DebugError ( const QString& pchErDescr,
                   const QString& pchPar1Descr, 
@@ -77,10 +114,43 @@ void DebugError ( const QString& pchErDescr,
                   const double   dPar2 );
 
 // calculate the bit rate in bits per second from the number of coded bytes
-inline int CalcBitRateBitsPerSecFromCodedBytes ( const int iCeltNumCodedBytes )
+inline int CalcBitRateBitsPerSecFromCodedBytes ( const int iCeltNumCodedBytes,
+                                                 const int iFrameSizeSamples = SYSTEM_FRAME_SIZE_SAMPLES )
 {
     return ( SYSTEM_SAMPLE_RATE_HZ * iCeltNumCodedBytes * 8 ) /
-        SYSTEM_FRAME_SIZE_SAMPLES;
+        iFrameSizeSamples;
+}
+
+// uncompressed audio (audio coding type "none"): the 16 bit samples are
+// transmitted in little endian byte order
+inline void PackRawAudio ( const int16_t* psAudio,
+                           const int      iNumSamples,
+                           uint8_t*       pbyData )
+{
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        pbyData[2 * i]     = static_cast<uint8_t> ( psAudio[i] & 255 );
+        pbyData[2 * i + 1] = static_cast<uint8_t> ( ( psAudio[i] >> 8 ) & 255 );
+    }
+}
+
+// a NULL pointer as data means that the packet was lost, the frame is muted
+inline void UnpackRawAudio ( const uint8_t* pbyData,
+                             const int      iNumSamples,
+                             int16_t*       psAudio )
+{
+    for ( int i = 0; i < iNumSamples; i++ )
+    {
+        if ( pbyData == NULL )
+        {
+            psAudio[i] = 0;
+        }
+        else
+        {
+            psAudio[i] = static_cast<int16_t> (
+                pbyData[2 * i] | ( pbyData[2 * i + 1] << 8 ) );
+        }
+    }
 }
 
 
@@ -402,6 +472,110 @@ template<class TData> void CMovingAv<TData>::Add ( const TData tNewD )
 }
 
 
+/******************************************************************************\
+* CMovingAvBit Class (Moving Average of Binary Values)                         *
+\******************************************************************************/
+// The history is bit-packed in 32 bit words (the memory is reduced by a factor
+// of eight compared to a CMovingAv<char>) and the number of set bits in the
+// history is updated on each new value.
+class CMovingAvBit
+{
+public:
+    CMovingAvBit() :
+        iHistoryLength ( 0 ),
+        iCurIdx ( 0 ),
+        iNorm ( 0 ),
+        iNumSetBits ( 0 ),
+        dNoDataResult ( 0 ) {}
+
+    void Init ( const int    iNewSize,
+                const double dNNoDRes = 0 )
+    {
+        iHistoryLength = iNewSize;
+        dNoDataResult  = dNNoDRes;
+        vecuHistory.Init ( ( iNewSize + 31 ) / 32 );
+        Reset();
+    }
+
+    void Reset()
+    {
+        iNorm       = 0;
+        iCurIdx     = 0;
+        iNumSetBits = 0;
+        vecuHistory.Reset ( 0 );
+    }
+
+    void Add ( const bool bNewD )
+    {
+        uint32_t&      uWord = vecuHistory[iCurIdx >> 5];
+        const uint32_t uMask = static_cast<uint32_t> ( 1 ) << ( iCurIdx & 31 );
+
+        // subtract oldest value (not yet initialized values are zero)
+        if ( uWord & uMask )
+        {
+            iNumSetBits--;
+        }
+
+        // add new value and write in memory
+        if ( bNewD )
+        {
+            uWord |= uMask;
+            iNumSetBits++;
+        }
+        else
+        {
+            uWord &= ~uMask;
+        }
+
+        // increase position pointer and test if wrap
+        iCurIdx++;
+        if ( iCurIdx >= iHistoryLength )
+        {
+            iCurIdx = 0;
+        }
+
+        // take care of norm
+        if ( iNorm < iHistoryLength )
+        {
+            iNorm++;
+        }
+    }
+
+    inline double GetAverage() const
+    {
+        // make sure we do not divide by zero
+        if ( iNorm == 0 )
+        {
+            return dNoDataResult;
+        }
+        else
+        {
+            return static_cast<double> ( iNumSetBits ) / iNorm;
+        }
+    }
+
+    double InitializationState() const
+    {
+        // make sure we do not divide by zero
+        if ( iHistoryLength != 0 )
+        {
+            return static_cast<double> ( iNorm ) / iHistoryLength;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+protected:
+    CVector<uint32_t> vecuHistory;
+    int               iHistoryLength;
+    int               iCurIdx;
+    int               iNorm;
+    int               iNumSetBits;
+    double            dNoDataResult;
+};
+
 /******************************************************************************\
 * GUI Utilities                                                                *
 \******************************************************************************/
@@ -446,7 +620,8 @@ enum EAudComprType
     // used for protocol -> enum values must be fixed!
     CT_NONE = 0,
     CT_CELT = 1,
-    CT_OPUS = 2
+    CT_OPUS = 2,
+    CT_OPUS64 = 3 // OPUS with the small frame size
 };
 
 
@@ -497,6 +672,7 @@ public:
     CStereoSignalLevelMeter() { Reset(); }
 
     void   Update ( CVector<short>& vecsAudio );
+    void   Update ( CVector<float>& vecfAudio );
     double MicLevelLeft()  { return CalcLogResult ( dCurLevelL ); }
     double MicLevelRight() { return CalcLogResult ( dCurLevelR ); }
     void   Reset()         { dCurLevelL = 0.0; dCurLevelR = 0.0; }
@@ -550,6 +726,18 @@ public:
                  ( CompAddr.iPort    == iPort ) );
     }
 
+    // The local transport for co-located clients uses the address 0.0.0.0
+    // (which can never be the source of a network packet) and the UDP port
+    // number of the peer which is unique on the host.
+    static CHostAddress LocalTransport ( const quint16 iNPort )
+        { return CHostAddress ( QHostAddress ( static_cast<quint32> ( 0 ) ), iNPort ); }
+
+    bool IsLocalTransport() const
+    {
+        return ( InetAddr == QHostAddress ( static_cast<quint32> ( 0 ) ) ) &&
+               ( iPort != 0 );
+    }
+
     QString toString ( const EStringMode eStringMode = SM_IP_PORT ) const
     {
         QString strReturn = InetAddr.toString();
@@ -871,23 +1059,77 @@ public:
 
 
 // Audio reverbration ----------------------------------------------------------
+// Note that the output is not bit exact compared to the former per sample
+// implementation: the delay lines store float values instead of truncating
+// them to integers and the filters are calculated in float instead of double
+// (see CAudioReverbTestbench for a comparison).
 class CAudioReverb
 {
 public:
     CAudioReverb() {}
     
-    void   Init ( const int iSampleRate, const double rT60 = (double) 5.0 );
-    void   Clear();
-    double ProcessSample ( const double input );
+    void Init ( const int iSampleRate, const double rT60 = (double) 5.0 );
+    void Clear();
+
+    // adds the reverberation signal of one channel of an interleaved stereo
+    // block (channel index 0: left, 1: right) weighted with the given level
+    void Process ( CVector<int16_t>& vecsStereo,
+                   const int         iStereoBlockSize,
+                   const int         iChannel,
+                   const double      dLevel );
+
+    // floating point samples (the samples are not clipped)
+    void Process ( CVector<float>& vecfStereo,
+                   const int       iStereoBlockSize,
+                   const int       iChannel,
+                   const double    dLevel );
 
 protected:
     void setT60 ( const double rT60, const int iSampleRate );
     bool isPrime ( const int number );
 
-    CFIFO<int>  allpassDelays_[3];
-    CFIFO<int>  combDelays_[4];
-    double      allpassCoefficient_;
-    double      combCoefficient_[4];
+    void ProcessBlock ( const int iLen );
+
+    void ProcessAllpass ( const int iIdx, float* pfData, const int iLen );
+    void ProcessComb    ( const int iIdx, const float* pfIn, float* pfOut, const int iLen );
+
+    // the delay lines are processed block-wise, a block must not be longer
+    // than the shortest delay line
+    CVector<float> vecfAllpassDelays[3];
+    int            iAllpassDelayIdx[3];
+    CVector<float> vecfCombDelays[4];
+    int            iCombDelayIdx[4];
+    int            iMaxBlockLen;
+    float          fAllpassCoefficient;
+    float          fCombCoefficient[4];
+    CVector<float> vecfBlock;
+    CVector<float> vecfBlockOut;
+};
+
+
+// Clock drift resampler -------------------------------------------------------
+// Asynchronous resampler for the compensation of small clock drifts. The input
+// frames are stored in a FIFO and the output samples are interpolated at a
+// fractional read position which advances by the resampling ratio (number of
+// input samples per output sample). For ratios close to one a cubic Hermite
+// interpolation gives a good quality with only four taps.
+class CDriftResampler
+{
+public:
+    CDriftResampler() { Init ( 1, 0 ); }
+
+    void Init ( const int iNewNumChannels, const int iNewFrameSize );
+    void Reset();
+    bool NeedsFrame ( const double dRatio ) const;
+    void PutFrame ( const int16_t* psFrame );
+    void GetFrame ( int16_t* psFrame, const double dRatio );
+
+protected:
+    CVector<int16_t> vecsBuffer; // interleaved samples of all channels
+    int              iNumChannels;
+    int              iFrameSize;
+    int              iNumSamples; // number of stored samples per channel
+    double           dReadPos;
 };
 
 
@@ -951,11 +1193,39 @@ public:
             return round ( dValue + dHysteresis );
         }
     }
+
+    static int GreatestCommonDivisor ( int iA, int iB )
+    {
+        // Euclidean algorithm
+        while ( iB != 0 )
+        {
+            const int iRemainder = iA % iB;
+
+            iA = iB;
+            iB = iRemainder;
+        }
+
+        return iA;
+    }
+};
+
+
+// Thread sleep ----------------------------------------------------------------
+// The sleep functions of QThread are protected in Qt 4, this class makes them
+// usable outside of a thread object.
+class CThreadSleep : public QThread
+{
+public:
+    static void MSleep ( const unsigned long iTimeMs ) { QThread::msleep ( iTimeMs ); }
 };
 
 
 // Precise time ----------------------------------------------------------------
-// required for ping measurement
+// Monotonic time with microsecond resolution, required for ping measurement.
+// All objects share the same time base so that the time stamps can be
+// exchanged between objects and threads (e.g. the receive time stamps of the
+// socket). The time stamps are 32 bit values which wrap around after about 71
+// minutes, therefore time differences must be calculated with DiffUs().
 class CPreciseTime
 {
 public:
@@ -966,14 +1236,33 @@ public:
     virtual ~CPreciseTime() { timeEndPeriod ( 1 ); }
 #endif
 
-    // precise time (on Windows the QTime is not precise enough)
-    int elapsed()
+    int elapsedUs() const
     {
-#ifdef _WIN32
-        return timeGetTime();
-#else
-        return QTime().elapsed();
-#endif
+        return static_cast<int> ( static_cast<uint32_t> (
+            GetTimeBase().nsecsElapsed() / 1000 ) );
+    }
+
+    static int DiffUs ( const int iTimeUs, const int iRefTimeUs )
+    {
+        // the time stamps wrap around
+        return static_cast<int> ( static_cast<uint32_t> ( iTimeUs ) -
+                                  static_cast<uint32_t> ( iRefTimeUs ) );
+    }
+
+protected:
+    static QElapsedTimer StartTimeBase()
+    {
+        QElapsedTimer TimeBase;
+        TimeBase.start();
+        return TimeBase;
+    }
+
+    static const QElapsedTimer& GetTimeBase()
+    {
+        // the QElapsedTimer uses the monotonic clock of the operating system
+        // (on Windows the performance counter)
+        static const QElapsedTimer TimeBase = StartTimeBase();
+        return TimeBase;
     }
 };
 
@@ -1015,27 +1304,314 @@ public:
         }
 
         // add errors as values 0 and 1 to get correct error rate average
-        if ( bState )
+        ErrorsMovAvBuf.Add ( bState );
+
+        // store state
+        bPreviousState = bState;
+    }
+
+    double GetAverage() { return ErrorsMovAvBuf.GetAverage(); }
+    double InitializationState() { return ErrorsMovAvBuf.InitializationState(); } 
+
+protected:
+    CMovingAvBit ErrorsMovAvBuf;
+    bool         bBlockOnDoubleErrors;
+    bool         bPreviousState;
+};
+
+
+// Audio processing time measurement -------------------------------------------
+// stages of the audio processing which are measured
+enum EAudioProcStage
+{
+    APS_REVERB = 0,
+    APS_ENCODE,
+    APS_SEND,
+    APS_DECODE,
+    APS_TOTAL,
+    APS_NUM_STAGES // must be the last entry
+};
+
+// The statistic is only updated by the audio thread and read by the GUI
+// thread. Since there is only one writer, the counters are simply loaded and
+// stored atomically without any mutex which must not be used in the audio
+// callback. A reset is only requested by the GUI thread with an atomic flag,
+// the counters are cleared by the audio thread on its next update so that
+// they are never written by two threads at the same time.
+class CAudioProcTimeStats
+{
+public:
+    CAudioProcTimeStats() : iBudgetNs ( 1 ), iResetRequested ( 0 ) { Reset(); }
+
+    void SetBudget ( const int iBlockSizeSamples, const int iSampleRate )
+    {
+        // the budget of one audio callback is the duration of the sound card
+        // block, must only be called if the audio thread is not running
+        iBudgetNs = static_cast<int> (
+            static_cast<qint64> ( iBlockSizeSamples ) * 1000000000 / iSampleRate );
+
+        if ( iBudgetNs < 1 )
         {
-            ErrorsMovAvBuf.Add ( 1 );
+            iBudgetNs = 1;
         }
-        else
+    }
+
+    void RequestReset() { AtomicStoreRelease ( iResetRequested, 1 ); }
+
+    void Update ( const EAudioProcStage eStage, const qint64 iTimeNs )
+    {
+        // a requested reset is done by the audio thread itself
+        if ( AtomicLoadAcquire ( iResetRequested ) != 0 )
         {
-            ErrorsMovAvBuf.Add ( 0 );
+            Reset();
+            AtomicStoreRelease ( iResetRequested, 0 );
+        }
+
+        const int iPercent = static_cast<int> ( iTimeNs * 100 / iBudgetNs );
 
+        // find the histogram bin, the last bin collects all values which
+        // exceeded the budget
+        int iBin = 0;
+
+        while ( ( iBin < AUD_PROC_TIME_NUM_BINS - 1 ) &&
+                ( iPercent >= GetBinLimitPercent ( iBin ) ) )
+        {
+            iBin++;
         }
 
-        // store state
-        bPreviousState = bState;
+        AtomicStoreRelease ( veciHist[eStage][iBin],
+            AtomicLoadAcquire ( veciHist[eStage][iBin] ) + 1 );
+
+        const int iTimeUs = static_cast<int> ( iTimeNs / 1000 );
+
+        if ( iTimeUs > AtomicLoadAcquire ( veciMaxTimeUs[eStage] ) )
+        {
+            AtomicStoreRelease ( veciMaxTimeUs[eStage], iTimeUs );
+        }
     }
 
-    double GetAverage() { return ErrorsMovAvBuf.GetAverage(); }
-    double InitializationState() { return ErrorsMovAvBuf.InitializationState(); } 
+    int GetBinCount ( const EAudioProcStage eStage, const int iBin ) const
+        { return AtomicLoadAcquire ( veciHist[eStage][iBin] ); }
+
+    int GetMaxTimeUs ( const EAudioProcStage eStage ) const
+        { return AtomicLoadAcquire ( veciMaxTimeUs[eStage] ); }
+
+    int GetBudgetUs() const { return iBudgetNs / 1000; }
+
+    // number of audio callbacks and the callbacks which needed at least 75 %
+    // of the budget (but did not exceed it) or which exceeded the budget
+    int GetNumCallbacks() const
+    {
+        int iNumCallbacks = 0;
+
+        for ( int i = 0; i < AUD_PROC_TIME_NUM_BINS; i++ )
+        {
+            iNumCallbacks += GetBinCount ( APS_TOTAL, i );
+        }
+
+        return iNumCallbacks;
+    }
+
+    int GetNumNearBudget() const
+        { return GetBinCount ( APS_TOTAL, AUD_PROC_TIME_NUM_BINS - 2 ); }
+
+    int GetNumOverBudget() const
+        { return GetBinCount ( APS_TOTAL, AUD_PROC_TIME_NUM_BINS - 1 ); }
+
+    QString GetHistogramText ( const EAudioProcStage eStage ) const
+    {
+        QString strHist;
+
+        for ( int i = 0; i < AUD_PROC_TIME_NUM_BINS; i++ )
+        {
+            if ( i > 0 )
+            {
+                strHist += ", ";
+            }
+
+            if ( i < AUD_PROC_TIME_NUM_BINS - 1 )
+            {
+                strHist += "<" + QString().setNum ( GetBinLimitPercent ( i ) ) + "%: ";
+            }
+            else
+            {
+                strHist += ">=" + QString().setNum ( GetBinLimitPercent ( i - 1 ) ) + "%: ";
+            }
+
+            strHist += QString().setNum ( GetBinCount ( eStage, i ) );
+        }
+
+        return strHist;
+    }
+
+    static int GetBinLimitPercent ( const int iBin )
+    {
+        // upper limits of the bins (the last bin has no upper limit)
+        static const int iBinLimitsPercent[AUD_PROC_TIME_NUM_BINS - 1] =
+            { 10, 25, 50, 75, 100 };
+
+        return iBinLimitsPercent[iBin];
+    }
+
+protected:
+    void Reset()
+    {
+        for ( int i = 0; i < APS_NUM_STAGES; i++ )
+        {
+            for ( int j = 0; j < AUD_PROC_TIME_NUM_BINS; j++ )
+            {
+                AtomicStoreRelease ( veciHist[i][j], 0 );
+            }
+
+            AtomicStoreRelease ( veciMaxTimeUs[i], 0 );
+        }
+    }
+
+    int        iBudgetNs;
+    QAtomicInt iResetRequested;
+    QAtomicInt veciHist[APS_NUM_STAGES][AUD_PROC_TIME_NUM_BINS];
+    QAtomicInt veciMaxTimeUs[APS_NUM_STAGES];
+};
+
+
+// Round trip time statistic ---------------------------------------------------
+// Running statistic of the round trip times of a connection. The mean value
+// and the percentiles are calculated from the last round trip times, the
+// jitter is the smoothed difference of consecutive round trip times like the
+// inter-arrival jitter of RFC 3550. A std::vector is used for the history so
+// that the statistic can be copied (e.g. to store it in a map).
+class CRttStatistics
+{
+public:
+    CRttStatistics() : veciRttUs ( RTT_STAT_HISTORY_LEN, 0 ) { Reset(); }
+
+    void Reset()
+    {
+        iNumValues = 0;
+        iPutPos    = 0;
+        iLastRttUs = 0;
+        dJitterUs  = 0;
+    }
+
+    void Update ( const int iRttUs )
+    {
+        if ( iNumValues > 0 )
+        {
+            dJitterUs += ( abs ( iRttUs - iLastRttUs ) - dJitterUs ) / 16;
+        }
+
+        iLastRttUs         = iRttUs;
+        veciRttUs[iPutPos] = iRttUs;
+        iPutPos            = ( iPutPos + 1 ) % RTT_STAT_HISTORY_LEN;
+
+        if ( iNumValues < RTT_STAT_HISTORY_LEN )
+        {
+            iNumValues++;
+        }
+    }
+
+    bool IsValid() const { return iNumValues > 0; }
+    int GetNumValues() const { return iNumValues; }
+    int GetLastUs() const { return iLastRttUs; }
+    double GetJitterUs() const { return dJitterUs; }
+
+    double GetMeanUs() const
+    {
+        double dSum = 0;
+
+        for ( int i = 0; i < iNumValues; i++ )
+        {
+            dSum += veciRttUs[i];
+        }
+
+        return iNumValues > 0 ? dSum / iNumValues : 0;
+    }
+
+    int GetPercentileUs ( const int iPercent ) const
+    {
+        int iRet = 0;
+
+        if ( iNumValues > 0 )
+        {
+            // nearest rank of the sorted history
+            std::vector<int> veciSorted ( veciRttUs.begin(),
+                                          veciRttUs.begin() + iNumValues );
+
+            std::sort ( veciSorted.begin(), veciSorted.end() );
+
+            const int iRank = ( iPercent * iNumValues + 99 ) / 100;
+
+            iRet = veciSorted[std::max ( iRank, 1 ) - 1];
+        }
+
+        return iRet;
+    }
+
+    QString GetText() const
+    {
+        QString strText = "---";
+
+        if ( iNumValues > 0 )
+        {
+            strText = "mean " + QString().setNum ( GetMeanUs() / 1000, 'f', 2 ) +
+                " ms, p50 " + QString().setNum ( GetPercentileUs ( 50 ) / 1000.0, 'f', 2 ) +
+                " ms, p95 " + QString().setNum ( GetPercentileUs ( 95 ) / 1000.0, 'f', 2 ) +
+                " ms, p99 " + QString().setNum ( GetPercentileUs ( 99 ) / 1000.0, 'f', 2 ) +
+                " ms, jitter " + QString().setNum ( dJitterUs / 1000, 'f', 2 ) + " ms";
+        }
+
+        return strText;
+    }
+
+protected:
+    std::vector<int> veciRttUs;
+    int              iNumValues;
+    int              iPutPos;
+    int              iLastRttUs;
+    double           dJitterUs;
+};
+
+
+// Inter-arrival jitter measurement --------------------------------------------
+// The inter-arrival jitter of RFC 3550 where the transmit interval is the
+// nominal packet interval of the connection. The statistic is updated by the
+// socket thread and the result is read atomically by other threads.
+class CInterArrivalJitter
+{
+public:
+    CInterArrivalJitter() : iLastArrivalTimeUs ( 0 ), bLastIsValid ( false ),
+        dJitterUs ( 0 ), iJitterUs ( 0 ) {}
+
+    void Update ( const int iArrivalTimeUs, const int iIntervalUs )
+    {
+        if ( bLastIsValid )
+        {
+            const int iDiffUs =
+                CPreciseTime::DiffUs ( iArrivalTimeUs, iLastArrivalTimeUs );
+
+            if ( ( iDiffUs >= 0 ) && ( iDiffUs < INTER_ARRIVAL_MAX_GAP_US ) )
+            {
+                dJitterUs += ( abs ( iDiffUs - iIntervalUs ) - dJitterUs ) / 16;
+            }
+            else
+            {
+                dJitterUs = 0;
+            }
+
+            AtomicStoreRelease ( iJitterUs, static_cast<int> ( dJitterUs ) );
+        }
+
+        iLastArrivalTimeUs = iArrivalTimeUs;
+        bLastIsValid       = true;
+    }
+
+    int GetJitterUs() const { return AtomicLoadAcquire ( iJitterUs ); }
 
 protected:
-    CMovingAv<char> ErrorsMovAvBuf;
-    bool            bBlockOnDoubleErrors;
-    bool            bPreviousState;
+    int        iLastArrivalTimeUs;
+    bool       bLastIsValid;
+    double     dJitterUs;
+    QAtomicInt iJitterUs;
 };
 
 #endif /* !defined ( UTIL_HOIH934256GEKJH98_3_43445KJIUHF1912__INCLUDED_ ) */